@@ -0,0 +1,67 @@
+#ifndef _ALLOCTRACK_H
+#define _ALLOCTRACK_H
+
+// Contagem das alocações de memória feitas durante o laço de renderização.
+//
+// O programa substitui os operadores globais new/delete (todas as
+// plataformas) e, no Linux (glibc), também malloc()/calloc()/realloc()/free(),
+// repassando as chamadas para o alocador original. Entre AllocTrack_BeginFrame()
+// e AllocTrack_EndFrame() cada alocação feita pela thread do laço é contada,
+// junto com o número de bytes pedidos e o local da chamada: a pilha de
+// chamadas (ALLOCTRACK_STACK_DEPTH endereços) é guardada em uma tabela de
+// tamanho fixo, sem alocar memória. Alocações de outras threads (p.ex. do
+// driver OpenGL) e de fora do quadro não são contadas.
+//
+// No Linux cada alocação é atribuída a quem a pediu, pelo endereço de
+// retorno (e, se este estiver na libc/libstdc++, pela pilha de chamadas): o
+// próprio programa ou outra biblioteca. Alocações de outras bibliotecas, como
+// o driver OpenGL dentro de glDrawElements() (o Mesa llvmpipe aloca milhares
+// de vezes por quadro), fogem do controle do programa e são contadas à parte,
+// sem registrar o local. Nas demais plataformas todas as alocações via new
+// são atribuídas ao programa.
+//
+// Após o aquecimento, o quadro não deve alocar memória: dados temporários do
+// quadro ficam na arena linear de "framearena.h". O modo --bench (veja
+// bench.h) falha se algum quadro após o aquecimento alocar memória, e lista
+// os locais das alocações. Os nomes das funções são obtidos com dladdr(); para
+// funções sem símbolo exportado é mostrado o deslocamento dentro do
+// executável, que pode ser traduzido com "addr2line -f -C -e main 0x...".
+
+#include <cstdio>
+
+#define ALLOCTRACK_STACK_DEPTH 8   // Endereços guardados por local de alocação
+#define ALLOCTRACK_MAX_SITES   256 // Locais distintos guardados
+
+struct AllocTrackStats
+{
+    unsigned long      frames;              // Quadros contados
+    unsigned long      frames_with_allocs;  // Quadros com alguma alocação
+    unsigned long      max_allocs_per_frame;
+    unsigned long long new_allocs;          // Chamadas a new/new[] feitas pelo programa
+    unsigned long long malloc_allocs;       // Chamadas a malloc/calloc/realloc feitas pelo programa (somente glibc)
+    unsigned long long bytes;               // Bytes pedidos pelo programa (new e malloc)
+    unsigned long long external_allocs;     // Alocações feitas por outras bibliotecas (somente glibc)
+    unsigned long      lost_sites;          // Alocações cujo local não coube na tabela
+};
+
+// Deve ser chamada uma vez, pela thread do laço de renderização, antes do
+// primeiro quadro.
+void AllocTrack_Init();
+
+// Delimitam a parte medida de um quadro.
+void AllocTrack_BeginFrame();
+void AllocTrack_EndFrame();
+
+// Alocações do programa (new + malloc) no último quadro terminado.
+unsigned long AllocTrack_LastFrameAllocs();
+
+// Zera as estatísticas e a tabela de locais (p.ex. ao fim do aquecimento).
+void AllocTrack_ResetStats();
+
+AllocTrackStats AllocTrack_GetStats();
+
+// Escreve em "f" os "max_sites" locais com mais alocações, com suas pilhas
+// de chamadas.
+void AllocTrack_PrintSites(FILE* f, int max_sites);
+
+#endif // _ALLOCTRACK_H
@@ -0,0 +1,84 @@
+#ifndef _ASSETIO_H
+#define _ASSETIO_H
+
+// Leitura em lote dos arquivos carregados na inicialização (modelos ".obj" e
+// texturas ".png").
+//
+// AssetIO_ReadAll() recebe a lista inteira de arquivos e pede todas as
+// leituras de uma vez. A cada leitura terminada, em qualquer ordem, é chamada
+// a função "done" na thread que chamou AssetIO_ReadAll(), que decodifica o
+// arquivo (tinyobjloader, stb_image) e o envia para a GPU enquanto os demais
+// arquivos ainda estão sendo lidos. Assim a espera pelo disco de um arquivo
+// se sobrepõe ao processamento dos anteriores, em vez de cada recurso ser
+// lido e processado um após o outro.
+//
+// Há três formas ("backends") de fazer as leituras, escolhidas com
+// "--io uring|threads|sync":
+//   - "uring": io_uring do Linux (5.7 ou mais recente), usado diretamente
+//     pelas chamadas de sistema, sem a liburing. Todas as leituras são
+//     enviadas ao kernel em uma única chamada io_uring_enter();
+//   - "threads": ASSETIO_NUM_THREADS threads que leem um arquivo cada por vez
+//     (fread), em qualquer sistema;
+//   - "sync": um arquivo após o outro, na própria thread (para comparação).
+// Por padrão é usado "uring" e, se o kernel não oferecer io_uring (ou o seu
+// uso estiver bloqueado), "threads".
+//
+// O conteúdo de cada arquivo fica em um buffer alocado por AssetIO_ReadAll(),
+// válido somente durante a chamada de "done". Os arquivos ".mtl" continuam
+// sendo lidos pelo tinyobjloader (veja o construtor de ObjModel que recebe o
+// conteúdo do ".obj" em objmodel.h).
+
+#include <cstddef>
+
+#define ASSETIO_NUM_THREADS 4 // Threads do backend "threads"
+
+enum AssetIOBackend
+{
+    ASSETIO_AUTO,    // "uring", ou "threads" se io_uring não estiver disponível
+    ASSETIO_URING,
+    ASSETIO_THREADS,
+    ASSETIO_SYNC
+};
+
+// Uma leitura do lote.
+struct AssetRead
+{
+    const char*    filepath;
+    void*          user;     // Livre para quem pede a leitura
+
+    // Preenchidos antes da chamada de "done".
+    const unsigned char* data; // NULL se o arquivo não pôde ser lido
+    size_t               size;
+};
+
+typedef void (*AssetReadDone)(AssetRead* read);
+
+struct AssetIOStats
+{
+    AssetIOBackend backend;   // Backend de fato usado no último lote
+    int            files;
+    size_t         bytes;
+    double         total_ms;  // Do pedido das leituras ao fim do último "done"
+    double         wait_ms;   // Tempo em que a thread esperou por leituras
+};
+
+// Trata o argumento argv[*i], caso seja "--io backend". Retorna false se o
+// argumento não for deste módulo.
+bool AssetIO_ParseArg(int argc, char* argv[], int* i);
+
+// Backend escolhido com "--io" (ASSETIO_AUTO se não houver a opção).
+AssetIOBackend AssetIO_GetBackend();
+const char* AssetIO_BackendName(AssetIOBackend backend);
+
+// Lê os "count" arquivos de "reads", chamando "done" para cada um assim que a
+// sua leitura termina. Retorna após todas as chamadas de "done".
+void AssetIO_ReadAll(AssetRead* reads, int count, AssetReadDone done, AssetIOBackend backend = ASSETIO_AUTO);
+
+AssetIOStats AssetIO_GetStats();
+
+// Retira o arquivo do cache de páginas do sistema operacional, para medir
+// leituras "a frio" sem privilégios de administrador (posix_fadvise() com
+// POSIX_FADV_DONTNEED; somente Linux). Retorna false se não for possível.
+bool AssetIO_DropCache(const char* filepath);
+
+#endif // _ASSETIO_H
@@ -0,0 +1,87 @@
+#ifndef _ASSETPACK_H
+#define _ASSETPACK_H
+
+// Pacote de recursos: um único arquivo com os modelos, texturas e shaders da
+// cena, usado com "--pack arquivo" no lugar dos ~50 arquivos de "data/" e
+// "src/".
+//
+// O arquivo começa com um índice (AssetPackHeader seguido de um
+// AssetPackEntry por recurso) e traz depois o conteúdo de cada recurso,
+// alinhado a 4 KiB. Os modelos são guardados já "cozidos": a malha montada
+// por BuildTriangles() (veja WriteCookedMesh() em objmodel.h), sem a leitura
+// do ".obj" e o cálculo das normais. Texturas ficam no formato original
+// (PNG), decodificadas com stbi_load_from_memory(), e shaders como texto.
+//
+// O pacote é mapeado na memória (mmap) por AssetPack_Open(): somente as
+// páginas de fato lidas são trazidas do disco, e os carregadores leem
+// diretamente do mapeamento, sem cópias intermediárias nem uma abertura de
+// arquivo por recurso. O conteúdo de cada recurso é conferido com o hash do
+// índice (FNV-1a de 64 bits) a cada leitura.
+//
+// O pacote é gerado pelo programa "packer" (veja src/packer.cpp e o alvo
+// "pack" do Makefile). Os recursos são procurados pelo nome do arquivo, sem o
+// diretório (p.ex. "museu.obj", "shader_vertex.glsl").
+
+#include <cstddef>
+#include <cstdint>
+
+#define ASSETPACK_MAGIC     "FCGPACK"
+#define ASSETPACK_VERSION   3
+#define ASSETPACK_ALIGN     4096
+#define ASSETPACK_NAME_SIZE 48
+
+enum AssetPackFormat
+{
+    ASSETPACK_COOKED_MESH = 1, // Veja WriteCookedMesh() em objmodel.h
+    ASSETPACK_IMAGE       = 2, // Arquivo de imagem original (PNG)
+    ASSETPACK_TEXT        = 3  // Arquivo de texto (shaders GLSL)
+};
+
+struct AssetPackHeader
+{
+    char     magic[8];     // ASSETPACK_MAGIC
+    uint32_t version;
+    uint32_t num_entries;
+};
+
+struct AssetPackEntry
+{
+    char     name[ASSETPACK_NAME_SIZE];
+    uint64_t offset;       // A partir do início do arquivo, múltiplo de ASSETPACK_ALIGN
+    uint64_t size;
+    uint32_t format;       // AssetPackFormat
+    uint32_t reserved;
+    uint64_t hash;         // AssetPack_Hash() do conteúdo
+};
+
+// Trata o argumento argv[*i], caso seja "--pack arquivo". Retorna false se o
+// argumento não for deste módulo.
+bool AssetPack_ParseArg(int argc, char* argv[], int* i);
+
+// Mapeia o pacote indicado com "--pack". Termina o programa com uma mensagem
+// se o arquivo não puder ser aberto ou não for um pacote válido. Sem
+// "--pack", não faz nada.
+void AssetPack_Open();
+bool AssetPack_IsOpen();
+void AssetPack_Close();
+
+// Procura um recurso pelo nome do arquivo; "path" pode incluir o diretório,
+// que é ignorado. Retorna o conteúdo (dentro do mapeamento, válido até
+// AssetPack_Close()) e o seu tamanho em "size", ou NULL se o recurso não
+// estiver no pacote ou tiver outro formato. Termina o programa se o conteúdo
+// não corresponder ao hash do índice. Pode ser chamada de qualquer thread.
+const void* AssetPack_Find(const char* path, AssetPackFormat format, size_t* size);
+
+// Como AssetPack_Find(), mas termina o programa com uma mensagem se o recurso
+// não existir.
+const void* AssetPack_Get(const char* path, AssetPackFormat format, size_t* size);
+
+uint64_t AssetPack_Hash(const void* data, size_t size);
+
+// Geração do pacote (somente o "packer"): os recursos são acumulados na
+// memória e escritos de uma vez por AssetPack_Write(), que retorna false em
+// caso de erro de escrita.
+void AssetPack_Add(const char* name, AssetPackFormat format, const void* data, size_t size);
+bool AssetPack_Write(const char* filename);
+
+#endif // _ASSETPACK_H
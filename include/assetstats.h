@@ -0,0 +1,96 @@
+#ifndef _ASSETSTATS_H
+#define _ASSETSTATS_H
+
+// Relatório de memória e de tempo de carregamento de cada recurso da cena
+// (modelos ".obj" e texturas ".png").
+//
+// Para cada recurso guardamos o tamanho do arquivo, o tempo de leitura
+// (tinyobjloader ou stb_image), de montagem da malha e de envio para a GPU,
+// o pico de memória de CPU enquanto o recurso é processado, os bytes alocados
+// na GPU em vertex buffers (VBO), index buffers (IBO) e texturas (incluindo
+// os níveis de mipmap), e o número de vértices enviados e de vértices únicos
+// (combinações distintas de posição, normal e coordenada de textura).
+//
+// Os bytes de CPU são calculados a partir da capacidade dos vetores que
+// guardam os dados (veja ObjModelMemoryBytes() em objmodel.h), e os de GPU a
+// partir dos tamanhos passados ao OpenGL; o driver pode usar um pouco mais.
+//
+// A tabela tem tamanho fixo (ASSETSTATS_MAX_ASSETS). O relatório é impresso
+// ao fim do carregamento por AssetStats_PrintTable().
+
+#include <cstdio>
+#include <cstddef>
+
+#define ASSETSTATS_MAX_ASSETS 64
+#define ASSETSTATS_NAME_SIZE  32
+
+enum AssetKind
+{
+    ASSET_MODEL,
+    ASSET_TEXTURE
+};
+
+struct AssetStats
+{
+    char      name[ASSETSTATS_NAME_SIZE]; // Nome do arquivo, sem o diretório
+    AssetKind kind;
+    size_t    file_bytes;
+    double    load_ms;           // Leitura e decodificação do arquivo
+    double    build_ms;          // Normais e malha de triângulos (somente modelos)
+    double    upload_ms;         // Cópia para a GPU
+    size_t    cpu_peak_bytes;    // Maior uso de memória de CPU durante o carregamento
+    size_t    gpu_vbo_bytes;
+    size_t    gpu_ibo_bytes;
+    size_t    gpu_texture_bytes;
+    size_t    vertices;          // Vértices enviados para a GPU (somente modelos)
+    size_t    unique_vertices;   // Vértices distintos (somente modelos)
+    long      page_faults;       // Faltas de página do processamento do recurso
+};
+
+// Soma de todos os recursos registrados.
+struct AssetStatsTotals
+{
+    int    assets;
+    int    lost_assets;          // Recursos que não couberam na tabela
+    size_t file_bytes;
+    double load_ms;
+    double build_ms;
+    double upload_ms;
+    size_t cpu_peak_bytes;       // Maior pico entre os recursos
+    size_t gpu_vbo_bytes;
+    size_t gpu_ibo_bytes;
+    size_t gpu_texture_bytes;
+};
+
+// Registra um novo recurso lido de "filepath" e retorna a sua entrada, que é
+// preenchida por quem carrega o recurso. Com a tabela cheia o recurso é
+// contado em "lost_assets" e a entrada retornada não aparece no relatório.
+AssetStats* AssetStats_Add(const char* filepath, AssetKind kind);
+
+// Indica o fim do carregamento do recurso (após o envio para a GPU).
+void AssetStats_Finish(AssetStats* stats);
+
+int AssetStats_Count();
+const AssetStats* AssetStats_Get(int index);
+AssetStatsTotals AssetStats_GetTotals();
+
+// Tamanho de um arquivo em bytes (0 se não existir).
+size_t AssetStats_FileSize(const char* filepath);
+
+// Bytes de uma textura 2D de "width" x "height" com todos os níveis de
+// mipmap, com "bytes_per_texel" bytes por texel.
+size_t AssetStats_TextureBytes(int width, int height, int bytes_per_texel);
+
+// Relógio para medir os tempos, em milissegundos.
+double AssetStats_NowMs();
+
+// Pico de memória residente (RSS) do processo e faltas de página desde o
+// início do programa. Retorna false se o sistema não fornece esses números
+// (somente Linux e macOS, via getrusage()).
+bool AssetStats_GetProcessMemory(size_t* peak_rss_bytes, long* page_faults);
+
+// Escreve a tabela com todos os recursos e o total, seguida do pico de
+// memória do processo.
+void AssetStats_PrintTable(FILE* f);
+
+#endif // _ASSETSTATS_H
@@ -0,0 +1,91 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+// Modo de benchmark ("--bench"): renderiza sem janela, dentro de um
+// framebuffer object (FBO), percorrendo o museu por um roteiro fixo de
+// câmera, e escreve um resumo dos tempos de quadro em JSON.
+//
+// No Linux o contexto OpenGL é criado via EGL sem superfície
+// (EGL_MESA_platform_surfaceless / EGL_KHR_surfaceless_context), de modo que
+// o programa roda sem servidor gráfico, inclusive no Mesa llvmpipe (sem GPU).
+// Quando isto não é possível (p.ex. no macOS), main() cria uma janela GLFW
+// invisível e renderiza no mesmo FBO.
+//
+// O roteiro é determinístico: ele é reproduzido como uma gravação de eventos
+// (veja replay.h), com o tempo da simulação avançando um passo fixo por quadro
+// e as teclas enviadas para KeyCallback() nos mesmos quadros em toda
+// execução. Ele consiste em:
+//   1. Caminhada pelo corredor com a FREE_CAMERA (teclas W e D);
+//   2. LOOK_AT_CAMERA em cada um dos 18 estandes (ENTER e seta para a direita);
+//   3. No estande 18, os cinco objetos são soltos (tecla ENTER) um a um.
+//
+// Após os BENCH_WARMUP_FRAMES quadros iniciais, o laço de renderização não
+// deve alocar memória; o programa termina com erro se alocar.
+//
+// Argumentos de linha de comando reconhecidos:
+//   --bench                 Liga o modo de benchmark
+//   --bench-size LxA        Resolução do FBO (padrão 1280x720)
+//   --bench-output arquivo  Arquivo JSON de saída (padrão "bench.json")
+//
+// Com "--replay arquivo" a gravação substitui o roteiro.
+
+#define BENCH_WARMUP_FRAMES 30 // Quadros iniciais ignorados nas estatísticas
+
+struct BenchConfig
+{
+    bool        enabled;
+    int         width;
+    int         height;
+    const char* output;
+};
+
+void Bench_InitConfig(BenchConfig* config);
+
+// Trata o argumento argv[*i], caso seja um dos argumentos "--bench*",
+// avançando *i sobre o valor do argumento. Retorna false se argv[*i] não
+// pertence ao benchmark.
+bool Bench_ParseArg(int argc, char* argv[], int* i, BenchConfig* config);
+
+// Inicia o roteiro (caso não haja uma gravação sendo reproduzida). O fim do
+// benchmark é indicado por Replay_Finished().
+void Bench_Start();
+
+// Cria um contexto OpenGL 3.3 core sem janela e carrega as funções com a
+// GLAD. Retorna false caso não seja possível (main() usa então a GLFW).
+bool Bench_CreateContext();
+void Bench_DestroyContext();
+
+// Carregador de funções OpenGL do contexto sem janela, para as funções que a
+// GLAD não carrega (veja multidraw.h). NULL sem o contexto EGL.
+void* Bench_GetProcAddress(const char* name);
+
+// Contexto adicional que compartilha objetos (buffers, texturas, fences) com
+// o contexto criado acima, para a thread de envio (veja uploader.h).
+// Bench_CreateSharedContext() e Bench_DestroySharedContext() são chamadas
+// pela thread do laço; Bench_MakeSharedContextCurrent(), pela thread que
+// usará o contexto.
+bool Bench_CreateSharedContext();
+void Bench_DestroySharedContext();
+bool Bench_MakeSharedContextCurrent(bool current);
+
+// Cria e ativa o FBO (cor RGBA8 + profundidade de 24 bits) onde a cena é
+// desenhada.
+bool Bench_CreateFramebuffer(int width, int height);
+
+// Delimitam um quadro. "stand" é o índice (0 a 17) do estande em foco na
+// LOOK_AT_CAMERA, ou -1 durante a caminhada. Bench_EndFrame() aguarda a GPU
+// terminar (glFinish) antes de medir o tempo do quadro, e retorna este tempo
+// em milissegundos.
+void Bench_BeginFrame();
+double Bench_EndFrame(int stand);
+
+// Escreve o resumo (percentis do tempo de quadro, médias por estande,
+// alocações de memória) em JSON e no terminal. Retorna false em caso de erro.
+bool Bench_WriteJSON(const BenchConfig& config);
+
+// Verifica que nenhum quadro após o aquecimento alocou memória (veja
+// alloctrack.h). Caso contrário lista os locais das alocações e retorna
+// false.
+bool Bench_CheckAllocations();
+
+#endif // _BENCH_H
@@ -0,0 +1,32 @@
+#ifndef _FRAMEARENA_H
+#define _FRAMEARENA_H
+
+// Arena linear para dados temporários de um quadro (p.ex. os vértices do
+// texto, veja TextRendering_PrintString()). A memória é um bloco fixo de
+// FRAMEARENA_SIZE bytes, reservado uma única vez; FrameArena_Alloc() apenas
+// avança um ponteiro, e FrameArena_Reset(), no início de cada quadro, libera
+// tudo de uma vez. Assim o laço de renderização não usa o heap (veja
+// alloctrack.h).
+//
+// A memória obtida só é válida até o próximo FrameArena_Reset(). Esgotar a
+// arena é um erro de programação: o programa termina com uma mensagem.
+
+#include <cstddef>
+
+#define FRAMEARENA_SIZE (1024*1024)
+
+// Reserva "size" bytes alinhados a "align" (potência de 2).
+void* FrameArena_Alloc(size_t size, size_t align = 16);
+
+template <typename T> T* FrameArena_AllocArray(size_t count)
+{
+    return (T*)FrameArena_Alloc(count * sizeof(T), alignof(T));
+}
+
+// Libera toda a memória da arena. Chamada no início de cada quadro.
+void FrameArena_Reset();
+
+// Maior uso da arena, em bytes, em um único quadro.
+size_t FrameArena_HighWater();
+
+#endif // _FRAMEARENA_H
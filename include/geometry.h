@@ -0,0 +1,63 @@
+#ifndef _GEOMETRY_H
+#define _GEOMETRY_H
+
+// Testes de colisão e de intersecção, e outras funções de geometria
+// utilizadas pela cena. Nenhuma delas depende de OpenGL, de modo que podem
+// ser medidas isoladamente (veja "microbench.cpp").
+
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#define QUANT_ESTANDE 18
+
+struct square_bbox{
+    glm::vec3   p1;
+    glm::vec3   p2;
+    glm::vec3   p3;
+    glm::vec3   p4;
+};
+
+struct box_obj {
+    glm::vec3   c; // center
+    float       x_size; // distance from center to x
+    float       y_size; // distance from center to y
+    float       z_size; // distance from center to z
+};
+
+struct sphere_obj {
+    glm::vec3   c; // center
+    float       r; // radius
+};
+
+struct plane_obj {
+    glm::vec3   c; // center
+    float       x_size; // distance from center to x
+    float       z_size; // distance from center to z
+};
+
+// Contornos (no plano XZ) do museu, dos estandes e do dinossauro, definidos
+// em main() a partir das bounding boxes dos objetos. Utilizados por
+// check_colision().
+extern struct square_bbox Museu;
+extern std::vector<square_bbox> estandes_bbox;
+extern struct square_bbox Dino;
+
+bool check_inside_museum(float x, float z);
+bool check_estande(struct square_bbox estande, float x, float z);
+bool check_estandes(float x, float z);
+bool check_dino(float x, float z);
+bool check_colision(float x, float z);
+
+float F_p1_p2(glm::vec3 v, glm::vec3 a, float x, float z);
+
+float absolute_float(float v);
+glm::vec4 bezier(float t, glm::vec4 p1, glm::vec4 p2, glm::vec4 p3, glm::vec4 p4);
+bool interseccao_caixa_caixa(struct box_obj obj1, struct box_obj obj2);
+bool interseccao_esfera_esfera(struct sphere_obj obj1, struct sphere_obj obj2);
+bool interseccao_caixa_esfera(struct box_obj caixa, struct sphere_obj esfera);
+bool interseccao_caixa_plano(struct box_obj caixa, struct plane_obj plano);
+bool interseccao_esfera_plano(struct sphere_obj esfera, struct plane_obj plano);
+
+#endif // _GEOMETRY_H
@@ -0,0 +1,97 @@
+/*
+
+    Instrumentação opcional do carregador GLAD (src/glad.c).
+
+    Quando compilado com -DGLAD_PROFILE (veja o alvo "profile" do Makefile),
+    src/glad.c passa a oferecer funções que substituem os ponteiros carregados
+    por gladLoadGLLoader() por versões que contam as chamadas de cada ponto de
+    entrada, os bytes enviados por glBufferData/glBufferSubData/glTexImage2D e
+    os draw calls com seus números de índices, quadro a quadro.
+
+    Enquanto a instrumentação está desligada os ponteiros originais ficam
+    instalados, de modo que o custo é zero. Em um build normal (sem
+    GLAD_PROFILE) todas as funções abaixo viram macros vazias.
+
+    Os contadores do quadro não são protegidos contra acesso concorrente:
+    somente a thread do laço os altera. Outras threads com contexto OpenGL
+    próprio (p.ex. a thread de envio, veja uploader.h) devem chamar
+    gladProfileSkipThread() antes das suas chamadas, que deixam de ser
+    contadas.
+
+*/
+
+#ifndef __glad_profile_h_
+#define __glad_profile_h_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GLAD_PROFILE_MAX_ENTRY_POINTS 96
+
+typedef struct gladProfileFrame {
+    unsigned long      frame;          /* Índice do quadro */
+    unsigned long      total_calls;    /* Total de chamadas OpenGL instrumentadas */
+    unsigned long      draw_calls;     /* glDraw* */
+    unsigned long long draw_indices;   /* Índices (ou vértices, em glDrawArrays*) desenhados */
+    unsigned long      uniform_calls;  /* glUniform* */
+    unsigned long long buffer_bytes;   /* Bytes enviados por glBufferData/glBufferSubData */
+    unsigned long long texture_bytes;  /* Bytes enviados por glTexImage2D/glTexSubImage2D */
+    unsigned long      calls[GLAD_PROFILE_MAX_ENTRY_POINTS]; /* Chamadas por ponto de entrada */
+} gladProfileFrame;
+
+#ifdef GLAD_PROFILE
+
+/* Liga (1) ou desliga (0) a instrumentação. Deve ser chamada após gladLoadGLLoader(). */
+void gladProfileSetEnabled(int enabled);
+int gladProfileIsEnabled(void);
+
+/* Delimitam um quadro. Os contadores do quadro são guardados no histórico em gladProfileEndFrame(). */
+void gladProfileBeginFrame(void);
+void gladProfileEndFrame(void);
+
+/* As chamadas OpenGL da thread atual deixam de ser contadas (mas continuam sendo executadas). */
+void gladProfileSkipThread(void);
+
+/* Para funções carregadas fora da GLAD (p.ex. glMultiDrawElementsIndirect(), veja multidraw.h):
+   devolve um ponteiro que conta as chamadas de "name" e chama "proc", ou o próprio "proc" se
+   "name" não é instrumentada. */
+void* gladProfileWrapProc(const char* name, void* proc);
+
+int gladProfileNumEntryPoints(void);
+const char* gladProfileEntryPointName(int index);
+
+/* Último quadro completo, ou NULL caso nenhum quadro tenha sido registrado. */
+const gladProfileFrame* gladProfileLastFrame(void);
+
+/* Escreve um resumo de uma linha do último quadro em "buffer". Retorna o número de caracteres escritos. */
+int gladProfileFormatSummary(char* buffer, size_t size);
+
+/* Exportam todos os quadros do histórico. Retornam 0 em caso de erro. */
+int gladProfileWriteCSV(const char* filename);
+int gladProfileWriteJSON(const char* filename);
+
+#else
+
+#define gladProfileSetEnabled(enabled) ((void)(enabled))
+#define gladProfileIsEnabled() 0
+#define gladProfileBeginFrame() ((void)0)
+#define gladProfileEndFrame() ((void)0)
+#define gladProfileSkipThread() ((void)0)
+#define gladProfileWrapProc(name, proc) ((void)(name), (proc))
+#define gladProfileNumEntryPoints() 0
+#define gladProfileEntryPointName(index) ((const char*)0)
+#define gladProfileLastFrame() ((const gladProfileFrame*)0)
+#define gladProfileFormatSummary(buffer, size) ((void)(buffer), (void)(size), 0)
+#define gladProfileWriteCSV(filename) 0
+#define gladProfileWriteJSON(filename) 0
+
+#endif /* GLAD_PROFILE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __glad_profile_h_ */
@@ -0,0 +1,63 @@
+#ifndef _GLSTATE_H
+#define _GLSTATE_H
+
+#include <glad/glad.h>
+
+// Camada fina sobre os ponteiros de função carregados pela GLAD. Mantemos na
+// CPU uma cópia ("shadow") do estado atual do OpenGL: programa de GPU, VAO,
+// buffers, texturas e samplers de cada unidade, estado de blending, z-buffer e
+// culling, e os valores dos uniforms de cada programa. Chamadas que não
+// alteram nada são descartadas antes de chegarem ao driver.
+//
+// O cache pode ser desligado em tempo de execução (tecla F2); neste caso todas
+// as chamadas são repassadas diretamente para o OpenGL.
+//
+// IMPORTANTE: para que a cópia na CPU continue válida, todas as alterações do
+// estado coberto aqui devem passar por estas funções.
+
+struct GLStateStats
+{
+    unsigned long long filtered;  // Chamadas descartadas por serem redundantes
+    unsigned long long forwarded; // Chamadas repassadas para o OpenGL
+};
+
+// Liga/desliga o cache. Ao ligar, todo o estado conhecido é invalidado.
+void GLState_SetEnabled(bool enabled);
+bool GLState_IsEnabled();
+
+// Esquece todo o estado guardado na CPU (p.ex. após código externo alterar o
+// estado do OpenGL diretamente).
+void GLState_Invalidate();
+
+GLStateStats GLState_GetStats();
+void GLState_ResetStats();
+
+void GLState_UseProgram(GLuint program);
+void GLState_DeleteProgram(GLuint program);
+void GLState_BindVertexArray(GLuint vao);
+void GLState_BindBuffer(GLenum target, GLuint buffer);
+void GLState_ActiveTexture(GLenum texture);
+void GLState_BindTexture(GLenum target, GLuint texture);
+void GLState_BindSampler(GLuint unit, GLuint sampler);
+
+// Apagam objetos OpenGL. O OpenGL desfaz as ligações de um objeto apagado, e
+// o nome pode ser reutilizado pelo driver; a cópia na CPU é atualizada.
+void GLState_DeleteVertexArray(GLuint vao);
+void GLState_DeleteBuffer(GLuint buffer);
+void GLState_DeleteTexture(GLuint texture);
+
+void GLState_Enable(GLenum cap);
+void GLState_Disable(GLenum cap);
+void GLState_BlendFunc(GLenum sfactor, GLenum dfactor);
+void GLState_DepthFunc(GLenum func);
+void GLState_CullFace(GLenum mode);
+void GLState_FrontFace(GLenum mode);
+void GLState_PolygonMode(GLenum face, GLenum mode);
+void GLState_ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+// Uniforms do programa atualmente em uso (veja GLState_UseProgram()).
+void GLState_Uniform1i(GLint location, GLint v0);
+void GLState_Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+void GLState_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+#endif // _GLSTATE_H
@@ -0,0 +1,57 @@
+#ifndef _GOLDEN_H
+#define _GOLDEN_H
+
+// Teste de regressão visual e de tempo de quadro ("--golden diretório").
+//
+// Roda como o --bench (sem janela, em um FBO de tamanho fixo; veja bench.h),
+// mas com um roteiro próprio: três vistas gerais do corredor com a
+// FREE_CAMERA e uma vista de cada um dos 18 estandes com a LOOK_AT_CAMERA.
+// Cada vista é mantida por GOLDEN_SHOT_FRAMES quadros e capturada no último
+// deles; como o tempo da simulação avança um passo fixo por quadro (veja
+// replay.h), as animações estão sempre no mesmo instante na captura.
+//
+// Cada captura é comparada com a imagem de referência "diretório/nome.png":
+//   - por pixel: quantos pixels têm algum canal diferindo mais que a
+//     tolerância (--golden-tolerance, padrão 8 de 255); falha se forem mais
+//     que GOLDEN_MAX_BAD_PIXELS do total;
+//   - perceptual: SSIM médio da luminância em janelas de 8x8 pixels; falha
+//     se for menor que GOLDEN_MIN_SSIM.
+// Quando uma vista falha, a captura e um mapa das diferenças são salvos em
+// "diretório/nome_atual.png" e "diretório/nome_diff.png".
+//
+// A mediana do tempo dos últimos GOLDEN_MEASURE_FRAMES quadros de cada vista é
+// comparado com o registrado em "diretório/tempos.txt"; falha se aumentar
+// mais que a fração --golden-max-regression (padrão 0.25, isto é, 25%).
+//
+// Com "--golden-update" as capturas e os tempos viram as novas referências.
+// As referências dependem da GPU, do driver e da resolução (--bench-size),
+// por isso devem ser geradas na mesma máquina em que o teste roda.
+//
+// O resultado de cada vista é salvo em "golden.json"; main() termina com
+// EXIT_FAILURE se alguma vista falhar.
+
+#define GOLDEN_SHOT_FRAMES    45     // Quadros em cada vista
+#define GOLDEN_MEASURE_FRAMES 30     // Quadros finais de cada vista usados na mediana do tempo
+#define GOLDEN_MAX_BAD_PIXELS 0.005  // Fração máxima de pixels fora da tolerância
+#define GOLDEN_MIN_SSIM       0.98   // SSIM mínimo
+
+// Trata o argumento argv[*i], caso seja um dos argumentos "--golden*",
+// avançando *i sobre o valor do argumento. Retorna false se argv[*i] não
+// pertence a este módulo.
+bool Golden_ParseArg(int argc, char* argv[], int* i);
+
+bool Golden_IsEnabled();
+
+// Monta o roteiro das vistas (veja replay.h) para capturas de
+// "width" x "height" pixels. Deve ser chamada antes de Bench_Start().
+void Golden_Start(int width, int height);
+
+// Deve ser chamada após Bench_EndFrame(), com o FBO do benchmark ainda
+// ativo. "frame_ms" é o tempo do quadro que acabou de ser desenhado.
+void Golden_EndFrame(double frame_ms);
+
+// Escreve "golden.json" (e, com --golden-update, as novas referências).
+// Retorna false se alguma vista falhou.
+bool Golden_Finish();
+
+#endif // _GOLDEN_H
@@ -0,0 +1,87 @@
+#ifndef _GPUTIMER_H
+#define _GPUTIMER_H
+
+#include <glad/glad.h>
+
+// Medição de tempo na GPU por etapa ("pass") de renderização do quadro,
+// utilizando "query objects" do OpenGL 3.3: GL_TIME_ELAPSED para o tempo de
+// cada etapa, GL_TIMESTAMP para o quadro inteiro, e GL_PRIMITIVES_GENERATED e
+// GL_SAMPLES_PASSED (quando o driver oferece contadores para elas).
+//
+// Os resultados de uma query só ficam prontos alguns quadros depois que os
+// comandos são enviados. Para que a CPU nunca fique esperando pela GPU,
+// mantemos GPUTIMER_FRAMES_IN_FLIGHT conjuntos de queries e só lemos um
+// conjunto quando todas as suas queries indicam GL_QUERY_RESULT_AVAILABLE.
+// Quadros cujo resultado ainda não está pronto são descartados e contados.
+//
+// Junto com o tempo de GPU também medimos o tempo de CPU gasto entre
+// GpuTimer_BeginPass() e GpuTimer_EndPass(), permitindo comparar o custo do
+// envio de comandos com o custo de execução na GPU.
+//
+// Uso típico, dentro do laço de renderização:
+//
+//     GpuTimer_BeginFrame();
+//     GpuTimer_BeginPass(GPUTIMER_MUSEU);
+//     ... desenha o museu ...
+//     GpuTimer_EndPass(GPUTIMER_MUSEU);
+//     ...
+//     GpuTimer_EndFrame();
+
+#define GPUTIMER_FRAMES_IN_FLIGHT 4 // Conjuntos de queries em uso simultâneo
+#define GPUTIMER_HISTORY 240        // Quadros considerados nas estatísticas
+
+enum GpuTimerPass
+{
+    GPUTIMER_MUSEU,
+    GPUTIMER_ESTANDES,   // Os 18 pedestais
+    GPUTIMER_DINOSSAURO,
+    GPUTIMER_EXPOSICAO_1, // Objetos expostos no estande 1; os estandes 2 a 18
+                          // seguem em sequência (GPUTIMER_EXPOSICAO_1 + n-1)
+    GPUTIMER_EXPOSICAO_18 = GPUTIMER_EXPOSICAO_1 + 17,
+    GPUTIMER_MULTIDAO,   // Instâncias de "--crowd" (veja instancecull.h)
+    GPUTIMER_ENVIO_INDIRETO, // Objetos da arena enviados de uma vez (veja multidraw.h)
+    GPUTIMER_IMPOSTORES, // Objetos expostos desenhados como impostores (veja impostor.h)
+    GPUTIMER_TEXTO,
+    GPUTIMER_NUM_PASSES
+};
+
+// Estatísticas de uma etapa sobre os últimos GPUTIMER_HISTORY quadros lidos.
+// Tempos em milissegundos.
+struct GpuTimerStats
+{
+    const char* name;
+    int    samples;        // Quadros considerados
+    double gpu_mean_ms;
+    double gpu_p50_ms;
+    double gpu_p95_ms;
+    double gpu_p99_ms;
+    double gpu_max_ms;
+    double cpu_mean_ms;    // Tempo de CPU para envio dos comandos da etapa
+    double cpu_p95_ms;
+    double primitives;     // Média de primitivas geradas (0 se indisponível)
+    double samples_passed; // Média de amostras que passaram no teste de profundidade (0 se indisponível)
+};
+
+// Cria as queries. Deve ser chamada após gladLoadGLLoader().
+void GpuTimer_Init();
+
+// Liga/desliga a medição. Desligada, as funções abaixo não fazem nada.
+void GpuTimer_SetEnabled(bool enabled);
+bool GpuTimer_IsEnabled();
+
+void GpuTimer_BeginFrame();
+void GpuTimer_EndFrame();
+void GpuTimer_BeginPass(int pass);
+void GpuTimer_EndPass(int pass);
+
+const char* GpuTimer_PassName(int pass);
+GpuTimerStats GpuTimer_GetStats(int pass);
+// Estatísticas do quadro inteiro (GL_TIMESTAMP no início e no fim do quadro).
+GpuTimerStats GpuTimer_GetFrameStats();
+// Quadros descartados por seus resultados não estarem prontos a tempo.
+unsigned long GpuTimer_DroppedFrames();
+
+// Exporta as estatísticas de todas as etapas. Retorna false em caso de erro.
+bool GpuTimer_WriteJSON(const char* filename);
+
+#endif // _GPUTIMER_H
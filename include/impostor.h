@@ -0,0 +1,142 @@
+#ifndef _IMPOSTOR_H
+#define _IMPOSTOR_H
+
+// Impostores: objetos expostos pequenos na tela desenhados como um único
+// quadrilátero voltado para a câmera.
+//
+// Preparo (Impostor_BakePending(), no início de cada quadro, até
+// IMPOSTOR_BAKES_PER_FRAME exposições por vez para não atrasar o primeiro
+// quadro; até lá o objeto é desenhado como malha): cada exposição
+// registrada (uma malha com um object_id, veja ImpostorExhibit) é desenhada
+// com o programa principal em IMPOSTOR_AZIMUTHS x IMPOSTOR_ELEVATIONS
+// direções ao seu redor, com projeção ortográfica, em uma camada própria de
+// dois atlas (texturas GL_TEXTURE_2D_ARRAY, um quadro de IMPOSTOR_TILE
+// pixels por vista). No modo
+// de preparo (uniform "impostor_bake", veja "shader_fragment.glsl") o
+// shader grava, em vez da cor iluminada:
+//   - atlas de cor: a refletância difusa Kd, já com a textura e a projeção
+//     de coordenadas de textura do objeto, e a cobertura no alfa;
+//   - atlas de normais: a normal no sistema de coordenadas do modelo, e a
+//     profundidade do ponto (0 a 1 ao longo do diâmetro da esfera que
+//     envolve a bounding box) no alfa.
+// Fora do objeto os dois atlas ficam zerados; a filtragem linear e os
+// mipmaps dão valores multiplicados pela cobertura, divididos de volta ao
+// desenhar, de modo que a borda não escurece.
+//
+// Desenho (Impostor_Draw(), chamada por DrawVirtualObject()): quando a
+// esfera envolvente do objeto ocupa menos que "--impostor-pixels" pixels
+// na tela (padrão IMPOSTOR_DEFAULT_PIXELS), o objeto entra na fila do
+// quadro em vez de ser desenhado. A vista usada é a mais próxima da direção
+// da câmera no sistema de coordenadas do modelo, e o "para cima" do
+// quadrilátero é o da vista levado ao mundo pela matriz de modelagem: assim
+// objetos que giram (p.ex. as chaleiras dos estandes 14 a 17) mostram a
+// face certa, na orientação certa. Impostor_EndFrame() desenha toda a fila
+// com uma única chamada (glDrawArraysInstanced(), um quadrilátero por
+// instância). O shader do impostor reconstrói a posição de cada fragmento
+// a partir da profundidade guardada, grava gl_FragDepth (o impostor se
+// encaixa no pedestal) e aplica a mesma iluminação de
+// "shader_fragment.glsl", com a normal do atlas girada para o mundo; Ks e q
+// vêm do registro da exposição. A esfera do estande 11 (Gouraud) e a do 13
+// (Blinn-Phong) usam Phong por fragmento.
+//
+// Limitações: objetos com escala não uniforme (razão entre os eixos acima
+// de IMPOSTOR_MAX_SCALE_RATIO) são sempre desenhados como malha, pois o
+// atlas é feito com escala uniforme. Com "--stream" o preparo só acontece
+// quando a cena está completa (veja streaming.h). Quando um uniform que
+// muda a aparência de um objeto é alterado (cor da lâmpada, direção da
+// projeção planar), Impostor_Invalidate() pede um novo preparo.
+// "--no-impostors" desliga os impostores.
+//
+// Somente a thread do laço.
+
+#include <cstdio>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#define IMPOSTOR_MAX_EXHIBITS    32
+#define IMPOSTOR_MAX_QUADS       256   // Impostores por quadro
+#define IMPOSTOR_AZIMUTHS        8     // Vistas ao redor do eixo Y do modelo, a cada 45 graus
+#define IMPOSTOR_ELEVATIONS      5     // Vistas de -60 a 60 graus de elevação, a cada 30 graus
+#define IMPOSTOR_TILE            48    // Pixels de cada vista no atlas
+#define IMPOSTOR_MARGIN          1.05f // Folga do quadro em relação à esfera envolvente
+#define IMPOSTOR_DEFAULT_PIXELS  24.0f
+#define IMPOSTOR_MAX_SCALE_RATIO 1.1f
+#define IMPOSTOR_TEXTURE_UNIT    22    // Unidades 22 (cor) e 23 (normais)
+#define IMPOSTOR_BAKES_PER_FRAME 2
+
+// Uma exposição: a malha "name" desenhada com o object_id "object_id", com
+// os parâmetros especulares do shader para este objeto.
+struct ImpostorExhibit
+{
+    const char* name;
+    int         object_id;
+    glm::vec3   ks;
+    float       q;
+};
+
+struct ImpostorStats
+{
+    int                exhibits;    // Exposições registradas
+    int                baked;       // Exposições com atlas pronto
+    unsigned long      bakes;       // Preparos feitos (inclui repetições por Impostor_Invalidate())
+    double             bake_ms;     // Tempo de CPU dos preparos
+    size_t             atlas_bytes; // Memória de GPU dos dois atlas
+    unsigned long      draws;       // Desenhos de exposições registradas
+    unsigned long      impostors;   // ... feitos como impostor
+    int                max_quads;   // Maior fila em um quadro
+    unsigned long      dropped;     // Impostores desenhados como malha por fila cheia
+};
+
+// Desenha, com o programa principal no modo de preparo, a malha de "name"
+// (no nível de detalhe adequado a IMPOSTOR_TILE pixels, veja lod.h) com o
+// object_id dado, a matriz de modelagem Impostor_BakeModel() da sua
+// bounding box e as matrizes "view" e "projection". Retorna false se a
+// malha ainda não está disponível (p.ex. um substituto do carregamento sob
+// demanda).
+typedef bool (*ImpostorBakeFunc)(const char* name, int object_id, const glm::mat4& view, const glm::mat4& projection);
+
+// Trata o argumento argv[*i], caso seja "--no-impostors" ou
+// "--impostor-pixels pixels". Retorna false se o argumento não for deste
+// módulo.
+bool Impostor_ParseArg(int argc, char* argv[], int* i);
+
+// Cria o programa, os atlas e os buffers para as exposições dadas. Com os
+// impostores desligados não faz nada.
+void Impostor_Init(const ImpostorExhibit* exhibits, int count, ImpostorBakeFunc bake);
+
+// Matriz que leva a bounding box de um modelo à esfera de raio 1 centrada
+// na origem, usada no preparo.
+glm::mat4 Impostor_BakeModel(const glm::vec3& bbox_min, const glm::vec3& bbox_max);
+
+// Prepara os atlas de até IMPOSTOR_BAKES_PER_FRAME exposições pendentes.
+// Usa o programa principal, o estado de culling e de z-buffer atuais, e
+// altera os uniforms "model", "view", "projection", "object_id" e "bbox_*";
+// restaura o framebuffer e o viewport. Retorna true se alguma exposição foi preparada.
+bool Impostor_BakePending();
+
+// Pede um novo preparo das exposições da malha "name".
+void Impostor_Invalidate(const char* name);
+
+// Altura em pixels da área de desenho.
+void Impostor_SetViewportHeight(int height);
+
+// Matrizes da câmera do quadro; esvazia a fila.
+void Impostor_BeginFrame(const glm::mat4& view, const glm::mat4& projection);
+
+// Coloca o objeto na fila de impostores, se ele for uma exposição preparada
+// e pequena o bastante na tela. Retorna false se ele deve ser desenhado
+// como malha.
+bool Impostor_Draw(const char* name, int object_id, const glm::mat4& model,
+                   const glm::vec3& bbox_min, const glm::vec3& bbox_max);
+
+// Desenha a fila do quadro. Deixa em uso o programa dos impostores.
+void Impostor_EndFrame();
+
+ImpostorStats Impostor_GetStats();
+
+// Escreve o resumo: exposições preparadas, memória dos atlas e desenhos
+// feitos como impostor.
+void Impostor_PrintStats(FILE* f);
+
+#endif // _IMPOSTOR_H
@@ -0,0 +1,102 @@
+#ifndef _INSTANCECULL_H
+#define _INSTANCECULL_H
+
+// Instâncias testadas contra o frustum na GPU, com transform feedback
+// (OpenGL 3.3).
+//
+// Um conjunto é uma malha repetida com várias matrizes de modelagem (p.ex.
+// os 18 estandes, ou a multidão de "--crowd"). Os registros das instâncias
+// (matriz, bounding box e object_id, no formato MultiDrawRecord de
+// multidraw.h) vão uma única vez para um buffer da GPU, na criação do
+// conjunto; depois disso a CPU não lê nem escreve nada por instância.
+//
+// Teste (InstanceCull_BeginFrame(), no início de cada quadro): um ponto por
+// instância passa por um programa próprio com GL_RASTERIZER_DISCARD ligado.
+// O vertex shader só repassa o registro; o geometry shader leva os oito
+// cantos da bounding box ao clip space e emite o registro somente se nenhum
+// dos planos do frustum deixa todos os cantos do lado de fora. O transform
+// feedback grava os registros emitidos, em sequência, no buffer de visíveis
+// do conjunto, e uma query GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN conta
+// quantos foram. (O vertex shader sozinho não consegue descartar pontos; a
+// compactação precisa do geometry shader.)
+//
+// Desenho (InstanceCull_Draw()): um glDrawElementsInstancedBaseVertex() com
+// a malha do objeto e os registros visíveis como atributos por instância
+// (os mesmos do envio indireto, com o uniform "multi_draw" ligado). O número
+// de instâncias é o resultado da query, lido pela CPU. Para que ela não
+// espere a GPU terminar o teste, os buffers de visíveis e as queries são
+// duplicados: se o resultado do quadro atual ainda não está disponível
+// (GL_QUERY_RESULT_AVAILABLE), são desenhados os registros do teste do
+// quadro anterior, com a sua contagem; uma instância que acaba de entrar no
+// frustum pode aparecer com um quadro de atraso. Em contextos 4.4 ou mais
+// recentes a CPU não lê o resultado: ele é gravado pela própria GPU
+// (GL_QUERY_BUFFER) no comando de um glDrawElementsIndirect(). Neste caso,
+// o número de instâncias das estatísticas e do perfhud.h chega com um
+// quadro de atraso, e somente quando já disponível.
+//
+// Cada conjunto tem o seu VAO de desenho, com os atributos da malha copiados
+// do VAO do objeto; ele é refeito quando o VAO do objeto muda (carregamento
+// sob demanda) ou a arena de geometria cresce (veja mesharena.h). As
+// instâncias usam a malha original: os níveis de detalhe, os meshlets e os
+// impostores são escolhidos por objeto, na CPU.
+//
+// "--no-instance-culling" desenha as instâncias uma a uma, com
+// DrawVirtualObject(). "--crowd n" acrescenta à cena n cubos pequenos
+// espalhados pelo chão do museu, para medir o custo por instância.
+
+#include <cstdio>
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#define INSTANCECULL_MAX_SETS 8
+
+struct InstanceCullStats
+{
+    bool          indirect;   // Número de instâncias gravado pela GPU
+    int           sets;
+    unsigned long instances;  // Instâncias de todos os conjuntos
+    unsigned long frames;
+    unsigned long tested;     // Soma, nos quadros, das instâncias testadas
+    unsigned long visible;    // e das visíveis, nos quadros com a contagem lida
+    unsigned long counted;    // Quadros com a contagem lida
+    unsigned long late;       // Desenhos com o teste do quadro anterior
+    unsigned long rebuilds;   // VAOs de desenho refeitos
+};
+
+// Trata o argumento argv[*i], caso seja "--no-instance-culling" ou
+// "--crowd n". Retorna false se o argumento não for deste módulo.
+bool InstanceCull_ParseArg(int argc, char* argv[], int* i);
+
+bool InstanceCull_IsEnabled();
+
+// Número de cubos da multidão ("--crowd"); 0 sem ela.
+int InstanceCull_CrowdSize();
+
+// Compila o programa do teste e, em contextos 4.4 ou mais recentes, carrega
+// glDrawElementsIndirect() com "load" (veja multidraw.h). Com o módulo
+// desligado não faz nada.
+void InstanceCull_Init(GLADloadproc load);
+
+// Cria um conjunto com "count" instâncias da mesma malha e do mesmo
+// material, e retorna o seu índice, ou -1 com o módulo desligado.
+int InstanceCull_CreateSet(const glm::mat4* models, int count, int object_id, const glm::vec3& bbox_min,
+                           const glm::vec3& bbox_max);
+
+// Testa as instâncias de todos os conjuntos com as matrizes do quadro. Muda o
+// programa em uso.
+void InstanceCull_BeginFrame(const glm::mat4& view, const glm::mat4& projection);
+
+// Desenha as instâncias visíveis de um conjunto com a malha dada, com o
+// programa principal em uso. Muda o VAO ligado.
+void InstanceCull_Draw(int set, GLuint vertex_array_object_id, GLenum mode, size_t first_index, size_t num_indices,
+                       GLint base_vertex);
+
+InstanceCullStats InstanceCull_GetStats();
+
+// Escreve o resumo: instâncias testadas e visíveis por quadro.
+void InstanceCull_PrintStats(FILE* f);
+
+#endif // _INSTANCECULL_H
@@ -0,0 +1,79 @@
+#ifndef _LOADARENA_H
+#define _LOADARENA_H
+
+// Arena linear para os dados intermediários do carregamento de um modelo
+// (as normais de ComputeNormals() e os vetores de MeshData, veja objmodel.h).
+//
+// Antes de processar um modelo calculamos, a partir do número de faces, o
+// tamanho exato de todos os buffers, e reservamos um único bloco com
+// LoadArena_Reserve(). Os buffers são então obtidos com LoadArena_Alloc(),
+// que apenas avança um ponteiro: não há realocações nem cópias enquanto os
+// vetores crescem, nem memória reservada "sobrando" como no crescimento
+// geométrico de std::vector. Após a cópia para a GPU, LoadArena_Release()
+// devolve o bloco inteiro de uma só vez.
+//
+// Ao contrário da arena do quadro (framearena.h), o bloco é alocado do heap,
+// pois o seu tamanho depende do modelo. Esgotar a arena é um erro de
+// programação: o programa termina com uma mensagem.
+//
+// Cada thread tem a sua própria arena. Uma malha montada em uma thread e
+// enviada para a GPU em outra (veja streaming.h) leva o bloco consigo:
+// LoadArena_Detach() entrega o bloco a quem chama, que o libera com
+// LoadArena_FreeDetached() após o envio.
+
+#include <cstddef>
+
+struct LoadArenaStats
+{
+    unsigned long reserves;       // Blocos alocados
+    size_t        peak_capacity;  // Maior bloco alocado, em bytes
+};
+
+// Descarta todas as alocações anteriores e garante um bloco com pelo menos
+// "size" bytes. Um bloco já existente é reaproveitado se for grande o
+// suficiente; caso contrário é trocado por um bloco de exatamente "size" bytes.
+void LoadArena_Reserve(size_t size);
+
+// Reserva "size" bytes alinhados a "align" (potência de 2) dentro do bloco.
+void* LoadArena_Alloc(size_t size, size_t align = 16);
+
+template <typename T> T* LoadArena_AllocArray(size_t count)
+{
+    return (T*)LoadArena_Alloc(count * sizeof(T), alignof(T));
+}
+
+// Libera o bloco. Toda memória obtida da arena deixa de ser válida.
+void LoadArena_Release();
+
+// Retira o bloco da arena sem liberá-lo, e retorna o seu endereço e
+// tamanho. A próxima reserva aloca um novo bloco.
+void* LoadArena_Detach(size_t* capacity);
+void LoadArena_FreeDetached(void* block);
+
+// Bytes em uso, tamanho do bloco atual e estatísticas, da thread atual.
+size_t LoadArena_Used();
+size_t LoadArena_Capacity();
+LoadArenaStats LoadArena_GetStats();
+
+// Folga para o alinhamento, a ser somada uma vez por buffer ao tamanho pedido
+// em LoadArena_Reserve().
+#define LOADARENA_ALIGN_SLACK 16
+
+// Alocador para std::vector com memória da arena. A memória só é devolvida
+// por LoadArena_Release(); por isso o vetor deve ter a capacidade exata
+// reservada (reserve()) antes de crescer.
+template <typename T> struct LoadArenaAllocator
+{
+    typedef T value_type;
+
+    LoadArenaAllocator() {}
+    template <typename U> LoadArenaAllocator(const LoadArenaAllocator<U>&) {}
+
+    T* allocate(size_t n) { return LoadArena_AllocArray<T>(n); }
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U> bool operator==(const LoadArenaAllocator<T>&, const LoadArenaAllocator<U>&) { return true; }
+template <typename T, typename U> bool operator!=(const LoadArenaAllocator<T>&, const LoadArenaAllocator<U>&) { return false; }
+
+#endif // _LOADARENA_H
@@ -0,0 +1,128 @@
+#ifndef _LOD_H
+#define _LOD_H
+
+// Níveis de detalhe (LOD) das malhas.
+//
+// Construção (Lod_BuildLevels(), chamada por BuildTriangles()): cada objeto
+// com pelo menos LOD_MIN_TRIANGLES triângulos ganha até MESH_MAX_LODS níveis
+// simplificados, com cerca de 1/2, 1/4 e 1/8 dos triângulos originais. A
+// simplificação colapsa arestas, levando um vértice até o outro, em ordem
+// crescente de erro pelas quádricas de Garland e Heckbert ("Surface
+// Simplification Using Quadric Error Metrics", 1997). Assim cada nível usa
+// somente vértices da malha original, e acrescenta apenas índices. Para
+// preservar a aparência:
+//   - uma posição com duas coordenadas de textura (costura do mapeamento)
+//     só se move ao longo da costura, com os dois lados juntos; uma posição
+//     da borda de uma superfície aberta, só ao longo da borda; posições onde
+//     costuras ou bordas se ramificam não são removidas;
+//   - colapsos que invertem um triângulo, ou o giram mais de ~78 graus, são
+//     recusados;
+//   - cada canto de um triângulo simplificado usa, dentre os vértices
+//     originais com a mesma posição e coordenada de textura, aquele com a
+//     normal mais próxima da normal do triângulo (em modelos facetados, como
+//     o triceratops, cada posição tem uma normal por face).
+// Um nível só é guardado se tiver no máximo 60% dos triângulos do anterior,
+// o que limita os índices extras a 1,18 vez os da malha original (veja
+// Lod_MaxExtraIndices()). Os dados temporários ficam no heap, não na arena
+// de carregamento, e Lod_BuildLevels() pode ser chamada de qualquer thread.
+//
+// O erro de um nível é o maior erro dos colapsos feitos até ele: a distância
+// média quadrática (RMS), ponderada pela área, da posição resultante aos
+// planos dos triângulos originais que ela substitui. O desvio máximo pode
+// ser algumas vezes maior, e por isso o limite padrão é de uma fração de
+// pixel.
+//
+// Seleção (Lod_Select(), a cada desenho): o erro de cada nível é projetado
+// na tela, a partir da distância da câmera à esfera que envolve a bounding
+// box do objeto, e é escolhido o nível mais simples cujo erro fica abaixo de
+// "--lod-error pixels" (padrão LOD_DEFAULT_ERROR_PIXELS). Para que
+// o nível não troque a cada quadro quando o objeto está perto do limite,
+// passar para um nível mais simples exige um erro LOD_HYSTERESIS abaixo do
+// limite. O nível é lembrado por instância: um mesmo modelo é desenhado
+// várias vezes (p.ex. a chaleira, com quatro materiais, e a vaca, duas
+// vezes com o mesmo material), e a ordem dos desenhos muda de um quadro para
+// outro (objetos fora do frustum, impostores, carregamento sob demanda).
+// Cada desenho retoma o nível da instância com o mesmo "object_id" (veja
+// SetObjectId() em main.cpp) cujo centro estava mais perto no último desenho,
+// a menos do raio da esfera envolvente; objetos que se movem continuam com a
+// sua instância, e dois objetos iguais em estandes diferentes não trocam de
+// nível entre si.
+// "--no-lod" desenha sempre a malha original.
+//
+// Lod_PrintStats() informa os triângulos desenhados em relação aos da malha
+// original ao longo da execução (p.ex. no roteiro do benchmark).
+
+#include <cstdio>
+#include <cstddef>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "objmodel.h"
+
+#define LOD_MIN_TRIANGLES        2500  // Objetos menores não são simplificados
+#define LOD_DEFAULT_ERROR_PIXELS 0.25f
+#define LOD_HYSTERESIS           0.25f // Fração do limite, ao simplificar
+#define LOD_MAX_INSTANCES        8     // Instâncias de um modelo com nível lembrado
+
+// Nível escolhido para uma instância de um modelo (veja Lod_Select()).
+struct LodInstance
+{
+    int           object_id;
+    glm::vec3     center; // Centro da bounding box, no espaço do mundo
+    int           level;
+    unsigned long frame;  // Quadro do último desenho; 0 para uma posição livre
+};
+
+// Instâncias de um modelo. Deve começar zerado.
+struct LodState
+{
+    LodInstance instances[LOD_MAX_INSTANCES];
+};
+
+struct LodStats
+{
+    unsigned long      draws;                          // Desenhos de objetos com níveis
+    unsigned long      level_draws[MESH_MAX_LODS + 1]; // Desenhos por nível (0 = original)
+    unsigned long      switches;                       // Trocas de nível
+    unsigned long long full_triangles;                 // Triângulos com a malha original
+    unsigned long long drawn_triangles;                // Triângulos de fato desenhados
+};
+
+// Número máximo de índices que Lod_BuildLevels() acrescenta para um objeto
+// com "num_indices" índices (0 se ele não for simplificado).
+size_t Lod_MaxExtraIndices(size_t num_indices);
+
+// Constrói os níveis de detalhe de todos os objetos de "mesh", acrescentando
+// os seus índices ao fim de mesh->indices, cuja capacidade já deve incluir
+// Lod_MaxExtraIndices() de cada objeto.
+void Lod_BuildLevels(MeshData* mesh);
+
+// Trata o argumento argv[*i], caso seja "--no-lod" ou "--lod-error pixels".
+// Retorna false se o argumento não for deste módulo.
+bool Lod_ParseArg(int argc, char* argv[], int* i);
+
+// Altura em pixels da área de desenho.
+void Lod_SetViewportHeight(int height);
+
+// Matrizes da câmera do quadro; chamada uma vez por quadro, antes dos
+// desenhos.
+void Lod_BeginFrame(const glm::mat4& view, const glm::mat4& projection);
+
+// Nível a desenhar (0 para a malha original, de "num_indices" índices, ou
+// 1 a lods.count) para um objeto com o material "object_id" e a matriz de
+// modelagem "model".
+int Lod_Select(const MeshLods& lods, size_t num_indices, LodState* state, int object_id, const glm::mat4& model,
+               const glm::vec3& bbox_min, const glm::vec3& bbox_max);
+
+// Nível mais simples cujo erro fica abaixo do limite com "pixels_per_unit"
+// pixels por unidade do modelo, sem histerese nem estatísticas (p.ex. para
+// o preparo dos impostores, veja impostor.h).
+int Lod_SelectForScale(const MeshLods& lods, float pixels_per_unit);
+
+LodStats Lod_GetStats();
+
+// Escreve o resumo: desenhos por nível e redução do número de triângulos.
+void Lod_PrintStats(FILE* f);
+
+#endif // _LOD_H
@@ -0,0 +1,103 @@
+#ifndef _MESHARENA_H
+#define _MESHARENA_H
+
+// Arena de geometria: as malhas de todos os modelos em um único buffer de
+// vértices e um único buffer de índices, com um só VAO.
+//
+// O buffer de vértices tem três regiões, uma por atributo, com "capacidade"
+// vértices cada: posições (vec4, "(location = 0)" em "shader_vertex.glsl"),
+// normais (vec4, "(location = 1)") e coordenadas de textura (vec2,
+// "(location = 2)"). Uma malha recebe um trecho de vértices (o mesmo nas três
+// regiões) e um trecho de índices. Os índices continuam relativos à malha: o
+// primeiro vértice do trecho é o "base vertex" de glDrawElementsBaseVertex(),
+// e o primeiro índice é somado ao deslocamento de cada desenho. Atributos
+// ausentes na malha são preenchidos com zeros, o mesmo valor que o shader lê
+// de um atributo desligado.
+//
+// Os trechos livres de cada buffer ficam em uma tabela ordenada pela posição
+// (até MESHARENA_MAX_FREE_RANGES trechos). MeshArena_Alloc() usa o menor
+// trecho livre que comporta o pedido ("best fit"), e MeshArena_Free() junta o
+// trecho devolvido aos vizinhos livres. Quando nenhum trecho comporta o
+// pedido, o buffer cresce (pelo menos o dobro): um buffer novo é criado, o
+// conteúdo é copiado na GPU (glCopyBufferSubData()) e o VAO passa a apontar
+// para ele. A fragmentação informada é a fração do espaço livre fora do maior
+// trecho livre: 0% quando todo o espaço livre é contíguo.
+//
+// Fora da arena ficam a caixa substituta do carregamento sob demanda, os
+// lotes estáticos (staticbatch.h), que têm um atributo a mais, e os buffers
+// de passagem da thread de envio (uploader.h), copiados para a arena pela
+// thread do laço com MeshArena_CopyFromBuffers().
+//
+// "--no-mesh-arena" volta a criar um VAO e buffers próprios por modelo.
+// Somente a thread do laço.
+
+#include <cstdio>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+#define MESHARENA_INITIAL_VERTICES (1 << 18) // 10 MiB
+#define MESHARENA_INITIAL_INDICES  (1 << 20) // 4 MiB
+#define MESHARENA_MAX_FREE_RANGES  256
+
+// Trechos de uma malha na arena.
+struct MeshArenaAllocation
+{
+    size_t first_vertex; // "base vertex" dos desenhos
+    size_t num_vertices;
+    size_t first_index;  // Somado aos índices de início dos desenhos
+    size_t num_indices;
+};
+
+struct MeshArenaStats
+{
+    size_t        vertex_capacity;
+    size_t        vertices_used;
+    size_t        index_capacity;
+    size_t        indices_used;
+    int           vertex_free_ranges;
+    int           index_free_ranges;
+    size_t        largest_free_vertices;
+    size_t        largest_free_indices;
+    unsigned long allocations;
+    unsigned long frees;
+    unsigned long grows;         // Crescimentos de algum dos buffers
+    size_t        bytes;         // Memória de GPU dos dois buffers
+};
+
+// Trata o argumento argv[*i], caso seja "--no-mesh-arena". Retorna false se
+// o argumento não for deste módulo.
+bool MeshArena_ParseArg(int argc, char* argv[], int* i);
+
+bool MeshArena_IsEnabled();
+
+// Cria o VAO e os buffers com a capacidade inicial. Com a arena desligada
+// não faz nada.
+void MeshArena_Init();
+
+// VAO compartilhado por todas as malhas da arena.
+GLuint MeshArena_VertexArray();
+
+// Reserva trechos para uma malha, fazendo a arena crescer se preciso. Altera
+// o VAO ligado.
+void MeshArena_Alloc(size_t num_vertices, size_t num_indices, MeshArenaAllocation* allocation);
+
+// Copia uma malha para os seus trechos. "normals" e "texcoords" podem ser
+// NULL (atributo ausente).
+void MeshArena_Upload(const MeshArenaAllocation& allocation, const float* positions, const float* normals,
+                      const float* texcoords, const GLuint* indices);
+
+// Copia, na GPU, uma malha de buffers próprios (p.ex. os da thread de envio)
+// para os seus trechos. Buffers 0 são atributos ausentes.
+void MeshArena_CopyFromBuffers(const MeshArenaAllocation& allocation, GLuint positions, GLuint normals,
+                               GLuint texcoords, GLuint indices);
+
+// Devolve os trechos de uma malha.
+void MeshArena_Free(const MeshArenaAllocation& allocation);
+
+MeshArenaStats MeshArena_GetStats();
+
+// Escreve o resumo: ocupação, trechos livres e fragmentação.
+void MeshArena_PrintStats(FILE* f);
+
+#endif // _MESHARENA_H
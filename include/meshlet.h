@@ -0,0 +1,110 @@
+#ifndef _MESHLET_H
+#define _MESHLET_H
+
+// Meshlets: grupos de triângulos dos objetos grandes, descartados um a um
+// antes do desenho.
+//
+// Construção (Meshlet_Build(), chamada por BuildTriangles() depois dos
+// níveis de detalhe): os triângulos originais de cada objeto com pelo menos
+// MESHLET_MIN_TRIANGLES triângulos são reordenados em grupos de até
+// MESHLET_MAX_VERTICES posições distintas e MESHLET_MAX_TRIANGLES
+// triângulos. Cada grupo começa no primeiro triângulo livre e cresce pelos
+// vizinhos (triângulos que compartilham uma posição), preferindo os que
+// acrescentam menos posições e, entre eles, os com normal mais próxima da
+// média do grupo, o que estreita o cone das normais. Para cada grupo são
+// guardados (veja Meshlet em objmodel.h):
+//   - a esfera que envolve os seus vértices;
+//   - o eixo do cone das normais das faces (pela ordem dos vértices, como o
+//     GL_CULL_FACE) e o seno da sua abertura. Um grupo com normais a mais de
+//     90 graus do eixo nunca é descartado por estar de costas.
+// Os meshlets fazem parte da malha cozida do pacote de recursos. Os dados
+// temporários ficam no heap, e Meshlet_Build() pode ser chamada de qualquer
+// thread.
+//
+// Culling (Meshlet_Cull(), a cada desenho de um objeto com meshlets na malha
+// original, veja lod.h): os grupos são testados de 4 em 4 (SSE, ou um laço
+// escalar em outras arquiteturas), no sistema de coordenadas do modelo:
+//   - contra os 6 planos do frustum, extraídos de projection*view*model;
+//   - contra o cone das normais, com a câmera levada ao modelo: o grupo está
+//     todo de costas se dot(c - olho, eixo) >= seno * |c - olho| + raio.
+//     Na projeção ortográfica o olho fica muito longe, na direção de visão.
+// Os grupos que sobram são devolvidos como trechos de índices, juntando
+// grupos vizinhos, para glMultiDrawElements(). Com GL_CULL_FACE os
+// triângulos de costas só são descartados depois do vertex shader; aqui
+// nem chegam a ser enviados.
+//
+// "--no-meshlets" desenha os objetos inteiros. Meshlet_PrintStats() informa
+// os grupos descartados por quadro.
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "objmodel.h"
+
+#define MESHLET_MAX_VERTICES  64
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_MIN_TRIANGLES 4096 // Objetos menores são desenhados inteiros
+
+// Quatro meshlets, campo a campo, para os testes em SSE.
+struct MeshletBlock
+{
+    float        center_x[4], center_y[4], center_z[4], radius[4];
+    float        axis_x[4], axis_y[4], axis_z[4], cutoff[4];
+    unsigned int first_index[4];
+    unsigned int num_indices[4];
+};
+
+// Meshlets de um objeto, guardados com o objeto em g_VirtualScene.
+struct MeshletSet
+{
+    std::vector<MeshletBlock> blocks;
+    int                       count; // Meshlets; o último bloco pode estar incompleto
+    size_t                    num_indices;
+};
+
+struct MeshletStats
+{
+    unsigned long      frames;
+    unsigned long      draws;            // Desenhos de objetos com meshlets
+    unsigned long      tested;           // Meshlets testados
+    unsigned long      frustum_culled;   // ... descartados fora do frustum
+    unsigned long      backface_culled;  // ... descartados de costas
+    unsigned long      ranges;           // Trechos enviados a glMultiDrawElements()
+    unsigned long long full_triangles;   // Triângulos desses objetos
+    unsigned long long drawn_triangles;  // ... de fato enviados
+};
+
+// Reordena os triângulos originais dos objetos grandes de "mesh" em
+// meshlets, preenchendo mesh->meshlets e MeshShape::first_meshlet e
+// num_meshlets.
+void Meshlet_Build(MeshData* mesh);
+
+// Copia os meshlets de um objeto para "set", em blocos de 4, somando
+// "first_index" (a posição da malha no buffer de índices, veja mesharena.h)
+// ao início de cada um.
+void Meshlet_MakeSet(const Meshlet* meshlets, size_t count, size_t first_index, MeshletSet* set);
+
+// Trata o argumento argv[*i], caso seja "--no-meshlets". Retorna false se o
+// argumento não for deste módulo.
+bool Meshlet_ParseArg(int argc, char* argv[], int* i);
+
+// Matrizes da câmera do quadro; chamada uma vez por quadro, antes dos
+// desenhos.
+void Meshlet_BeginFrame(const glm::mat4& view, const glm::mat4& projection);
+
+// Testa os meshlets de "set" com a matriz de modelagem "model" e escreve em
+// "counts" e "offsets" (com espaço para set.count trechos) os trechos de
+// índices a desenhar, em bytes a partir do início do buffer de índices.
+// Retorna o número de trechos (0 se tudo foi descartado), ou -1 se o objeto
+// deve ser desenhado inteiro (sem meshlets, ou com "--no-meshlets").
+int Meshlet_Cull(const MeshletSet& set, const glm::mat4& model, int* counts, const void** offsets);
+
+MeshletStats Meshlet_GetStats();
+
+// Escreve o resumo: meshlets testados e descartados por quadro.
+void Meshlet_PrintStats(FILE* f);
+
+#endif // _MESHLET_H
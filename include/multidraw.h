@@ -0,0 +1,114 @@
+#ifndef _MULTIDRAW_H
+#define _MULTIDRAW_H
+
+// Envio da cena por glMultiDrawElementsIndirect() (OpenGL 4.3), para os
+// objetos da arena de geometria (veja mesharena.h).
+//
+// Com o envio ligado, DrawVirtualObject() não desenha: escolhe o nível de
+// detalhe e os meshlets como antes, e acrescenta à fila do quadro um
+// registro por objeto (matriz de modelagem, object_id e bounding box,
+// MultiDraw_AddObject()) e um comando DrawElementsIndirectCommand por trecho
+// de índices (MultiDraw_AddCommand()). MultiDraw_Flush(), ao fim da cena,
+// copia as duas filas para buffers da GPU e desenha tudo com uma única
+// chamada. O custo de envio na CPU deixa de crescer com o número de
+// objetos: são sempre as mesmas poucas chamadas OpenGL por quadro.
+//
+// Os shaders continuam em GLSL 3.30, sem gl_DrawID: o "baseInstance" de cada
+// comando é o índice do registro do seu objeto, e os registros são lidos
+// como atributos por instância (glVertexAttribDivisor(), "(location = 4)" a
+// "(location = 10)" em "shader_vertex.glsl") do VAO da arena. Com o uniform
+// "multi_draw" ligado, os shaders usam esses valores no lugar dos uniforms
+// "model", "object_id", "bbox_min" e "bbox_max". Fora do envio os atributos
+// por instância são ignorados.
+//
+// A ordem dos desenhos muda (todos ao fim da cena), o que não altera a
+// imagem: a cena opaca não usa blending. Os estandes medidos por gputimer.h
+// passam a incluir somente o seu custo de CPU; o da GPU vai para o
+// envio único. Objetos fora da arena (a caixa substituta, os lotes
+// estáticos), objetos que não são de triângulos e o preparo dos impostores
+// são desenhados na hora.
+//
+// O envio fica ligado quando o contexto é 4.3 ou mais recente (o Mesa
+// llvmpipe oferece 4.5) e a arena está ligada. As funções que não fazem parte
+// do OpenGL 3.3 carregado pela GLAD são obtidas com o mesmo carregador
+// (glfwGetProcAddress(), ou eglGetProcAddress() sem janela, veja bench.h).
+// "--no-multi-draw" mantém os desenhos um a um, do OpenGL 3.3.
+
+#include <cstdio>
+
+#include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#define MULTIDRAW_MAX_OBJECTS  1024 // Registros por envio
+#define MULTIDRAW_MAX_COMMANDS 4096 // Comandos por envio (um por trecho de meshlets)
+
+// Registro de um objeto, lido pelos shaders como atributos por instância.
+// Também usado pelos desenhos instanciados de instancecull.h.
+struct MultiDrawRecord
+{
+    float model[16];
+    float bbox_min[4];
+    float bbox_max[4];
+    GLint object_id;
+    GLint padding[3];
+};
+
+struct MultiDrawStats
+{
+    bool          active;     // Envio em uso
+    int           gl_major;   // Versão do contexto
+    int           gl_minor;
+    unsigned long frames;
+    unsigned long flushes;    // Chamadas a glMultiDrawElementsIndirect()
+    unsigned long objects;    // Registros enviados
+    unsigned long commands;   // Comandos enviados
+};
+
+// Trata o argumento argv[*i], caso seja "--no-multi-draw". Retorna false se
+// o argumento não for deste módulo.
+bool MultiDraw_ParseArg(int argc, char* argv[], int* i);
+
+// Verifica a versão do contexto, carrega glMultiDrawElementsIndirect() com
+// "load" e cria os buffers, com os atributos por instância no VAO
+// "vertex_array_object_id". Com o envio desligado ou indisponível não faz
+// nada.
+void MultiDraw_Init(GLADloadproc load, GLuint vertex_array_object_id);
+
+bool MultiDraw_IsActive();
+
+// Início do quadro: "multi_draw_uniform" é a posição do uniform "multi_draw"
+// no programa principal.
+void MultiDraw_BeginFrame(GLint multi_draw_uniform);
+
+// Preenche um registro.
+void MultiDraw_MakeRecord(const glm::mat4& model, int object_id, const glm::vec3& bbox_min, const glm::vec3& bbox_max,
+                          MultiDrawRecord* record);
+
+// Aponta os atributos por instância do VAO ligado para os registros em
+// "buffer". Funciona também sem o envio indireto (OpenGL 3.3).
+void MultiDraw_SetRecordAttributes(GLuint buffer);
+
+// Liga ou desliga o uso dos registros no lugar dos uniforms pelos shaders do
+// programa principal, em uso.
+void MultiDraw_UseRecords(bool use);
+
+// Começa um objeto: os comandos seguintes usam este registro.
+void MultiDraw_AddObject(const glm::mat4& model, int object_id, const glm::vec3& bbox_min, const glm::vec3& bbox_max);
+
+// Acrescenta um comando do objeto atual: "count" índices a partir de
+// "first_index" no buffer de índices do VAO, somados a "base_vertex". Com a
+// fila cheia, ela é enviada antes e o registro do objeto atual passa para a
+// fila nova.
+void MultiDraw_AddCommand(GLsizei count, size_t first_index, GLint base_vertex);
+
+// Desenha a fila com o programa principal em uso e a esvazia. Liga o VAO
+// dado a MultiDraw_Init().
+void MultiDraw_Flush();
+
+MultiDrawStats MultiDraw_GetStats();
+
+// Escreve o resumo: comandos e registros por quadro.
+void MultiDraw_PrintStats(FILE* f);
+
+#endif // _MULTIDRAW_H
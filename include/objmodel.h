@@ -0,0 +1,181 @@
+#ifndef _OBJMODEL_H
+#define _OBJMODEL_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <streambuf>
+#include <stdexcept>
+
+#include <glm/vec3.hpp>
+
+// Headers da biblioteca para carregar modelos obj
+#include <tiny_obj_loader.h>
+
+#include "trace.h"
+#include "loadarena.h"
+
+// Estrutura que representa um modelo geométrico carregado a partir de um
+// arquivo ".obj".
+struct ObjModel
+{
+    tinyobj::attrib_t                 attrib;
+    std::vector<tinyobj::shape_t>     shapes;
+    std::vector<tinyobj::material_t>  materials;
+
+    // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
+    ObjModel(const char* filename, const char* basepath = "../../data/", bool triangulate = true)
+    {
+        TRACE_ZONE("ObjModel");
+        printf("Carregando modelo \"%s\"... ", filename);
+
+        char filepath[100];
+        strcpy(filepath, filename);
+        strcat(filepath, ".obj");
+
+        std::string err;
+        bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filepath, basepath, triangulate);
+
+        if (!err.empty())
+            fprintf(stderr, "\n%s\n", err.c_str());
+
+        if (!ret)
+            throw std::runtime_error("Erro ao carregar modelo.");
+
+        printf("OK.\n");
+    }
+
+    // Este construtor lê o modelo do conteúdo de "filename" já carregado na
+    // memória (veja assetio.h). Os materiais (".mtl") são lidos de "basepath".
+    ObjModel(const char* filename, const void* data, size_t size, const char* basepath = "../../data/", bool triangulate = true)
+    {
+        TRACE_ZONE("ObjModel");
+        printf("Carregando modelo \"%s\"... ", filename);
+
+        MemoryStreamBuf buffer(data, size);
+        std::istream stream(&buffer);
+        tinyobj::MaterialFileReader material_reader(basepath);
+
+        std::string err;
+        bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &stream, &material_reader, triangulate);
+
+        if (!err.empty())
+            fprintf(stderr, "\n%s\n", err.c_str());
+
+        if (!ret)
+            throw std::runtime_error("Erro ao carregar modelo.");
+
+        printf("OK.\n");
+    }
+
+private:
+    // Leitura de um bloco de memória como std::istream, sem cópia.
+    struct MemoryStreamBuf : public std::streambuf
+    {
+        MemoryStreamBuf(const void* data, size_t size)
+        {
+            char* begin = (char*)data;
+            setg(begin, begin, begin + size);
+        }
+    };
+};
+
+// Malha de triângulos de um ObjModel, pronta para ser copiada para a GPU por
+// BuildTrianglesAndAddToVirtualScene() (definida em main.cpp). Os vértices
+// não são compartilhados: cada triângulo tem seus três vértices.
+//
+// Os vetores de MeshData ficam na arena de carregamento (veja loadarena.h),
+// com o tamanho exato calculado a partir do número de faces; eles deixam de
+// ser válidos após LoadArena_Release() ou o próximo LoadArena_Reserve().
+//
+// Objetos com muitos triângulos têm também níveis de detalhe simplificados
+// (veja lod.h): os índices de cada nível ficam em MeshData::indices, depois
+// dos índices de todos os objetos, e apontam para os mesmos vértices. Os
+// triângulos originais desses objetos são ainda reordenados em grupos
+// (meshlets, veja meshlet.h), guardados em MeshData::meshlets.
+#define MESH_MAX_LODS 3
+
+struct MeshLods
+{
+    int          count;                      // Níveis simplificados (0 se não houver)
+    size_t       first_index[MESH_MAX_LODS]; // Do nível 1 (o mais detalhado) ao "count"
+    size_t       num_indices[MESH_MAX_LODS];
+    float        error[MESH_MAX_LODS];       // Erro geométrico, nas unidades do modelo
+};
+
+// Grupo de triângulos de um objeto grande (veja meshlet.h): um trecho
+// contíguo de MeshData::indices, com a esfera que o envolve e o cone das
+// normais dos seus triângulos, no sistema de coordenadas do modelo.
+struct Meshlet
+{
+    unsigned int first_index;
+    unsigned int num_indices;
+    glm::vec3    center;
+    float        radius;
+    glm::vec3    cone_axis;
+    float        cone_cutoff; // Seno da abertura do cone; 1 se o grupo nunca fica de costas
+};
+
+struct MeshShape
+{
+    std::string  name;        // Nome do objeto
+    size_t       first_index; // Índice do primeiro vértice dentro de MeshData::indices
+    size_t       num_indices; // Número de índices do objeto
+    glm::vec3    bbox_min;    // Axis-Aligned Bounding Box do objeto
+    glm::vec3    bbox_max;
+    MeshLods     lods;
+    size_t       first_meshlet; // Em MeshData::meshlets
+    size_t       num_meshlets;  // 0 se o objeto é desenhado inteiro
+};
+
+typedef std::vector<unsigned int, LoadArenaAllocator<unsigned int> > MeshIndexVector;
+typedef std::vector<float, LoadArenaAllocator<float> >               MeshFloatVector;
+
+struct MeshData
+{
+    MeshIndexVector        indices;              // GL_ELEMENT_ARRAY_BUFFER
+    MeshFloatVector        model_coefficients;   // vec4, "(location = 0)" em "shader_vertex.glsl"
+    MeshFloatVector        normal_coefficients;  // vec4, "(location = 1)"
+    MeshFloatVector        texture_coefficients; // vec2, "(location = 2)"
+    std::vector<MeshShape> shapes;
+    std::vector<Meshlet>   meshlets;
+};
+
+// Computa normais de um ObjModel, caso não existam. Os dados temporários
+// ficam na arena de carregamento.
+void ComputeNormals(ObjModel* model);
+
+// Parte da construção da malha que não depende de OpenGL: preenche "mesh"
+// (cujos vetores são esvaziados antes) a partir de "model", incluindo os
+// níveis de detalhe (Lod_BuildLevels()) e os meshlets (Meshlet_Build()).
+// Reserva a arena de carregamento; quem chama a libera após usar a malha.
+void BuildTriangles(ObjModel* model, MeshData* mesh);
+
+// Número de vértices distintos do modelo, isto é, de combinações distintas
+// de índices de posição, normal e coordenada de textura. BuildTriangles() não
+// compartilha vértices: envia 3 vértices por triângulo.
+size_t CountUniqueVertices(const ObjModel* model);
+
+// Memória de CPU ocupada pelos dados de um ObjModel e de uma MeshData,
+// calculada pela capacidade dos seus vetores.
+size_t ObjModelMemoryBytes(const ObjModel* model);
+size_t MeshDataMemoryBytes(const MeshData* mesh);
+
+// Libera a memória dos dados lidos do arquivo (p.ex. após montar a malha).
+void ReleaseObjModel(ObjModel* model);
+
+// Malha "cozida" para o pacote de recursos (veja assetpack.h): os vetores de
+// uma MeshData e os seus objetos, em um bloco binário que é lido sem
+// tinyobjloader nem ComputeNormals(). O número de vértices únicos do modelo
+// original é guardado junto, para o relatório de assetstats.h.
+//
+// ReadCookedMesh() reserva a arena de carregamento com o tamanho exato, como
+// BuildTriangles(), e copia os vetores do bloco. Retorna false se o bloco
+// estiver truncado, não for uma malha, ou tiver um trecho de índices (objeto,
+// nível de detalhe ou meshlet) fora dos índices da malha.
+void WriteCookedMesh(const MeshData* mesh, size_t unique_vertices, std::vector<unsigned char>* out);
+bool ReadCookedMesh(const void* data, size_t size, MeshData* mesh, size_t* unique_vertices);
+
+#endif // _OBJMODEL_H
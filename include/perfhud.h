@@ -0,0 +1,54 @@
+#ifndef _PERFHUD_H
+#define _PERFHUD_H
+
+// Painel de desempenho mostrado sobre a cena (tecla F1), para diagnosticar
+// no próprio local uma máquina lenta sem precisar de um profiler.
+//
+// A cada quadro são registrados apenas alguns números: o tempo de CPU do
+// quadro (de PerfHud_BeginFrame() a PerfHud_EndFrame()), o intervalo entre
+// quadros, e os contadores de chamadas de desenho e de triângulos enviados
+// (PerfHud_CountDraw()). Os tempos ficam em um buffer circular com os últimos
+// PERFHUD_HISTORY quadros. O texto do painel (médias, gráfico do tempo de
+// quadro, memória de texturas e buffers, custo de cada estande medido por
+// gputimer.h) só é recalculado PERFHUD_REFRESH_HZ vezes por segundo, em
+// buffers de tamanho fixo: nenhum quadro aloca memória (veja alloctrack.h).
+//
+// A coleta é feita mesmo com o painel escondido, de modo que o histórico já
+// está completo quando o painel é aberto. O desenho fica a cargo de quem
+// chama PerfHud_GetLines(), com as funções TextRendering_*().
+
+#include <cstddef>
+
+#define PERFHUD_HISTORY       240 // Quadros no buffer circular e no gráfico
+#define PERFHUD_REFRESH_HZ    4   // Atualizações do texto por segundo
+#define PERFHUD_GRAPH_COLUMNS 60  // Cada coluna do gráfico resume PERFHUD_HISTORY/PERFHUD_GRAPH_COLUMNS quadros
+#define PERFHUD_GRAPH_ROWS    6
+#define PERFHUD_MAX_LINES     (PERFHUD_GRAPH_ROWS + 10)
+#define PERFHUD_LINE_SIZE     96
+
+// Liga/desliga a exibição do painel.
+void PerfHud_SetEnabled(bool enabled);
+bool PerfHud_IsEnabled();
+
+// Delimitam o trabalho de CPU de um quadro. "stand" é o estande em foco na
+// câmera (0 a 17), ou -1 se nenhum.
+void PerfHud_BeginFrame();
+void PerfHud_EndFrame(int stand);
+
+// Conta uma chamada de desenho com "triangles" triângulos.
+void PerfHud_CountDraw(unsigned long triangles);
+
+// Memória alocada na GPU para texturas e buffers, estimada a partir dos
+// tamanhos passados para glTexImage2D() e glBufferData(). As funções
+// "Remove" descontam objetos apagados (veja streaming.h).
+void PerfHud_AddTextureMemory(size_t bytes);
+void PerfHud_AddBufferMemory(size_t bytes);
+void PerfHud_RemoveTextureMemory(size_t bytes);
+void PerfHud_RemoveBufferMemory(size_t bytes);
+
+// Linhas de texto do painel, recalculadas no máximo PERFHUD_REFRESH_HZ vezes
+// por segundo. Retorna o número de linhas; "lines" aponta para memória
+// interna, válida até a próxima chamada.
+int PerfHud_GetLines(const char* const** lines);
+
+#endif // _PERFHUD_H
@@ -0,0 +1,110 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+// Gravação e reprodução dos eventos de entrada (teclado e mouse).
+//
+// Com "--record arquivo" todo evento recebido pelos callbacks da GLFW é
+// salvo, junto com o índice do quadro em que foi recebido e o instante (em
+// segundos desde o início do primeiro quadro), antes de ser repassado para
+// KeyCallback(), MouseButtonCallback() ou CursorPosCallback(). O fechamento
+// da janela grava o registro REPLAY_END, com o instante em que ocorreu.
+//
+// Com "--replay arquivo" a janela deixa de receber eventos do usuário, e o
+// tempo da simulação (veja current_time() em main.cpp) avança um passo fixo
+// por quadro, ignorando glfwGetTime(). No início de cada quadro,
+// Replay_BeginFrame() repassa aos mesmos callbacks os eventos cujo instante
+// gravado já foi alcançado pelo tempo da simulação. Os eventos seguem o
+// relógio, e não a contagem de quadros: uma tecla segurada por 2 s na
+// gravação continua segurada por 2 s de simulação, e a câmera anda a mesma
+// distância (a menos de um passo), qualquer que seja a taxa de quadros da
+// gravação ou o passo da reprodução. Duas reproduções do mesmo arquivo com o mesmo passo geram
+// exatamente as mesmas imagens, quadro a quadro. O programa termina no
+// instante do fechamento gravado (ou antes, se um evento reproduzido fechar
+// a janela, p.ex. ESC). Pode ser combinado com "--bench" para medir uma
+// visita real.
+//
+// O roteiro do --bench (veja bench.h) também é reproduzido por este módulo,
+// a partir de eventos montados em memória (Replay_SetEvents()), repassados
+// pelo índice do quadro.
+//
+// Formato do arquivo (inteiros e reais na ordem de bytes da máquina, que é
+// little-endian em todas as plataformas suportadas):
+//
+//     cabeçalho: "FCGR", u32 versão (REPLAY_VERSION)
+//     registros: u32 quadro, f32 instante, u8 tipo, e conforme o tipo:
+//         REPLAY_KEY           i32 tecla, i32 scancode, u8 ação, u8 modificadores
+//         REPLAY_MOUSE_BUTTON  u8 botão, u8 ação, u8 modificadores, f64 x, f64 y
+//         REPLAY_CURSOR_POS    f64 x, f64 y
+//         REPLAY_END           (nada; "quadro" é o total de quadros gravados e
+//                              "instante" o do fechamento da janela)
+//
+// A posição do cursor é guardada em f64 (como a GLFW a entrega), pois
+// qualquer arredondamento mudaria a câmera na reprodução.
+//
+// Argumentos de linha de comando reconhecidos:
+//   --record arquivo      Grava os eventos em "arquivo"
+//   --replay arquivo      Reproduz os eventos de "arquivo"
+//   --replay-step s       Passo de tempo da reprodução, em segundos (padrão 1/60)
+
+#define REPLAY_VERSION 2 // 2: instantes contados a partir do primeiro quadro
+
+enum ReplayEventType
+{
+    REPLAY_KEY          = 1,
+    REPLAY_MOUSE_BUTTON = 2,
+    REPLAY_CURSOR_POS   = 3,
+    REPLAY_END          = 4
+};
+
+struct ReplayEvent
+{
+    unsigned int frame;    // Quadro em que o evento é repassado (veja Replay_BeginFrame())
+    float        time;     // Segundos desde o início da gravação
+    int          type;     // REPLAY_*
+    int          key;      // Tecla (REPLAY_KEY) ou botão (REPLAY_MOUSE_BUTTON)
+    int          scancode;
+    int          action;
+    int          mods;
+    double       x, y;     // Posição do cursor
+};
+
+struct GLFWwindow;
+
+// Trata o argumento argv[*i], caso seja um dos argumentos acima, avançando
+// *i sobre o valor do argumento. Retorna false se argv[*i] não pertence a
+// este módulo.
+bool Replay_ParseArg(int argc, char* argv[], int* i);
+
+bool Replay_IsRecording();
+bool Replay_IsPlaying();
+
+// Substitui os callbacks de entrada da janela: durante a gravação pelos do
+// gravador; durante a reprodução por nenhum.
+void Replay_InstallCallbacks(GLFWwindow* window);
+
+// Reproduz "events" (ordenados por quadro), terminando após "num_frames"
+// quadros. Utilizada pelo roteiro do --bench.
+void Replay_SetEvents(const ReplayEvent* events, int num_events, unsigned int num_frames);
+
+// Deve ser chamada no início de cada quadro. Na reprodução repassa aos
+// callbacks os eventos do quadro; na gravação marca o quadro dos próximos
+// eventos recebidos.
+void Replay_BeginFrame(GLFWwindow* window);
+
+// Indica se a reprodução terminou: o tempo da simulação passou do
+// fechamento gravado (ou do último quadro do roteiro), ou a janela foi
+// fechada por um evento reproduzido. "window" pode ser NULL (--bench).
+bool Replay_Finished(GLFWwindow* window);
+
+// Tempo da simulação na reprodução: quadros reproduzidos vezes o passo.
+double Replay_Time();
+double Replay_TimeStep();
+
+// Posição do cursor. Na reprodução é a gravada no último evento do mouse;
+// caso contrário a informada por glfwGetCursorPos().
+void Replay_GetCursorPos(GLFWwindow* window, double* x, double* y);
+
+// Termina a gravação, escrevendo o registro REPLAY_END.
+void Replay_Close();
+
+#endif // _REPLAY_H
@@ -0,0 +1,99 @@
+#ifndef _STATICBATCH_H
+#define _STATICBATCH_H
+
+// Lotes estáticos: objetos pequenos que nunca se movem (o museu e os
+// estandes) juntados, já no sistema de coordenadas do mundo, em poucos
+// buffers desenhados com a matriz de modelagem identidade.
+//
+// Construção (StaticBatch_Build(), uma vez, depois que as malhas dos objetos
+// estão na GPU): cada objeto é lido de volta dos buffers do seu VAO (a malha
+// na CPU já foi liberada, veja loadarena.h), e os seus vértices são levados
+// ao mundo: a posição pela matriz de modelagem, a normal pela inversa da
+// transposta (como em "shader_vertex.glsl"), e a coordenada de textura sem
+// mudança. A posição original também é guardada ("(location = 3)" em
+// "shader_vertex.glsl"), pois o shader projeta texturas a partir de
+// "position_model". Os objetos são agrupados por material (o object_id do
+// shader), na ordem em que são registrados, e um lote novo começa quando o
+// atual passaria de "--static-batch-vertices" vértices (padrão
+// STATICBATCH_DEFAULT_MAX_VERTICES, um lote por material).
+// Um objeto nunca é dividido entre lotes.
+//
+// Desenho: um glDrawElements() por lote, com o uniform "static_batch" ligado
+// para que o vertex shader use a posição original guardada. Os uniforms
+// "bbox_min" e "bbox_max" são os do primeiro objeto do lote. Os objetos
+// juntados perdem os níveis de detalhe, os meshlets e os impostores, feitos
+// por objeto; por isso malhas grandes, que os têm (o triceratops), ficam
+// fora dos lotes e continuam desenhadas uma a uma.
+//
+// Os lotes vêm desligados: no Mesa llvmpipe o envio indireto (multidraw.h)
+// e o teste das instâncias na GPU (instancecull.h) já juntam os desenhos do
+// museu e dos estandes, e o tempo por quadro do benchmark não melhora com
+// eles. "--static-batching" os liga, e "--no-static-batching" desenha os
+// objetos um a um.
+
+#include <cstdio>
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#define STATICBATCH_MAX_SOURCES          64
+#define STATICBATCH_MAX_BATCHES          16
+#define STATICBATCH_DEFAULT_MAX_VERTICES (1 << 20)
+
+// Um objeto estático: a malha de "name", desenhada com "object_id" e "model".
+struct StaticBatchSource
+{
+    const char* name;
+    int         object_id;
+    glm::mat4   model;
+    GLuint      vertex_array_object_id;
+    GLint       base_vertex; // Somado aos índices (veja mesharena.h)
+    size_t      first_index;
+    size_t      num_indices;
+    glm::vec3   bbox_min; // Do modelo
+    glm::vec3   bbox_max;
+};
+
+struct StaticBatch
+{
+    GLuint    vertex_array_object_id;
+    GLsizei   num_indices;
+    int       object_id;
+    glm::vec3 bbox_min; // Do primeiro objeto, para o shader
+    glm::vec3 bbox_max;
+};
+
+struct StaticBatchStats
+{
+    int    sources;   // Objetos juntados
+    int    batches;   // Lotes criados
+    size_t vertices;
+    size_t bytes;     // Memória de GPU dos lotes
+    double build_ms;
+};
+
+// Trata o argumento argv[*i], caso seja "--static-batching",
+// "--no-static-batching" ou "--static-batch-vertices n". Retorna false se o
+// argumento não for deste módulo.
+bool StaticBatch_ParseArg(int argc, char* argv[], int* i);
+
+bool StaticBatch_IsEnabled();
+
+// true depois de StaticBatch_Build(): os objetos registrados devem ser
+// desenhados pelos lotes.
+bool StaticBatch_IsBuilt();
+
+// Cria os lotes com os objetos dados. Altera o VAO e os buffers ligados.
+void StaticBatch_Build(const StaticBatchSource* sources, int count);
+
+int StaticBatch_Count();
+const StaticBatch& StaticBatch_Get(int batch);
+
+StaticBatchStats StaticBatch_GetStats();
+
+// Escreve o resumo: objetos, lotes e memória.
+void StaticBatch_PrintStats(FILE* f);
+
+#endif // _STATICBATCH_H
@@ -0,0 +1,115 @@
+#ifndef _STREAMING_H
+#define _STREAMING_H
+
+// Carregamento sob demanda ("streaming") dos objetos expostos nos estandes,
+// ativado com "--stream".
+//
+// Somente o museu, os pedestais e o dinossauro são carregados na
+// inicialização. Os modelos e texturas de cada estande são registrados com
+// Streaming_AddModel()/Streaming_AddTexture() e Streaming_AddToStand(), e
+// ficam inicialmente ausentes: no seu lugar é desenhado um substituto (uma
+// caixa cinza, veja main.cpp). A cada quadro, Streaming_Update() marca como
+// "próximos" os recursos dos estandes a menos de "--stream-radius" metros da
+// câmera e pede à thread de carregamento os que ainda não estão na memória.
+//
+// A thread de carregamento lê e decodifica os arquivos (tinyobjloader,
+// stb_image) e monta as malhas, que entrega à thread de envio (veja
+// uploader.h); a thread do laço apenas cria o VAO de cada malha, ou liga a
+// textura à sua unidade, quando o envio termina.
+//
+// Com "--no-upload-thread" (ou se não for possível criar o contexto da
+// thread de envio) o envio é feito pela própria thread do laço: a cada
+// quadro são enviados recursos enquanto o tempo estimado de envio (aprendido
+// dos envios anteriores) couber em "--stream-upload-ms" milissegundos, para
+// que o carregamento não atrase os quadros.
+//
+// Os dados já lidos mas ainda não enviados não passam de
+// "--stream-cpu-budget" MiB: a thread de carregamento espera antes de ler o
+// próximo arquivo.
+//
+// Quando os recursos na GPU passam de "--stream-gpu-budget" MiB, os que
+// estão há mais tempo longe da câmera (LRU) são descartados e voltam a ser
+// desenhados como substitutos. Recursos próximos nunca são descartados.
+//
+// Com "--progressive" todos os recursos são pedidos desde o primeiro quadro
+// (os dos estandes próximos primeiro) e nada é descartado: a janela mostra o
+// museu logo após o carregamento do museu e dos pedestais, e os objetos
+// expostos aparecem à medida que são carregados. O tempo até o primeiro
+// quadro e até a cena completa é medido em main.cpp.
+//
+// São contados carregamentos, descartes, quadros com algum recurso próximo
+// ausente ("stalls"), quadros acima do orçamento e a latência entre o pedido
+// e o envio para a GPU (veja Streaming_PrintStats()).
+
+#include <cstdio>
+#include <cstddef>
+
+#include <glm/vec4.hpp>
+
+#include "objmodel.h"
+#include "assetstats.h"
+#include "uploader.h"
+
+#define STREAMING_MAX_ASSETS        64
+#define STREAMING_MAX_STANDS        32
+#define STREAMING_MAX_STAND_ASSETS  8   // Recursos por estande
+#define STREAMING_DEFAULT_UPLOAD_MS 4.0
+#define STREAMING_DEFAULT_RADIUS    8.0f
+#define STREAMING_DEFAULT_GPU_MIB   48
+#define STREAMING_DEFAULT_CPU_MIB   32
+
+struct StreamingStats
+{
+    unsigned long requests;         // Pedidos de carregamento
+    unsigned long loads;            // Recursos enviados para a GPU
+    unsigned long cancelled;        // Pedidos descartados antes do envio, por não estarem mais próximos
+    unsigned long evictions;        // Recursos descartados da GPU por falta de orçamento
+    unsigned long failures;         // Arquivos que não puderam ser lidos
+    unsigned long frames;
+    unsigned long stall_frames;     // Quadros com algum recurso próximo desenhado como substituto
+    unsigned long over_budget_frames; // Quadros acima do orçamento de GPU sem nada para descartar
+    unsigned long upload_frames;    // Quadros com algum envio para a GPU
+    unsigned long upload_overrun_frames; // Quadros em que o envio passou de "--stream-upload-ms"
+    double        max_frame_upload_ms;
+    size_t        gpu_bytes;        // Bytes na GPU dos recursos carregados sob demanda
+    size_t        peak_gpu_bytes;
+    size_t        peak_cpu_bytes;   // Maior volume de dados lidos aguardando envio
+    double        mean_latency_ms;  // Do pedido ao envio para a GPU
+    double        max_latency_ms;
+};
+
+// Trata o argumento argv[*i], caso seja "--progressive", "--no-upload-thread"
+// ou um dos "--stream*", avançando *i se o argumento tiver um valor. Retorna
+// false se o argumento não for deste módulo.
+bool Streaming_ParseArg(int argc, char* argv[], int* i);
+bool Streaming_IsEnabled();
+bool Streaming_IsProgressive();
+
+// Indica se todos os recursos registrados estão na GPU (ou falharam).
+bool Streaming_IsFullyLoaded();
+
+// Registram um modelo (arquivo ".obj", sem a extensão, com os materiais em
+// "basepath") ou uma textura (".png", sem a extensão, na unidade de textura
+// "unit"). Retornam o índice do recurso.
+int Streaming_AddModel(const char* filepath, const char* basepath);
+int Streaming_AddTexture(const char* filepath, int unit);
+
+// Indica que os objetos expostos no estande "stand" usam o recurso "asset".
+void Streaming_AddToStand(int stand, int asset);
+
+// Inicia as threads de carregamento e de envio. Deve ser chamada após o
+// registro dos recursos, com o contexto de "window" (NULL no modo --bench sem
+// janela) atual.
+void Streaming_Start(GLFWwindow* window);
+
+// Chamada uma vez por quadro pela thread do laço de renderização.
+void Streaming_Update(glm::vec4 camera_position, const glm::vec4* stand_positions, int num_stands);
+
+// Termina as threads de carregamento e de envio e libera os dados ainda não
+// enviados.
+void Streaming_Stop();
+
+StreamingStats Streaming_GetStats();
+void Streaming_PrintStats(FILE* f);
+
+#endif // _STREAMING_H
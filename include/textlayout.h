@@ -0,0 +1,26 @@
+#ifndef _TEXTLAYOUT_H
+#define _TEXTLAYOUT_H
+
+// Posicionamento dos caracteres de uma string com a fonte DejaVu (veja
+// "dejavufont.h"): calcula, sem OpenGL, os dois triângulos de cada caractere.
+// Utilizado por TextRendering_PrintString() em "textrendering.cpp", e medido
+// isoladamente em "microbench.cpp".
+
+#define TEXTLAYOUT_FLOATS_PER_GLYPH 24 // 6 vértices (x, y, s, t) por caractere
+
+// Escreve em "vertices" os triângulos dos caracteres de "str", começando na
+// posição (x,y) em NDC. "sx" e "sy" convertem pixels da fonte para NDC.
+// "vertices" deve ter espaço para strlen(str)*TEXTLAYOUT_FLOATS_PER_GLYPH
+// floats. Caracteres que não existem na fonte são ignorados, e espaços só
+// avançam a posição. Retorna o número de caracteres posicionados.
+int TextLayout_String(const char* str, float x, float y, float sx, float sy, float* vertices);
+
+// Altura de uma linha e largura de um caractere (a fonte é monoespaçada), em
+// pixels da fonte.
+float TextLayout_LineHeight();
+float TextLayout_CharWidth();
+
+// Textura da fonte (um canal de 8 bits por pixel).
+const unsigned char* TextLayout_FontTexture(int* width, int* height);
+
+#endif // _TEXTLAYOUT_H
@@ -0,0 +1,77 @@
+#ifndef _TEXTURECACHE_H
+#define _TEXTURECACHE_H
+
+// Cache de texturas por conteúdo e samplers compartilhados.
+//
+// Várias imagens da cena são idênticas depois de decodificadas (p.ex. as
+// texturas de cor sólida de "triangulo.png" e "rosquinha_1.png"). Antes de
+// criar uma textura, quem envia a imagem calcula o hash dos pixels
+// decodificados com TextureCache_Hash() e procura uma textura com o mesmo
+// hash e as mesmas dimensões com TextureCache_Acquire(): se existir, ela é
+// ligada também à nova unidade de textura, sem novo envio nem novos mipmaps.
+// Cada textura do cache conta as unidades que a usam; ela só é apagada
+// quando a última a libera (TextureCache_Release()).
+//
+// Dois conteúdos diferentes com o mesmo hash de 64 bits e as mesmas
+// dimensões seriam confundidos; os pixels não são comparados, pois a cópia
+// na CPU é descartada após o envio.
+//
+// Samplers são criados uma vez por conjunto de parâmetros
+// (TextureCache_GetSampler()), em vez de um por unidade de textura.
+//
+// O cache tem tamanho fixo (TEXTURECACHE_MAX_TEXTURES); com ele cheio, novas
+// texturas simplesmente não são compartilhadas. Somente a thread do laço.
+
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#define TEXTURECACHE_MAX_TEXTURES 64
+#define TEXTURECACHE_MAX_SAMPLERS 8
+
+struct TextureSamplerParams
+{
+    GLenum wrap_s;
+    GLenum wrap_t;
+    GLenum min_filter;
+    GLenum mag_filter;
+};
+
+struct TextureCacheStats
+{
+    unsigned long lookups;      // Chamadas de TextureCache_Acquire()
+    unsigned long hits;         // Texturas compartilhadas em vez de criadas
+    size_t        bytes_saved;  // Bytes de GPU das texturas não criadas
+    int           textures;     // Texturas no cache
+    int           samplers;     // Samplers criados
+    unsigned long sampler_requests;
+};
+
+// Hash dos pixels decodificados ("size" bytes). Pode ser chamada de
+// qualquer thread.
+uint64_t TextureCache_Hash(const unsigned char* pixels, size_t size);
+
+// Retorna a textura com este conteúdo, contando mais uma unidade que a usa,
+// ou 0 se não houver.
+GLuint TextureCache_Acquire(uint64_t hash, int width, int height);
+
+// Registra uma textura recém-criada, usada por uma unidade, que ocupa
+// "bytes" na GPU.
+void TextureCache_Insert(uint64_t hash, int width, int height, GLuint texture_id, size_t bytes);
+
+// Indica que uma unidade deixou de usar a textura. Retorna true se a
+// textura deve ser apagada (era a última unidade, ou a textura não está no
+// cache); neste caso "bytes" recebe os bytes registrados no cache, se houver.
+bool TextureCache_Release(GLuint texture_id, size_t* bytes);
+
+// Sampler com os parâmetros dados, criado no primeiro pedido.
+GLuint TextureCache_GetSampler(const TextureSamplerParams& params);
+
+TextureCacheStats TextureCache_GetStats();
+
+// Escreve o resumo: texturas compartilhadas, bytes economizados e samplers.
+void TextureCache_PrintStats(FILE* f);
+
+#endif // _TEXTURECACHE_H
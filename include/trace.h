@@ -0,0 +1,75 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+// Rastreamento ("tracing") de trechos do programa, exportado no formato
+// "Trace Event" do Chrome. O arquivo gerado pode ser aberto em
+// chrome://tracing ou em https://ui.perfetto.dev, mostrando a linha do tempo
+// do carregamento e de cada quadro.
+//
+// Só existe no build instrumentado ("make trace", que define TRACE_ENABLED).
+// Nos demais builds todas as macros abaixo viram nada e "trace.cpp" fica vazio.
+//
+//     void LoadTextureImage(const char* filename)
+//     {
+//         TRACE_ZONE("LoadTextureImage"); // Mede até o fim do escopo
+//         ...
+//     }
+//
+//     TRACE_BEGIN("camera");   // Para trechos que não formam um escopo,
+//     ...                      // como os blocos de cada estande em main().
+//     TRACE_END();
+//
+// Cada thread escreve em seu próprio buffer circular, sem locks; quando o
+// buffer enche, os eventos mais antigos são sobrescritos. O relógio é o
+// contador de ciclos do processador (TSC) em x86, convertido para
+// microssegundos na exportação; nas demais arquiteturas usamos
+// std::chrono::steady_clock.
+//
+// IMPORTANTE: os nomes precisam existir até a exportação (p.ex. literais de
+// string), pois somente o ponteiro é guardado.
+
+#ifdef TRACE_ENABLED
+
+#define TRACE_BUFFER_EVENTS (1 << 16) // Eventos guardados por thread
+#define TRACE_MAX_DEPTH 64            // Máximo de TRACE_BEGIN() aninhados por thread
+
+// Inicializa o relógio. Deve ser chamada no início de main().
+void Trace_Init();
+
+// Nome da thread atual, mostrado pelo visualizador.
+void Trace_SetThreadName(const char* name);
+
+void Trace_Begin(const char* name);
+void Trace_End();
+
+// Exporta os eventos de todas as threads. Retorna false em caso de erro.
+bool Trace_WriteChromeJSON(const char* filename);
+
+struct TraceZone
+{
+    explicit TraceZone(const char* name) { Trace_Begin(name); }
+    ~TraceZone() { Trace_End(); }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#define TRACE_BEGIN(name) Trace_Begin(name)
+#define TRACE_END() Trace_End()
+#define TRACE_THREAD_NAME(name) Trace_SetThreadName(name)
+#define TRACE_INIT() Trace_Init()
+#define TRACE_WRITE(filename) ((void)Trace_WriteChromeJSON(filename))
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_BEGIN(name)
+#define TRACE_END()
+#define TRACE_THREAD_NAME(name)
+#define TRACE_INIT()
+#define TRACE_WRITE(filename)
+
+#endif // TRACE_ENABLED
+
+#endif // _TRACE_H
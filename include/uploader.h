@@ -0,0 +1,103 @@
+#ifndef _UPLOADER_H
+#define _UPLOADER_H
+
+// Thread de envio para a GPU, usada pelo carregamento sob demanda (veja
+// streaming.h).
+//
+// A thread tem o seu próprio contexto OpenGL, que compartilha objetos com o
+// contexto da janela: uma janela GLFW invisível ou, no modo --bench sem
+// janela, um segundo contexto EGL (veja bench.h). Malhas e imagens já lidas
+// chegam por uma fila sem locks (um produtor, a thread de carregamento, e um
+// consumidor, a thread de envio). Os dados são copiados para buffers mapeados
+// com glMapBufferRange(): os vértices e índices direto nos seus buffers, e as
+// imagens em um pixel buffer object (PBO), de onde glTexImage2D() as lê.
+//
+// Ao fim de cada envio a thread insere uma fence (glFenceSync()) e devolve o
+// pedido por uma segunda fila sem locks. A thread do laço só usa os objetos
+// criados quando Uploader_PollFinished() verifica, sem esperar, que a fence
+// foi sinalizada. VAOs não são compartilhados entre contextos: o VAO de cada
+// malha é criado pela thread do laço nesse momento.
+//
+// A thread de envio não usa o cache de estado (glstate.h), que reflete o
+// contexto da janela. No build instrumentado ("make profile") as suas
+// chamadas não entram nos contadores do quadro (gladProfileSkipThread()),
+// que só a thread do laço altera; o seu custo aparece em UploaderStats.
+
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "objmodel.h"
+#include "mesharena.h"
+
+// Buffers de uma malha na GPU, em posições fixas; 0 indica um atributo
+// ausente.
+#define MESHBUFFER_POSITIONS 0 // vec4, "(location = 0)" em "shader_vertex.glsl"
+#define MESHBUFFER_NORMALS   1 // vec4, "(location = 1)"
+#define MESHBUFFER_TEXCOORDS 2 // vec2, "(location = 2)"
+#define MESHBUFFER_INDICES   3 // GL_ELEMENT_ARRAY_BUFFER
+#define MESHBUFFER_COUNT     4
+
+// Objetos OpenGL de uma malha enviada para a GPU, para que possam ser
+// apagados quando a malha é descartada. Na arena de geometria (veja
+// mesharena.h) o VAO é o da arena, os buffers são 0 e a malha ocupa os
+// trechos "arena".
+struct MeshBuffers
+{
+    GLuint              vertex_array_object_id;
+    GLuint              buffer_ids[MESHBUFFER_COUNT];
+    size_t              bytes;                        // Soma dos tamanhos dos buffers
+    MeshArenaAllocation arena;
+};
+
+#define UPLOADER_QUEUE_SIZE 64 // Pedidos em andamento (potência de 2)
+
+// Um pedido de envio: uma malha ou uma imagem RGB. Os dados de entrada devem
+// continuar válidos até o pedido ser devolvido por Uploader_PollFinished().
+struct UploadJob
+{
+    const MeshData*      mesh;
+    const unsigned char* pixels;
+    int                  width;
+    int                  height;
+
+    // Preenchidos pela thread de envio.
+    MeshBuffers buffers;       // Sem VAO (vertex_array_object_id = 0)
+    GLuint      texture_id;
+    size_t      gpu_bytes;
+    double      upload_ms;
+    GLsync      fence;
+};
+
+struct UploaderStats
+{
+    unsigned long jobs;
+    double        busy_ms;         // Tempo gasto enviando
+    size_t        bytes;
+    unsigned long pending_polls;   // Consultas a uma fence ainda não sinalizada
+};
+
+// Cria o contexto compartilhado e inicia a thread. "window" é a janela do
+// programa, ou NULL no modo --bench sem janela. Deve ser chamada pela thread
+// do laço, com o seu contexto atual. Retorna false se não for possível criar
+// o contexto ou ativá-lo na thread de envio (que então já terminou); neste
+// caso o envio continua na thread do laço.
+bool Uploader_Start(GLFWwindow* window);
+bool Uploader_IsRunning();
+
+// Enfileira um pedido. Somente uma thread pode enviar pedidos. Retorna false
+// se a fila estiver cheia.
+bool Uploader_Submit(UploadJob* job);
+
+// Retorna o próximo pedido terminado cuja fence já foi sinalizada, ou NULL.
+// Os pedidos são devolvidos na ordem de envio. Somente a thread do laço.
+UploadJob* Uploader_PollFinished();
+
+// Termina a thread. Pedidos ainda não devolvidos são abandonados (os dados
+// de entrada continuam de quem os enviou).
+void Uploader_Stop();
+
+UploaderStats Uploader_GetStats();
+
+#endif // _UPLOADER_H
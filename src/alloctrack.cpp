@@ -0,0 +1,380 @@
+// Contagem de alocações de memória. Veja comentários em "include/alloctrack.h".
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+
+#include "alloctrack.h"
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#define ALLOCTRACK_HAS_BACKTRACE 1
+#endif
+
+#if defined(__GLIBC__)
+#include <link.h>
+#define ALLOCTRACK_CLASSIFY 1
+
+// Alocador original da glibc, chamado pelas funções substituídas abaixo.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void  __libc_free(void* ptr);
+#define ALLOCTRACK_HOOK_MALLOC 1
+#define RawMalloc __libc_malloc
+#define RawFree   __libc_free
+#else
+#define RawMalloc std::malloc
+#define RawFree   std::free
+#endif
+
+struct AllocSite
+{
+    bool               used;
+    uint32_t           hash;
+    int                depth;
+    void*              stack[ALLOCTRACK_STACK_DEPTH];
+    unsigned long      count;
+    unsigned long long bytes;
+};
+
+// Somente a thread do laço de renderização, entre AllocTrack_BeginFrame() e
+// AllocTrack_EndFrame(), tem "t_Counting" ligado; as variáveis abaixo são
+// escritas apenas por ela. "t_InHook" evita contar as alocações feitas pelo
+// próprio backtrace().
+static thread_local bool t_Counting = false;
+static thread_local bool t_InHook = false;
+
+#ifdef ALLOCTRACK_CLASSIFY
+// Trechos de código executável do processo, para saber de onde vem cada
+// alocação: do próprio programa, da biblioteca padrão (libc, libstdc++,
+// libgcc, libm) chamada pelo programa ou por outra biblioteca, ou de outras
+// bibliotecas (driver OpenGL, GLFW, ...).
+enum CodeOwner { OWNER_PROGRAM, OWNER_RUNTIME, OWNER_EXTERNAL };
+
+#define ALLOCTRACK_MAX_RANGES 32
+
+struct CodeRange
+{
+    uintptr_t begin;
+    uintptr_t end;
+    CodeOwner owner;
+};
+
+static CodeRange g_Ranges[ALLOCTRACK_MAX_RANGES];
+static int       g_NumRanges = 0;
+#endif
+
+static AllocTrackStats g_Stats;
+static unsigned long   g_FrameAllocs = 0;
+static unsigned long   g_LastFrameAllocs = 0;
+static AllocSite       g_Sites[ALLOCTRACK_MAX_SITES];
+
+static uint32_t HashStack(void* const* stack, int depth)
+{
+    // FNV-1a sobre os endereços.
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < depth; ++i)
+    {
+        uintptr_t a = (uintptr_t)stack[i];
+        for (size_t b = 0; b < sizeof(a); ++b)
+        {
+            h ^= (uint32_t)(a & 0xff);
+            h *= 16777619u;
+            a >>= 8;
+        }
+    }
+    return h;
+}
+
+static void RecordSite(size_t size)
+{
+#ifdef ALLOCTRACK_HAS_BACKTRACE
+    // Os dois primeiros endereços são Record() e a função substituída
+    // (operator new, malloc, ...), iguais em toda alocação.
+    void* stack[ALLOCTRACK_STACK_DEPTH + 2];
+    int n = backtrace(stack, ALLOCTRACK_STACK_DEPTH + 2) - 2;
+    if (n <= 0)
+        return;
+    void* const* frames = stack + 2;
+    uint32_t hash = HashStack(frames, n);
+
+    for (int probe = 0; probe < ALLOCTRACK_MAX_SITES; ++probe)
+    {
+        AllocSite& site = g_Sites[(hash + probe) % ALLOCTRACK_MAX_SITES];
+        if (!site.used)
+        {
+            site.used  = true;
+            site.hash  = hash;
+            site.depth = n;
+            memcpy(site.stack, frames, n * sizeof(void*));
+        }
+        else if (site.hash != hash || site.depth != n || memcmp(site.stack, frames, n * sizeof(void*)) != 0)
+            continue;
+
+        site.count += 1;
+        site.bytes += size;
+        return;
+    }
+#endif
+    g_Stats.lost_sites += 1;
+}
+
+#ifdef ALLOCTRACK_CLASSIFY
+static int AddRange(struct dl_phdr_info* info, size_t, void*)
+{
+    // O primeiro módulo (nome vazio) é o executável.
+    CodeOwner owner = OWNER_EXTERNAL;
+    const char* name = info->dlpi_name;
+    if (name == NULL || name[0] == '\0')
+        owner = OWNER_PROGRAM;
+    else if (strstr(name, "/libc.so") || strstr(name, "/libstdc++.so") || strstr(name, "/libgcc_s.so") || strstr(name, "/libm.so"))
+        owner = OWNER_RUNTIME;
+    else
+        return 0; // Qualquer endereço fora dos trechos guardados é OWNER_EXTERNAL
+
+    for (int i = 0; i < info->dlpi_phnum && g_NumRanges < ALLOCTRACK_MAX_RANGES; ++i)
+    {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_X))
+            continue;
+        CodeRange& r = g_Ranges[g_NumRanges++];
+        r.begin = info->dlpi_addr + ph.p_vaddr;
+        r.end   = r.begin + ph.p_memsz;
+        r.owner = owner;
+    }
+    return 0;
+}
+
+static CodeOwner Owner(const void* address)
+{
+    uintptr_t a = (uintptr_t)address;
+    for (int i = 0; i < g_NumRanges; ++i)
+        if (a >= g_Ranges[i].begin && a < g_Ranges[i].end)
+            return g_Ranges[i].owner;
+    return OWNER_EXTERNAL;
+}
+
+// Indica se a alocação, chamada a partir de "caller", foi pedida pelo
+// programa. Quando quem chama é a biblioteca padrão (p.ex. std::string ou
+// strdup()), subimos na pilha até o primeiro código fora dela.
+static bool IsProgramAllocation(const void* caller)
+{
+    CodeOwner owner = Owner(caller);
+    if (owner != OWNER_RUNTIME)
+        return owner == OWNER_PROGRAM;
+
+    // Procuramos "caller" na pilha (os endereços anteriores são deste
+    // arquivo) e seguimos a partir dele.
+    void* stack[ALLOCTRACK_STACK_DEPTH + 4];
+    int n = backtrace(stack, ALLOCTRACK_STACK_DEPTH + 4);
+    bool found = false;
+    for (int i = 0; i < n; ++i)
+    {
+        if (!found)
+        {
+            found = (stack[i] == caller);
+            continue;
+        }
+        owner = Owner(stack[i]);
+        if (owner != OWNER_RUNTIME)
+            return owner == OWNER_PROGRAM;
+    }
+    return true; // Na dúvida, contamos
+}
+#endif
+
+// "caller" é o endereço de retorno da função substituída (operator new,
+// malloc, ...).
+static __attribute__((noinline)) void Record(size_t size, bool is_new, const void* caller)
+{
+    if (!t_Counting || t_InHook)
+        return;
+    t_InHook = true;
+
+#ifdef ALLOCTRACK_CLASSIFY
+    // Alocações de outras bibliotecas (p.ex. o driver OpenGL, dentro de
+    // glDrawElements()) fogem do controle do programa: são somente contadas.
+    if (!IsProgramAllocation(caller))
+    {
+        g_Stats.external_allocs += 1;
+        t_InHook = false;
+        return;
+    }
+#endif
+
+    if (is_new)
+        g_Stats.new_allocs += 1;
+    else
+        g_Stats.malloc_allocs += 1;
+    g_Stats.bytes += size;
+    g_FrameAllocs += 1;
+    RecordSite(size);
+
+    t_InHook = false;
+}
+
+void AllocTrack_Init()
+{
+#ifdef ALLOCTRACK_HAS_BACKTRACE
+    // A primeira chamada a backtrace() carrega a biblioteca de "unwinding",
+    // alocando memória; fazemos isto agora, fora de qualquer quadro.
+    void* stack[ALLOCTRACK_STACK_DEPTH];
+    backtrace(stack, ALLOCTRACK_STACK_DEPTH);
+#endif
+#ifdef ALLOCTRACK_CLASSIFY
+    g_NumRanges = 0;
+    dl_iterate_phdr(AddRange, NULL);
+#endif
+    AllocTrack_ResetStats();
+}
+
+void AllocTrack_BeginFrame()
+{
+    g_FrameAllocs = 0;
+    t_Counting = true;
+}
+
+void AllocTrack_EndFrame()
+{
+    t_Counting = false;
+
+    g_Stats.frames += 1;
+    if (g_FrameAllocs > 0)
+        g_Stats.frames_with_allocs += 1;
+    g_Stats.max_allocs_per_frame = std::max(g_Stats.max_allocs_per_frame, g_FrameAllocs);
+    g_LastFrameAllocs = g_FrameAllocs;
+}
+
+unsigned long AllocTrack_LastFrameAllocs()
+{
+    return g_LastFrameAllocs;
+}
+
+void AllocTrack_ResetStats()
+{
+    memset(&g_Stats, 0, sizeof(g_Stats));
+    memset(g_Sites, 0, sizeof(g_Sites));
+    g_FrameAllocs = 0;
+}
+
+AllocTrackStats AllocTrack_GetStats()
+{
+    return g_Stats;
+}
+
+static bool CompareSites(int a, int b)
+{
+    return g_Sites[a].count > g_Sites[b].count;
+}
+
+void AllocTrack_PrintSites(FILE* f, int max_sites)
+{
+    int order[ALLOCTRACK_MAX_SITES];
+    int num_sites = 0;
+    for (int i = 0; i < ALLOCTRACK_MAX_SITES; ++i)
+        if (g_Sites[i].used)
+            order[num_sites++] = i;
+    std::sort(order, order + num_sites, CompareSites);
+
+    for (int i = 0; i < num_sites && i < max_sites; ++i)
+    {
+        const AllocSite& site = g_Sites[order[i]];
+        fprintf(f, "  %lu alocacoes, %llu bytes:\n", site.count, site.bytes);
+#ifdef ALLOCTRACK_HAS_BACKTRACE
+        for (int d = 0; d < site.depth; ++d)
+        {
+            // Endereços de retorno apontam para a instrução seguinte à
+            // chamada; subtraímos 1 para que addr2line mostre a linha da
+            // chamada.
+            uintptr_t addr = (uintptr_t)site.stack[d] - 1;
+            Dl_info info;
+            if (dladdr((void*)addr, &info) == 0)
+            {
+                fprintf(f, "    %p\n", (void*)addr);
+                continue;
+            }
+
+            const char* module = info.dli_fname ? strrchr(info.dli_fname, '/') : NULL;
+            module = module ? module + 1 : (info.dli_fname ? info.dli_fname : "?");
+
+            if (info.dli_sname != NULL)
+            {
+                int status = 0;
+                char* name = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+                fprintf(f, "    %s+0x%lx (%s)\n", status == 0 ? name : info.dli_sname,
+                        (unsigned long)(addr - (uintptr_t)info.dli_saddr), module);
+                free(name);
+            }
+            else
+                fprintf(f, "    %s+0x%lx\n", module, (unsigned long)(addr - (uintptr_t)info.dli_fbase));
+        }
+#endif
+    }
+    if (g_Stats.lost_sites > 0)
+        fprintf(f, "  (%lu alocacoes sem local registrado)\n", g_Stats.lost_sites);
+}
+
+// Operadores globais substituídos. Todas as variantes do C++11 passam por
+// aqui; as versões de vetor e "nothrow" usam as mesmas funções.
+
+void* operator new(size_t size)
+{
+    Record(size, true, __builtin_return_address(0));
+    void* p = RawMalloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    Record(size, true, __builtin_return_address(0));
+    void* p = RawMalloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    Record(size, true, __builtin_return_address(0));
+    return RawMalloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    Record(size, true, __builtin_return_address(0));
+    return RawMalloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept                          { RawFree(p); }
+void operator delete[](void* p) noexcept                        { RawFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept   { RawFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { RawFree(p); }
+
+#ifdef ALLOCTRACK_HOOK_MALLOC
+// Funções de alocação do C, substituídas para todo o processo (inclusive
+// bibliotecas dinâmicas como o driver OpenGL). free() não precisa ser
+// substituída, pois a memória vem do mesmo alocador.
+extern "C" void* malloc(size_t size) __THROW
+{
+    Record(size, false, __builtin_return_address(0));
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) __THROW
+{
+    Record(count * size, false, __builtin_return_address(0));
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) __THROW
+{
+    Record(size, false, __builtin_return_address(0));
+    return __libc_realloc(ptr, size);
+}
+#endif
@@ -0,0 +1,495 @@
+// Leitura em lote dos arquivos. Veja comentários em "include/assetio.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define ASSETIO_HAS_URING 1
+#endif
+#endif
+#endif
+
+#include "assetio.h"
+#include "assetstats.h"
+#include "trace.h"
+
+static AssetIOBackend g_Backend = ASSETIO_AUTO;
+static AssetIOStats   g_Stats;
+
+bool AssetIO_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--io") != 0 || *i + 1 >= argc)
+        return false;
+
+    const char* name = argv[++*i];
+    if (strcmp(name, "uring") == 0)
+        g_Backend = ASSETIO_URING;
+    else if (strcmp(name, "threads") == 0)
+        g_Backend = ASSETIO_THREADS;
+    else if (strcmp(name, "sync") == 0)
+        g_Backend = ASSETIO_SYNC;
+    else
+    {
+        fprintf(stderr, "ERROR: unknown I/O backend \"%s\" (use uring, threads or sync).\n", name);
+        std::exit(EXIT_FAILURE);
+    }
+    return true;
+}
+
+AssetIOBackend AssetIO_GetBackend()
+{
+    return g_Backend;
+}
+
+const char* AssetIO_BackendName(AssetIOBackend backend)
+{
+    switch (backend)
+    {
+    case ASSETIO_URING:   return "io_uring";
+    case ASSETIO_THREADS: return "threads";
+    case ASSETIO_SYNC:    return "sync";
+    default:              return "auto";
+    }
+}
+
+AssetIOStats AssetIO_GetStats()
+{
+    return g_Stats;
+}
+
+// Lê o arquivo inteiro para um buffer alocado com malloc(). Retorna NULL se
+// não for possível.
+static unsigned char* ReadWholeFile(const char* filepath, size_t* size)
+{
+    FILE* f = fopen(filepath, "rb");
+    if (f == NULL)
+        return NULL;
+
+    unsigned char* data = NULL;
+    if (fseek(f, 0, SEEK_END) == 0)
+    {
+        long length = ftell(f);
+        if (length >= 0 && fseek(f, 0, SEEK_SET) == 0)
+        {
+            // +1 para que um arquivo vazio também tenha um buffer.
+            data = (unsigned char*)malloc((size_t)length + 1);
+            if (data != NULL && fread(data, 1, (size_t)length, f) != (size_t)length)
+            {
+                free(data);
+                data = NULL;
+            }
+            *size = (size_t)length;
+        }
+    }
+    fclose(f);
+    return data;
+}
+
+// Chama "done" com o resultado de uma leitura e libera o buffer.
+static void Complete(AssetRead* read, unsigned char* data, size_t size, AssetReadDone done)
+{
+    read->data = data;
+    read->size = (data != NULL) ? size : 0;
+    g_Stats.files += 1;
+    g_Stats.bytes += read->size;
+    done(read);
+    free(data);
+    read->data = NULL;
+}
+
+static void ReadAllSync(AssetRead* reads, int count, AssetReadDone done)
+{
+    for (int r = 0; r < count; ++r)
+    {
+        double start = AssetStats_NowMs();
+        size_t size = 0;
+        unsigned char* data = ReadWholeFile(reads[r].filepath, &size);
+        g_Stats.wait_ms += AssetStats_NowMs() - start;
+        Complete(&reads[r], data, size, done);
+    }
+}
+
+// Backend "threads": as threads pegam o próximo arquivo da lista por um
+// contador atômico e devolvem as leituras terminadas por uma fila protegida
+// por mutex, de onde a thread que chamou AssetIO_ReadAll() as retira.
+struct FinishedRead
+{
+    int            index;
+    unsigned char* data;
+    size_t         size;
+};
+
+static void ReadAllThreads(AssetRead* reads, int count, AssetReadDone done)
+{
+    std::atomic<int>         next(0);
+    std::mutex               mutex;
+    std::condition_variable  finished_cv;
+    std::deque<FinishedRead> finished;
+
+    int num_threads = (count < ASSETIO_NUM_THREADS) ? count : ASSETIO_NUM_THREADS;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+        threads.push_back(std::thread([&]() {
+            TRACE_THREAD_NAME("Leitura");
+            for (int r = next++; r < count; r = next++)
+            {
+                FinishedRead result;
+                result.index = r;
+                result.size = 0;
+                {
+                    TRACE_ZONE("AssetIO_Read");
+                    result.data = ReadWholeFile(reads[r].filepath, &result.size);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(result);
+                finished_cv.notify_one();
+            }
+        }));
+
+    for (int completed = 0; completed < count; ++completed)
+    {
+        FinishedRead result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (finished.empty())
+            {
+                double start = AssetStats_NowMs();
+                finished_cv.wait(lock, [&]() { return !finished.empty(); });
+                g_Stats.wait_ms += AssetStats_NowMs() - start;
+            }
+            result = finished.front();
+            finished.pop_front();
+        }
+        Complete(&reads[result.index], result.data, result.size, done);
+    }
+
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+}
+
+#if defined(ASSETIO_HAS_URING)
+
+// Backend "io_uring". O kernel e o programa compartilham duas filas
+// circulares mapeadas na memória: a de envio (SQ), onde escrevemos um
+// "io_uring_sqe" por leitura, e a de resultados (CQ), onde o kernel escreve
+// um "io_uring_cqe" por leitura terminada. Cada fila tem um índice "head"
+// (lido por um lado) e um "tail" (escrito pelo outro), acessados com
+// acquire/release como nas filas de uploader.cpp.
+struct URing
+{
+    int   fd;
+    void* sq_ptr;
+    void* cq_ptr;
+    size_t sq_size;
+    size_t cq_size;
+
+    unsigned*      sq_tail;
+    unsigned*      sq_mask;
+    unsigned*      sq_array;
+    unsigned       sq_entries;
+    io_uring_sqe*  sqes;
+
+    unsigned*      cq_head;
+    unsigned*      cq_tail;
+    unsigned*      cq_mask;
+    io_uring_cqe*  cqes;
+};
+
+static void URingDestroy(URing* ring)
+{
+    if (ring->sqes != NULL)
+        munmap(ring->sqes, ring->sq_entries * sizeof(io_uring_sqe));
+    if (ring->cq_ptr != NULL && ring->cq_ptr != ring->sq_ptr)
+        munmap(ring->cq_ptr, ring->cq_size);
+    if (ring->sq_ptr != NULL)
+        munmap(ring->sq_ptr, ring->sq_size);
+    if (ring->fd >= 0)
+        close(ring->fd);
+}
+
+static bool URingCreate(URing* ring, unsigned entries)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0)
+        return false;
+
+    // IORING_OP_READ existe desde o Linux 5.6; IORING_FEAT_FAST_POLL (5.7)
+    // é o primeiro indicador de versão posterior a ele.
+    if ((params.features & IORING_FEAT_FAST_POLL) == 0)
+    {
+        URingDestroy(ring);
+        return false;
+    }
+
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && ring->cq_size > ring->sq_size)
+        ring->sq_size = ring->cq_size;
+
+    void* sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED)
+    {
+        URingDestroy(ring);
+        return false;
+    }
+    ring->sq_ptr = sq_ptr;
+
+    void* cq_ptr = sq_ptr;
+    if (!single_mmap)
+    {
+        cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED)
+        {
+            URingDestroy(ring);
+            return false;
+        }
+    }
+    ring->cq_ptr = cq_ptr;
+
+    void* sqes = mmap(NULL, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        URingDestroy(ring);
+        return false;
+    }
+    ring->sqes = (io_uring_sqe*)sqes;
+    ring->sq_entries = params.sq_entries;
+
+    char* sq = (char*)sq_ptr;
+    ring->sq_tail  = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask  = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+
+    char* cq = (char*)cq_ptr;
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes    = (io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+}
+
+static int URingEnter(URing* ring, unsigned to_submit, unsigned min_complete)
+{
+    int result;
+    do
+    {
+        result = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, min_complete,
+                              min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+// Uma leitura em andamento: o arquivo aberto, o buffer e quanto já foi lido.
+// Leituras parciais (possíveis em arquivos grandes) são pedidas de novo a
+// partir de "done".
+struct URingRead
+{
+    int            fd;
+    unsigned char* data;
+    size_t         size;
+    size_t         done;
+};
+
+static void URingQueueRead(URing* ring, unsigned* tail, int index, const URingRead* read)
+{
+    unsigned slot = *tail & *ring->sq_mask;
+    io_uring_sqe* sqe = &ring->sqes[slot];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = read->fd;
+    sqe->off       = read->done;
+    sqe->addr      = (unsigned long long)(uintptr_t)(read->data + read->done);
+    sqe->len       = (unsigned)(read->size - read->done);
+    sqe->user_data = (unsigned long long)index;
+    ring->sq_array[slot] = slot;
+    *tail += 1;
+}
+
+static bool ReadAllURing(AssetRead* reads, int count, AssetReadDone done)
+{
+    // Uma entrada por arquivo, para que todos caibam em um único envio.
+    unsigned entries = 1;
+    while (entries < (unsigned)count && entries < 4096)
+        entries *= 2;
+
+    URing ring;
+    if (!URingCreate(&ring, entries))
+        return false;
+
+    // Os arquivos são abertos aqui (o tamanho de cada um define o seu
+    // buffer); somente as leituras do conteúdo vão para o kernel.
+    std::vector<URingRead> pending(count);
+    std::deque<int> queue;
+    for (int r = 0; r < count; ++r)
+    {
+        URingRead& read = pending[r];
+        read.data = NULL;
+        read.size = 0;
+        read.done = 0;
+        read.fd = open(reads[r].filepath, O_RDONLY);
+        struct stat st;
+        if (read.fd >= 0 && fstat(read.fd, &st) == 0)
+        {
+            read.size = (size_t)st.st_size;
+            read.data = (unsigned char*)malloc(read.size + 1);
+        }
+        queue.push_back(r);
+    }
+
+    int completed = 0;
+    unsigned in_flight = 0;
+    while (completed < count)
+    {
+        // Arquivos que não abriram, e arquivos vazios, não vão para o
+        // kernel. Os demais são enviados enquanto houver espaço na fila.
+        unsigned tail = *ring.sq_tail;
+        unsigned queued = 0;
+        while (!queue.empty() && in_flight + queued < ring.sq_entries)
+        {
+            int r = queue.front();
+            queue.pop_front();
+            URingRead& read = pending[r];
+            if (read.data == NULL || read.done == read.size)
+            {
+                unsigned char* data = read.data;
+                if (read.fd >= 0)
+                    close(read.fd);
+                read.fd = -1;
+                read.data = NULL;
+                Complete(&reads[r], data, read.size, done);
+                completed += 1;
+                continue;
+            }
+            URingQueueRead(&ring, &tail, r, &read);
+            queued += 1;
+        }
+        __atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+
+        if (completed == count)
+            break;
+
+        // Envia as novas leituras e espera por pelo menos um resultado.
+        double start = AssetStats_NowMs();
+        int result;
+        {
+            TRACE_ZONE("AssetIO_Wait");
+            result = URingEnter(&ring, queued, 1);
+        }
+        g_Stats.wait_ms += AssetStats_NowMs() - start;
+        if (result < 0)
+        {
+            fprintf(stderr, "ERROR: io_uring_enter() failed (%s).\n", strerror(errno));
+            std::exit(EXIT_FAILURE);
+        }
+        in_flight += queued;
+
+        unsigned head = *ring.cq_head;
+        unsigned cq_tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        while (head != cq_tail)
+        {
+            const io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+            int r = (int)cqe->user_data;
+            int res = cqe->res;
+            head += 1;
+            in_flight -= 1;
+
+            URingRead& read = pending[r];
+            if (res > 0)
+            {
+                read.done += (size_t)res;
+                if (read.done < read.size)
+                {
+                    queue.push_back(r);
+                    continue;
+                }
+            }
+            else
+            {
+                // Erro, ou fim do arquivo antes do tamanho esperado.
+                free(read.data);
+                read.data = NULL;
+            }
+
+            // O resultado é consumido antes de chamar "done", que pode
+            // demorar: o kernel continua as demais leituras enquanto isso.
+            __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+            close(read.fd);
+            read.fd = -1;
+            unsigned char* data = read.data;
+            read.data = NULL;
+            Complete(&reads[r], data, read.size, done);
+            completed += 1;
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    URingDestroy(&ring);
+    return true;
+}
+
+#endif // ASSETIO_HAS_URING
+
+void AssetIO_ReadAll(AssetRead* reads, int count, AssetReadDone done, AssetIOBackend backend)
+{
+    TRACE_ZONE("AssetIO_ReadAll");
+    memset(&g_Stats, 0, sizeof(g_Stats));
+    double start = AssetStats_NowMs();
+
+    if (backend == ASSETIO_AUTO)
+        backend = ASSETIO_URING;
+
+    if (backend == ASSETIO_URING)
+    {
+#if defined(ASSETIO_HAS_URING)
+        if (ReadAllURing(reads, count, done))
+            backend = ASSETIO_URING;
+        else
+#endif
+        backend = ASSETIO_THREADS;
+    }
+
+    if (backend == ASSETIO_THREADS)
+        ReadAllThreads(reads, count, done);
+    else if (backend == ASSETIO_SYNC)
+        ReadAllSync(reads, count, done);
+
+    g_Stats.backend = backend;
+    g_Stats.total_ms = AssetStats_NowMs() - start;
+}
+
+bool AssetIO_DropCache(const char* filepath)
+{
+#if defined(__linux__)
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return ok;
+#else
+    (void)filepath;
+    return false;
+#endif
+}
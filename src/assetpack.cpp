@@ -0,0 +1,259 @@
+// Pacote de recursos. Veja comentários em "include/assetpack.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "assetpack.h"
+
+static const char* g_PackFilename = NULL;
+
+// Mapeamento do pacote aberto.
+static const unsigned char*  g_Data = NULL;
+static size_t                g_Size = 0;
+static const AssetPackEntry* g_Entries = NULL;
+static uint32_t              g_NumEntries = 0;
+#if defined(_WIN32)
+static HANDLE g_File = INVALID_HANDLE_VALUE;
+static HANDLE g_Mapping = NULL;
+#endif
+
+bool AssetPack_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--pack") == 0 && *i + 1 < argc)
+        g_PackFilename = argv[++*i];
+    else
+        return false;
+    return true;
+}
+
+static bool MapFile(const char* filename)
+{
+#if defined(_WIN32)
+    g_File = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (g_File == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    GetFileSizeEx(g_File, &size);
+    g_Mapping = CreateFileMappingA(g_File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (g_Mapping == NULL)
+        return false;
+    g_Data = (const unsigned char*)MapViewOfFile(g_Mapping, FILE_MAP_READ, 0, 0, 0);
+    g_Size = (size_t)size.QuadPart;
+    return g_Data != NULL;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    // O descritor pode ser fechado: o mapeamento continua válido.
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    g_Data = (const unsigned char*)data;
+    g_Size = (size_t)st.st_size;
+    return true;
+#endif
+}
+
+static void InvalidPack(const char* reason)
+{
+    fprintf(stderr, "ERROR: \"%s\" is not a valid asset pack (%s). Rebuild it with \"make pack\".\n", g_PackFilename, reason);
+    std::exit(EXIT_FAILURE);
+}
+
+void AssetPack_Open()
+{
+    if (g_PackFilename == NULL || g_Data != NULL)
+        return;
+
+    if (!MapFile(g_PackFilename))
+    {
+        fprintf(stderr, "ERROR: Cannot open asset pack \"%s\".\n", g_PackFilename);
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Somente o índice é validado aqui; o conteúdo de cada recurso é
+    // conferido quando for lido.
+    const AssetPackHeader* header = (const AssetPackHeader*)g_Data;
+    if (g_Size < sizeof(AssetPackHeader) || memcmp(header->magic, ASSETPACK_MAGIC, sizeof(ASSETPACK_MAGIC)) != 0)
+        InvalidPack("bad magic");
+    if (header->version != ASSETPACK_VERSION)
+        InvalidPack("unsupported version");
+    if (sizeof(AssetPackHeader) + (size_t)header->num_entries * sizeof(AssetPackEntry) > g_Size)
+        InvalidPack("truncated index");
+
+    g_Entries = (const AssetPackEntry*)(g_Data + sizeof(AssetPackHeader));
+    g_NumEntries = header->num_entries;
+    for (uint32_t e = 0; e < g_NumEntries; ++e)
+        if (g_Entries[e].offset > g_Size || g_Entries[e].size > g_Size - g_Entries[e].offset
+            || g_Entries[e].name[ASSETPACK_NAME_SIZE - 1] != '\0')
+            InvalidPack("bad entry");
+
+    printf("Pacote de recursos \"%s\": %u recursos, %.1f MiB.\n", g_PackFilename, g_NumEntries, g_Size / (1024.0*1024.0));
+}
+
+bool AssetPack_IsOpen()
+{
+    return g_Data != NULL;
+}
+
+void AssetPack_Close()
+{
+    if (g_Data == NULL)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(g_Data);
+    CloseHandle(g_Mapping);
+    CloseHandle(g_File);
+    g_Mapping = NULL;
+    g_File = INVALID_HANDLE_VALUE;
+#else
+    munmap((void*)g_Data, g_Size);
+#endif
+    g_Data = NULL;
+    g_Size = 0;
+    g_Entries = NULL;
+    g_NumEntries = 0;
+}
+
+static const char* BaseName(const char* path)
+{
+    const char* name = strrchr(path, '/');
+    return (name != NULL) ? name + 1 : path;
+}
+
+const void* AssetPack_Find(const char* path, AssetPackFormat format, size_t* size)
+{
+    const char* name = BaseName(path);
+
+    // Busca linear: o índice tem algumas dezenas de entradas, lidas uma vez
+    // por recurso carregado.
+    for (uint32_t e = 0; e < g_NumEntries; ++e)
+    {
+        const AssetPackEntry& entry = g_Entries[e];
+        if (strcmp(entry.name, name) != 0 || entry.format != (uint32_t)format)
+            continue;
+
+        const unsigned char* data = g_Data + entry.offset;
+        if (AssetPack_Hash(data, (size_t)entry.size) != entry.hash)
+        {
+            fprintf(stderr, "ERROR: \"%s\" in asset pack \"%s\" is corrupted (hash mismatch).\n", name, g_PackFilename);
+            std::exit(EXIT_FAILURE);
+        }
+        *size = (size_t)entry.size;
+        return data;
+    }
+    return NULL;
+}
+
+const void* AssetPack_Get(const char* path, AssetPackFormat format, size_t* size)
+{
+    const void* data = AssetPack_Find(path, format, size);
+    if (data == NULL)
+    {
+        fprintf(stderr, "ERROR: \"%s\" not found in asset pack \"%s\".\n", BaseName(path), g_PackFilename);
+        std::exit(EXIT_FAILURE);
+    }
+    return data;
+}
+
+uint64_t AssetPack_Hash(const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Recursos acumulados pelo "packer".
+struct PendingEntry
+{
+    AssetPackEntry             entry;
+    std::vector<unsigned char> data;
+};
+static std::vector<PendingEntry> g_Pending;
+
+void AssetPack_Add(const char* name, AssetPackFormat format, const void* data, size_t size)
+{
+    name = BaseName(name);
+    if (strlen(name) >= ASSETPACK_NAME_SIZE)
+    {
+        fprintf(stderr, "ERROR: asset name \"%s\" too long for the pack (max. %d characters).\n", name, ASSETPACK_NAME_SIZE - 1);
+        std::exit(EXIT_FAILURE);
+    }
+
+    PendingEntry pending;
+    memset(&pending.entry, 0, sizeof(pending.entry));
+    strcpy(pending.entry.name, name);
+    pending.entry.size   = size;
+    pending.entry.format = format;
+    pending.entry.hash   = AssetPack_Hash(data, size);
+    pending.data.assign((const unsigned char*)data, (const unsigned char*)data + size);
+    g_Pending.push_back(pending);
+}
+
+static uint64_t AlignUp(uint64_t offset)
+{
+    return (offset + ASSETPACK_ALIGN - 1) / ASSETPACK_ALIGN * ASSETPACK_ALIGN;
+}
+
+bool AssetPack_Write(const char* filename)
+{
+    AssetPackHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ASSETPACK_MAGIC, sizeof(ASSETPACK_MAGIC));
+    header.version = ASSETPACK_VERSION;
+    header.num_entries = (uint32_t)g_Pending.size();
+
+    uint64_t offset = AlignUp(sizeof(header) + g_Pending.size() * sizeof(AssetPackEntry));
+    for (size_t e = 0; e < g_Pending.size(); ++e)
+    {
+        g_Pending[e].entry.offset = offset;
+        offset = AlignUp(offset + g_Pending[e].entry.size);
+    }
+
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (size_t e = 0; ok && e < g_Pending.size(); ++e)
+        ok = fwrite(&g_Pending[e].entry, sizeof(AssetPackEntry), 1, f) == 1;
+
+    // O espaço até cada conteúdo é preenchido com zeros.
+    static const unsigned char zeros[ASSETPACK_ALIGN] = {};
+    long position = (long)(sizeof(header) + g_Pending.size() * sizeof(AssetPackEntry));
+    for (size_t e = 0; ok && e < g_Pending.size(); ++e)
+    {
+        const PendingEntry& pending = g_Pending[e];
+        size_t padding = (size_t)(pending.entry.offset - position);
+        ok = fwrite(zeros, 1, padding, f) == padding
+          && fwrite(pending.data.data(), 1, pending.data.size(), f) == pending.data.size();
+        position = (long)(pending.entry.offset + pending.entry.size);
+    }
+
+    if (fclose(f) != 0)
+        ok = false;
+    return ok;
+}
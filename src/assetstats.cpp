@@ -0,0 +1,169 @@
+// Relatório dos recursos carregados. Veja comentários em "include/assetstats.h".
+#include <cstring>
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "assetstats.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static AssetStats g_Assets[ASSETSTATS_MAX_ASSETS];
+static int        g_NumAssets = 0;
+static int        g_LostAssets = 0;
+static AssetStats g_Overflow; // Entrada devolvida com a tabela cheia
+
+static long CurrentPageFaults()
+{
+    size_t peak_rss;
+    long page_faults;
+    return AssetStats_GetProcessMemory(&peak_rss, &page_faults) ? page_faults : 0;
+}
+
+AssetStats* AssetStats_Add(const char* filepath, AssetKind kind)
+{
+    AssetStats* stats = &g_Overflow;
+    if (g_NumAssets < ASSETSTATS_MAX_ASSETS)
+        stats = &g_Assets[g_NumAssets++];
+    else
+        g_LostAssets += 1;
+
+    memset(stats, 0, sizeof(*stats));
+    const char* name = strrchr(filepath, '/');
+    name = (name != NULL) ? name + 1 : filepath;
+    strncpy(stats->name, name, ASSETSTATS_NAME_SIZE - 1);
+    stats->kind = kind;
+    stats->file_bytes = AssetStats_FileSize(filepath);
+
+    // Até AssetStats_Finish() guardamos aqui a contagem inicial.
+    stats->page_faults = CurrentPageFaults();
+    return stats;
+}
+
+void AssetStats_Finish(AssetStats* stats)
+{
+    stats->page_faults = CurrentPageFaults() - stats->page_faults;
+}
+
+int AssetStats_Count()
+{
+    return g_NumAssets;
+}
+
+const AssetStats* AssetStats_Get(int index)
+{
+    return &g_Assets[index];
+}
+
+AssetStatsTotals AssetStats_GetTotals()
+{
+    AssetStatsTotals totals;
+    memset(&totals, 0, sizeof(totals));
+    totals.assets = g_NumAssets;
+    totals.lost_assets = g_LostAssets;
+    for (int i = 0; i < g_NumAssets; ++i)
+    {
+        const AssetStats& a = g_Assets[i];
+        totals.file_bytes        += a.file_bytes;
+        totals.load_ms           += a.load_ms;
+        totals.build_ms          += a.build_ms;
+        totals.upload_ms         += a.upload_ms;
+        totals.gpu_vbo_bytes     += a.gpu_vbo_bytes;
+        totals.gpu_ibo_bytes     += a.gpu_ibo_bytes;
+        totals.gpu_texture_bytes += a.gpu_texture_bytes;
+        if (a.cpu_peak_bytes > totals.cpu_peak_bytes)
+            totals.cpu_peak_bytes = a.cpu_peak_bytes;
+    }
+    return totals;
+}
+
+size_t AssetStats_FileSize(const char* filepath)
+{
+    FILE* f = fopen(filepath, "rb");
+    if (f == NULL)
+        return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return (size > 0) ? (size_t)size : 0;
+}
+
+size_t AssetStats_TextureBytes(int width, int height, int bytes_per_texel)
+{
+    size_t bytes = 0;
+    for (;;)
+    {
+        bytes += (size_t)width * height * bytes_per_texel;
+        if (width == 1 && height == 1)
+            break;
+        width  = (width  > 1) ? width/2  : 1;
+        height = (height > 1) ? height/2 : 1;
+    }
+    return bytes;
+}
+
+double AssetStats_NowMs()
+{
+    return std::chrono::duration<double, std::milli>(Clock::now().time_since_epoch()).count();
+}
+
+bool AssetStats_GetProcessMemory(size_t* peak_rss_bytes, long* page_faults)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return false;
+#if defined(__APPLE__)
+    *peak_rss_bytes = (size_t)usage.ru_maxrss;        // Em bytes no macOS
+#else
+    *peak_rss_bytes = (size_t)usage.ru_maxrss * 1024; // Em KiB no Linux
+#endif
+    *page_faults = usage.ru_minflt + usage.ru_majflt;
+    return true;
+#else
+    (void)peak_rss_bytes;
+    (void)page_faults;
+    return false;
+#endif
+}
+
+static double KiB(size_t bytes)
+{
+    return bytes / 1024.0;
+}
+
+void AssetStats_PrintTable(FILE* f)
+{
+    fprintf(f, "%-20s %9s %8s %8s %8s %9s %9s %9s %9s %8s %8s %7s\n",
+            "recurso", "arq. KiB", "leit. ms", "mont. ms", "envio ms",
+            "CPU KiB", "VBO KiB", "IBO KiB", "tex. KiB", "vertices", "unicos", "faltas");
+
+    for (int i = 0; i < g_NumAssets; ++i)
+    {
+        const AssetStats& a = g_Assets[i];
+        if (a.kind == ASSET_MODEL)
+            fprintf(f, "%-20s %9.1f %8.2f %8.2f %8.2f %9.1f %9.1f %9.1f %9s %8lu %8lu %7ld\n",
+                    a.name, KiB(a.file_bytes), a.load_ms, a.build_ms, a.upload_ms,
+                    KiB(a.cpu_peak_bytes), KiB(a.gpu_vbo_bytes), KiB(a.gpu_ibo_bytes), "-",
+                    (unsigned long)a.vertices, (unsigned long)a.unique_vertices, a.page_faults);
+        else
+            fprintf(f, "%-20s %9.1f %8.2f %8s %8.2f %9.1f %9s %9s %9.1f %8s %8s %7ld\n",
+                    a.name, KiB(a.file_bytes), a.load_ms, "-", a.upload_ms,
+                    KiB(a.cpu_peak_bytes), "-", "-", KiB(a.gpu_texture_bytes), "-", "-", a.page_faults);
+    }
+
+    AssetStatsTotals t = AssetStats_GetTotals();
+    fprintf(f, "%-20s %9.1f %8.2f %8.2f %8.2f %9.1f %9.1f %9.1f %9.1f\n",
+            "total", KiB(t.file_bytes), t.load_ms, t.build_ms, t.upload_ms,
+            KiB(t.cpu_peak_bytes), KiB(t.gpu_vbo_bytes), KiB(t.gpu_ibo_bytes), KiB(t.gpu_texture_bytes));
+    if (t.lost_assets > 0)
+        fprintf(f, "(%d recursos nao couberam na tabela)\n", t.lost_assets);
+
+    size_t peak_rss;
+    long page_faults;
+    if (AssetStats_GetProcessMemory(&peak_rss, &page_faults))
+        fprintf(f, "Processo: pico de memoria residente %.1f MiB, %ld faltas de pagina.\n",
+                peak_rss / (1024.0*1024.0), page_faults);
+}
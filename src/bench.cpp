@@ -0,0 +1,421 @@
+// Modo de benchmark sem janela. Veja comentários em "include/bench.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h> // Somente as constantes GLFW_KEY_*
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "bench.h"
+#include "replay.h"
+#include "alloctrack.h"
+
+// Duração de cada parte do roteiro, em quadros.
+#define BENCH_WALK_FRAMES   360 // Caminhada para frente (W)
+#define BENCH_STRAFE_FRAMES 60  // Passo para o lado (D)
+#define BENCH_STAND_FRAMES  90  // Tempo em cada um dos estandes 1 a 17
+#define BENCH_DROP_FRAMES   240 // Tempo para cada objeto do estande 18 cair
+
+typedef std::chrono::steady_clock Clock;
+
+static unsigned int           g_BenchFrame = 0;
+
+static Clock::time_point      g_FrameStart;
+static std::vector<float>     g_FrameMs;
+static std::vector<int>       g_FrameStand;
+
+static GLuint g_BenchFBO = 0;
+static GLuint g_BenchColor = 0;
+static GLuint g_BenchDepth = 0;
+
+static void AddEvent(std::vector<ReplayEvent>& events, unsigned int frame, int key, int action)
+{
+    ReplayEvent e;
+    memset(&e, 0, sizeof(e));
+    e.frame  = frame;
+    e.type   = REPLAY_KEY;
+    e.key    = key;
+    e.action = action;
+    events.push_back(e);
+}
+
+// Monta o roteiro de teclas descrito em bench.h e o entrega para a
+// reprodução de eventos (veja replay.h). Retorna o número de quadros.
+static unsigned int BuildTour()
+{
+    std::vector<ReplayEvent> events;
+    unsigned int f = BENCH_WARMUP_FRAMES;
+
+    // 1. Caminhada pelo corredor
+    AddEvent(events, f, GLFW_KEY_W, GLFW_PRESS);
+    f += BENCH_WALK_FRAMES;
+    AddEvent(events, f, GLFW_KEY_W, GLFW_RELEASE);
+    AddEvent(events, f, GLFW_KEY_D, GLFW_PRESS);
+    f += BENCH_STRAFE_FRAMES;
+    AddEvent(events, f, GLFW_KEY_D, GLFW_RELEASE);
+
+    // 2. LOOK_AT_CAMERA nos estandes 1 a 17
+    f += 1;
+    AddEvent(events, f, GLFW_KEY_ENTER, GLFW_PRESS);
+    for (int stand = 0; stand < 17; ++stand)
+    {
+        f += BENCH_STAND_FRAMES;
+        AddEvent(events, f, GLFW_KEY_RIGHT, GLFW_PRESS);
+    }
+
+    // 3. Estande 18: soltamos os cinco objetos, um por vez
+    for (int obj = 0; obj < 5; ++obj)
+    {
+        f += 30;
+        AddEvent(events, f, GLFW_KEY_ENTER, GLFW_PRESS);
+        f += BENCH_DROP_FRAMES;
+    }
+
+    Replay_SetEvents(&events[0], (int)events.size(), f);
+    return f;
+}
+
+void Bench_InitConfig(BenchConfig* config)
+{
+    config->enabled   = false;
+    config->width     = 1280;
+    config->height    = 720;
+    config->output    = "bench.json";
+}
+
+bool Bench_ParseArg(int argc, char* argv[], int* i, BenchConfig* config)
+{
+    const char* arg = argv[*i];
+    if (strcmp(arg, "--bench") == 0)
+        config->enabled = true;
+    else if (strcmp(arg, "--bench-size") == 0 && *i + 1 < argc)
+    {
+        ++*i;
+        if (sscanf(argv[*i], "%dx%d", &config->width, &config->height) != 2 || config->width <= 0 || config->height <= 0)
+        {
+            fprintf(stderr, "ERROR: invalid --bench-size \"%s\" (expected WIDTHxHEIGHT).\n", argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else if (strcmp(arg, "--bench-output") == 0 && *i + 1 < argc)
+        config->output = argv[++*i];
+    else
+        return false;
+    return true;
+}
+
+void Bench_Start()
+{
+    // Com --replay os eventos gravados substituem o roteiro.
+    unsigned int frames = Replay_IsPlaying() ? 0 : BuildTour();
+    g_BenchFrame = 0;
+    g_FrameMs.reserve(frames);
+    g_FrameStand.reserve(frames);
+}
+
+#ifdef __linux__
+
+static EGLDisplay g_BenchDisplay = EGL_NO_DISPLAY;
+static EGLContext g_BenchContext = EGL_NO_CONTEXT;
+static EGLContext g_BenchSharedContext = EGL_NO_CONTEXT;
+static EGLConfig  g_BenchConfig = (EGLConfig)0;
+
+static const EGLint g_BenchContextAttribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+    EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+    EGL_NONE
+};
+
+bool Bench_CreateContext()
+{
+    // Preferimos a plataforma "surfaceless" do Mesa, que não precisa de
+    // servidor gráfico nem de GPU.
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != NULL)
+        g_BenchDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (g_BenchDisplay == EGL_NO_DISPLAY)
+        g_BenchDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (g_BenchDisplay == EGL_NO_DISPLAY || !eglInitialize(g_BenchDisplay, &major, &minor))
+    {
+        fprintf(stderr, "ERROR: eglInitialize() failed.\n");
+        g_BenchDisplay = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "ERROR: eglBindAPI(EGL_OPENGL_API) failed.\n");
+        Bench_DestroyContext();
+        return false;
+    }
+
+    // Nenhuma superfície é criada; mesmo assim alguns drivers exigem uma
+    // configuração compatível com pbuffers.
+    const EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = (EGLConfig)0; // EGL_NO_CONFIG_KHR
+    EGLint num_configs = 0;
+    eglChooseConfig(g_BenchDisplay, config_attribs, &config, 1, &num_configs);
+    if (num_configs == 0)
+        config = (EGLConfig)0;
+    g_BenchConfig = config;
+
+    g_BenchContext = eglCreateContext(g_BenchDisplay, config, EGL_NO_CONTEXT, g_BenchContextAttribs);
+    if (g_BenchContext == EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "ERROR: eglCreateContext() failed (0x%x).\n", eglGetError());
+        Bench_DestroyContext();
+        return false;
+    }
+
+    if (!eglMakeCurrent(g_BenchDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, g_BenchContext))
+    {
+        fprintf(stderr, "ERROR: eglMakeCurrent() without surface failed (0x%x).\n", eglGetError());
+        Bench_DestroyContext();
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress))
+    {
+        fprintf(stderr, "ERROR: gladLoadGLLoader() failed.\n");
+        Bench_DestroyContext();
+        return false;
+    }
+
+    printf("Benchmark: contexto EGL %d.%d sem superficie.\n", major, minor);
+    return true;
+}
+
+void Bench_DestroyContext()
+{
+    if (g_BenchDisplay == EGL_NO_DISPLAY)
+        return;
+    eglMakeCurrent(g_BenchDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (g_BenchSharedContext != EGL_NO_CONTEXT)
+        eglDestroyContext(g_BenchDisplay, g_BenchSharedContext);
+    if (g_BenchContext != EGL_NO_CONTEXT)
+        eglDestroyContext(g_BenchDisplay, g_BenchContext);
+    eglTerminate(g_BenchDisplay);
+    g_BenchContext = EGL_NO_CONTEXT;
+    g_BenchSharedContext = EGL_NO_CONTEXT;
+    g_BenchDisplay = EGL_NO_DISPLAY;
+}
+
+void* Bench_GetProcAddress(const char* name)
+{
+    return (void*)eglGetProcAddress(name);
+}
+
+bool Bench_CreateSharedContext()
+{
+    if (g_BenchContext == EGL_NO_CONTEXT)
+        return false;
+    g_BenchSharedContext = eglCreateContext(g_BenchDisplay, g_BenchConfig, g_BenchContext, g_BenchContextAttribs);
+    if (g_BenchSharedContext == EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "ERROR: eglCreateContext() for the shared context failed (0x%x).\n", eglGetError());
+        return false;
+    }
+    return true;
+}
+
+void Bench_DestroySharedContext()
+{
+    if (g_BenchSharedContext != EGL_NO_CONTEXT)
+        eglDestroyContext(g_BenchDisplay, g_BenchSharedContext);
+    g_BenchSharedContext = EGL_NO_CONTEXT;
+}
+
+bool Bench_MakeSharedContextCurrent(bool current)
+{
+    return eglMakeCurrent(g_BenchDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                          current ? g_BenchSharedContext : EGL_NO_CONTEXT) == EGL_TRUE;
+}
+
+#else
+
+bool Bench_CreateContext()
+{
+    return false;
+}
+
+void Bench_DestroyContext()
+{
+}
+
+void* Bench_GetProcAddress(const char*)
+{
+    return NULL;
+}
+
+bool Bench_CreateSharedContext()
+{
+    return false;
+}
+
+void Bench_DestroySharedContext()
+{
+}
+
+bool Bench_MakeSharedContextCurrent(bool)
+{
+    return false;
+}
+
+#endif // __linux__
+
+bool Bench_CreateFramebuffer(int width, int height)
+{
+    glGenFramebuffers(1, &g_BenchFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_BenchFBO);
+
+    glGenRenderbuffers(1, &g_BenchColor);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_BenchColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_BenchColor);
+
+    glGenRenderbuffers(1, &g_BenchDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_BenchDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_BenchDepth);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERROR: benchmark framebuffer incomplete (0x%x).\n", status);
+        return false;
+    }
+    return true;
+}
+
+void Bench_BeginFrame()
+{
+    // As alocações do aquecimento (caches e vetores atingindo seu tamanho
+    // final) não contam para Bench_CheckAllocations().
+    if (g_BenchFrame == BENCH_WARMUP_FRAMES)
+        AllocTrack_ResetStats();
+
+    g_FrameStart = Clock::now();
+}
+
+double Bench_EndFrame(int stand)
+{
+    // Sem troca de buffers nada limita quantos quadros a CPU envia à frente
+    // da GPU; esperamos a GPU para medir o custo real de cada quadro.
+    glFinish();
+
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - g_FrameStart).count();
+    if (g_BenchFrame >= BENCH_WARMUP_FRAMES)
+    {
+        g_FrameMs.push_back((float)ms);
+        g_FrameStand.push_back(stand);
+    }
+    g_BenchFrame += 1;
+    return ms;
+}
+
+// Percentil "p" (entre 0 e 1) de valores já ordenados.
+static double Percentile(const std::vector<float>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    return sorted[(size_t)(p*(sorted.size() - 1) + 0.5)];
+}
+
+static double Mean(const std::vector<float>& values)
+{
+    if (values.empty())
+        return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); ++i)
+        sum += values[i];
+    return sum / values.size();
+}
+
+// Tempos dos quadros em que "stand" estava em foco, ordenados.
+static std::vector<float> SortedFrames(int stand, bool all)
+{
+    std::vector<float> ms;
+    for (size_t i = 0; i < g_FrameMs.size(); ++i)
+        if (all || g_FrameStand[i] == stand)
+            ms.push_back(g_FrameMs[i]);
+    std::sort(ms.begin(), ms.end());
+    return ms;
+}
+
+bool Bench_WriteJSON(const BenchConfig& config)
+{
+    FILE* f = fopen(config.output, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", config.output);
+        return false;
+    }
+
+    std::vector<float> all = SortedFrames(0, true);
+    double mean = Mean(all);
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+    fprintf(f, "  \"width\": %d,\n  \"height\": %d,\n  \"time_step\": %.6f,\n", config.width, config.height, Replay_TimeStep());
+    fprintf(f, "  \"frames\": %u,\n  \"warmup_frames\": %d,\n", (unsigned int)all.size(), BENCH_WARMUP_FRAMES);
+    fprintf(f, "  \"frame_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+            mean, Percentile(all, 0.50), Percentile(all, 0.90), Percentile(all, 0.95), Percentile(all, 0.99),
+            all.empty() ? 0.0 : all.back());
+    fprintf(f, "  \"fps_mean\": %.2f,\n", mean > 0.0 ? 1000.0/mean : 0.0);
+
+    AllocTrackStats allocs = AllocTrack_GetStats();
+    fprintf(f, "  \"allocations\": {\"frames_with_allocs\": %lu, \"max_per_frame\": %lu, \"new\": %llu, \"malloc\": %llu, \"bytes\": %llu, \"external\": %llu},\n",
+            allocs.frames_with_allocs, allocs.max_allocs_per_frame, allocs.new_allocs, allocs.malloc_allocs, allocs.bytes, allocs.external_allocs);
+
+    std::vector<float> walk = SortedFrames(-1, false);
+    fprintf(f, "  \"free_walk\": {\"frames\": %u, \"mean_ms\": %.4f, \"p95_ms\": %.4f},\n",
+            (unsigned int)walk.size(), Mean(walk), Percentile(walk, 0.95));
+
+    fprintf(f, "  \"stands\": [\n");
+    for (int stand = 0; stand < 18; ++stand)
+    {
+        std::vector<float> ms = SortedFrames(stand, false);
+        fprintf(f, "    {\"stand\": %d, \"frames\": %u, \"mean_ms\": %.4f, \"p95_ms\": %.4f}%s\n",
+                stand + 1, (unsigned int)ms.size(), Mean(ms), Percentile(ms, 0.95), (stand < 17) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+
+    printf("Benchmark: %u quadros, media %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms. Resumo em \"%s\".\n",
+           (unsigned int)all.size(), mean, Percentile(all, 0.50), Percentile(all, 0.95), Percentile(all, 0.99), config.output);
+    return true;
+}
+
+bool Bench_CheckAllocations()
+{
+    AllocTrackStats allocs = AllocTrack_GetStats();
+    if (allocs.frames_with_allocs == 0)
+    {
+        printf("Benchmark: nenhuma alocacao de memoria em %lu quadros apos o aquecimento (%llu alocacoes de outras bibliotecas).\n",
+               allocs.frames, allocs.external_allocs);
+        return true;
+    }
+
+    fprintf(stderr, "ERROR: %lu of %lu frames allocated memory after warm-up (%llu new, %llu malloc, %llu bytes). Call sites:\n",
+            allocs.frames_with_allocs, allocs.frames, allocs.new_allocs, allocs.malloc_allocs, allocs.bytes);
+    AllocTrack_PrintSites(stderr, 10);
+    return false;
+}
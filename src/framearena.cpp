@@ -0,0 +1,35 @@
+// Arena linear de cada quadro. Veja comentários em "include/framearena.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "framearena.h"
+
+alignas(64) static unsigned char g_Arena[FRAMEARENA_SIZE];
+static size_t g_ArenaUsed = 0;
+static size_t g_ArenaHighWater = 0;
+
+void* FrameArena_Alloc(size_t size, size_t align)
+{
+    size_t begin = (g_ArenaUsed + align - 1) & ~(align - 1);
+    if (begin + size > FRAMEARENA_SIZE)
+    {
+        fprintf(stderr, "ERROR: frame arena exhausted (%lu of %d bytes requested).\n",
+                (unsigned long)(begin + size), FRAMEARENA_SIZE);
+        std::exit(EXIT_FAILURE);
+    }
+    g_ArenaUsed = begin + size;
+    if (g_ArenaUsed > g_ArenaHighWater)
+        g_ArenaHighWater = g_ArenaUsed;
+    return g_Arena + begin;
+}
+
+void FrameArena_Reset()
+{
+    g_ArenaUsed = 0;
+}
+
+size_t FrameArena_HighWater()
+{
+    return g_ArenaHighWater;
+}
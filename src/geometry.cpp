@@ -0,0 +1,166 @@
+// Testes de colisão e funções de geometria. Veja comentários em "include/geometry.h".
+#include <cmath>
+
+#include "geometry.h"
+
+struct square_bbox Museu;
+std::vector<square_bbox> estandes_bbox;
+struct square_bbox Dino;
+
+float absolute_float(float v){
+    if (v < 0){
+        return -v;
+    }
+    return v;
+}
+
+glm::vec4 bezier(float t, glm::vec4 p1, glm::vec4 p2, glm::vec4 p3, glm::vec4 p4)
+{
+
+    glm::vec4 c12 = p1 + t*(p2-p1);
+    glm::vec4 c23 = p2 + t*(p3-p2);
+    glm::vec4 c34 = p3 + t*(p4-p3);
+    glm::vec4 c123 = c12 + t*(c23-c12);
+    glm::vec4 c234 = c23 + t*(c34-c23);
+    glm::vec4 c = c123 + t*(c234-c123);
+
+    return c;
+}
+
+bool interseccao_caixa_caixa(struct box_obj obj1, struct box_obj obj2){
+    glm::vec3 distancia_centros = (obj1.c - obj2.c);
+
+    bool x_dist = absolute_float(distancia_centros.x) <= (obj1.x_size + obj2.x_size);
+    bool y_dist = absolute_float(distancia_centros.y) <= (obj1.y_size + obj2.y_size);
+    bool z_dist = absolute_float(distancia_centros.z) <= (obj1.z_size + obj2.z_size);
+
+    return (x_dist && y_dist && z_dist);
+}
+
+bool interseccao_esfera_esfera(struct sphere_obj obj1, struct sphere_obj obj2){
+    glm::vec3 vetor_dist = obj1.c - obj2.c;
+    float distancia_centros = sqrt( pow(vetor_dist.x,2) + pow(vetor_dist.y,2) + pow(vetor_dist.z,2) );
+
+    return distancia_centros <= (obj1.r + obj2.r);
+}
+
+bool interseccao_caixa_esfera(struct box_obj caixa, struct sphere_obj esfera){
+    glm::vec3 distancia_centros = (caixa.c - esfera.c);
+
+    if (absolute_float(distancia_centros.x) > (caixa.x_size + esfera.r)){
+        return false;
+    }
+    if (absolute_float(distancia_centros.y) > (caixa.y_size + esfera.r)){
+        return false;
+    }
+    if (absolute_float(distancia_centros.z) > (caixa.z_size + esfera.r)){
+        return false;
+    }
+
+
+    if (absolute_float(distancia_centros.x) <= caixa.x_size ){
+        return true;
+    }
+    if (absolute_float(distancia_centros.y) <= caixa.y_size ){
+        return true;
+    }
+    if (absolute_float(distancia_centros.z) <= caixa.z_size ){
+        return true;
+    }
+
+    return ( pow(distancia_centros.x - caixa.x_size, 2) + pow(distancia_centros.y - caixa.y_size, 2) )
+                        <= pow(esfera.r, 2);
+
+}
+
+bool interseccao_caixa_plano(struct box_obj caixa, struct plane_obj plano){
+    glm::vec3 distancia_centros = (caixa.c - plano.c);
+
+    bool y_dist = absolute_float(distancia_centros.y) <= (caixa.y_size);
+    bool x_dist = absolute_float(distancia_centros.x) <= (caixa.x_size + plano.x_size);
+    bool z_dist = absolute_float(distancia_centros.z) <= (caixa.z_size + plano.z_size);
+
+    return (y_dist && x_dist && z_dist);
+}
+
+bool interseccao_esfera_plano(struct sphere_obj esfera, struct plane_obj plano){
+    glm::vec3 distancia_centros = (esfera.c - plano.c);
+
+    bool y_dist = absolute_float(distancia_centros.y) <= (esfera.r);
+    bool x_dist = absolute_float(distancia_centros.x) <= (esfera.r + plano.x_size);
+    bool z_dist = absolute_float(distancia_centros.z) <= (esfera.r + plano.z_size);
+
+    return (y_dist && x_dist && z_dist);
+}
+
+/// return true if inside museum
+bool check_inside_museum(float x,  float z){
+    glm::vec3 p_41 = Museu.p4 - Museu.p1;
+    glm::vec3 p_24 = Museu.p2 - Museu.p4;
+    glm::vec3 p_12 = Museu.p1 - Museu.p2;
+
+    glm::vec3 p_23 = Museu.p2 - Museu.p3;
+    glm::vec3 p_42 = Museu.p4 - Museu.p2;
+    glm::vec3 p_34 = Museu.p3 - Museu.p4;
+
+    bool t1 = F_p1_p2(p_41, Museu.p4, x, z) > 0 && F_p1_p2(p_24, Museu.p2, x, z) > 0 && F_p1_p2(p_12, Museu.p1, x, z) > 0;
+    bool t2 = F_p1_p2(p_23, Museu.p2, x, z) > 0 && F_p1_p2(p_42, Museu.p4, x, z) > 0 && F_p1_p2(p_34, Museu.p3, x, z) > 0;
+
+    if (t1 || t2) {
+        return true;
+    }
+    return false;
+}
+
+/// return true if outside estande
+bool check_estande(struct square_bbox estande, float x, float z){
+    glm::vec3 p_41 = estande.p4 - estande.p1;
+    glm::vec3 p_24 = estande.p2 - estande.p4;
+    glm::vec3 p_12 = estande.p1 - estande.p2;
+
+    glm::vec3 p_23 = estande.p2 - estande.p3;
+    glm::vec3 p_42 = estande.p4 - estande.p2;
+    glm::vec3 p_34 = estande.p3 - estande.p4;
+
+    bool t1 = F_p1_p2(p_41, estande.p4, x, z) >= 0 && F_p1_p2(p_24, estande.p2, x, z) >= 0 && F_p1_p2(p_12, estande.p1, x, z) >= 0;
+    bool t2 = F_p1_p2(p_23, estande.p2, x, z) >= 0 && F_p1_p2(p_42, estande.p4, x, z) >= 0 && F_p1_p2(p_34, estande.p3, x, z) >= 0;
+
+    if (t1 || t2) {
+        return false;
+    }
+    return true;
+}
+
+bool check_estandes(float x, float z){
+    bool colisoes_estandes = true;
+    for (int i=0; i != QUANT_ESTANDE; i++){
+        colisoes_estandes = colisoes_estandes && check_estande(estandes_bbox[i], x, z);
+    }
+    return colisoes_estandes;
+}
+
+bool check_dino(float x, float z){
+    glm::vec3 p_41 = Dino.p4 - Dino.p1;
+    glm::vec3 p_24 = Dino.p2 - Dino.p4;
+    glm::vec3 p_12 = Dino.p1 - Dino.p2;
+
+    glm::vec3 p_23 = Dino.p2 - Dino.p3;
+    glm::vec3 p_42 = Dino.p4 - Dino.p2;
+    glm::vec3 p_34 = Dino.p3 - Dino.p4;
+
+    bool t1 = F_p1_p2(p_41, Dino.p4, x, z) >= 0 && F_p1_p2(p_24, Dino.p2, x, z) >= 0 && F_p1_p2(p_12, Dino.p1, x, z) >= 0;
+    bool t2 = F_p1_p2(p_23, Dino.p2, x, z) >= 0 && F_p1_p2(p_42, Dino.p4, x, z) >= 0 && F_p1_p2(p_34, Dino.p3, x, z) >= 0;
+
+    if (t1 || t2) {
+        return false;
+    }
+    return true;
+}
+
+float F_p1_p2(glm::vec3 v, glm::vec3 a, float x, float z){
+    return v.z*x - v.x*z - v.z*a.x + v.x*a.z;
+}
+
+bool check_colision(float x, float z){
+    return check_inside_museum(x, z) && check_estandes(x, z) && check_dino(x, z);
+}
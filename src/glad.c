@@ -1802,3 +1802,350 @@ int gladLoadGLLoader(GLADloadproc load) {
 	return GLVersion.major != 0 || GLVersion.minor != 0;
 }
 
+
+#ifdef GLAD_PROFILE
+/*
+    Instrumentação dos ponteiros carregados acima. Veja include/glad/glad_profile.h.
+
+    Cada ponto de entrada listado em GLAD_PROFILE_ENTRY_POINTS ganha uma função
+    "prof_<nome>" que conta a chamada, executa um "hook" opcional (bytes
+    enviados, índices desenhados, ...) e repassa a chamada para o ponteiro
+    original, guardado em "prof_real_<nome>". gladProfileSetEnabled() troca
+    os ponteiros glad_gl* entre as duas versões.
+*/
+#include <glad/glad_profile.h>
+
+#define GLAD_PROFILE_HISTORY 1024
+
+static gladProfileFrame prof_current;
+static gladProfileFrame *prof_history = NULL;
+static unsigned long prof_recorded = 0;
+static unsigned long prof_frame_index = 0;
+static int prof_enabled = 0;
+static int prof_installed = 0;
+/* glad.c é compilado como C++ pelo Makefile, e como C por outras IDEs. */
+#ifdef __cplusplus
+#define PROF_THREAD_LOCAL thread_local
+#else
+#define PROF_THREAD_LOCAL _Thread_local
+#endif
+static PROF_THREAD_LOCAL int prof_skip_thread = 0; /* Veja gladProfileSkipThread() */
+
+static unsigned long long prof_pixel_bytes(GLsizei width, GLsizei height, GLenum format, GLenum type) {
+    unsigned long long components, size;
+    switch(format) {
+        case GL_RED: case GL_DEPTH_COMPONENT: case GL_RED_INTEGER: components = 1; break;
+        case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL: components = 2; break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+        default: components = 4; break;
+    }
+    switch(type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE: size = 1; break;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: size = 2; break;
+        case GL_UNSIGNED_INT_24_8: components = 1; size = 4; break;
+        default: size = 4; break;
+    }
+    return (unsigned long long)width * (unsigned long long)height * components * size;
+}
+
+static unsigned long long prof_multidraw_count(const GLsizei *count, GLsizei drawcount) {
+    unsigned long long total = 0;
+    GLsizei i;
+    for(i = 0; i < drawcount; i++) total += (unsigned long long)count[i];
+    return total;
+}
+
+#define PROF_HOOK_NONE (void)0
+#define PROF_HOOK_UNIFORM prof_current.uniform_calls += 1
+#define PROF_HOOK_DRAW(n) (prof_current.draw_calls += 1, prof_current.draw_indices += (unsigned long long)(n))
+#define PROF_HOOK_MULTIDRAW(n, draws) (prof_current.draw_calls += (unsigned long)(draws), prof_current.draw_indices += (n))
+#define PROF_HOOK_BUFFER(data, size) prof_current.buffer_bytes += ((data) != NULL) ? (unsigned long long)(size) : 0
+#define PROF_HOOK_TEXTURE(pixels, w, h, f, t) prof_current.texture_bytes += ((pixels) != NULL) ? prof_pixel_bytes(w, h, f, t) : 0
+
+/* V(tipo, nome, parâmetros, argumentos, hook) para funções sem retorno;
+   R(tipo, retorno, nome, parâmetros, argumentos, hook) para as demais. */
+#define GLAD_PROFILE_ENTRY_POINTS(V, R) \
+    V(PFNGLACTIVETEXTUREPROC, glActiveTexture, (GLenum texture), (texture), PROF_HOOK_NONE) \
+    V(PFNGLATTACHSHADERPROC, glAttachShader, (GLuint program, GLuint shader), (program, shader), PROF_HOOK_NONE) \
+    V(PFNGLBEGINQUERYPROC, glBeginQuery, (GLenum target, GLuint id), (target, id), PROF_HOOK_NONE) \
+    V(PFNGLBINDBUFFERPROC, glBindBuffer, (GLenum target, GLuint buffer), (target, buffer), PROF_HOOK_NONE) \
+    V(PFNGLBINDBUFFERBASEPROC, glBindBufferBase, (GLenum target, GLuint index, GLuint buffer), (target, index, buffer), PROF_HOOK_NONE) \
+    V(PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer, (GLenum target, GLuint framebuffer), (target, framebuffer), PROF_HOOK_NONE) \
+    V(PFNGLBINDSAMPLERPROC, glBindSampler, (GLuint unit, GLuint sampler), (unit, sampler), PROF_HOOK_NONE) \
+    V(PFNGLBINDTEXTUREPROC, glBindTexture, (GLenum target, GLuint texture), (target, texture), PROF_HOOK_NONE) \
+    V(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray, (GLuint array), (array), PROF_HOOK_NONE) \
+    V(PFNGLBLENDFUNCPROC, glBlendFunc, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor), PROF_HOOK_NONE) \
+    V(PFNGLBUFFERDATAPROC, glBufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage), (target, size, data, usage), PROF_HOOK_BUFFER(data, size)) \
+    V(PFNGLBUFFERSUBDATAPROC, glBufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data), (target, offset, size, data), PROF_HOOK_BUFFER(data, size)) \
+    V(PFNGLCLEARPROC, glClear, (GLbitfield mask), (mask), PROF_HOOK_NONE) \
+    V(PFNGLCLEARCOLORPROC, glClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha), PROF_HOOK_NONE) \
+    R(PFNGLCLIENTWAITSYNCPROC, GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout), (sync, flags, timeout), PROF_HOOK_NONE) \
+    V(PFNGLCOMPILESHADERPROC, glCompileShader, (GLuint shader), (shader), PROF_HOOK_NONE) \
+    R(PFNGLCREATEPROGRAMPROC, GLuint, glCreateProgram, (void), (), PROF_HOOK_NONE) \
+    R(PFNGLCREATESHADERPROC, GLuint, glCreateShader, (GLenum type), (type), PROF_HOOK_NONE) \
+    V(PFNGLCULLFACEPROC, glCullFace, (GLenum mode), (mode), PROF_HOOK_NONE) \
+    V(PFNGLDELETEBUFFERSPROC, glDeleteBuffers, (GLsizei n, const GLuint *buffers), (n, buffers), PROF_HOOK_NONE) \
+    V(PFNGLDELETEPROGRAMPROC, glDeleteProgram, (GLuint program), (program), PROF_HOOK_NONE) \
+    V(PFNGLDELETESHADERPROC, glDeleteShader, (GLuint shader), (shader), PROF_HOOK_NONE) \
+    V(PFNGLDELETETEXTURESPROC, glDeleteTextures, (GLsizei n, const GLuint *textures), (n, textures), PROF_HOOK_NONE) \
+    V(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays, (GLsizei n, const GLuint *arrays), (n, arrays), PROF_HOOK_NONE) \
+    V(PFNGLDEPTHFUNCPROC, glDepthFunc, (GLenum func), (func), PROF_HOOK_NONE) \
+    V(PFNGLDISABLEPROC, glDisable, (GLenum cap), (cap), PROF_HOOK_NONE) \
+    V(PFNGLDRAWARRAYSPROC, glDrawArrays, (GLenum mode, GLint first, GLsizei count), (mode, first, count), PROF_HOOK_DRAW(count)) \
+    V(PFNGLDRAWARRAYSINSTANCEDPROC, glDrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei instancecount), (mode, first, count, instancecount), PROF_HOOK_DRAW((unsigned long long)count * instancecount)) \
+    V(PFNGLDRAWELEMENTSPROC, glDrawElements, (GLenum mode, GLsizei count, GLenum type, const void *indices), (mode, count, type, indices), PROF_HOOK_DRAW(count)) \
+    V(PFNGLDRAWELEMENTSBASEVERTEXPROC, glDrawElementsBaseVertex, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLint basevertex), (mode, count, type, indices, basevertex), PROF_HOOK_DRAW(count)) \
+    V(PFNGLDRAWELEMENTSINSTANCEDPROC, glDrawElementsInstanced, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount), (mode, count, type, indices, instancecount), PROF_HOOK_DRAW((unsigned long long)count * instancecount)) \
+    V(PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC, glDrawElementsInstancedBaseVertex, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount, GLint basevertex), (mode, count, type, indices, instancecount, basevertex), PROF_HOOK_DRAW((unsigned long long)count * instancecount)) \
+    V(PFNGLENABLEPROC, glEnable, (GLenum cap), (cap), PROF_HOOK_NONE) \
+    V(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray, (GLuint index), (index), PROF_HOOK_NONE) \
+    V(PFNGLENDQUERYPROC, glEndQuery, (GLenum target), (target), PROF_HOOK_NONE) \
+    R(PFNGLFENCESYNCPROC, GLsync, glFenceSync, (GLenum condition, GLbitfield flags), (condition, flags), PROF_HOOK_NONE) \
+    V(PFNGLFRONTFACEPROC, glFrontFace, (GLenum mode), (mode), PROF_HOOK_NONE) \
+    V(PFNGLGENBUFFERSPROC, glGenBuffers, (GLsizei n, GLuint *buffers), (n, buffers), PROF_HOOK_NONE) \
+    V(PFNGLGENERATEMIPMAPPROC, glGenerateMipmap, (GLenum target), (target), PROF_HOOK_NONE) \
+    V(PFNGLGENSAMPLERSPROC, glGenSamplers, (GLsizei count, GLuint *samplers), (count, samplers), PROF_HOOK_NONE) \
+    V(PFNGLGENTEXTURESPROC, glGenTextures, (GLsizei n, GLuint *textures), (n, textures), PROF_HOOK_NONE) \
+    V(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays, (GLsizei n, GLuint *arrays), (n, arrays), PROF_HOOK_NONE) \
+    R(PFNGLGETERRORPROC, GLenum, glGetError, (void), (), PROF_HOOK_NONE) \
+    V(PFNGLGETINTEGERVPROC, glGetIntegerv, (GLenum pname, GLint *data), (pname, data), PROF_HOOK_NONE) \
+    V(PFNGLGETQUERYOBJECTUI64VPROC, glGetQueryObjectui64v, (GLuint id, GLenum pname, GLuint64 *params), (id, pname, params), PROF_HOOK_NONE) \
+    V(PFNGLGETQUERYOBJECTUIVPROC, glGetQueryObjectuiv, (GLuint id, GLenum pname, GLuint *params), (id, pname, params), PROF_HOOK_NONE) \
+    R(PFNGLGETUNIFORMLOCATIONPROC, GLint, glGetUniformLocation, (GLuint program, const GLchar *name), (program, name), PROF_HOOK_NONE) \
+    V(PFNGLLINKPROGRAMPROC, glLinkProgram, (GLuint program), (program), PROF_HOOK_NONE) \
+    R(PFNGLMAPBUFFERRANGEPROC, void *, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access), (target, offset, length, access), PROF_HOOK_NONE) \
+    V(PFNGLMULTIDRAWELEMENTSPROC, glMultiDrawElements, (GLenum mode, const GLsizei *count, GLenum type, const void *const*indices, GLsizei drawcount), (mode, count, type, indices, drawcount), PROF_HOOK_MULTIDRAW(prof_multidraw_count(count, drawcount), drawcount)) \
+    V(PFNGLMULTIDRAWELEMENTSBASEVERTEXPROC, glMultiDrawElementsBaseVertex, (GLenum mode, const GLsizei *count, GLenum type, const void *const*indices, GLsizei drawcount, const GLint *basevertex), (mode, count, type, indices, drawcount, basevertex), PROF_HOOK_MULTIDRAW(prof_multidraw_count(count, drawcount), drawcount)) \
+    V(PFNGLPIXELSTOREIPROC, glPixelStorei, (GLenum pname, GLint param), (pname, param), PROF_HOOK_NONE) \
+    V(PFNGLPOLYGONMODEPROC, glPolygonMode, (GLenum face, GLenum mode), (face, mode), PROF_HOOK_NONE) \
+    V(PFNGLQUERYCOUNTERPROC, glQueryCounter, (GLuint id, GLenum target), (id, target), PROF_HOOK_NONE) \
+    V(PFNGLREADPIXELSPROC, glReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels), (x, y, width, height, format, type, pixels), PROF_HOOK_NONE) \
+    V(PFNGLSAMPLERPARAMETERIPROC, glSamplerParameteri, (GLuint sampler, GLenum pname, GLint param), (sampler, pname, param), PROF_HOOK_NONE) \
+    V(PFNGLSHADERSOURCEPROC, glShaderSource, (GLuint shader, GLsizei count, const GLchar *const*string, const GLint *length), (shader, count, string, length), PROF_HOOK_NONE) \
+    V(PFNGLTEXIMAGE2DPROC, glTexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels), (target, level, internalformat, width, height, border, format, type, pixels), PROF_HOOK_TEXTURE(pixels, width, height, format, type)) \
+    V(PFNGLTEXSUBIMAGE2DPROC, glTexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels), (target, level, xoffset, yoffset, width, height, format, type, pixels), PROF_HOOK_TEXTURE(pixels, width, height, format, type)) \
+    V(PFNGLUNIFORM1FPROC, glUniform1f, (GLint location, GLfloat v0), (location, v0), PROF_HOOK_UNIFORM) \
+    V(PFNGLUNIFORM1IPROC, glUniform1i, (GLint location, GLint v0), (location, v0), PROF_HOOK_UNIFORM) \
+    V(PFNGLUNIFORM4FPROC, glUniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (location, v0, v1, v2, v3), PROF_HOOK_UNIFORM) \
+    V(PFNGLUNIFORM4FVPROC, glUniform4fv, (GLint location, GLsizei count, const GLfloat *value), (location, count, value), PROF_HOOK_UNIFORM) \
+    V(PFNGLUNIFORMMATRIX4FVPROC, glUniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value), (location, count, transpose, value), PROF_HOOK_UNIFORM) \
+    R(PFNGLUNMAPBUFFERPROC, GLboolean, glUnmapBuffer, (GLenum target), (target), PROF_HOOK_NONE) \
+    V(PFNGLUSEPROGRAMPROC, glUseProgram, (GLuint program), (program), PROF_HOOK_NONE) \
+    V(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor, (GLuint index, GLuint divisor), (index, divisor), PROF_HOOK_NONE) \
+    V(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer), (index, size, type, normalized, stride, pointer), PROF_HOOK_NONE) \
+    V(PFNGLVIEWPORTPROC, glViewport, (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height), PROF_HOOK_NONE)
+
+/* Funções posteriores ao OpenGL 3.3, carregadas fora da GLAD pelos módulos
+   que as usam e contadas pelos ponteiros de gladProfileWrapProc(). Os
+   índices dos comandos indiretos estão em buffers da GPU e não são somados. */
+typedef void (APIENTRYP PROF_PFNGLDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect);
+typedef void (APIENTRYP PROF_PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+#define GLAD_PROFILE_LOADED_ENTRY_POINTS(V) \
+    V(PROF_PFNGLDRAWELEMENTSINDIRECTPROC, glDrawElementsIndirect, (GLenum mode, GLenum type, const void *indirect), (mode, type, indirect), PROF_HOOK_DRAW(0)) \
+    V(PROF_PFNGLMULTIDRAWELEMENTSINDIRECTPROC, glMultiDrawElementsIndirect, (GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride), (mode, type, indirect, drawcount, stride), PROF_HOOK_MULTIDRAW(0, drawcount))
+
+#define PROF_ENUM_V(type, name, params, args, hook) PROF_##name,
+#define PROF_ENUM_R(type, ret, name, params, args, hook) PROF_##name,
+enum { GLAD_PROFILE_ENTRY_POINTS(PROF_ENUM_V, PROF_ENUM_R) GLAD_PROFILE_LOADED_ENTRY_POINTS(PROF_ENUM_V) PROF_NUM_ENTRY_POINTS };
+
+#define PROF_NAME_V(type, name, params, args, hook) #name,
+#define PROF_NAME_R(type, ret, name, params, args, hook) #name,
+static const char *prof_names[] = { GLAD_PROFILE_ENTRY_POINTS(PROF_NAME_V, PROF_NAME_R) GLAD_PROFILE_LOADED_ENTRY_POINTS(PROF_NAME_V) NULL };
+
+#define PROF_REAL_V(type, name, params, args, hook) static type prof_real_##name = NULL;
+#define PROF_REAL_R(type, ret, name, params, args, hook) static type prof_real_##name = NULL;
+GLAD_PROFILE_ENTRY_POINTS(PROF_REAL_V, PROF_REAL_R)
+GLAD_PROFILE_LOADED_ENTRY_POINTS(PROF_REAL_V)
+
+#define PROF_WRAP_V(type, name, params, args, hook) \
+    static void APIENTRY prof_##name params { \
+        if(!prof_skip_thread) { \
+            prof_current.calls[PROF_##name] += 1; \
+            prof_current.total_calls += 1; \
+            hook; \
+        } \
+        prof_real_##name args; \
+    }
+#define PROF_WRAP_R(type, ret, name, params, args, hook) \
+    static ret APIENTRY prof_##name params { \
+        if(!prof_skip_thread) { \
+            prof_current.calls[PROF_##name] += 1; \
+            prof_current.total_calls += 1; \
+            hook; \
+        } \
+        return prof_real_##name args; \
+    }
+GLAD_PROFILE_ENTRY_POINTS(PROF_WRAP_V, PROF_WRAP_R)
+
+/* Os ponteiros de gladProfileWrapProc() ficam sempre instalados: só contam
+   com a instrumentação ligada. */
+#define PROF_WRAP_LOADED_V(type, name, params, args, hook) \
+    static void APIENTRY prof_##name params { \
+        if(prof_enabled && !prof_skip_thread) { \
+            prof_current.calls[PROF_##name] += 1; \
+            prof_current.total_calls += 1; \
+            hook; \
+        } \
+        prof_real_##name args; \
+    }
+GLAD_PROFILE_LOADED_ENTRY_POINTS(PROF_WRAP_LOADED_V)
+
+#define PROF_INSTALL_V(type, name, params, args, hook) \
+    prof_real_##name = glad_##name; \
+    if(prof_real_##name != NULL) glad_##name = prof_##name;
+#define PROF_INSTALL_R(type, ret, name, params, args, hook) \
+    prof_real_##name = glad_##name; \
+    if(prof_real_##name != NULL) glad_##name = prof_##name;
+
+#define PROF_RESTORE_V(type, name, params, args, hook) \
+    if(prof_real_##name != NULL) glad_##name = prof_real_##name;
+#define PROF_RESTORE_R(type, ret, name, params, args, hook) \
+    if(prof_real_##name != NULL) glad_##name = prof_real_##name;
+
+typedef char prof_check_entry_points[(PROF_NUM_ENTRY_POINTS <= GLAD_PROFILE_MAX_ENTRY_POINTS) ? 1 : -1];
+
+void gladProfileSetEnabled(int enabled) {
+    enabled = enabled ? 1 : 0;
+    if(enabled == prof_enabled) return;
+
+    if(enabled) {
+        if(prof_history == NULL) {
+            prof_history = (gladProfileFrame *)calloc(GLAD_PROFILE_HISTORY, sizeof(gladProfileFrame));
+            if(prof_history == NULL) return;
+        }
+        if(!prof_installed) {
+            GLAD_PROFILE_ENTRY_POINTS(PROF_INSTALL_V, PROF_INSTALL_R)
+            prof_installed = 1;
+        }
+        memset(&prof_current, 0, sizeof(prof_current));
+        prof_current.frame = prof_frame_index;
+    } else if(prof_installed) {
+        GLAD_PROFILE_ENTRY_POINTS(PROF_RESTORE_V, PROF_RESTORE_R)
+        prof_installed = 0;
+    }
+    prof_enabled = enabled;
+}
+
+int gladProfileIsEnabled(void) {
+    return prof_enabled;
+}
+
+#define PROF_LOOKUP_V(type, entry, params, args, hook) \
+    if(strcmp(name, #entry) == 0) { \
+        prof_real_##entry = (type)proc; \
+        return (void *)prof_##entry; \
+    }
+
+void *gladProfileWrapProc(const char *name, void *proc) {
+    if(proc == NULL) return NULL;
+    GLAD_PROFILE_LOADED_ENTRY_POINTS(PROF_LOOKUP_V)
+    return proc;
+}
+
+void gladProfileBeginFrame(void) {
+    if(!prof_enabled) return;
+    memset(&prof_current, 0, sizeof(prof_current));
+    prof_current.frame = prof_frame_index;
+}
+
+void gladProfileEndFrame(void) {
+    if(prof_enabled) {
+        prof_history[prof_recorded % GLAD_PROFILE_HISTORY] = prof_current;
+        prof_recorded += 1;
+    }
+    prof_frame_index += 1;
+}
+
+void gladProfileSkipThread(void) {
+    prof_skip_thread = 1;
+}
+
+int gladProfileNumEntryPoints(void) {
+    return PROF_NUM_ENTRY_POINTS;
+}
+
+const char* gladProfileEntryPointName(int index) {
+    if(index < 0 || index >= PROF_NUM_ENTRY_POINTS) return NULL;
+    return prof_names[index];
+}
+
+const gladProfileFrame* gladProfileLastFrame(void) {
+    if(prof_recorded == 0) return NULL;
+    return &prof_history[(prof_recorded - 1) % GLAD_PROFILE_HISTORY];
+}
+
+int gladProfileFormatSummary(char *buffer, size_t size) {
+    const gladProfileFrame *f = gladProfileLastFrame();
+    int i, top = -1;
+    if(buffer == NULL || size == 0) return 0;
+    if(f == NULL) return snprintf(buffer, size, "GL: sem dados");
+    for(i = 0; i < PROF_NUM_ENTRY_POINTS; i++) {
+        if(top < 0 || f->calls[i] > f->calls[top]) top = i;
+    }
+    return snprintf(buffer, size, "GL: %lu chamadas, %lu draws (%llu indices), %lu uniforms, %llu B buffers, %llu B texturas, mais chamada: %s (%lu)",
+        f->total_calls, f->draw_calls, f->draw_indices, f->uniform_calls,
+        f->buffer_bytes, f->texture_bytes, prof_names[top], f->calls[top]);
+}
+
+/* Primeiro quadro guardado no histórico (o histórico é circular). */
+static unsigned long prof_first_recorded(void) {
+    return (prof_recorded > GLAD_PROFILE_HISTORY) ? prof_recorded - GLAD_PROFILE_HISTORY : 0;
+}
+
+int gladProfileWriteCSV(const char *filename) {
+    FILE *file;
+    unsigned long n;
+    int i;
+
+    if(prof_recorded == 0) return 0;
+    file = fopen(filename, "w");
+    if(file == NULL) return 0;
+
+    fprintf(file, "frame,total_calls,draw_calls,draw_indices,uniform_calls,buffer_bytes,texture_bytes");
+    for(i = 0; i < PROF_NUM_ENTRY_POINTS; i++) fprintf(file, ",%s", prof_names[i]);
+    fprintf(file, "\n");
+
+    for(n = prof_first_recorded(); n < prof_recorded; n++) {
+        const gladProfileFrame *f = &prof_history[n % GLAD_PROFILE_HISTORY];
+        fprintf(file, "%lu,%lu,%lu,%llu,%lu,%llu,%llu", f->frame, f->total_calls, f->draw_calls,
+            f->draw_indices, f->uniform_calls, f->buffer_bytes, f->texture_bytes);
+        for(i = 0; i < PROF_NUM_ENTRY_POINTS; i++) fprintf(file, ",%lu", f->calls[i]);
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return 1;
+}
+
+int gladProfileWriteJSON(const char *filename) {
+    FILE *file;
+    unsigned long n;
+    int i, first;
+
+    if(prof_recorded == 0) return 0;
+    file = fopen(filename, "w");
+    if(file == NULL) return 0;
+
+    fprintf(file, "{\n  \"frames\": [\n");
+    for(n = prof_first_recorded(); n < prof_recorded; n++) {
+        const gladProfileFrame *f = &prof_history[n % GLAD_PROFILE_HISTORY];
+        fprintf(file, "    {\"frame\": %lu, \"total_calls\": %lu, \"draw_calls\": %lu, \"draw_indices\": %llu, "
+            "\"uniform_calls\": %lu, \"buffer_bytes\": %llu, \"texture_bytes\": %llu, \"calls\": {",
+            f->frame, f->total_calls, f->draw_calls, f->draw_indices, f->uniform_calls,
+            f->buffer_bytes, f->texture_bytes);
+        first = 1;
+        for(i = 0; i < PROF_NUM_ENTRY_POINTS; i++) {
+            if(f->calls[i] == 0) continue;
+            fprintf(file, "%s\"%s\": %lu", first ? "" : ", ", prof_names[i], f->calls[i]);
+            first = 0;
+        }
+        fprintf(file, "}}%s\n", (n + 1 < prof_recorded) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    fclose(file);
+    return 1;
+}
+
+#endif /* GLAD_PROFILE */
@@ -0,0 +1,377 @@
+// Cache do estado do OpenGL na CPU. Veja comentários em "include/glstate.h".
+#include <map>
+#include <vector>
+#include <cstring>
+
+#include "glstate.h"
+
+#define GLSTATE_MAX_TEXTURE_UNITS 32
+
+// Valor usado para indicar que não sabemos qual o estado atual do OpenGL. Como
+// nenhum nome de objeto ou enum válido tem este valor, a próxima chamada
+// sempre é repassada para o driver.
+#define GLSTATE_UNKNOWN 0xFFFFFFFFu
+
+// Valor guardado para um uniform. "type" igual a 0 indica valor desconhecido.
+struct UniformValue
+{
+    GLenum  type;
+    GLint   i;
+    GLfloat f[16];
+};
+
+struct ShadowState
+{
+    GLuint program;
+    GLuint vao;
+    GLuint array_buffer;
+    GLuint element_array_buffer; // Faz parte do estado do VAO!
+    GLenum active_texture;
+    GLuint texture_2d[GLSTATE_MAX_TEXTURE_UNITS];
+    GLuint sampler[GLSTATE_MAX_TEXTURE_UNITS];
+
+    GLuint blend;      // GL_TRUE, GL_FALSE ou GLSTATE_UNKNOWN
+    GLuint depth_test;
+    GLuint cull_face;
+    GLenum blend_src, blend_dst;
+    GLenum depth_func;
+    GLenum cull_face_mode;
+    GLenum front_face;
+    GLenum polygon_mode;
+    GLfloat clear_color[4];
+    bool    clear_color_known;
+};
+
+static bool         g_GLStateEnabled = true;
+static ShadowState  g_Shadow;
+static GLStateStats g_GLStateStats = { 0, 0 };
+
+// Valores dos uniforms de cada programa, indexados pela "location".
+static std::map<GLuint, std::vector<UniformValue> > g_ProgramUniforms;
+static std::vector<UniformValue>* g_CurrentUniforms = NULL;
+
+static void InvalidateShadow()
+{
+    g_Shadow.program              = GLSTATE_UNKNOWN;
+    g_Shadow.vao                  = GLSTATE_UNKNOWN;
+    g_Shadow.array_buffer         = GLSTATE_UNKNOWN;
+    g_Shadow.element_array_buffer = GLSTATE_UNKNOWN;
+    g_Shadow.active_texture       = GLSTATE_UNKNOWN;
+    for (int i = 0; i < GLSTATE_MAX_TEXTURE_UNITS; ++i)
+    {
+        g_Shadow.texture_2d[i] = GLSTATE_UNKNOWN;
+        g_Shadow.sampler[i]    = GLSTATE_UNKNOWN;
+    }
+    g_Shadow.blend             = GLSTATE_UNKNOWN;
+    g_Shadow.depth_test        = GLSTATE_UNKNOWN;
+    g_Shadow.cull_face         = GLSTATE_UNKNOWN;
+    g_Shadow.blend_src         = GLSTATE_UNKNOWN;
+    g_Shadow.blend_dst         = GLSTATE_UNKNOWN;
+    g_Shadow.depth_func        = GLSTATE_UNKNOWN;
+    g_Shadow.cull_face_mode    = GLSTATE_UNKNOWN;
+    g_Shadow.front_face        = GLSTATE_UNKNOWN;
+    g_Shadow.polygon_mode      = GLSTATE_UNKNOWN;
+    g_Shadow.clear_color_known = false;
+
+    g_ProgramUniforms.clear();
+    g_CurrentUniforms = NULL;
+}
+
+// Inicializa o estado como "desconhecido" antes de main() ser executada.
+static struct GLStateInit { GLStateInit() { InvalidateShadow(); } } g_GLStateInit;
+
+// Retorna true se a chamada deve ser repassada para o OpenGL, atualizando os
+// contadores. "changed" indica se o valor pedido difere do valor guardado.
+static inline bool Forward(bool changed)
+{
+    if (!g_GLStateEnabled || changed)
+    {
+        g_GLStateStats.forwarded += 1;
+        return true;
+    }
+    g_GLStateStats.filtered += 1;
+    return false;
+}
+
+void GLState_SetEnabled(bool enabled)
+{
+    if (enabled && !g_GLStateEnabled)
+        InvalidateShadow();
+    g_GLStateEnabled = enabled;
+}
+
+bool GLState_IsEnabled()
+{
+    return g_GLStateEnabled;
+}
+
+void GLState_Invalidate()
+{
+    InvalidateShadow();
+}
+
+GLStateStats GLState_GetStats()
+{
+    return g_GLStateStats;
+}
+
+void GLState_ResetStats()
+{
+    g_GLStateStats.filtered = 0;
+    g_GLStateStats.forwarded = 0;
+}
+
+void GLState_UseProgram(GLuint program)
+{
+    if (Forward(g_Shadow.program != program))
+        glUseProgram(program);
+
+    g_Shadow.program = program;
+    g_CurrentUniforms = (program != 0) ? &g_ProgramUniforms[program] : NULL;
+}
+
+void GLState_DeleteProgram(GLuint program)
+{
+    // O nome do programa pode ser reutilizado pelo driver; esquecemos os
+    // valores de uniforms guardados para ele.
+    g_ProgramUniforms.erase(program);
+    if (g_Shadow.program == program)
+    {
+        g_Shadow.program = GLSTATE_UNKNOWN;
+        g_CurrentUniforms = NULL;
+    }
+    g_GLStateStats.forwarded += 1;
+    glDeleteProgram(program);
+}
+
+void GLState_BindVertexArray(GLuint vao)
+{
+    if (Forward(g_Shadow.vao != vao))
+    {
+        glBindVertexArray(vao);
+        // O GL_ELEMENT_ARRAY_BUFFER é armazenado dentro do VAO.
+        g_Shadow.element_array_buffer = GLSTATE_UNKNOWN;
+    }
+    g_Shadow.vao = vao;
+}
+
+void GLState_BindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* shadow = NULL;
+    if (target == GL_ARRAY_BUFFER)
+        shadow = &g_Shadow.array_buffer;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+        shadow = &g_Shadow.element_array_buffer;
+
+    if (Forward(shadow == NULL || *shadow != buffer))
+        glBindBuffer(target, buffer);
+
+    if (shadow != NULL)
+        *shadow = buffer;
+}
+
+void GLState_ActiveTexture(GLenum texture)
+{
+    if (Forward(g_Shadow.active_texture != texture))
+        glActiveTexture(texture);
+    g_Shadow.active_texture = texture;
+}
+
+void GLState_BindTexture(GLenum target, GLuint texture)
+{
+    GLuint unit = g_Shadow.active_texture - GL_TEXTURE0;
+    bool tracked = target == GL_TEXTURE_2D
+                && g_Shadow.active_texture != GLSTATE_UNKNOWN
+                && unit < GLSTATE_MAX_TEXTURE_UNITS;
+
+    if (Forward(!tracked || g_Shadow.texture_2d[unit] != texture))
+        glBindTexture(target, texture);
+
+    if (tracked)
+        g_Shadow.texture_2d[unit] = texture;
+}
+
+void GLState_BindSampler(GLuint unit, GLuint sampler)
+{
+    bool tracked = unit < GLSTATE_MAX_TEXTURE_UNITS;
+
+    if (Forward(!tracked || g_Shadow.sampler[unit] != sampler))
+        glBindSampler(unit, sampler);
+
+    if (tracked)
+        g_Shadow.sampler[unit] = sampler;
+}
+
+void GLState_DeleteVertexArray(GLuint vao)
+{
+    if (g_Shadow.vao == vao)
+    {
+        g_Shadow.vao = 0;
+        g_Shadow.element_array_buffer = GLSTATE_UNKNOWN;
+    }
+    g_GLStateStats.forwarded += 1;
+    glDeleteVertexArrays(1, &vao);
+}
+
+void GLState_DeleteBuffer(GLuint buffer)
+{
+    // Um GL_ELEMENT_ARRAY_BUFFER pode estar ligado a outros VAOs além do
+    // atual; apagá-lo só o desliga do VAO atual.
+    if (g_Shadow.array_buffer == buffer)
+        g_Shadow.array_buffer = 0;
+    if (g_Shadow.element_array_buffer == buffer)
+        g_Shadow.element_array_buffer = 0;
+    g_GLStateStats.forwarded += 1;
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLState_DeleteTexture(GLuint texture)
+{
+    for (int i = 0; i < GLSTATE_MAX_TEXTURE_UNITS; ++i)
+        if (g_Shadow.texture_2d[i] == texture)
+            g_Shadow.texture_2d[i] = 0;
+    g_GLStateStats.forwarded += 1;
+    glDeleteTextures(1, &texture);
+}
+
+static GLuint* CapabilityShadow(GLenum cap)
+{
+    switch (cap)
+    {
+        case GL_BLEND:      return &g_Shadow.blend;
+        case GL_DEPTH_TEST: return &g_Shadow.depth_test;
+        case GL_CULL_FACE:  return &g_Shadow.cull_face;
+        default:            return NULL;
+    }
+}
+
+void GLState_Enable(GLenum cap)
+{
+    GLuint* shadow = CapabilityShadow(cap);
+    if (Forward(shadow == NULL || *shadow != GL_TRUE))
+        glEnable(cap);
+    if (shadow != NULL)
+        *shadow = GL_TRUE;
+}
+
+void GLState_Disable(GLenum cap)
+{
+    GLuint* shadow = CapabilityShadow(cap);
+    if (Forward(shadow == NULL || *shadow != GL_FALSE))
+        glDisable(cap);
+    if (shadow != NULL)
+        *shadow = GL_FALSE;
+}
+
+void GLState_BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    if (Forward(g_Shadow.blend_src != sfactor || g_Shadow.blend_dst != dfactor))
+        glBlendFunc(sfactor, dfactor);
+    g_Shadow.blend_src = sfactor;
+    g_Shadow.blend_dst = dfactor;
+}
+
+void GLState_DepthFunc(GLenum func)
+{
+    if (Forward(g_Shadow.depth_func != func))
+        glDepthFunc(func);
+    g_Shadow.depth_func = func;
+}
+
+void GLState_CullFace(GLenum mode)
+{
+    if (Forward(g_Shadow.cull_face_mode != mode))
+        glCullFace(mode);
+    g_Shadow.cull_face_mode = mode;
+}
+
+void GLState_FrontFace(GLenum mode)
+{
+    if (Forward(g_Shadow.front_face != mode))
+        glFrontFace(mode);
+    g_Shadow.front_face = mode;
+}
+
+void GLState_PolygonMode(GLenum face, GLenum mode)
+{
+    // Em um contexto "core" só existe GL_FRONT_AND_BACK.
+    bool tracked = (face == GL_FRONT_AND_BACK);
+    if (Forward(!tracked || g_Shadow.polygon_mode != mode))
+        glPolygonMode(face, mode);
+    g_Shadow.polygon_mode = tracked ? mode : GLSTATE_UNKNOWN;
+}
+
+void GLState_ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    const GLfloat* c = g_Shadow.clear_color;
+    bool changed = !g_Shadow.clear_color_known || c[0] != r || c[1] != g || c[2] != b || c[3] != a;
+    if (Forward(changed))
+        glClearColor(r, g, b, a);
+
+    g_Shadow.clear_color[0] = r;
+    g_Shadow.clear_color[1] = g;
+    g_Shadow.clear_color[2] = b;
+    g_Shadow.clear_color[3] = a;
+    g_Shadow.clear_color_known = true;
+}
+
+// Retorna o valor guardado para o uniform "location" do programa atual, ou
+// NULL caso não seja possível guardá-lo (programa desconhecido, location -1).
+static UniformValue* CurrentUniform(GLint location)
+{
+    if (g_CurrentUniforms == NULL || location < 0)
+        return NULL;
+
+    if ((size_t)location >= g_CurrentUniforms->size())
+    {
+        UniformValue unknown;
+        memset(&unknown, 0, sizeof(unknown));
+        g_CurrentUniforms->resize(location + 1, unknown);
+    }
+    return &(*g_CurrentUniforms)[location];
+}
+
+void GLState_Uniform1i(GLint location, GLint v0)
+{
+    UniformValue* u = CurrentUniform(location);
+    if (Forward(u == NULL || u->type != GL_INT || u->i != v0))
+        glUniform1i(location, v0);
+    if (u != NULL)
+    {
+        u->type = GL_INT;
+        u->i = v0;
+    }
+}
+
+void GLState_Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    UniformValue* u = CurrentUniform(location);
+    const GLfloat v[4] = { v0, v1, v2, v3 };
+    if (Forward(u == NULL || u->type != GL_FLOAT_VEC4 || memcmp(u->f, v, sizeof(v)) != 0))
+        glUniform4f(location, v0, v1, v2, v3);
+    if (u != NULL)
+    {
+        u->type = GL_FLOAT_VEC4;
+        memcpy(u->f, v, sizeof(v));
+    }
+}
+
+void GLState_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    // Somente matrizes individuais (count == 1) e não transpostas são
+    // guardadas; os demais casos são sempre repassados.
+    UniformValue* u = (count == 1 && transpose == GL_FALSE) ? CurrentUniform(location) : NULL;
+    if (Forward(u == NULL || u->type != GL_FLOAT_MAT4 || memcmp(u->f, value, 16*sizeof(GLfloat)) != 0))
+        glUniformMatrix4fv(location, count, transpose, value);
+    if (u != NULL)
+    {
+        u->type = GL_FLOAT_MAT4;
+        memcpy(u->f, value, 16*sizeof(GLfloat));
+    }
+    else if (count != 1 || transpose != GL_FALSE)
+    {
+        UniformValue* stale = CurrentUniform(location);
+        if (stale != NULL)
+            stale->type = 0;
+    }
+}
@@ -0,0 +1,486 @@
+// Teste de regressão visual e de tempo de quadro. Veja comentários em "include/golden.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h> // Somente as constantes GLFW_KEY_*
+
+#include <stb_image.h>
+
+#include "golden.h"
+#include "bench.h"
+#include "replay.h"
+
+#define GOLDEN_WALK_FRAMES 180 // Quadros de caminhada entre as vistas do corredor
+
+struct GoldenShot
+{
+    std::string  name;
+    unsigned int capture_frame; // Quadro (contando de zero) em que a imagem é capturada
+    std::vector<float> ms;      // Tempos dos GOLDEN_MEASURE_FRAMES quadros finais
+    bool         captured;
+    bool         passed;
+    bool         has_golden;
+    long         bad_pixels;
+    int          max_diff;
+    double       ssim;
+    double       baseline_ms;   // Tempo de referência (ou negativo, se não houver)
+};
+
+static bool        g_GoldenEnabled = false;
+static bool        g_GoldenUpdate = false;
+static const char* g_GoldenDir = NULL;
+static int         g_GoldenTolerance = 8;
+static double      g_GoldenMaxRegression = 0.25;
+static int         g_GoldenWidth = 0;
+static int         g_GoldenHeight = 0;
+
+static std::vector<GoldenShot> g_Shots;
+static unsigned int            g_GoldenFrame = 0;
+
+bool Golden_ParseArg(int argc, char* argv[], int* i)
+{
+    const char* arg = argv[*i];
+    if (strcmp(arg, "--golden") == 0 && *i + 1 < argc)
+    {
+        g_GoldenEnabled = true;
+        g_GoldenDir = argv[++*i];
+    }
+    else if (strcmp(arg, "--golden-update") == 0)
+        g_GoldenUpdate = true;
+    else if (strcmp(arg, "--golden-tolerance") == 0 && *i + 1 < argc)
+    {
+        g_GoldenTolerance = atoi(argv[++*i]);
+        if (g_GoldenTolerance < 0 || g_GoldenTolerance > 255)
+        {
+            fprintf(stderr, "ERROR: invalid --golden-tolerance \"%s\" (expected 0 to 255).\n", argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else if (strcmp(arg, "--golden-max-regression") == 0 && *i + 1 < argc)
+    {
+        g_GoldenMaxRegression = atof(argv[++*i]);
+        if (!(g_GoldenMaxRegression >= 0.0))
+        {
+            fprintf(stderr, "ERROR: invalid --golden-max-regression \"%s\".\n", argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else
+        return false;
+    return true;
+}
+
+bool Golden_IsEnabled()
+{
+    return g_GoldenEnabled;
+}
+
+static std::string GoldenPath(const std::string& name, const char* suffix)
+{
+    return std::string(g_GoldenDir) + "/" + name + suffix;
+}
+
+// Mediana dos tempos de quadro da vista; menos sensível que a média a
+// quadros isolados atrasados pelo sistema operacional.
+static double MedianMs(const GoldenShot& shot)
+{
+    if (shot.ms.empty())
+        return 0.0;
+    std::vector<float> sorted = shot.ms;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size()/2];
+}
+
+// Vista mantida nos próximos GOLDEN_SHOT_FRAMES quadros, a partir de *frame.
+static void AddShot(const char* name, unsigned int* frame)
+{
+    GoldenShot shot;
+    shot.name          = name;
+    shot.capture_frame = *frame + GOLDEN_SHOT_FRAMES - 1;
+    shot.captured      = false;
+    shot.passed        = false;
+    shot.has_golden    = false;
+    shot.bad_pixels    = 0;
+    shot.max_diff      = 0;
+    shot.ssim          = 0.0;
+    shot.baseline_ms   = -1.0;
+    g_Shots.push_back(shot);
+    *frame += GOLDEN_SHOT_FRAMES;
+}
+
+static void AddKey(std::vector<ReplayEvent>& events, unsigned int frame, int key, int action)
+{
+    ReplayEvent e;
+    memset(&e, 0, sizeof(e));
+    e.frame  = frame;
+    e.type   = REPLAY_KEY;
+    e.key    = key;
+    e.action = action;
+    events.push_back(e);
+}
+
+// Lê "tempos.txt": uma linha "nome milissegundos" por vista.
+static void LoadBaselineTimes()
+{
+    std::string path = GoldenPath("tempos", ".txt");
+    FILE* f = fopen(path.c_str(), "r");
+    if (f == NULL)
+        return;
+
+    char name[32];
+    double ms;
+    while (fscanf(f, "%31s %lf", name, &ms) == 2)
+        for (size_t i = 0; i < g_Shots.size(); ++i)
+            if (g_Shots[i].name == name)
+                g_Shots[i].baseline_ms = ms;
+    fclose(f);
+}
+
+void Golden_Start(int width, int height)
+{
+    if (Replay_IsPlaying())
+    {
+        fprintf(stderr, "ERROR: --golden and --replay cannot be used together.\n");
+        std::exit(EXIT_FAILURE);
+    }
+    g_GoldenWidth  = width;
+    g_GoldenHeight = height;
+
+    std::vector<ReplayEvent> events;
+    unsigned int f = BENCH_WARMUP_FRAMES;
+
+    // Vistas gerais do corredor, com a FREE_CAMERA
+    AddShot("corredor_entrada", &f);
+    AddKey(events, f, GLFW_KEY_W, GLFW_PRESS);
+    f += GOLDEN_WALK_FRAMES;
+    AddKey(events, f, GLFW_KEY_W, GLFW_RELEASE);
+    AddShot("corredor_meio", &f);
+    AddKey(events, f, GLFW_KEY_W, GLFW_PRESS);
+    f += GOLDEN_WALK_FRAMES;
+    AddKey(events, f, GLFW_KEY_W, GLFW_RELEASE);
+    AddKey(events, f, GLFW_KEY_D, GLFW_PRESS);
+    f += 60;
+    AddKey(events, f, GLFW_KEY_D, GLFW_RELEASE);
+    AddShot("corredor_fim", &f);
+
+    // Um estande por vez, com a LOOK_AT_CAMERA
+    AddKey(events, f, GLFW_KEY_ENTER, GLFW_PRESS);
+    for (int stand = 0; stand < 18; ++stand)
+    {
+        if (stand > 0)
+            AddKey(events, f, GLFW_KEY_RIGHT, GLFW_PRESS);
+        char name[16];
+        snprintf(name, sizeof(name), "estande_%02d", stand + 1);
+        AddShot(name, &f);
+    }
+
+    Replay_SetEvents(&events[0], (int)events.size(), f);
+    g_GoldenFrame = 0;
+    if (!g_GoldenUpdate)
+        LoadBaselineTimes();
+}
+
+// Escreve uma imagem RGB em PNG. As linhas de "rgb" estão na ordem do
+// OpenGL (de baixo para cima). Os dados são guardados sem compressão (blocos
+// "stored" do deflate), o que dispensa uma biblioteca de compressão.
+static uint32_t g_CrcTable[256];
+
+static uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size)
+{
+    if (g_CrcTable[1] == 0)
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            g_CrcTable[n] = c;
+        }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = g_CrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutU32BE(std::vector<unsigned char>& out, uint32_t v)
+{
+    out.push_back((unsigned char)(v >> 24));
+    out.push_back((unsigned char)(v >> 16));
+    out.push_back((unsigned char)(v >> 8));
+    out.push_back((unsigned char)v);
+}
+
+static void PutChunk(FILE* f, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    PutU32BE(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PutU32BE(chunk, Crc32(0, &chunk[4], chunk.size() - 4));
+    fwrite(&chunk[0], 1, chunk.size(), f);
+}
+
+static bool WritePNG(const std::string& path, int width, int height, const unsigned char* rgb)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", path.c_str());
+        return false;
+    }
+
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<unsigned char> header;
+    PutU32BE(header, width);
+    PutU32BE(header, height);
+    header.push_back(8); // Bits por canal
+    header.push_back(2); // RGB
+    header.push_back(0); // Deflate
+    header.push_back(0); // Filtros adaptativos (usamos somente "nenhum")
+    header.push_back(0); // Sem entrelaçamento
+    PutChunk(f, "IHDR", header);
+
+    // Linhas de cima para baixo, cada uma precedida pelo tipo de filtro.
+    size_t row_size = (size_t)width*3;
+    std::vector<unsigned char> raw;
+    raw.reserve((row_size + 1)*height);
+    for (int y = height - 1; y >= 0; --y)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y*row_size, rgb + (y + 1)*row_size);
+    }
+
+    // Fluxo zlib com blocos "stored" de até 65535 bytes.
+    std::vector<unsigned char> zlib;
+    zlib.reserve(raw.size() + raw.size()/65535*5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    size_t pos = 0;
+    for (;;)
+    {
+        size_t len = raw.size() - pos;
+        if (len > 65535)
+            len = 65535;
+        bool last = (pos + len == raw.size());
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((unsigned char)len);
+        zlib.push_back((unsigned char)(len >> 8));
+        zlib.push_back((unsigned char)~len);
+        zlib.push_back((unsigned char)(~len >> 8));
+        for (size_t i = pos; i < pos + len; ++i)
+        {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+        if (last)
+            break;
+    }
+    PutU32BE(zlib, (b << 16) | a); // Adler-32
+    PutChunk(f, "IDAT", zlib);
+    PutChunk(f, "IEND", std::vector<unsigned char>());
+
+    bool ok = !ferror(f);
+    fclose(f);
+    if (!ok)
+        fprintf(stderr, "ERROR: Cannot write file \"%s\".\n", path.c_str());
+    return ok;
+}
+
+static inline float Luma(const unsigned char* p)
+{
+    return 0.299f*p[0] + 0.587f*p[1] + 0.114f*p[2];
+}
+
+// SSIM médio da luminância, em janelas de 8x8 pixels sem sobreposição.
+static double MeanSSIM(const unsigned char* a, const unsigned char* b, int width, int height)
+{
+    const double C1 = (0.01*255)*(0.01*255);
+    const double C2 = (0.03*255)*(0.03*255);
+
+    double sum = 0.0;
+    int windows = 0;
+    for (int wy = 0; wy + 8 <= height; wy += 8)
+        for (int wx = 0; wx + 8 <= width; wx += 8)
+        {
+            double ma = 0.0, mb = 0.0, va = 0.0, vb = 0.0, cov = 0.0;
+            for (int y = wy; y < wy + 8; ++y)
+                for (int x = wx; x < wx + 8; ++x)
+                {
+                    double la = Luma(a + (y*width + x)*3);
+                    double lb = Luma(b + (y*width + x)*3);
+                    ma += la;  mb += lb;
+                    va += la*la;  vb += lb*lb;  cov += la*lb;
+                }
+            ma /= 64;  mb /= 64;
+            va = va/64 - ma*ma;
+            vb = vb/64 - mb*mb;
+            cov = cov/64 - ma*mb;
+            sum += ((2*ma*mb + C1)*(2*cov + C2)) / ((ma*ma + mb*mb + C1)*(va + vb + C2));
+            windows += 1;
+        }
+    return windows > 0 ? sum / windows : 1.0;
+}
+
+// Compara a captura com a referência, preenchendo os campos da vista.
+static void CompareShot(GoldenShot& shot, const std::vector<unsigned char>& image)
+{
+    std::string path = GoldenPath(shot.name, ".png");
+
+    // Imagens na ordem do OpenGL, como a captura (veja WritePNG()).
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, channels;
+    unsigned char* golden = stbi_load(path.c_str(), &width, &height, &channels, 3);
+    if (golden == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open golden image \"%s\" (run with --golden-update).\n", path.c_str());
+        shot.passed = false;
+        return;
+    }
+    shot.has_golden = true;
+
+    if (width != g_GoldenWidth || height != g_GoldenHeight)
+    {
+        fprintf(stderr, "ERROR: golden image \"%s\" is %dx%d, expected %dx%d.\n", path.c_str(), width, height, g_GoldenWidth, g_GoldenHeight);
+        stbi_image_free(golden);
+        shot.passed = false;
+        return;
+    }
+
+    // Mapa das diferenças: pixels fora da tolerância em vermelho sobre a
+    // referência escurecida.
+    std::vector<unsigned char> diff(image.size());
+    long num_pixels = (long)width*height;
+    for (long i = 0; i < num_pixels; ++i)
+    {
+        int d = 0;
+        for (int c = 0; c < 3; ++c)
+        {
+            int dc = abs((int)image[i*3 + c] - (int)golden[i*3 + c]);
+            if (dc > d)
+                d = dc;
+        }
+        if (d > shot.max_diff)
+            shot.max_diff = d;
+
+        if (d > g_GoldenTolerance)
+        {
+            shot.bad_pixels += 1;
+            diff[i*3 + 0] = 255;
+            diff[i*3 + 1] = 0;
+            diff[i*3 + 2] = 0;
+        }
+        else
+        {
+            unsigned char l = (unsigned char)(Luma(golden + i*3) / 3);
+            diff[i*3 + 0] = diff[i*3 + 1] = diff[i*3 + 2] = l;
+        }
+    }
+    shot.ssim = MeanSSIM(&image[0], golden, width, height);
+    stbi_image_free(golden);
+
+    shot.passed = shot.bad_pixels <= GOLDEN_MAX_BAD_PIXELS*num_pixels && shot.ssim >= GOLDEN_MIN_SSIM;
+    if (!shot.passed)
+    {
+        fprintf(stderr, "ERROR: \"%s\" differs from the golden image: %ld pixels over tolerance, SSIM %.4f.\n",
+                shot.name.c_str(), shot.bad_pixels, shot.ssim);
+        WritePNG(GoldenPath(shot.name, "_atual.png"), width, height, &image[0]);
+        WritePNG(GoldenPath(shot.name, "_diff.png"), width, height, &diff[0]);
+    }
+}
+
+void Golden_EndFrame(double frame_ms)
+{
+    unsigned int frame = g_GoldenFrame++;
+    for (size_t i = 0; i < g_Shots.size(); ++i)
+    {
+        GoldenShot& shot = g_Shots[i];
+        if (frame + GOLDEN_MEASURE_FRAMES > shot.capture_frame && frame <= shot.capture_frame)
+        {
+            shot.ms.push_back((float)frame_ms);
+        }
+        if (frame != shot.capture_frame)
+            continue;
+
+        std::vector<unsigned char> image((size_t)g_GoldenWidth*g_GoldenHeight*3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, g_GoldenWidth, g_GoldenHeight, GL_RGB, GL_UNSIGNED_BYTE, &image[0]);
+        shot.captured = true;
+
+        if (g_GoldenUpdate)
+            shot.passed = WritePNG(GoldenPath(shot.name, ".png"), g_GoldenWidth, g_GoldenHeight, &image[0]);
+        else
+            CompareShot(shot, image);
+    }
+}
+
+bool Golden_Finish()
+{
+    int failures = 0;
+    for (size_t i = 0; i < g_Shots.size(); ++i)
+    {
+        GoldenShot& shot = g_Shots[i];
+        double ms = MedianMs(shot);
+        if (!shot.captured)
+            shot.passed = false;
+        if (!g_GoldenUpdate && shot.baseline_ms > 0.0 && ms > shot.baseline_ms*(1.0 + g_GoldenMaxRegression))
+        {
+            fprintf(stderr, "ERROR: frame time of \"%s\" regressed: %.3f ms (reference %.3f ms).\n", shot.name.c_str(), ms, shot.baseline_ms);
+            shot.passed = false;
+        }
+        if (!shot.passed)
+            failures += 1;
+    }
+
+    if (g_GoldenUpdate)
+    {
+        std::string path = GoldenPath("tempos", ".txt");
+        FILE* f = fopen(path.c_str(), "w");
+        if (f == NULL)
+        {
+            fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", path.c_str());
+            return false;
+        }
+        for (size_t i = 0; i < g_Shots.size(); ++i)
+            fprintf(f, "%s %.4f\n", g_Shots[i].name.c_str(), MedianMs(g_Shots[i]));
+        fclose(f);
+    }
+
+    FILE* f = fopen("golden.json", "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"golden.json\".\n");
+        return false;
+    }
+    fprintf(f, "{\n  \"mode\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n", g_GoldenUpdate ? "update" : "compare", g_GoldenWidth, g_GoldenHeight);
+    fprintf(f, "  \"tolerance\": %d,\n  \"max_bad_pixels\": %.4f,\n  \"min_ssim\": %.4f,\n  \"max_regression\": %.3f,\n",
+            g_GoldenTolerance, GOLDEN_MAX_BAD_PIXELS, GOLDEN_MIN_SSIM, g_GoldenMaxRegression);
+    fprintf(f, "  \"failures\": %d,\n  \"shots\": [\n", failures);
+    for (size_t i = 0; i < g_Shots.size(); ++i)
+    {
+        const GoldenShot& shot = g_Shots[i];
+        fprintf(f, "    {\"name\": \"%s\", \"passed\": %s, \"bad_pixels\": %ld, \"max_diff\": %d, \"ssim\": %.5f, \"frame_ms\": %.4f, \"reference_ms\": %.4f}%s\n",
+                shot.name.c_str(), shot.passed ? "true" : "false", shot.bad_pixels, shot.max_diff, shot.has_golden ? shot.ssim : 0.0,
+                MedianMs(shot), shot.baseline_ms > 0.0 ? shot.baseline_ms : 0.0,
+                (i + 1 < g_Shots.size()) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+
+    if (g_GoldenUpdate)
+        printf("Golden: %u referencias salvas em \"%s\".\n", (unsigned int)g_Shots.size() - failures, g_GoldenDir);
+    else
+        printf("Golden: %u vistas, %d falhas. Resultado em \"golden.json\".\n", (unsigned int)g_Shots.size(), failures);
+    return failures == 0;
+}
@@ -0,0 +1,353 @@
+// Medição de tempo por etapa na GPU. Veja comentários em "include/gputimer.h".
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+
+#include "gputimer.h"
+
+static const char* g_PassNames[GPUTIMER_NUM_PASSES] = {
+    "museu", "estandes", "dinossauro",
+    "exposicao_01", "exposicao_02", "exposicao_03", "exposicao_04", "exposicao_05", "exposicao_06",
+    "exposicao_07", "exposicao_08", "exposicao_09", "exposicao_10", "exposicao_11", "exposicao_12",
+    "exposicao_13", "exposicao_14", "exposicao_15", "exposicao_16", "exposicao_17", "exposicao_18",
+    "multidao", "envio_indireto", "impostores", "texto"
+};
+
+// Queries de um quadro. Só voltam a ser usadas depois de lidas (ou descartadas)
+// GPUTIMER_FRAMES_IN_FLIGHT quadros mais tarde.
+struct QuerySet
+{
+    GLuint time[GPUTIMER_NUM_PASSES];
+    GLuint primitives[GPUTIMER_NUM_PASSES];
+    GLuint samples[GPUTIMER_NUM_PASSES];
+    GLuint frame_begin;
+    GLuint frame_end;
+    bool   used[GPUTIMER_NUM_PASSES];
+    double cpu_ms[GPUTIMER_NUM_PASSES];
+    bool   pending;
+};
+
+// Últimos GPUTIMER_HISTORY valores de cada etapa, em um buffer circular.
+struct PassHistory
+{
+    float gpu_ms[GPUTIMER_HISTORY];
+    float cpu_ms[GPUTIMER_HISTORY];
+    float primitives[GPUTIMER_HISTORY];
+    float samples_passed[GPUTIMER_HISTORY];
+    int   count;
+    int   next;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static bool          g_GpuTimerReady   = false;
+static bool          g_GpuTimerEnabled = true;
+static bool          g_HasTimeElapsed  = false;
+static bool          g_HasTimestamp    = false;
+static bool          g_HasPrimitives   = false;
+static bool          g_HasSamples      = false;
+static QuerySet      g_QuerySets[GPUTIMER_FRAMES_IN_FLIGHT];
+static QuerySet*     g_CurrentSet      = NULL;
+static unsigned long g_FrameIndex      = 0;
+static unsigned long g_DroppedFrames   = 0;
+static int           g_ActivePass      = -1;
+static Clock::time_point g_PassStart;
+
+// Índice GPUTIMER_NUM_PASSES guarda o histórico do quadro inteiro.
+static PassHistory   g_History[GPUTIMER_NUM_PASSES + 1];
+
+static bool HasCounter(GLenum target)
+{
+    GLint bits = 0;
+    glGetQueryiv(target, GL_QUERY_COUNTER_BITS, &bits);
+    // Alguns drivers não aceitam a consulta para todos os alvos; limpamos o erro.
+    while (glGetError() != GL_NO_ERROR) {}
+    return bits > 0;
+}
+
+void GpuTimer_Init()
+{
+    if (g_GpuTimerReady)
+        return;
+
+    g_HasTimeElapsed = HasCounter(GL_TIME_ELAPSED);
+    g_HasTimestamp   = HasCounter(GL_TIMESTAMP);
+    g_HasPrimitives  = HasCounter(GL_PRIMITIVES_GENERATED);
+    g_HasSamples     = HasCounter(GL_SAMPLES_PASSED);
+
+    for (int i = 0; i < GPUTIMER_FRAMES_IN_FLIGHT; ++i)
+    {
+        QuerySet& set = g_QuerySets[i];
+        memset(&set, 0, sizeof(set));
+        glGenQueries(GPUTIMER_NUM_PASSES, set.time);
+        glGenQueries(GPUTIMER_NUM_PASSES, set.primitives);
+        glGenQueries(GPUTIMER_NUM_PASSES, set.samples);
+        glGenQueries(1, &set.frame_begin);
+        glGenQueries(1, &set.frame_end);
+    }
+    memset(g_History, 0, sizeof(g_History));
+
+    printf("Queries de GPU: tempo %s, timestamp %s, primitivas %s, amostras %s.\n",
+           g_HasTimeElapsed ? "sim" : "nao", g_HasTimestamp ? "sim" : "nao",
+           g_HasPrimitives ? "sim" : "nao", g_HasSamples ? "sim" : "nao");
+
+    g_GpuTimerReady = true;
+}
+
+void GpuTimer_SetEnabled(bool enabled)
+{
+    // Só trocamos de estado entre quadros, para não deixar queries abertas.
+    if (g_CurrentSet == NULL)
+        g_GpuTimerEnabled = enabled;
+}
+
+bool GpuTimer_IsEnabled()
+{
+    return g_GpuTimerEnabled;
+}
+
+static void PushSample(PassHistory& h, float gpu_ms, float cpu_ms, float primitives, float samples_passed)
+{
+    h.gpu_ms[h.next]         = gpu_ms;
+    h.cpu_ms[h.next]         = cpu_ms;
+    h.primitives[h.next]     = primitives;
+    h.samples_passed[h.next] = samples_passed;
+    h.next = (h.next + 1) % GPUTIMER_HISTORY;
+    if (h.count < GPUTIMER_HISTORY)
+        h.count += 1;
+}
+
+static bool Available(GLuint query)
+{
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+}
+
+static GLuint64 Result(GLuint query)
+{
+    GLuint64 value = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &value);
+    return value;
+}
+
+// Lê os resultados de um conjunto de queries, caso todos estejam prontos.
+// Nunca bloqueia: retorna false se algum resultado ainda não está disponível.
+static bool Collect(const QuerySet& set)
+{
+    for (int p = 0; p < GPUTIMER_NUM_PASSES; ++p)
+    {
+        if (!set.used[p])
+            continue;
+        if ((g_HasTimeElapsed && !Available(set.time[p]))
+         || (g_HasPrimitives  && !Available(set.primitives[p]))
+         || (g_HasSamples     && !Available(set.samples[p])))
+            return false;
+    }
+    if (g_HasTimestamp && (!Available(set.frame_begin) || !Available(set.frame_end)))
+        return false;
+
+    double frame_cpu_ms = 0.0;
+    for (int p = 0; p < GPUTIMER_NUM_PASSES; ++p)
+    {
+        if (!set.used[p])
+            continue;
+        float gpu_ms     = g_HasTimeElapsed ? Result(set.time[p]) / 1.0e6f : 0.0f;
+        float primitives = g_HasPrimitives  ? (float)Result(set.primitives[p]) : 0.0f;
+        float samples    = g_HasSamples     ? (float)Result(set.samples[p]) : 0.0f;
+        PushSample(g_History[p], gpu_ms, (float)set.cpu_ms[p], primitives, samples);
+        frame_cpu_ms += set.cpu_ms[p];
+    }
+
+    if (g_HasTimestamp)
+    {
+        GLuint64 begin = Result(set.frame_begin);
+        GLuint64 end   = Result(set.frame_end);
+        float frame_ms = (end > begin) ? (end - begin) / 1.0e6f : 0.0f;
+        PushSample(g_History[GPUTIMER_NUM_PASSES], frame_ms, (float)frame_cpu_ms, 0.0f, 0.0f);
+    }
+    return true;
+}
+
+void GpuTimer_BeginFrame()
+{
+    if (!g_GpuTimerReady || !g_GpuTimerEnabled || g_CurrentSet != NULL)
+        return;
+
+    QuerySet& set = g_QuerySets[g_FrameIndex % GPUTIMER_FRAMES_IN_FLIGHT];
+    if (set.pending && !Collect(set))
+        g_DroppedFrames += 1;
+
+    set.pending = false;
+    for (int p = 0; p < GPUTIMER_NUM_PASSES; ++p)
+    {
+        set.used[p] = false;
+        set.cpu_ms[p] = 0.0;
+    }
+
+    if (g_HasTimestamp)
+        glQueryCounter(set.frame_begin, GL_TIMESTAMP);
+
+    g_CurrentSet = &set;
+}
+
+void GpuTimer_EndFrame()
+{
+    if (g_CurrentSet == NULL)
+        return;
+
+    if (g_ActivePass >= 0)
+        GpuTimer_EndPass(g_ActivePass);
+
+    if (g_HasTimestamp)
+        glQueryCounter(g_CurrentSet->frame_end, GL_TIMESTAMP);
+
+    g_CurrentSet->pending = true;
+    g_CurrentSet = NULL;
+    g_FrameIndex += 1;
+}
+
+void GpuTimer_BeginPass(int pass)
+{
+    // O OpenGL não permite duas queries do mesmo tipo ativas ao mesmo tempo;
+    // etapas não podem ser aninhadas nem repetidas no mesmo quadro.
+    if (g_CurrentSet == NULL || g_ActivePass >= 0 || pass < 0 || pass >= GPUTIMER_NUM_PASSES || g_CurrentSet->used[pass])
+        return;
+
+    if (g_HasTimeElapsed) glBeginQuery(GL_TIME_ELAPSED, g_CurrentSet->time[pass]);
+    if (g_HasPrimitives)  glBeginQuery(GL_PRIMITIVES_GENERATED, g_CurrentSet->primitives[pass]);
+    if (g_HasSamples)     glBeginQuery(GL_SAMPLES_PASSED, g_CurrentSet->samples[pass]);
+
+    g_CurrentSet->used[pass] = true;
+    g_ActivePass = pass;
+    g_PassStart = Clock::now();
+}
+
+void GpuTimer_EndPass(int pass)
+{
+    if (g_CurrentSet == NULL || g_ActivePass != pass)
+        return;
+
+    if (g_HasTimeElapsed) glEndQuery(GL_TIME_ELAPSED);
+    if (g_HasPrimitives)  glEndQuery(GL_PRIMITIVES_GENERATED);
+    if (g_HasSamples)     glEndQuery(GL_SAMPLES_PASSED);
+
+    g_CurrentSet->cpu_ms[pass] = std::chrono::duration<double, std::milli>(Clock::now() - g_PassStart).count();
+    g_ActivePass = -1;
+}
+
+const char* GpuTimer_PassName(int pass)
+{
+    if (pass < 0 || pass >= GPUTIMER_NUM_PASSES)
+        return "quadro";
+    return g_PassNames[pass];
+}
+
+// Percentil "p" (entre 0 e 1) de valores já ordenados.
+static double Percentile(const float* sorted, int n, double p)
+{
+    if (n == 0)
+        return 0.0;
+    int index = (int)(p*(n - 1) + 0.5);
+    return sorted[index];
+}
+
+static double Mean(const float* values, int n)
+{
+    if (n == 0)
+        return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i)
+        sum += values[i];
+    return sum / n;
+}
+
+static GpuTimerStats ComputeStats(int index)
+{
+    const PassHistory& h = g_History[index];
+    int n = h.count;
+
+    GpuTimerStats stats;
+    stats.name    = GpuTimer_PassName(index);
+    stats.samples = n;
+
+    float sorted[GPUTIMER_HISTORY];
+
+    std::copy(h.gpu_ms, h.gpu_ms + n, sorted);
+    std::sort(sorted, sorted + n);
+    stats.gpu_mean_ms = Mean(sorted, n);
+    stats.gpu_p50_ms  = Percentile(sorted, n, 0.50);
+    stats.gpu_p95_ms  = Percentile(sorted, n, 0.95);
+    stats.gpu_p99_ms  = Percentile(sorted, n, 0.99);
+    stats.gpu_max_ms  = (n > 0) ? sorted[n-1] : 0.0;
+
+    std::copy(h.cpu_ms, h.cpu_ms + n, sorted);
+    std::sort(sorted, sorted + n);
+    stats.cpu_mean_ms = Mean(sorted, n);
+    stats.cpu_p95_ms  = Percentile(sorted, n, 0.95);
+
+    stats.primitives     = Mean(h.primitives, n);
+    stats.samples_passed = Mean(h.samples_passed, n);
+    return stats;
+}
+
+GpuTimerStats GpuTimer_GetStats(int pass)
+{
+    if (pass < 0 || pass >= GPUTIMER_NUM_PASSES)
+        pass = GPUTIMER_NUM_PASSES;
+    return ComputeStats(pass);
+}
+
+GpuTimerStats GpuTimer_GetFrameStats()
+{
+    return ComputeStats(GPUTIMER_NUM_PASSES);
+}
+
+unsigned long GpuTimer_DroppedFrames()
+{
+    return g_DroppedFrames;
+}
+
+static void WriteStatsJSON(FILE* f, const GpuTimerStats& s)
+{
+    fprintf(f, "{\"name\": \"%s\", \"samples\": %d, "
+               "\"gpu_mean_ms\": %.4f, \"gpu_p50_ms\": %.4f, \"gpu_p95_ms\": %.4f, \"gpu_p99_ms\": %.4f, \"gpu_max_ms\": %.4f, "
+               "\"cpu_mean_ms\": %.4f, \"cpu_p95_ms\": %.4f, \"primitives\": %.1f, \"samples_passed\": %.1f}",
+            s.name, s.samples,
+            s.gpu_mean_ms, s.gpu_p50_ms, s.gpu_p95_ms, s.gpu_p99_ms, s.gpu_max_ms,
+            s.cpu_mean_ms, s.cpu_p95_ms, s.primitives, s.samples_passed);
+}
+
+bool GpuTimer_WriteJSON(const char* filename)
+{
+    if (!g_GpuTimerReady)
+        return false;
+
+    FILE* f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+
+    fprintf(f, "{\n  \"frames\": %lu,\n  \"dropped_frames\": %lu,\n  \"history\": %d,\n",
+            g_FrameIndex, g_DroppedFrames, GPUTIMER_HISTORY);
+    fprintf(f, "  \"available\": {\"time_elapsed\": %s, \"timestamp\": %s, \"primitives_generated\": %s, \"samples_passed\": %s},\n",
+            g_HasTimeElapsed ? "true" : "false", g_HasTimestamp ? "true" : "false",
+            g_HasPrimitives ? "true" : "false", g_HasSamples ? "true" : "false");
+
+    fprintf(f, "  \"frame\": ");
+    WriteStatsJSON(f, GpuTimer_GetFrameStats());
+    fprintf(f, ",\n  \"passes\": [\n");
+    for (int p = 0; p < GPUTIMER_NUM_PASSES; ++p)
+    {
+        fprintf(f, "    ");
+        WriteStatsJSON(f, GpuTimer_GetStats(p));
+        fprintf(f, (p + 1 < GPUTIMER_NUM_PASSES) ? ",\n" : "\n");
+    }
+    fprintf(f, "  ]\n}\n");
+
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,532 @@
+// Impostores. Veja comentários em "include/impostor.h".
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "impostor.h"
+#include "matrices.h"
+#include "glstate.h"
+#include "perfhud.h"
+#include "assetstats.h"
+
+GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
+void TextRendering_LoadShader(const GLchar* const shader_string, GLuint shader_id); // Função definida em textrendering.cpp
+
+#define IMPOSTOR_TILES       (IMPOSTOR_AZIMUTHS * IMPOSTOR_ELEVATIONS)
+#define IMPOSTOR_MAX_LEVEL   2                        // Mipmaps até IMPOSTOR_TILE/4 pixels por vista
+#define IMPOSTOR_ELEVATION   (float)(M_PI / 3.0)      // Maior elevação das vistas (60 graus)
+
+// Constantes acima como texto, no código dos shaders.
+#define IMPOSTOR_STRING(x)   IMPOSTOR_STRING_(x)
+#define IMPOSTOR_STRING_(x)  #x
+
+// Cada impostor da fila é uma instância com seis atributos vec4 (veja o
+// vertex shader abaixo).
+struct ImpostorQuad
+{
+    glm::vec4 center; // Centro no mundo; w: raio da esfera envolvente
+    glm::vec4 right;  // Eixos do quadrilátero; w: camada * IMPOSTOR_TILES + vista
+    glm::vec4 up;     // w: expoente especular q
+    glm::vec4 normal_x; // Colunas da matriz das normais; w: Ks
+    glm::vec4 normal_y;
+    glm::vec4 normal_z;
+};
+
+const GLchar* const impostorvertexshader_source = ""
+"#version 330 core\n"
+"layout (location = 0) in vec4 center;\n"
+"layout (location = 1) in vec4 right;\n"
+"layout (location = 2) in vec4 up;\n"
+"layout (location = 3) in vec4 normal_x;\n"
+"layout (location = 4) in vec4 normal_y;\n"
+"layout (location = 5) in vec4 normal_z;\n"
+"uniform mat4 view;\n"
+"uniform mat4 projection;\n"
+"out vec2 corner;\n"
+"out vec2 atlas_uv;\n"
+"flat out int layer;\n"
+"flat out vec4 center_radius;\n"
+"flat out vec3 axis_right;\n"
+"flat out vec3 axis_up;\n"
+"flat out mat3 normal_matrix;\n"
+"flat out vec4 ks_q;\n"
+"void main()\n"
+"{\n"
+    "corner = vec2((gl_VertexID & 1) != 0 ? 1.0 : -1.0, (gl_VertexID & 2) != 0 ? 1.0 : -1.0);\n"
+    "int index = int(right.w + 0.5);\n"
+    "layer = index / " IMPOSTOR_STRING(IMPOSTOR_TILES) ";\n"
+    "int tile = index - layer * " IMPOSTOR_STRING(IMPOSTOR_TILES) ";\n"
+    "vec2 tile_xy = vec2(tile % " IMPOSTOR_STRING(IMPOSTOR_AZIMUTHS) ", tile / " IMPOSTOR_STRING(IMPOSTOR_AZIMUTHS) ");\n"
+    "atlas_uv = (tile_xy + corner * 0.5 + 0.5) / vec2(" IMPOSTOR_STRING(IMPOSTOR_AZIMUTHS) ", " IMPOSTOR_STRING(IMPOSTOR_ELEVATIONS) ");\n"
+    "float extent = center.w * " IMPOSTOR_STRING(IMPOSTOR_MARGIN) ";\n"
+    "vec3 position = center.xyz + extent * (corner.x * right.xyz + corner.y * up.xyz);\n"
+    "gl_Position = projection * view * vec4(position, 1.0);\n"
+    "center_radius = center;\n"
+    "axis_right = right.xyz;\n"
+    "axis_up = up.xyz;\n"
+    "normal_matrix = mat3(normal_x.xyz, normal_y.xyz, normal_z.xyz);\n"
+    "ks_q = vec4(normal_x.w, normal_y.w, normal_z.w, up.w);\n"
+"}\n"
+"\0";
+
+// Mesma iluminação do fim de "shader_fragment.glsl" (Phong com a fonte de
+// luz spotlight).
+const GLchar* const impostorfragmentshader_source = ""
+"#version 330 core\n"
+"uniform mat4 view;\n"
+"uniform mat4 projection;\n"
+"uniform sampler2DArray color_atlas;\n"
+"uniform sampler2DArray normal_atlas;\n"
+"in vec2 corner;\n"
+"in vec2 atlas_uv;\n"
+"flat in int layer;\n"
+"flat in vec4 center_radius;\n"
+"flat in vec3 axis_right;\n"
+"flat in vec3 axis_up;\n"
+"flat in mat3 normal_matrix;\n"
+"flat in vec4 ks_q;\n"
+"out vec3 color;\n"
+"#define M_PI 3.14159265358979323846\n"
+"void main()\n"
+"{\n"
+    "vec4 kd_coverage = texture(color_atlas, vec3(atlas_uv, layer));\n"
+    "if (kd_coverage.a < 0.5)\n"
+        "discard;\n"
+    "vec4 normal_depth = texture(normal_atlas, vec3(atlas_uv, layer)) / kd_coverage.a;\n"
+    "vec3 Kd = kd_coverage.rgb / kd_coverage.a;\n"
+    "vec3 Ks = ks_q.rgb;\n"
+    "float q = ks_q.a;\n"
+    "vec3 axis_front = cross(axis_right, axis_up);\n"
+    "float extent = center_radius.w * " IMPOSTOR_STRING(IMPOSTOR_MARGIN) ";\n"
+    "vec4 p = vec4(center_radius.xyz + extent * (corner.x * axis_right + corner.y * axis_up)\n"
+    "              + center_radius.w * (1.0 - 2.0 * normal_depth.a) * axis_front, 1.0);\n"
+    "vec4 p_clip = projection * view * p;\n"
+    "gl_FragDepth = 0.5 * p_clip.z / p_clip.w + 0.5;\n"
+    "vec4 camera_position = inverse(view) * vec4(0.0, 0.0, 0.0, 1.0);\n"
+    "vec4 spotlightPosition = vec4(-22.0,4,0.0,1.0);\n"
+    "vec4 spotlightDirection = vec4(0.0,-1.0,0.0,0.0);\n"
+    "vec4 n = vec4(normalize(normal_matrix * (normal_depth.rgb * 2.0 - 1.0)), 0.0);\n"
+    "vec4 l = normalize(spotlightPosition - p);\n"
+    "vec4 v = normalize(camera_position - p);\n"
+    "vec4 r = -l + 2*n*(dot(n, l));\n"
+    "float lambert = max(0,dot(n,l));\n"
+    "vec3 I = vec3(1.0, 1.0, 1.0);\n"
+    "vec3 Ia = vec3(0.1, 0.1, 0.1);\n"
+    "if(dot((normalize(p - spotlightPosition)), normalize(spotlightDirection)) < cos(M_PI/2.5))\n"
+        "color = Kd * (lambert + 0.01);\n"
+    "else\n"
+        "color = Kd*I*lambert + Ia + Ks*I*pow(max(0.0, dot(r,v)),q);\n"
+    "color = pow(color, vec3(1.0,1.0,1.0)/2.2);\n"
+"}\n"
+"\0";
+
+struct Exhibit
+{
+    ImpostorExhibit info;
+    bool            baked;   // Atlas pronto (pode estar desatualizado, se pending)
+    bool            pending; // Precisa de (novo) preparo
+};
+
+static bool             g_Enabled = true;
+static float            g_MaxPixels = IMPOSTOR_DEFAULT_PIXELS;
+static int              g_ViewportHeight = 600;
+static glm::mat4        g_View;
+static glm::mat4        g_Projection;
+static glm::vec3        g_CameraPosition;
+
+static Exhibit          g_Exhibits[IMPOSTOR_MAX_EXHIBITS];
+static int              g_NumExhibits = 0;
+static ImpostorBakeFunc g_BakeFunc = NULL;
+
+// Vistas do preparo: matriz "view" e eixos da imagem no sistema de
+// coordenadas do modelo.
+static glm::mat4        g_TileViews[IMPOSTOR_TILES];
+static glm::vec3        g_TileRight[IMPOSTOR_TILES];
+static glm::vec3        g_TileUp[IMPOSTOR_TILES];
+
+static GLuint           g_Program = 0;
+static GLint            g_ViewUniform;
+static GLint            g_ProjectionUniform;
+static GLuint           g_VAO;
+static GLuint           g_InstanceBuffer;
+static GLuint           g_ColorAtlas;
+static GLuint           g_NormalAtlas;
+static GLuint           g_Framebuffer;
+static GLuint           g_DepthBuffer;
+
+static ImpostorQuad     g_Quads[IMPOSTOR_MAX_QUADS];
+static int              g_NumQuads = 0;
+static ImpostorStats    g_Stats;
+
+bool Impostor_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--no-impostors") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    if (strcmp(argv[*i], "--impostor-pixels") == 0 && *i + 1 < argc)
+    {
+        g_MaxPixels = (float)atof(argv[++*i]);
+        return true;
+    }
+    return false;
+}
+
+glm::mat4 Impostor_BakeModel(const glm::vec3& bbox_min, const glm::vec3& bbox_max)
+{
+    glm::vec3 center = 0.5f * (bbox_min + bbox_max);
+    float radius = std::max(0.5f * glm::length(bbox_max - bbox_min), 1e-6f);
+    return Matrix_Scale(1.0f / radius, 1.0f / radius, 1.0f / radius)
+         * Matrix_Translate(-center.x, -center.y, -center.z);
+}
+
+// Direção da vista (i, j), do centro do modelo para a câmera.
+static glm::vec3 TileDirection(int i, int j)
+{
+    float azimuth = 2.0f * (float)M_PI * i / IMPOSTOR_AZIMUTHS;
+    float elevation = -IMPOSTOR_ELEVATION + 2.0f * IMPOSTOR_ELEVATION * j / (IMPOSTOR_ELEVATIONS - 1);
+    return glm::vec3(cosf(elevation) * sinf(azimuth), sinf(elevation), cosf(elevation) * cosf(azimuth));
+}
+
+static void CreateAtlas(GLuint* texture, int layers)
+{
+    glGenTextures(1, texture);
+    GLState_ActiveTexture(GL_TEXTURE0 + IMPOSTOR_TEXTURE_UNIT);
+    GLState_BindTexture(GL_TEXTURE_2D_ARRAY, *texture);
+    for (int level = 0; level <= IMPOSTOR_MAX_LEVEL; ++level)
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8,
+                     (IMPOSTOR_AZIMUTHS * IMPOSTOR_TILE) >> level, (IMPOSTOR_ELEVATIONS * IMPOSTOR_TILE) >> level, layers,
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, IMPOSTOR_MAX_LEVEL);
+
+    size_t bytes = 0;
+    for (int level = 0; level <= IMPOSTOR_MAX_LEVEL; ++level)
+        bytes += (size_t)((IMPOSTOR_AZIMUTHS * IMPOSTOR_TILE) >> level) * ((IMPOSTOR_ELEVATIONS * IMPOSTOR_TILE) >> level) * layers * 4;
+    g_Stats.atlas_bytes += bytes;
+    PerfHud_AddTextureMemory(bytes);
+}
+
+void Impostor_Init(const ImpostorExhibit* exhibits, int count, ImpostorBakeFunc bake)
+{
+    if (!g_Enabled)
+        return;
+
+    if (count > IMPOSTOR_MAX_EXHIBITS)
+    {
+        fprintf(stderr, "ERROR: too many impostor exhibits (max. %d).\n", IMPOSTOR_MAX_EXHIBITS);
+        std::exit(EXIT_FAILURE);
+    }
+    for (int e = 0; e < count; ++e)
+    {
+        g_Exhibits[e].info    = exhibits[e];
+        g_Exhibits[e].baked   = false;
+        g_Exhibits[e].pending = true;
+    }
+    g_NumExhibits = count;
+    g_BakeFunc = bake;
+    g_Stats.exhibits = count;
+
+    // A câmera de cada vista fica a uma distância 2 do centro da esfera de
+    // raio 1 (veja Impostor_BakeModel()), olhando para ele.
+    for (int j = 0; j < IMPOSTOR_ELEVATIONS; ++j)
+        for (int i = 0; i < IMPOSTOR_AZIMUTHS; ++i)
+        {
+            int tile = j * IMPOSTOR_AZIMUTHS + i;
+            glm::vec3 d = TileDirection(i, j);
+            glm::vec4 view_vector = glm::vec4(-d, 0.0f);
+            g_TileViews[tile] = Matrix_Camera_View(glm::vec4(2.0f * d, 1.0f), view_vector, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+            g_TileRight[tile] = glm::normalize(glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), d));
+            g_TileUp[tile]    = glm::cross(d, g_TileRight[tile]);
+        }
+
+    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    TextRendering_LoadShader(impostorvertexshader_source, vertex_shader_id);
+    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+    TextRendering_LoadShader(impostorfragmentshader_source, fragment_shader_id);
+    g_Program = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+
+    g_ViewUniform       = glGetUniformLocation(g_Program, "view");
+    g_ProjectionUniform = glGetUniformLocation(g_Program, "projection");
+    GLState_UseProgram(g_Program);
+    GLState_Uniform1i(glGetUniformLocation(g_Program, "color_atlas"), IMPOSTOR_TEXTURE_UNIT);
+    GLState_Uniform1i(glGetUniformLocation(g_Program, "normal_atlas"), IMPOSTOR_TEXTURE_UNIT + 1);
+    GLState_UseProgram(0);
+
+    CreateAtlas(&g_ColorAtlas, count);
+    CreateAtlas(&g_NormalAtlas, count);
+
+    // Framebuffer do preparo: as duas saídas do fragment shader vão para a
+    // camada da exposição nos dois atlas (veja Impostor_BakePending()).
+    glGenRenderbuffers(1, &g_DepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_DepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, IMPOSTOR_AZIMUTHS * IMPOSTOR_TILE, IMPOSTOR_ELEVATIONS * IMPOSTOR_TILE);
+
+    GLint previous_framebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGenFramebuffers(1, &g_Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_Framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, g_ColorAtlas, 0, 0);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, g_NormalAtlas, 0, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_DepthBuffer);
+    const GLenum draw_buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, draw_buffers);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERROR: impostor framebuffer incomplete (0x%x).\n", status);
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Os quatro vértices de cada quadrilátero vêm de gl_VertexID; os
+    // atributos são por instância.
+    glGenVertexArrays(1, &g_VAO);
+    GLState_BindVertexArray(g_VAO);
+    glGenBuffers(1, &g_InstanceBuffer);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, g_InstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g_Quads), NULL, GL_DYNAMIC_DRAW);
+    PerfHud_AddBufferMemory(sizeof(g_Quads));
+    for (GLuint attribute = 0; attribute < 6; ++attribute)
+    {
+        glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(ImpostorQuad), (void*)(attribute * sizeof(glm::vec4)));
+        glVertexAttribDivisor(attribute, 1);
+        glEnableVertexAttribArray(attribute);
+    }
+    GLState_BindVertexArray(0);
+}
+
+bool Impostor_BakePending()
+{
+    if (g_Program == 0)
+        return false;
+
+    int pending = 0;
+    for (int e = 0; e < g_NumExhibits; ++e)
+        pending += g_Exhibits[e].pending;
+    if (pending == 0)
+        return false;
+
+    double start = AssetStats_NowMs();
+    GLint previous_framebuffer;
+    GLint previous_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_Framebuffer);
+
+    // Projeção ortográfica da esfera de raio 1, vista a uma distância 2: a
+    // profundidade vai de 0 no ponto mais próximo a 1 no mais distante.
+    glm::mat4 projection = Matrix_Orthographic(-IMPOSTOR_MARGIN, IMPOSTOR_MARGIN, -IMPOSTOR_MARGIN, IMPOSTOR_MARGIN, -1.0f, -3.0f);
+    const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat one = 1.0f;
+
+    int baked = 0;
+    for (int e = 0; e < g_NumExhibits && baked < IMPOSTOR_BAKES_PER_FRAME; ++e)
+    {
+        Exhibit& exhibit = g_Exhibits[e];
+        if (!exhibit.pending)
+            continue;
+
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, g_ColorAtlas, 0, e);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, g_NormalAtlas, 0, e);
+        glViewport(0, 0, IMPOSTOR_AZIMUTHS * IMPOSTOR_TILE, IMPOSTOR_ELEVATIONS * IMPOSTOR_TILE);
+        glClearBufferfv(GL_COLOR, 0, zero);
+        glClearBufferfv(GL_COLOR, 1, zero);
+        glClearBufferfv(GL_DEPTH, 0, &one);
+
+        bool drawn = true;
+        for (int tile = 0; tile < IMPOSTOR_TILES && drawn; ++tile)
+        {
+            glViewport((tile % IMPOSTOR_AZIMUTHS) * IMPOSTOR_TILE, (tile / IMPOSTOR_AZIMUTHS) * IMPOSTOR_TILE, IMPOSTOR_TILE, IMPOSTOR_TILE);
+            drawn = g_BakeFunc(exhibit.info.name, exhibit.info.object_id, g_TileViews[tile], projection);
+        }
+
+        // Malha ainda ausente: a camada foi limpa, e o atlas antigo (se
+        // houver) não vale mais.
+        exhibit.baked = drawn;
+        if (!drawn)
+            continue;
+
+        exhibit.pending = false;
+        g_Stats.bakes += 1;
+        baked += 1;
+    }
+
+    if (baked > 0)
+    {
+        GLState_ActiveTexture(GL_TEXTURE0 + IMPOSTOR_TEXTURE_UNIT);
+        GLState_BindTexture(GL_TEXTURE_2D_ARRAY, g_ColorAtlas);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        GLState_ActiveTexture(GL_TEXTURE0 + IMPOSTOR_TEXTURE_UNIT + 1);
+        GLState_BindTexture(GL_TEXTURE_2D_ARRAY, g_NormalAtlas);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+    g_Stats.bake_ms += AssetStats_NowMs() - start;
+    return baked > 0;
+}
+
+void Impostor_Invalidate(const char* name)
+{
+    for (int e = 0; e < g_NumExhibits; ++e)
+        if (strcmp(g_Exhibits[e].info.name, name) == 0)
+            g_Exhibits[e].pending = true;
+}
+
+void Impostor_SetViewportHeight(int height)
+{
+    g_ViewportHeight = height;
+}
+
+void Impostor_BeginFrame(const glm::mat4& view, const glm::mat4& projection)
+{
+    g_View           = view;
+    g_Projection     = projection;
+    g_CameraPosition = glm::vec3(glm::inverse(view)[3]);
+    g_NumQuads       = 0;
+}
+
+bool Impostor_Draw(const char* name, int object_id, const glm::mat4& model,
+                   const glm::vec3& bbox_min, const glm::vec3& bbox_max)
+{
+    if (g_Program == 0)
+        return false;
+
+    int e = 0;
+    while (e < g_NumExhibits && (g_Exhibits[e].info.object_id != object_id || strcmp(g_Exhibits[e].info.name, name) != 0))
+        ++e;
+    if (e == g_NumExhibits)
+        return false;
+
+    g_Stats.draws += 1;
+    if (!g_Exhibits[e].baked)
+        return false;
+
+    glm::mat3 linear = glm::mat3(model);
+    float scale_x = glm::length(linear[0]);
+    float scale_y = glm::length(linear[1]);
+    float scale_z = glm::length(linear[2]);
+    float max_scale = std::max(scale_x, std::max(scale_y, scale_z));
+    float min_scale = std::min(scale_x, std::min(scale_y, scale_z));
+    if (max_scale > min_scale * IMPOSTOR_MAX_SCALE_RATIO)
+        return false;
+
+    // Diâmetro na tela da esfera envolvente, como em Lod_Select().
+    glm::vec3 center = glm::vec3(model * glm::vec4(0.5f * (bbox_min + bbox_max), 1.0f));
+    float radius = 0.5f * glm::length(bbox_max - bbox_min) * max_scale;
+    float pixels = fabsf(g_Projection[1][1]) * g_ViewportHeight * radius;
+    if (g_Projection[2][3] != 0.0f)
+    {
+        float depth = -(g_View * glm::vec4(center, 1.0f)).z;
+        if (depth - radius <= 1e-3f)
+            return false; // Câmera dentro da esfera, ou objeto atrás dela
+        pixels /= depth - radius;
+    }
+    if (pixels >= g_MaxPixels)
+        return false;
+
+    if (g_NumQuads == IMPOSTOR_MAX_QUADS)
+    {
+        g_Stats.dropped += 1;
+        return false;
+    }
+
+    // Vista mais próxima da direção da câmera, no sistema de coordenadas do
+    // modelo (veja TileDirection()).
+    glm::vec3 to_camera = glm::normalize(g_CameraPosition - center);
+    glm::mat3 inverse_linear = glm::inverse(linear);
+    glm::vec3 d = glm::normalize(inverse_linear * to_camera);
+    float azimuth = atan2f(d.x, d.z);
+    float elevation = asinf(std::min(1.0f, std::max(-1.0f, d.y)));
+    int i = (int)floorf(azimuth * IMPOSTOR_AZIMUTHS / (2.0f * (float)M_PI) + 0.5f);
+    i = (i % IMPOSTOR_AZIMUTHS + IMPOSTOR_AZIMUTHS) % IMPOSTOR_AZIMUTHS;
+    int j = (int)floorf((elevation + IMPOSTOR_ELEVATION) * (IMPOSTOR_ELEVATIONS - 1) / (2.0f * IMPOSTOR_ELEVATION) + 0.5f);
+    j = std::min(IMPOSTOR_ELEVATIONS - 1, std::max(0, j));
+    int tile = j * IMPOSTOR_AZIMUTHS + i;
+
+    // O "para cima" da vista, levado ao mundo e projetado no plano voltado
+    // para a câmera.
+    glm::vec3 up = linear * g_TileUp[tile];
+    up -= to_camera * glm::dot(up, to_camera);
+    if (glm::dot(up, up) < 1e-8f)
+    {
+        glm::vec3 right = linear * g_TileRight[tile];
+        up = glm::cross(to_camera, right);
+    }
+    up = glm::normalize(up);
+    glm::vec3 right = glm::cross(up, to_camera);
+
+    const ImpostorExhibit& info = g_Exhibits[e].info;
+    glm::mat3 normal_matrix = glm::transpose(inverse_linear);
+    ImpostorQuad& quad = g_Quads[g_NumQuads++];
+    quad.center   = glm::vec4(center, radius);
+    quad.right    = glm::vec4(right, (float)(e * IMPOSTOR_TILES + tile));
+    quad.up       = glm::vec4(up, info.q);
+    quad.normal_x = glm::vec4(normal_matrix[0], info.ks.x);
+    quad.normal_y = glm::vec4(normal_matrix[1], info.ks.y);
+    quad.normal_z = glm::vec4(normal_matrix[2], info.ks.z);
+    g_Stats.impostors += 1;
+    return true;
+}
+
+void Impostor_EndFrame()
+{
+    g_Stats.max_quads = std::max(g_Stats.max_quads, g_NumQuads);
+    if (g_NumQuads == 0)
+        return;
+
+    GLState_UseProgram(g_Program);
+    GLState_UniformMatrix4fv(g_ViewUniform, 1, GL_FALSE, glm::value_ptr(g_View));
+    GLState_UniformMatrix4fv(g_ProjectionUniform, 1, GL_FALSE, glm::value_ptr(g_Projection));
+    GLState_ActiveTexture(GL_TEXTURE0 + IMPOSTOR_TEXTURE_UNIT);
+    GLState_BindTexture(GL_TEXTURE_2D_ARRAY, g_ColorAtlas);
+    GLState_ActiveTexture(GL_TEXTURE0 + IMPOSTOR_TEXTURE_UNIT + 1);
+    GLState_BindTexture(GL_TEXTURE_2D_ARRAY, g_NormalAtlas);
+
+    GLState_BindVertexArray(g_VAO);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, g_InstanceBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, g_NumQuads * sizeof(ImpostorQuad), g_Quads);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, g_NumQuads);
+    PerfHud_CountDraw(2 * g_NumQuads);
+}
+
+ImpostorStats Impostor_GetStats()
+{
+    ImpostorStats stats = g_Stats;
+    stats.baked = 0;
+    for (int e = 0; e < g_NumExhibits; ++e)
+        stats.baked += g_Exhibits[e].baked;
+    return stats;
+}
+
+void Impostor_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "Impostores: desligados (--no-impostors).\n");
+        return;
+    }
+
+    ImpostorStats stats = Impostor_GetStats();
+    fprintf(f, "Impostores: %d de %d exposicoes preparadas (%lu preparos, %.1f ms, atlas de %.1f MiB), %lu de %lu desenhos como impostor (%.1f%%), max. %d por quadro",
+            stats.baked, stats.exhibits, stats.bakes, stats.bake_ms, stats.atlas_bytes / (1024.0 * 1024.0),
+            stats.impostors, stats.draws, stats.draws > 0 ? 100.0 * stats.impostors / stats.draws : 0.0, stats.max_quads);
+    if (stats.dropped > 0)
+        fprintf(f, ", %lu como malha por fila cheia", stats.dropped);
+    fprintf(f, ".\n");
+}
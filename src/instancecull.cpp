@@ -0,0 +1,463 @@
+// Instâncias testadas na GPU. Veja comentários em "include/instancecull.h".
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glad/glad_profile.h>
+
+#include "instancecull.h"
+#include "multidraw.h"
+#include "mesharena.h"
+#include "glstate.h"
+#include "perfhud.h"
+
+void TextRendering_LoadShader(const GLchar* const shader_string, GLuint shader_id); // Função definida em textrendering.cpp
+
+// Ausentes na GLAD gerada para o OpenGL 3.3.
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_QUERY_BUFFER
+#define GL_QUERY_BUFFER 0x9192
+#endif
+typedef void (APIENTRYP PFNDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect);
+
+// Comando de glDrawElementsIndirect(); "instance_count" é gravado pela GPU.
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint  base_vertex;
+    GLuint reserved; // Deve ser 0
+};
+
+// Os registros visíveis e as queries são duplicados: o teste de um quadro
+// escreve em um par, e o do quadro anterior continua no outro.
+struct InstanceSet
+{
+    int           count;
+    GLuint        instance_buffer;    // Registros de todas as instâncias
+    GLuint        visible_buffers[2]; // Registros visíveis, escritos pelo transform feedback
+    GLuint        queries[2];         // GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN
+    int           current;            // Par do teste do quadro atual
+    GLuint        cull_vao;           // Um ponto por instância
+    GLuint        draw_vao;           // Malha + registros visíveis
+    GLuint        record_buffer;      // Registros ligados em "draw_vao"
+    GLuint        source_vao;         // VAO do objeto copiado em "draw_vao"
+    unsigned long arena_grows;        // Crescimentos da arena na cópia
+    GLuint        command_buffer;     // Somente com "g_Indirect"
+    GLuint        visible;            // Último resultado lido das queries
+    unsigned long tests;              // Testes feitos por InstanceCull_BeginFrame()
+};
+
+static bool                        g_Enabled = true;
+static int                         g_CrowdSize = 0;
+static bool                        g_Initialized = false;
+static bool                        g_Indirect = false;
+static PFNDRAWELEMENTSINDIRECTPROC g_DrawElementsIndirect = NULL;
+static GLuint                      g_Program = 0;
+static GLint                       g_ViewProjectionUniform = -1;
+static InstanceSet                 g_Sets[INSTANCECULL_MAX_SETS];
+static int                         g_NumSets = 0;
+static InstanceCullStats           g_Stats;
+
+// O vertex shader repassa o registro (veja MultiDrawRecord); o geometry
+// shader o emite se a bounding box pode estar dentro do frustum.
+const GLchar* const instancecullvertexshader_source = ""
+"#version 330 core\n"
+"layout (location = 0) in mat4 model;\n"
+"layout (location = 4) in vec4 bbox_min;\n"
+"layout (location = 5) in vec4 bbox_max;\n"
+"layout (location = 6) in ivec4 object_id;\n"
+"out mat4 v_model;\n"
+"out vec4 v_bbox_min;\n"
+"out vec4 v_bbox_max;\n"
+"flat out ivec4 v_object_id;\n"
+"void main()\n"
+"{\n"
+    "v_model = model;\n"
+    "v_bbox_min = bbox_min;\n"
+    "v_bbox_max = bbox_max;\n"
+    "v_object_id = object_id;\n"
+"}\n"
+"\0";
+
+const GLchar* const instancecullgeometryshader_source = ""
+"#version 330 core\n"
+"layout (points) in;\n"
+"layout (points, max_vertices = 1) out;\n"
+"uniform mat4 view_projection;\n"
+"in mat4 v_model[];\n"
+"in vec4 v_bbox_min[];\n"
+"in vec4 v_bbox_max[];\n"
+"flat in ivec4 v_object_id[];\n"
+"out vec4 out_model_0;\n"
+"out vec4 out_model_1;\n"
+"out vec4 out_model_2;\n"
+"out vec4 out_model_3;\n"
+"out vec4 out_bbox_min;\n"
+"out vec4 out_bbox_max;\n"
+"flat out ivec4 out_object_id;\n"
+"void main()\n"
+"{\n"
+    "mat4 m = view_projection * v_model[0];\n"
+    "vec4 c[8];\n"
+    "for (int i = 0; i < 8; ++i)\n"
+    "{\n"
+        "vec3 s = vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);\n"
+        "c[i] = m * vec4(mix(v_bbox_min[0].xyz, v_bbox_max[0].xyz, s), 1.0);\n"
+    "}\n"
+    "for (int axis = 0; axis < 3; ++axis)\n"
+    "{\n"
+        "bool below = true, above = true;\n"
+        "for (int i = 0; i < 8; ++i)\n"
+        "{\n"
+            "below = below && c[i][axis] < -c[i].w;\n"
+            "above = above && c[i][axis] > c[i].w;\n"
+        "}\n"
+        "if (below || above)\n"
+            "return;\n"
+    "}\n"
+    "out_model_0 = v_model[0][0];\n"
+    "out_model_1 = v_model[0][1];\n"
+    "out_model_2 = v_model[0][2];\n"
+    "out_model_3 = v_model[0][3];\n"
+    "out_bbox_min = v_bbox_min[0];\n"
+    "out_bbox_max = v_bbox_max[0];\n"
+    "out_object_id = v_object_id[0];\n"
+    "EmitVertex();\n"
+"}\n"
+"\0";
+
+// Saídas gravadas pelo transform feedback, na ordem de MultiDrawRecord.
+static const GLchar* const g_Varyings[] = {
+    "out_model_0", "out_model_1", "out_model_2", "out_model_3", "out_bbox_min", "out_bbox_max", "out_object_id"
+};
+
+bool InstanceCull_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--no-instance-culling") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    if (strcmp(argv[*i], "--crowd") == 0 && *i + 1 < argc)
+    {
+        g_CrowdSize = std::max(0, atoi(argv[++*i]));
+        return true;
+    }
+    return false;
+}
+
+bool InstanceCull_IsEnabled()
+{
+    return g_Enabled;
+}
+
+int InstanceCull_CrowdSize()
+{
+    return g_CrowdSize;
+}
+
+// Como CreateGpuProgram() (main.cpp), com as saídas do transform feedback
+// definidas antes da linkagem.
+static GLuint CreateCullProgram()
+{
+    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    TextRendering_LoadShader(instancecullvertexshader_source, vertex_shader_id);
+    GLuint geometry_shader_id = glCreateShader(GL_GEOMETRY_SHADER);
+    TextRendering_LoadShader(instancecullgeometryshader_source, geometry_shader_id);
+
+    GLuint program_id = glCreateProgram();
+    glAttachShader(program_id, vertex_shader_id);
+    glAttachShader(program_id, geometry_shader_id);
+    glTransformFeedbackVaryings(program_id, sizeof(g_Varyings) / sizeof(g_Varyings[0]), g_Varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program_id);
+
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    if (linked_ok == GL_FALSE)
+    {
+        GLchar log[1024];
+        GLsizei log_length = 0;
+        glGetProgramInfoLog(program_id, sizeof(log), &log_length, log);
+        fprintf(stderr, "ERROR: OpenGL linking of instance culling program failed.\n== Start of link log\n%s\n== End of link log\n", log);
+        std::exit(EXIT_FAILURE);
+    }
+
+    glDeleteShader(vertex_shader_id);
+    glDeleteShader(geometry_shader_id);
+    return program_id;
+}
+
+void InstanceCull_Init(GLADloadproc load)
+{
+    if (!g_Enabled || g_Initialized)
+        return;
+
+    g_Program = CreateCullProgram();
+    g_ViewProjectionUniform = glGetUniformLocation(g_Program, "view_projection");
+
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major * 10 + minor >= 44)
+        g_DrawElementsIndirect = (PFNDRAWELEMENTSINDIRECTPROC)
+            gladProfileWrapProc("glDrawElementsIndirect", load("glDrawElementsIndirect"));
+    g_Indirect = (g_DrawElementsIndirect != NULL);
+    g_Stats.indirect = g_Indirect;
+    g_Initialized = true;
+}
+
+int InstanceCull_CreateSet(const glm::mat4* models, int count, int object_id, const glm::vec3& bbox_min,
+                           const glm::vec3& bbox_max)
+{
+    if (!g_Initialized || count <= 0)
+        return -1;
+    if (g_NumSets == INSTANCECULL_MAX_SETS)
+    {
+        fprintf(stderr, "ERROR: too many instance sets (max. %d).\n", INSTANCECULL_MAX_SETS);
+        std::exit(EXIT_FAILURE);
+    }
+
+    int index = g_NumSets++;
+    InstanceSet& set = g_Sets[index];
+    memset(&set, 0, sizeof(set));
+    set.count = count;
+
+    std::vector<MultiDrawRecord> records(count);
+    for (int i = 0; i < count; ++i)
+        MultiDraw_MakeRecord(models[i], object_id, bbox_min, bbox_max, &records[i]);
+    size_t bytes = count * sizeof(MultiDrawRecord);
+
+    glGenBuffers(1, &set.instance_buffer);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, set.instance_buffer);
+    glBufferData(GL_ARRAY_BUFFER, bytes, records.data(), GL_STATIC_DRAW);
+    glGenBuffers(2, set.visible_buffers);
+    for (int b = 0; b < 2; ++b)
+    {
+        GLState_BindBuffer(GL_ARRAY_BUFFER, set.visible_buffers[b]);
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_DYNAMIC_COPY);
+    }
+
+    // Os registros como atributos por vértice do programa do teste.
+    glGenVertexArrays(1, &set.cull_vao);
+    GLState_BindVertexArray(set.cull_vao);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, set.instance_buffer);
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        glVertexAttribPointer(column, 4, GL_FLOAT, GL_FALSE, sizeof(MultiDrawRecord),
+                              (void*)(offsetof(MultiDrawRecord, model) + column * 4*sizeof(float)));
+        glEnableVertexAttribArray(column);
+    }
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(MultiDrawRecord), (void*)offsetof(MultiDrawRecord, bbox_min));
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(MultiDrawRecord), (void*)offsetof(MultiDrawRecord, bbox_max));
+    glVertexAttribIPointer(6, 4, GL_INT, sizeof(MultiDrawRecord), (void*)offsetof(MultiDrawRecord, object_id));
+    for (GLuint location = 4; location <= 6; ++location)
+        glEnableVertexAttribArray(location);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState_BindVertexArray(0);
+
+    glGenVertexArrays(1, &set.draw_vao);
+    glGenQueries(2, set.queries);
+    if (g_Indirect)
+    {
+        glGenBuffers(1, &set.command_buffer);
+        GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, set.command_buffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+        GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    PerfHud_AddBufferMemory(3 * bytes);
+    g_Stats.sets       = g_NumSets;
+    g_Stats.instances += count;
+    return index;
+}
+
+void InstanceCull_BeginFrame(const glm::mat4& view, const glm::mat4& projection)
+{
+    if (g_NumSets == 0)
+        return;
+
+    // Com o comando indireto, as estatísticas usam os resultados do quadro
+    // anterior, se todos já estiverem disponíveis; a CPU não espera a GPU, e
+    // os quadros ainda pendentes ficam fora da média. Sem ele, os resultados
+    // são lidos em InstanceCull_Draw().
+    if (g_Indirect && g_Sets[0].tests > 0)
+    {
+        bool available = true;
+        for (int s = 0; s < g_NumSets && available; ++s)
+        {
+            GLuint ready = GL_TRUE;
+            if (g_Sets[s].tests > 0)
+                glGetQueryObjectuiv(g_Sets[s].queries[g_Sets[s].current], GL_QUERY_RESULT_AVAILABLE, &ready);
+            available = (ready == GL_TRUE);
+        }
+        for (int s = 0; s < g_NumSets && available; ++s)
+        {
+            InstanceSet& set = g_Sets[s];
+            if (set.tests == 0)
+                continue;
+            glGetQueryObjectuiv(set.queries[set.current], GL_QUERY_RESULT, &set.visible);
+            g_Stats.visible += set.visible;
+        }
+        if (available)
+            g_Stats.counted += 1;
+    }
+
+    glm::mat4 view_projection = projection * view;
+    GLState_UseProgram(g_Program);
+    GLState_UniformMatrix4fv(g_ViewProjectionUniform, 1, GL_FALSE, glm::value_ptr(view_projection));
+    GLState_Enable(GL_RASTERIZER_DISCARD);
+    for (int s = 0; s < g_NumSets; ++s)
+    {
+        InstanceSet& set = g_Sets[s];
+        set.current = (set.tests > 0) ? 1 - set.current : 0;
+        GLState_BindVertexArray(set.cull_vao);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, set.visible_buffers[set.current]);
+        glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, set.queries[set.current]);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, set.count);
+        glEndTransformFeedback();
+        glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+        set.tests += 1;
+        g_Stats.tested += set.count;
+    }
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    GLState_Disable(GL_RASTERIZER_DISCARD);
+    g_Stats.frames += 1;
+    if (!g_Indirect)
+        g_Stats.counted += 1;
+}
+
+// Copia para o VAO de desenho do conjunto os atributos da malha (posições,
+// normais e coordenadas de textura) e o buffer de índices do VAO do objeto.
+// Os registros visíveis são ligados depois, em InstanceCull_Draw().
+static void CopyMeshAttributes(InstanceSet* set, GLuint vertex_array_object_id)
+{
+    struct Attribute
+    {
+        GLint enabled, buffer, size, type, normalized, stride;
+        void* pointer;
+    } attributes[3];
+
+    GLState_BindVertexArray(vertex_array_object_id);
+    for (GLuint location = 0; location < 3; ++location)
+    {
+        Attribute& a = attributes[location];
+        glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &a.enabled);
+        glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &a.buffer);
+        glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_SIZE, &a.size);
+        glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_TYPE, &a.type);
+        glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &a.normalized);
+        glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &a.stride);
+        glGetVertexAttribPointerv(location, GL_VERTEX_ATTRIB_ARRAY_POINTER, &a.pointer);
+    }
+    GLint index_buffer = 0;
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer);
+
+    GLState_BindVertexArray(set->draw_vao);
+    for (GLuint location = 0; location < 3; ++location)
+    {
+        const Attribute& a = attributes[location];
+        if (!a.enabled || a.buffer == 0)
+        {
+            glDisableVertexAttribArray(location);
+            continue;
+        }
+        GLState_BindBuffer(GL_ARRAY_BUFFER, a.buffer);
+        glVertexAttribPointer(location, a.size, a.type, (GLboolean)a.normalized, a.stride, a.pointer);
+        glEnableVertexAttribArray(location);
+    }
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+    set->record_buffer = 0;
+    set->source_vao  = vertex_array_object_id;
+    set->arena_grows = MeshArena_GetStats().grows;
+    g_Stats.rebuilds += 1;
+}
+
+void InstanceCull_Draw(int set_index, GLuint vertex_array_object_id, GLenum mode, size_t first_index, size_t num_indices,
+                       GLint base_vertex)
+{
+    if (set_index < 0 || set_index >= g_NumSets || g_Sets[set_index].tests == 0)
+        return;
+
+    InstanceSet& set = g_Sets[set_index];
+    if (set.source_vao != vertex_array_object_id || set.arena_grows != MeshArena_GetStats().grows)
+        CopyMeshAttributes(&set, vertex_array_object_id);
+
+    // Sem o comando indireto, o teste deste quadro é usado se o resultado
+    // da query já estiver disponível. Se não estiver, a CPU não espera: são
+    // desenhados os registros e a contagem do teste do quadro anterior.
+    int pair = set.current;
+    if (!g_Indirect && set.tests > 1)
+    {
+        GLuint ready = GL_FALSE;
+        glGetQueryObjectuiv(set.queries[pair], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (ready == GL_FALSE)
+        {
+            pair = 1 - pair;
+            g_Stats.late += 1;
+        }
+    }
+
+    GLState_BindVertexArray(set.draw_vao);
+    if (set.record_buffer != set.visible_buffers[pair])
+    {
+        MultiDraw_SetRecordAttributes(set.visible_buffers[pair]);
+        set.record_buffer = set.visible_buffers[pair];
+    }
+    MultiDraw_UseRecords(true);
+    if (g_Indirect)
+    {
+        // O comando é escrito antes do resultado da query, que a GPU grava
+        // por cima de "instance_count".
+        DrawElementsIndirectCommand command = { (GLuint)num_indices, 0, (GLuint)first_index, base_vertex, 0 };
+        GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, set.command_buffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+        GLState_BindBuffer(GL_QUERY_BUFFER, set.command_buffer);
+        glGetQueryObjectuiv(set.queries[pair], GL_QUERY_RESULT, (GLuint*)offsetof(DrawElementsIndirectCommand, instance_count));
+        GLState_BindBuffer(GL_QUERY_BUFFER, 0);
+        g_DrawElementsIndirect(mode, GL_UNSIGNED_INT, (void*)0);
+        GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        // Disponível, ou do quadro anterior: só espera se a GPU estiver
+        // mais de um quadro atrasada.
+        glGetQueryObjectuiv(set.queries[pair], GL_QUERY_RESULT, &set.visible);
+        if (set.visible > 0)
+            glDrawElementsInstancedBaseVertex(mode, (GLsizei)num_indices, GL_UNSIGNED_INT,
+                                              (void*)(first_index * sizeof(GLuint)), set.visible, base_vertex);
+        g_Stats.visible += set.visible;
+    }
+    MultiDraw_UseRecords(false);
+
+    PerfHud_CountDraw(mode == GL_TRIANGLES ? set.visible * (num_indices / 3) : 0);
+}
+
+InstanceCullStats InstanceCull_GetStats()
+{
+    return g_Stats;
+}
+
+void InstanceCull_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "Instancias: desligadas (--no-instance-culling).\n");
+        return;
+    }
+
+    InstanceCullStats stats = InstanceCull_GetStats();
+    double frames  = (stats.frames > 0) ? (double)stats.frames : 1.0;
+    double counted = (stats.counted > 0) ? (double)stats.counted : 1.0;
+    fprintf(f, "Instancias: %lu em %d conjuntos, por quadro %.1f testadas e %.1f visiveis na GPU (%s), %lu desenhos com o teste do quadro anterior, %lu VAOs refeitos.\n",
+            stats.instances, stats.sets, stats.tested / frames, stats.visible / counted,
+            stats.indirect ? "contagem em comando indireto" : "contagem lida pela CPU", stats.late, stats.rebuilds);
+}
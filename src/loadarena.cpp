@@ -0,0 +1,84 @@
+// Arena linear do carregamento de modelos. Veja comentários em "include/loadarena.h".
+#include <cstdio>
+#include <cstdlib>
+
+#include "loadarena.h"
+
+static thread_local unsigned char* g_Block = NULL;
+static thread_local size_t g_Capacity = 0;
+static thread_local size_t g_Used = 0;
+static thread_local LoadArenaStats g_Stats = { 0, 0 };
+
+void LoadArena_Reserve(size_t size)
+{
+    g_Used = 0;
+    if (size <= g_Capacity)
+        return;
+
+    std::free(g_Block);
+    g_Block = (unsigned char*)std::malloc(size);
+    if (g_Block == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot allocate %lu bytes for the load arena.\n", (unsigned long)size);
+        std::exit(EXIT_FAILURE);
+    }
+    g_Capacity = size;
+
+    g_Stats.reserves += 1;
+    if (size > g_Stats.peak_capacity)
+        g_Stats.peak_capacity = size;
+}
+
+void* LoadArena_Alloc(size_t size, size_t align)
+{
+    // O bloco vem de malloc(), alinhado para qualquer tipo; alinhamos o
+    // endereço, e não apenas o deslocamento.
+    size_t base  = (size_t)g_Block;
+    size_t begin = ((base + g_Used + align - 1) & ~(align - 1)) - base;
+    if (g_Block == NULL || begin + size > g_Capacity)
+    {
+        fprintf(stderr, "ERROR: load arena exhausted (%lu of %lu bytes requested).\n",
+                (unsigned long)(begin + size), (unsigned long)g_Capacity);
+        std::exit(EXIT_FAILURE);
+    }
+    g_Used = begin + size;
+    return g_Block + begin;
+}
+
+void LoadArena_Release()
+{
+    std::free(g_Block);
+    g_Block = NULL;
+    g_Capacity = 0;
+    g_Used = 0;
+}
+
+void* LoadArena_Detach(size_t* capacity)
+{
+    void* block = g_Block;
+    *capacity = g_Capacity;
+    g_Block = NULL;
+    g_Capacity = 0;
+    g_Used = 0;
+    return block;
+}
+
+void LoadArena_FreeDetached(void* block)
+{
+    std::free(block);
+}
+
+size_t LoadArena_Used()
+{
+    return g_Used;
+}
+
+size_t LoadArena_Capacity()
+{
+    return g_Capacity;
+}
+
+LoadArenaStats LoadArena_GetStats()
+{
+    return g_Stats;
+}
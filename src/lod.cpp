@@ -0,0 +1,887 @@
+// Níveis de detalhe. Veja comentários em "include/lod.h".
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+
+#include "lod.h"
+
+// Frações dos triângulos originais buscadas em cada nível.
+static const double g_LevelRatios[MESH_MAX_LODS] = { 0.5, 0.25, 0.125 };
+
+// Um nível é guardado somente com no máximo LOD_KEEP_NUM/LOD_KEEP_DEN dos
+// triângulos do anterior.
+#define LOD_KEEP_NUM 3
+#define LOD_KEEP_DEN 5
+
+// Peso dos planos que prendem bordas e costuras, em relação aos planos dos
+// triângulos.
+#define LOD_BORDER_WEIGHT 10.0
+
+// Maior erro aceito em um colapso, em fração da diagonal da bounding box.
+#define LOD_MAX_ERROR 0.05
+
+// Menor cosseno entre a normal de um triângulo antes e depois de um colapso.
+#define LOD_MIN_NORMAL_COS 0.2
+
+size_t Lod_MaxExtraIndices(size_t num_indices)
+{
+    size_t triangles = num_indices / 3;
+    if (triangles < LOD_MIN_TRIANGLES)
+        return 0;
+
+    size_t extra = 0;
+    for (int level = 0; level < MESH_MAX_LODS; ++level)
+    {
+        triangles = triangles * LOD_KEEP_NUM / LOD_KEEP_DEN;
+        extra += 3 * triangles;
+    }
+    return extra;
+}
+
+// Quádrica simétrica 4x4 (somente a metade de cima) e a soma dos pesos dos
+// planos acumulados.
+struct Quadric
+{
+    double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+    double weight;
+};
+
+static void Quadric_AddPlane(Quadric* q, const double* n, double d, double w)
+{
+    q->a00 += w*n[0]*n[0]; q->a01 += w*n[0]*n[1]; q->a02 += w*n[0]*n[2]; q->a03 += w*n[0]*d;
+    q->a11 += w*n[1]*n[1]; q->a12 += w*n[1]*n[2]; q->a13 += w*n[1]*d;
+    q->a22 += w*n[2]*n[2]; q->a23 += w*n[2]*d;
+    q->a33 += w*d*d;
+    q->weight += w;
+}
+
+static void Quadric_Add(Quadric* q, const Quadric& r)
+{
+    q->a00 += r.a00; q->a01 += r.a01; q->a02 += r.a02; q->a03 += r.a03;
+    q->a11 += r.a11; q->a12 += r.a12; q->a13 += r.a13;
+    q->a22 += r.a22; q->a23 += r.a23;
+    q->a33 += r.a33;
+    q->weight += r.weight;
+}
+
+// Soma ponderada dos quadrados das distâncias de "v" aos planos.
+static double Quadric_Error(const Quadric& q, const double* v)
+{
+    double x = v[0], y = v[1], z = v[2];
+    double e = q.a00*x*x + 2.0*q.a01*x*y + 2.0*q.a02*x*z + 2.0*q.a03*x
+             + q.a11*y*y + 2.0*q.a12*y*z + 2.0*q.a13*y
+             + q.a22*z*z + 2.0*q.a23*z
+             + q.a33;
+    return fabs(e);
+}
+
+static void Sub(const double* a, const double* b, double* out)
+{
+    out[0] = a[0] - b[0]; out[1] = a[1] - b[1]; out[2] = a[2] - b[2];
+}
+
+static void Cross(const double* a, const double* b, double* out)
+{
+    out[0] = a[1]*b[2] - a[2]*b[1];
+    out[1] = a[2]*b[0] - a[0]*b[2];
+    out[2] = a[0]*b[1] - a[1]*b[0];
+}
+
+static double Dot(const double* a, const double* b)
+{
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+static void TriangleNormal(const double* a, const double* b, const double* c, double* n)
+{
+    double ab[3], ac[3];
+    Sub(b, a, ab);
+    Sub(c, a, ac);
+    Cross(ab, ac, n);
+}
+
+enum VertexKind
+{
+    VERTEX_MANIFOLD, // Interior, com uma só coordenada de textura
+    VERTEX_BORDER,   // Na borda de uma superfície aberta
+    VERTEX_SEAM,     // Em uma costura de coordenadas de textura
+    VERTEX_LOCKED    // Não é removido
+};
+
+// Simplificação de um objeto. Os "cantos" são as posições dos índices do
+// objeto em MeshData::indices (3 por triângulo); as "posições" são os cantos
+// soldados pela coordenada; as "cunhas" são os cantos soldados pela posição e
+// pela coordenada de textura.
+struct Simplifier
+{
+    const MeshData*      mesh;
+    size_t               first_index;
+    int                  num_corners;
+    bool                 has_texcoords;
+    bool                 has_normals;
+
+    std::vector<int>     position;     // Posição de cada canto
+    std::vector<int>     wedge;        // Cunha de cada canto
+    std::vector<int>     wedge_first;  // Cantos de cada cunha em wedge_corners
+    std::vector<int>     wedge_corners;
+
+    std::vector<double>  point;        // xyz de cada posição
+    std::vector<Quadric> quadric;
+    std::vector<unsigned char> kind;
+    std::vector<unsigned char> removed;
+    std::vector<int>     locked;       // Passada em que a posição foi travada
+
+    std::vector<int>     triangles;    // 3 cantos por triângulo
+    std::vector<unsigned char> alive;
+    int                  alive_count;
+
+    std::vector<int>     adjacency_first; // Triângulos vivos de cada posição
+    std::vector<int>     adjacency;
+
+    double               max_cost;        // Maior custo aceito até agora
+};
+
+struct Candidate
+{
+    double cost;
+    int    from;
+    int    to;
+};
+
+static bool CandidateLess(const Candidate& a, const Candidate& b)
+{
+    return a.cost < b.cost;
+}
+
+static unsigned int CornerVertex(const Simplifier& s, int corner)
+{
+    return s.mesh->indices[s.first_index + corner];
+}
+
+static const float* CornerPosition(const Simplifier& s, int corner)
+{
+    return &s.mesh->model_coefficients[4*CornerVertex(s, corner)];
+}
+
+static const float* CornerTexcoord(const Simplifier& s, int corner)
+{
+    return &s.mesh->texture_coefficients[2*CornerVertex(s, corner)];
+}
+
+static int CornerOf(const Simplifier& s, int t, int pos)
+{
+    for (int i = 0; i < 3; ++i)
+        if (s.position[s.triangles[3*t + i]] == pos)
+            return s.triangles[3*t + i];
+    return -1;
+}
+
+// Solda os cantos por posição e por cunha. As chaves são copiadas para a
+// ordenação, em vez de comparadas através dos índices.
+struct WeldKey
+{
+    float key[3]; // Posição, ou (posição, u, v)
+    int   corner;
+
+    bool operator<(const WeldKey& k) const
+    {
+        if (key[0] != k.key[0]) return key[0] < k.key[0];
+        if (key[1] != k.key[1]) return key[1] < k.key[1];
+        return key[2] < k.key[2];
+    }
+    bool operator!=(const WeldKey& k) const
+    {
+        return key[0] != k.key[0] || key[1] != k.key[1] || key[2] != k.key[2];
+    }
+};
+
+static void WeldCorners(Simplifier* s)
+{
+    int n = s->num_corners;
+    std::vector<WeldKey> keys(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const float* p = CornerPosition(*s, i);
+        WeldKey k = { { p[0], p[1], p[2] }, i };
+        keys[i] = k;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    s->position.resize(n);
+    int positions = -1;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i == 0 || keys[i-1] != keys[i])
+        {
+            positions += 1;
+            s->point.push_back(keys[i].key[0]);
+            s->point.push_back(keys[i].key[1]);
+            s->point.push_back(keys[i].key[2]);
+        }
+        s->position[keys[i].corner] = positions;
+    }
+    positions += 1;
+
+    // A posição vai como float: o índice é exato até 2^24 posições.
+    for (int i = 0; i < n; ++i)
+    {
+        int corner = keys[i].corner;
+        const float* t = s->has_texcoords ? CornerTexcoord(*s, corner) : NULL;
+        WeldKey k = { { (float)s->position[corner], t ? t[0] : 0.0f, t ? t[1] : 0.0f }, corner };
+        keys[i] = k;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    s->wedge.resize(n);
+    s->wedge_corners.resize(n);
+    int wedges = -1;
+    for (int i = 0; i < n; ++i)
+    {
+        if (i == 0 || keys[i-1] != keys[i])
+        {
+            wedges += 1;
+            s->wedge_first.push_back(i);
+        }
+        s->wedge[keys[i].corner] = wedges;
+        s->wedge_corners[i] = keys[i].corner;
+    }
+    s->wedge_first.push_back(n);
+
+    s->quadric.assign(positions, Quadric());
+    s->kind.assign(positions, VERTEX_MANIFOLD);
+    s->removed.assign(positions, 0);
+    s->locked.assign(positions, -1);
+}
+
+// Classifica as posições pelas arestas (borda, costura, não-manifold) e
+// acumula as quádricas dos triângulos e das arestas de borda e costura.
+static void ClassifyAndBuildQuadrics(Simplifier* s)
+{
+    int num_triangles = s->num_corners / 3;
+    s->triangles.resize(s->num_corners);
+    s->alive.assign(num_triangles, 1);
+    s->alive_count = num_triangles;
+
+    std::vector<double> normals(3*num_triangles);
+    for (int t = 0; t < num_triangles; ++t)
+    {
+        for (int i = 0; i < 3; ++i)
+            s->triangles[3*t + i] = 3*t + i;
+
+        int p0 = s->position[3*t], p1 = s->position[3*t + 1], p2 = s->position[3*t + 2];
+        if (p0 == p1 || p1 == p2 || p0 == p2)
+        {
+            // Triângulos degenerados não aparecem e não entram na topologia.
+            s->alive[t] = 0;
+            s->alive_count -= 1;
+            continue;
+        }
+
+        double* n = &normals[3*t];
+        TriangleNormal(&s->point[3*p0], &s->point[3*p1], &s->point[3*p2], n);
+        double length = sqrt(Dot(n, n));
+        if (length == 0.0)
+            continue;
+        n[0] /= length; n[1] /= length; n[2] /= length;
+        double d = -Dot(n, &s->point[3*p0]);
+        for (int i = 0; i < 3; ++i)
+            Quadric_AddPlane(&s->quadric[s->position[3*t + i]], n, d, 0.5 * length);
+    }
+
+    // Arestas (posição menor, posição maior, triângulo), ordenadas para
+    // agrupar os triângulos de cada aresta.
+    struct Edge
+    {
+        int a, b, t;
+        bool operator<(const Edge& e) const
+        {
+            if (a != e.a) return a < e.a;
+            if (b != e.b) return b < e.b;
+            return t < e.t;
+        }
+    };
+    std::vector<Edge> edges;
+    edges.reserve(s->num_corners);
+    for (int t = 0; t < num_triangles; ++t)
+    {
+        if (!s->alive[t])
+            continue;
+        for (int i = 0; i < 3; ++i)
+        {
+            int a = s->position[3*t + i], b = s->position[3*t + (i+1)%3];
+            Edge e = { std::min(a, b), std::max(a, b), t };
+            edges.push_back(e);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    int positions = (int)s->kind.size();
+    std::vector<int> border_edges(positions, 0), seam_edges(positions, 0);
+    std::vector<unsigned char> nonmanifold(positions, 0);
+    for (size_t first = 0; first < edges.size(); )
+    {
+        size_t last = first + 1;
+        while (last < edges.size() && edges[last].a == edges[first].a && edges[last].b == edges[first].b)
+            last += 1;
+
+        int a = edges[first].a, b = edges[first].b;
+        bool constrained = false;
+        if (last - first == 1)
+        {
+            border_edges[a] += 1;
+            border_edges[b] += 1;
+            constrained = true;
+        }
+        else if (last - first == 2)
+        {
+            int t0 = edges[first].t, t1 = edges[first + 1].t;
+            if (s->wedge[CornerOf(*s, t0, a)] != s->wedge[CornerOf(*s, t1, a)]
+                || s->wedge[CornerOf(*s, t0, b)] != s->wedge[CornerOf(*s, t1, b)])
+            {
+                seam_edges[a] += 1;
+                seam_edges[b] += 1;
+                constrained = true;
+            }
+        }
+        else
+        {
+            nonmanifold[a] = nonmanifold[b] = 1;
+        }
+
+        // Plano que contém a aresta e é perpendicular ao triângulo: prende a
+        // borda (ou costura) no lugar.
+        for (size_t e = first; constrained && e < last; ++e)
+        {
+            const double* n = &normals[3*edges[e].t];
+            double ab[3], plane[3];
+            Sub(&s->point[3*b], &s->point[3*a], ab);
+            Cross(ab, n, plane);
+            double length = sqrt(Dot(plane, plane));
+            if (length == 0.0)
+                continue;
+            plane[0] /= length; plane[1] /= length; plane[2] /= length;
+            double d = -Dot(plane, &s->point[3*a]);
+            double w = LOD_BORDER_WEIGHT * Dot(ab, ab);
+            Quadric_AddPlane(&s->quadric[a], plane, d, w);
+            Quadric_AddPlane(&s->quadric[b], plane, d, w);
+        }
+        first = last;
+    }
+
+    // Vértices com mais de uma cunha fora de uma costura simples (p.ex. a
+    // ponta de uma costura) também ficam travados.
+    std::vector<int> wedges_per_position(positions, 0);
+    for (size_t w = 0; w + 1 < s->wedge_first.size(); ++w)
+        wedges_per_position[s->position[s->wedge_corners[s->wedge_first[w]]]] += 1;
+
+    for (int p = 0; p < positions; ++p)
+    {
+        if (nonmanifold[p])
+            s->kind[p] = VERTEX_LOCKED;
+        else if (border_edges[p] == 0 && seam_edges[p] == 0)
+            s->kind[p] = (wedges_per_position[p] == 1) ? VERTEX_MANIFOLD : VERTEX_LOCKED;
+        else if (border_edges[p] == 2 && seam_edges[p] == 0)
+            s->kind[p] = (wedges_per_position[p] == 1) ? VERTEX_BORDER : VERTEX_LOCKED;
+        else if (border_edges[p] == 0 && seam_edges[p] == 2)
+            s->kind[p] = (wedges_per_position[p] == 2) ? VERTEX_SEAM : VERTEX_LOCKED;
+        else
+            s->kind[p] = VERTEX_LOCKED;
+    }
+}
+
+static void BuildAdjacency(Simplifier* s)
+{
+    int positions = (int)s->kind.size();
+    s->adjacency_first.assign(positions + 1, 0);
+    int num_triangles = s->num_corners / 3;
+    for (int t = 0; t < num_triangles; ++t)
+        if (s->alive[t])
+            for (int i = 0; i < 3; ++i)
+                s->adjacency_first[s->position[s->triangles[3*t + i]] + 1] += 1;
+    for (int p = 0; p < positions; ++p)
+        s->adjacency_first[p + 1] += s->adjacency_first[p];
+
+    s->adjacency.resize(s->adjacency_first[positions]);
+    std::vector<int> fill(s->adjacency_first.begin(), s->adjacency_first.end() - 1);
+    for (int t = 0; t < num_triangles; ++t)
+        if (s->alive[t])
+            for (int i = 0; i < 3; ++i)
+                s->adjacency[fill[s->position[s->triangles[3*t + i]]]++] = t;
+}
+
+// Triângulos vivos que contêm a aresta (p, q), até "max".
+static int EdgeTriangles(const Simplifier& s, int p, int q, int* out, int max)
+{
+    int count = 0;
+    for (int i = s.adjacency_first[p]; i < s.adjacency_first[p + 1]; ++i)
+    {
+        int t = s.adjacency[i];
+        if (CornerOf(s, t, q) >= 0)
+        {
+            if (count < max)
+                out[count] = t;
+            count += 1;
+        }
+    }
+    return count;
+}
+
+// Verifica se a posição "p" pode ser levada até "q" pela aresta entre elas.
+static bool CollapseAllowed(const Simplifier& s, int p, int q)
+{
+    // Todas as arestas de uma posição interior são interiores: os colapsos
+    // preservam a topologia (veja Collapse()).
+    if (s.kind[p] == VERTEX_MANIFOLD)
+        return true;
+
+    int edge[2];
+    int count = EdgeTriangles(s, p, q, edge, 2);
+    switch (s.kind[p])
+    {
+    case VERTEX_BORDER:
+        return count == 1;
+    case VERTEX_SEAM:
+        return count == 2
+            && (s.wedge[CornerOf(s, edge[0], p)] != s.wedge[CornerOf(s, edge[1], p)]
+                || s.wedge[CornerOf(s, edge[0], q)] != s.wedge[CornerOf(s, edge[1], q)]);
+    default:
+        return false;
+    }
+}
+
+static double CollapseCost(const Simplifier& s, int p, int q)
+{
+    const double* v = &s.point[3*q];
+    double weight = s.quadric[p].weight + s.quadric[q].weight;
+    double error = Quadric_Error(s.quadric[p], v) + Quadric_Error(s.quadric[q], v);
+    return (weight > 0.0) ? error / weight : 0.0;
+}
+
+static void CollectNeighbours(const Simplifier& s, int p, std::vector<int>* out)
+{
+    out->clear();
+    for (int i = s.adjacency_first[p]; i < s.adjacency_first[p + 1]; ++i)
+    {
+        int t = s.adjacency[i];
+        for (int j = 0; j < 3; ++j)
+        {
+            int v = s.position[s.triangles[3*t + j]];
+            if (v != p)
+                out->push_back(v);
+        }
+    }
+    std::sort(out->begin(), out->end());
+    out->erase(std::unique(out->begin(), out->end()), out->end());
+}
+
+// Leva a posição "p" até "q", se o resultado for válido. A adjacência de "p"
+// e "q" deve estar atualizada (nenhuma das duas travada nesta passada). As
+// posições cujo melhor colapso pode ter mudado são marcadas em "dirty".
+static bool Collapse(Simplifier* s, int p, int q, int pass, std::vector<int>* scratch, std::vector<unsigned char>* dirty)
+{
+    int edge[2];
+    int edge_count = EdgeTriangles(*s, p, q, edge, 2);
+    if (edge_count == 0 || edge_count > 2)
+        return false;
+
+    // Condição de ligação: os vizinhos comuns de "p" e "q" são somente os
+    // vértices opostos à aresta; senão o colapso muda a topologia.
+    std::vector<int>& neighbours_p = scratch[0];
+    std::vector<int>& neighbours_q = scratch[1];
+    CollectNeighbours(*s, p, &neighbours_p);
+    CollectNeighbours(*s, q, &neighbours_q);
+    int common = 0;
+    for (size_t i = 0, j = 0; i < neighbours_p.size() && j < neighbours_q.size(); )
+    {
+        if (neighbours_p[i] < neighbours_q[j]) ++i;
+        else if (neighbours_p[i] > neighbours_q[j]) ++j;
+        else { ++common; ++i; ++j; }
+    }
+    if (common != edge_count)
+        return false;
+
+    // Canto que substitui o de "p" em cada triângulo que sobrevive: o canto
+    // de "q" em um triângulo da aresta do mesmo lado da costura, isto é, com
+    // a mesma cunha em "p".
+    std::vector<int>& replacements = scratch[2];
+    replacements.clear();
+    const double* target = &s->point[3*q];
+    for (int i = s->adjacency_first[p]; i < s->adjacency_first[p + 1]; ++i)
+    {
+        int t = s->adjacency[i];
+        if (t == edge[0] || (edge_count == 2 && t == edge[1]))
+            continue;
+
+        int slot = 0;
+        while (s->position[s->triangles[3*t + slot]] != p)
+            slot += 1;
+        int wedge_p = s->wedge[s->triangles[3*t + slot]];
+
+        int replacement = -1;
+        for (int e = 0; e < edge_count && replacement < 0; ++e)
+            if (s->wedge[CornerOf(*s, edge[e], p)] == wedge_p)
+                replacement = CornerOf(*s, edge[e], q);
+        if (replacement < 0)
+            return false;
+
+        // O triângulo não pode inverter nem girar demais.
+        const double* v[3];
+        for (int j = 0; j < 3; ++j)
+            v[j] = &s->point[3*s->position[s->triangles[3*t + j]]];
+        double before[3], after[3];
+        TriangleNormal(v[0], v[1], v[2], before);
+        v[slot] = target;
+        TriangleNormal(v[0], v[1], v[2], after);
+        double cosine = Dot(before, after);
+        if (cosine <= LOD_MIN_NORMAL_COS * sqrt(Dot(before, before) * Dot(after, after)))
+            return false;
+
+        replacements.push_back(3*t + slot);
+        replacements.push_back(replacement);
+    }
+
+    for (size_t r = 0; r < replacements.size(); r += 2)
+        s->triangles[replacements[r]] = replacements[r + 1];
+    for (int e = 0; e < edge_count; ++e)
+    {
+        s->alive[edge[e]] = 0;
+        s->alive_count -= 1;
+    }
+
+    // Todos os vizinhos de "p" têm a adjacência alterada: ficam travados até
+    // a próxima passada.
+    for (size_t i = 0; i < neighbours_p.size(); ++i)
+    {
+        s->locked[neighbours_p[i]] = pass;
+        (*dirty)[neighbours_p[i]] = 1;
+    }
+    for (size_t i = 0; i < neighbours_q.size(); ++i)
+        (*dirty)[neighbours_q[i]] = 1;
+    s->locked[p] = pass;
+    s->removed[p] = 1;
+    Quadric_Add(&s->quadric[q], s->quadric[p]);
+    return true;
+}
+
+// Colapsa arestas até o objeto ter no máximo "target" triângulos, ou até não
+// haver colapso válido com erro abaixo de "cost_limit".
+static void Simplify(Simplifier* s, int target, double cost_limit)
+{
+    std::vector<Candidate> candidates;
+    std::vector<int> scratch[3];
+    int positions = (int)s->kind.size();
+
+    // Melhor colapso de cada posição, recalculado somente para as posições
+    // cuja vizinhança mudou desde a passada anterior.
+    Candidate none = { 0.0, -1, -1 };
+    std::vector<Candidate> best(positions, none);
+    std::vector<unsigned char> dirty(positions, 1);
+
+    for (int pass = 0; s->alive_count > target; ++pass)
+    {
+        BuildAdjacency(s);
+
+        candidates.clear();
+        for (int p = 0; p < positions; ++p)
+        {
+            if (s->removed[p] || s->kind[p] == VERTEX_LOCKED)
+                continue;
+            if (dirty[p])
+            {
+                // Cada vizinho aparece em dois triângulos e é avaliado duas
+                // vezes, o que custa menos que eliminar as repetições.
+                dirty[p] = 0;
+                best[p] = none;
+                for (int i = s->adjacency_first[p]; i < s->adjacency_first[p + 1]; ++i)
+                {
+                    const int* corners = &s->triangles[3*s->adjacency[i]];
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        int q = s->position[corners[j]];
+                        if (q == p || !CollapseAllowed(*s, p, q))
+                            continue;
+                        double cost = CollapseCost(*s, p, q);
+                        if (best[p].to < 0 || cost < best[p].cost)
+                        {
+                            best[p].cost = cost;
+                            best[p].from = p;
+                            best[p].to   = q;
+                        }
+                    }
+                }
+            }
+            if (best[p].to >= 0 && best[p].cost <= cost_limit)
+                candidates.push_back(best[p]);
+        }
+        std::sort(candidates.begin(), candidates.end(), CandidateLess);
+
+        int collapses = 0;
+        for (size_t c = 0; c < candidates.size() && s->alive_count > target; ++c)
+        {
+            const Candidate& candidate = candidates[c];
+            if (s->locked[candidate.from] == pass || s->locked[candidate.to] == pass)
+                continue;
+            if (!Collapse(s, candidate.from, candidate.to, pass, scratch, &dirty))
+                continue;
+            s->max_cost = std::max(s->max_cost, candidate.cost);
+            collapses += 1;
+        }
+        if (collapses == 0)
+            break;
+    }
+}
+
+// Acrescenta os triângulos vivos a mesh->indices, escolhendo para cada canto
+// o vértice da mesma cunha com a normal mais próxima da do triângulo.
+static void EmitLevel(const Simplifier& s, MeshData* mesh)
+{
+    int num_triangles = s.num_corners / 3;
+    for (int t = 0; t < num_triangles; ++t)
+    {
+        if (!s.alive[t])
+            continue;
+
+        const int* corners = &s.triangles[3*t];
+        double normal[3];
+        TriangleNormal(&s.point[3*s.position[corners[0]]], &s.point[3*s.position[corners[1]]],
+                       &s.point[3*s.position[corners[2]]], normal);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            int chosen = corners[i];
+            if (s.has_normals)
+            {
+                int w = s.wedge[corners[i]];
+                double best = -HUGE_VAL;
+                for (int j = s.wedge_first[w]; j < s.wedge_first[w + 1]; ++j)
+                {
+                    int corner = s.wedge_corners[j];
+                    const float* n = &mesh->normal_coefficients[4*CornerVertex(s, corner)];
+                    double cosine = normal[0]*n[0] + normal[1]*n[1] + normal[2]*n[2];
+                    if (cosine > best)
+                    {
+                        best = cosine;
+                        chosen = corner;
+                    }
+                }
+            }
+            unsigned int vertex = CornerVertex(s, chosen);
+            mesh->indices.push_back(vertex);
+        }
+    }
+}
+
+static void BuildShapeLevels(MeshData* mesh, MeshShape* shape)
+{
+    Simplifier s;
+    s.mesh          = mesh;
+    s.first_index   = shape->first_index;
+    s.num_corners   = (int)shape->num_indices;
+    size_t num_vertices = mesh->model_coefficients.size() / 4;
+    s.has_texcoords = mesh->texture_coefficients.size() == 2*num_vertices;
+    s.has_normals   = mesh->normal_coefficients.size() == 4*num_vertices;
+    s.max_cost      = 0.0;
+
+    WeldCorners(&s);
+    ClassifyAndBuildQuadrics(&s);
+
+    glm::vec3 diagonal = shape->bbox_max - shape->bbox_min;
+    double max_error = LOD_MAX_ERROR * sqrt((double)glm::dot(diagonal, diagonal));
+
+    int original = (int)(shape->num_indices / 3);
+    int previous = original;
+    for (int level = 0; level < MESH_MAX_LODS; ++level)
+    {
+        Simplify(&s, (int)(original * g_LevelRatios[level]), max_error * max_error);
+
+        // Com poucos colapsos válidos o nível não compensa, e os seguintes
+        // também não.
+        if ((size_t)s.alive_count * LOD_KEEP_DEN > (size_t)previous * LOD_KEEP_NUM)
+            break;
+
+        shape->lods.first_index[level] = mesh->indices.size();
+        shape->lods.num_indices[level] = 3 * (size_t)s.alive_count;
+        shape->lods.error[level]       = (float)sqrt(s.max_cost);
+        shape->lods.count              = level + 1;
+        EmitLevel(s, mesh);
+        previous = s.alive_count;
+    }
+}
+
+void Lod_BuildLevels(MeshData* mesh)
+{
+    for (size_t shape = 0; shape < mesh->shapes.size(); ++shape)
+    {
+        MeshShape& theshape = mesh->shapes[shape];
+        theshape.lods.count = 0;
+        if (Lod_MaxExtraIndices(theshape.num_indices) > 0)
+            BuildShapeLevels(mesh, &theshape);
+    }
+}
+
+static bool          g_Enabled = true;
+static float         g_ErrorPixels = LOD_DEFAULT_ERROR_PIXELS;
+static int           g_ViewportHeight = 600;
+static glm::mat4     g_View;
+static glm::mat4     g_Projection;
+static unsigned long g_Frame = 0;
+static LodStats      g_Stats;
+
+bool Lod_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--no-lod") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    if (strcmp(argv[*i], "--lod-error") == 0 && *i + 1 < argc)
+    {
+        g_ErrorPixels = (float)atof(argv[++*i]);
+        return true;
+    }
+    return false;
+}
+
+void Lod_SetViewportHeight(int height)
+{
+    g_ViewportHeight = height;
+}
+
+void Lod_BeginFrame(const glm::mat4& view, const glm::mat4& projection)
+{
+    g_View       = view;
+    g_Projection = projection;
+    g_Frame     += 1;
+}
+
+// Instância de "state" para um desenho com "object_id" e centro "center":
+// dentre as ainda não desenhadas neste quadro e com o mesmo "object_id", a
+// de centro mais próximo, a menos de "radius"; senão uma posição livre ou
+// sem desenho no quadro anterior, reiniciada. NULL se todas estiverem em uso.
+static LodInstance* FindInstance(LodState* state, int object_id, const glm::vec3& center, float radius)
+{
+    LodInstance* nearest = NULL;
+    float nearest_distance = 0.0f;
+    LodInstance* unused = NULL;
+    for (int i = 0; i < LOD_MAX_INSTANCES; ++i)
+    {
+        LodInstance* instance = &state->instances[i];
+        if (instance->frame == g_Frame)
+            continue;
+        if (instance->frame != 0 && instance->object_id == object_id)
+        {
+            float distance = glm::length(instance->center - center);
+            if (distance <= radius && (nearest == NULL || distance < nearest_distance))
+            {
+                nearest = instance;
+                nearest_distance = distance;
+            }
+        }
+        if (instance->frame + 1 < g_Frame && (unused == NULL || instance->frame < unused->frame))
+            unused = instance;
+    }
+    if (nearest != NULL)
+        return nearest;
+    if (unused != NULL)
+    {
+        unused->object_id = object_id;
+        unused->level = 0;
+    }
+    return unused;
+}
+
+int Lod_Select(const MeshLods& lods, size_t num_indices, LodState* state, int object_id, const glm::mat4& model,
+               const glm::vec3& bbox_min, const glm::vec3& bbox_max)
+{
+    if (lods.count == 0 || !g_Enabled)
+        return 0;
+
+    // Pixels por unidade do modelo, no ponto da esfera envolvente mais
+    // próximo da câmera. Na projeção perspectiva (projection[2][3] != 0) o
+    // tamanho na tela é dividido pela profundidade.
+    float scale = std::max(glm::length(glm::vec3(model[0])),
+                  std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    glm::vec3 center = 0.5f * (bbox_min + bbox_max);
+    float radius = 0.5f * glm::length(bbox_max - bbox_min) * scale;
+    float pixels_per_unit = fabsf(g_Projection[1][1]) * 0.5f * g_ViewportHeight * scale;
+    if (g_Projection[2][3] != 0.0f)
+    {
+        float depth = -(g_View * model * glm::vec4(center, 1.0f)).z;
+        if (depth + radius <= 0.0f)
+            pixels_per_unit = 0.0f; // Todo atrás da câmera
+        else if (depth - radius <= 1e-3f)
+            pixels_per_unit = HUGE_VALF; // Câmera dentro da esfera
+        else
+            pixels_per_unit /= depth - radius;
+    }
+
+    // "fine": nível mais simples dentro do limite; "coarse": dentro do
+    // limite com a folga da histerese. O erro cresce com o nível.
+    int fine = 0, coarse = 0;
+    for (int level = 1; level <= lods.count; ++level)
+    {
+        float pixels = lods.error[level - 1] * pixels_per_unit;
+        if (pixels <= g_ErrorPixels)
+            fine = level;
+        if (pixels <= g_ErrorPixels * (1.0f - LOD_HYSTERESIS))
+            coarse = level;
+    }
+
+    int level = fine;
+    glm::vec3 world_center = glm::vec3(model * glm::vec4(center, 1.0f));
+    LodInstance* instance = FindInstance(state, object_id, world_center, radius);
+    if (instance != NULL)
+    {
+        int current = instance->level;
+        level = std::min(std::max(current, coarse), fine);
+        if (level != current)
+            g_Stats.switches += 1;
+        instance->level  = level;
+        instance->center = world_center;
+        instance->frame  = g_Frame;
+    }
+
+    g_Stats.draws += 1;
+    g_Stats.level_draws[level] += 1;
+    g_Stats.full_triangles  += num_indices / 3;
+    g_Stats.drawn_triangles += (level > 0 ? lods.num_indices[level - 1] : num_indices) / 3;
+    return level;
+}
+
+int Lod_SelectForScale(const MeshLods& lods, float pixels_per_unit)
+{
+    if (!g_Enabled)
+        return 0;
+
+    int level = 0;
+    while (level < lods.count && lods.error[level] * pixels_per_unit <= g_ErrorPixels)
+        ++level;
+    return level;
+}
+
+LodStats Lod_GetStats()
+{
+    return g_Stats;
+}
+
+void Lod_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "LOD: desligado (--no-lod).\n");
+        return;
+    }
+
+    LodStats stats = Lod_GetStats();
+    double reduction = (stats.full_triangles > 0) ? 100.0 * (1.0 - (double)stats.drawn_triangles / stats.full_triangles) : 0.0;
+    fprintf(f, "LOD: %lu desenhos de objetos com niveis de detalhe (por nivel:", stats.draws);
+    for (int level = 0; level <= MESH_MAX_LODS; ++level)
+        fprintf(f, " %lu", stats.level_draws[level]);
+    fprintf(f, "), %llu de %llu triangulos desenhados (%.1f%% a menos), %lu trocas de nivel.\n",
+            stats.drawn_triangles, stats.full_triangles, reduction, stats.switches);
+}
@@ -43,6 +43,7 @@
 
 // Headers das bibliotecas OpenGL
 #include <glad/glad.h>   // Criação de contexto OpenGL 3.3
+#include <glad/glad_profile.h> // Contadores de chamadas OpenGL (somente com "make profile")
 #include <GLFW/glfw3.h>  // Criação de janelas do sistema operacional
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
@@ -58,49 +59,68 @@
 // Headers locais, definidos na pasta "include/"
 #include "utils.h"
 #include "matrices.h"
+#include "geometry.h"
+#include "objmodel.h"
+#include "glstate.h"
+#include "gputimer.h"
+#include "trace.h"
+#include "bench.h"
+#include "replay.h"
+#include "golden.h"
+#include "alloctrack.h"
+#include "framearena.h"
+#include "perfhud.h"
+#include "assetstats.h"
+#include "streaming.h"
+#include "assetpack.h"
+#include "assetio.h"
+#include "texturecache.h"
+#include "lod.h"
+#include "impostor.h"
+#include "meshlet.h"
+#include "staticbatch.h"
+#include "mesharena.h"
+#include "multidraw.h"
+#include "instancecull.h"
 
-// Estrutura que representa um modelo geométrico carregado a partir de um
-// arquivo ".obj".
-struct ObjModel
-{
-    tinyobj::attrib_t                 attrib;
-    std::vector<tinyobj::shape_t>     shapes;
-    std::vector<tinyobj::material_t>  materials;
-
-    // Este construtor lê o modelo de um arquivo utilizando a biblioteca tinyobjloader.
-    ObjModel(const char* filename, const char* basepath = "../../data/", bool triangulate = true)
-    {
-        printf("Carregando modelo \"%s\"... ", filename);
-
-        char filepath[100];
-        strcpy(filepath, filename);
-        strcat(filepath, ".obj");
-
-        std::string err;
-        bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filepath, basepath, triangulate);
-
-        if (!err.empty())
-            fprintf(stderr, "\n%s\n", err.c_str());
-
-        if (!ret)
-            throw std::runtime_error("Erro ao carregar modelo.");
-
-        printf("OK.\n");
-    }
-};
 
 
 // Declaração de funções utilizadas para pilha de matrizes de modelagem.
 void PushMatrix(glm::mat4 M);
 void PopMatrix(glm::mat4& M);
 
+// Recursos registrados para carregamento sob demanda com cada nome de arquivo.
+typedef std::map<std::string, std::vector<int> > StreamedAssets;
+
 // Declaração de várias funções utilizadas em main().  Essas estão definidas
 // logo após a definição de main() neste arquivo.
-void BuildTrianglesAndAddToVirtualScene(ObjModel*); // Constrói representação de um ObjModel como malha de triângulos para renderização
-void ComputeNormals(ObjModel* model); // Computa normais de um ObjModel, caso não existam.
+void BuildTrianglesAndAddToVirtualScene(ObjModel*, AssetStats*); // Constrói representação de um ObjModel como malha de triângulos para renderização
+void LoadCookedMeshAndAddToVirtualScene(const char* objpath, AssetStats* stats); // Idem, com uma malha do pacote de recursos
+void AddMeshToVirtualScene(const MeshData* mesh, AssetStats* stats, MeshBuffers* buffers); // Copia uma malha montada para a GPU
+void AddUploadedMeshToVirtualScene(const MeshData* mesh, AssetStats* stats, MeshBuffers* buffers); // Registra uma malha enviada pela thread de envio
+void RemoveMeshFromVirtualScene(const MeshBuffers* buffers); // Apaga uma malha da GPU, trocando-a pelo substituto
+void BuildPlaceholders(); // Cria a malha e a textura desenhadas no lugar de recursos ausentes (veja streaming.h)
+void AddPlaceholderToVirtualScene(const char* name); // Registra um objeto ainda ausente
 void LoadShadersFromFiles(); // Carrega os shaders de vértice e fragmento, criando um programa de GPU
 void LoadTextureImage(const char* filename); // Função que carrega imagens de textura
-void DrawVirtualObject(const char* object_name); // Desenha um objeto armazenado em g_VirtualScene
+void QueueTextureImage(const char* filename); // Registra uma textura para a leitura em lote (veja assetio.h)
+void QueueModel(const char* filepath, const char* basepath); // Idem, para um modelo
+void LoadQueuedAssets(); // Lê todos os recursos registrados acima
+void LoadOrStreamTextureImage(const char* filename, StreamedAssets* streamed); // Carrega agora, ou registra para carregamento sob demanda
+GLuint UploadTextureImage(GLuint textureunit, const unsigned char* data, int width, int height, uint64_t content_hash, AssetStats* stats); // Copia uma imagem para a GPU
+GLuint BindUploadedTextureImage(GLuint textureunit, GLuint texture_id, int width, int height, uint64_t content_hash, AssetStats* stats); // Liga uma textura criada pela thread de envio
+size_t RemoveTextureImage(GLuint textureunit, GLuint texture_id, size_t bytes); // Apaga uma textura, trocando-a pelo substituto
+void SetObjectId(GLint object_id); // Define o "object_id" dos shaders para os próximos desenhos
+void DrawVirtualObject(const char* object_name, const glm::mat4& model); // Desenha um objeto armazenado em g_VirtualScene
+bool BakeImpostorView(const char* name, int object_id, const glm::mat4& view, const glm::mat4& projection); // Desenha uma vista de um impostor (veja impostor.h)
+void InitImpostors(); // Registra os objetos expostos que podem virar impostores
+glm::mat4 ModelMuseu();              // Matrizes de modelagem dos objetos que nunca se movem
+glm::mat4 ModelEstande(int estande); // (veja staticbatch.h)
+glm::mat4 ModelDinossauro();
+void InitStaticBatches(); // Junta os objetos que nunca se movem em lotes
+void DrawStaticBatches(); // Desenha os lotes estáticos
+void InitInstanceSets();  // Cria os conjuntos de instâncias testadas na GPU
+void DrawInstances(int set, const char* object_name); // Desenha as instâncias visíveis de um conjunto (veja instancecull.h)
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
 void LoadShader(const char* filename, GLuint shader_id); // Função utilizada pelas duas acima
@@ -110,9 +130,10 @@ void PrintObjModelInfo(ObjModel*); // Função para debugging
 // Declaração de funções auxiliares para renderizar texto dentro da janela
 // OpenGL. Estas funções estão definidas no arquivo "textrendering.cpp".
 void TextRendering_Init();
+void TextRendering_SetWindowSize(int width, int height); // Usado quando não há janela (modo --bench)
 float TextRendering_LineHeight(GLFWwindow* window);
 float TextRendering_CharWidth(GLFWwindow* window);
-void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f);
+void TextRendering_PrintString(GLFWwindow* window, const char* str, float x, float y, float scale = 1.0f);
 void TextRendering_PrintMatrix(GLFWwindow* window, glm::mat4 M, float x, float y, float scale = 1.0f);
 void TextRendering_PrintVector(GLFWwindow* window, glm::vec4 v, float x, float y, float scale = 1.0f);
 void TextRendering_PrintMatrixVectorProduct(GLFWwindow* window, glm::mat4 M, glm::vec4 v, float x, float y, float scale = 1.0f);
@@ -124,6 +145,8 @@ void TextRendering_PrintMatrixVectorProductDivW(GLFWwindow* window, glm::mat4 M,
 void TextRendering_ShowModelViewProjection(GLFWwindow* window, glm::mat4 projection, glm::mat4 view, glm::mat4 model, glm::vec4 p_model);
 
 void informative_text_stand(GLFWwindow* window);
+void TextRendering_ShowGpuTimers(GLFWwindow* window); // Tempos de GPU/CPU por etapa (veja gputimer.h)
+void TextRendering_ShowPerfHud(GLFWwindow* window);   // Painel de desempenho (veja perfhud.h)
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -135,22 +158,7 @@ void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 
 template <typename T> int sgn(T val);
-bool check_inside_museum(float x, float z);
-bool check_estande(struct square_bbox estande, float x, float z);
-bool check_estandes(float x, float z);
-bool check_dino(float x, float z);
-bool check_colision(float x, float z);
-
-float F_p1_p2(glm::vec3 v, glm::vec3 a, float x, float z);
-
-float absolute_float(float v);
-glm::vec4 bezier(float t, glm::vec4 p1, glm::vec4 p2, glm::vec4 p3, glm::vec4 p4);
-bool interseccao_caixa_caixa(struct box_obj obj1, struct box_obj obj2);
-bool interseccao_esfera_esfera(struct sphere_obj obj1, struct sphere_obj obj2);
-bool interseccao_caixa_esfera(struct box_obj caixa, struct sphere_obj esfera);
-bool interseccao_caixa_plano(struct box_obj caixa, struct plane_obj plano);
-bool interseccao_esfera_plano(struct sphere_obj esfera, struct plane_obj plano);
-bool check_colision(float x, float z);
+double current_time(); // Tempo atual em segundos (real ou simulado)
 
 // Definimos uma estrutura que armazenará dados necessários para renderizar
 // cada objeto da cena virtual.
@@ -161,8 +169,12 @@ struct SceneObject
     size_t       num_indices; // Número de índices do objeto dentro do vetor indices[] definido em BuildTrianglesAndAddToVirtualScene()
     GLenum       rendering_mode; // Modo de rasterização (GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.)
     GLuint       vertex_array_object_id; // ID do VAO onde estão armazenados os atributos do modelo
+    GLint        base_vertex; // Somado aos índices do objeto (glDrawElementsBaseVertex(), veja mesharena.h)
     glm::vec3    bbox_min; // Axis-Aligned Bounding Box do objeto
     glm::vec3    bbox_max;
+    MeshLods     lods;      // Níveis de detalhe (veja lod.h)
+    LodState     lod_state; // Nível escolhido para cada instância do objeto
+    MeshletSet   meshlets;  // Grupos de triângulos da malha original (veja meshlet.h)
 };
 
 // Abaixo definimos variáveis globais utilizadas em várias funções do código.
@@ -173,8 +185,10 @@ struct SceneObject
 // estes são acessados.
 std::map<std::string, SceneObject> g_VirtualScene;
 
-// Pilha que guardará as matrizes de modelagem.
-std::stack<glm::mat4>  g_MatrixStack;
+// Pilha que guardará as matrizes de modelagem. Sobre um std::vector, e não
+// sobre o std::deque padrão, para que empilhar e desempilhar a cada quadro
+// não aloque memória após a pilha atingir sua profundidade máxima.
+std::stack<glm::mat4, std::vector<glm::mat4> >  g_MatrixStack;
 
 // Razão de proporção da janela (largura/altura). Veja função FramebufferSizeCallback().
 float g_ScreenRatio = 1.0f;
@@ -250,10 +264,35 @@ float y;
 float z;
 float x;
 
-#define QUANT_ESTANDE 18
 std::vector<glm::vec4> posicoes_estandes;
 int estande_atual = 0;
 
+// Arquivos (modelos e texturas, sem o diretório e a extensão) usados pelos
+// objetos expostos em cada estande, para o carregamento sob demanda (veja
+// streaming.h). O museu, os pedestais e o dinossauro estão sempre carregados.
+#define NUM_ESTANDES 18
+#define MAX_ARQUIVOS_ESTANDE 6
+static const char* const g_ArquivosEstande[NUM_ESTANDES][MAX_ARQUIVOS_ESTANDE] = {
+    /*  1 */ { "plano_gc_real" },
+    /*  2 */ { "vetor", "azul", "amarelo" },
+    /*  3 */ { "cubo", "plano" },
+    /*  4 */ { "triangulo" },
+    /*  5 */ { "cow" },
+    /*  6 */ { "cubo" },
+    /*  7 */ { "cubo" },
+    /*  8 */ { "rosquinha_1", "rosquinha_2" },
+    /*  9 */ { "cow" },
+    /* 10 */ { "lampada", "vermelho", "azul", "verde", "rosa", "amarelo" },
+    /* 11 */ { "esfera" },
+    /* 12 */ { "esfera" },
+    /* 13 */ { "esfera" },
+    /* 14 */ { "chaleira" },
+    /* 15 */ { "chaleira" },
+    /* 16 */ { "chaleira" },
+    /* 17 */ { "chaleira" },
+    /* 18 */ { "plano", "cubo", "esfera" },
+};
+
 int opcao_estande1 = 0;
 
 int cor_lampada = 1;
@@ -282,30 +321,6 @@ float g_ForearmAngleZ = 0.0f;
 float g_TorsoPositionX = 0.0f;
 float g_TorsoPositionY = 0.0f;
 
-struct square_bbox{
-    glm::vec3   p1;
-    glm::vec3   p2;
-    glm::vec3   p3;
-    glm::vec3   p4;
-};
-
-struct box_obj {
-    glm::vec3   c; // center
-    float       x_size; // distance from center to x
-    float       y_size; // distance from center to y
-    float       z_size; // distance from center to z
-};
-
-struct sphere_obj {
-    glm::vec3   c; // center
-    float       r; // radius
-};
-
-struct plane_obj {
-    glm::vec3   c; // center
-    float       x_size; // distance from center to x
-    float       z_size; // distance from center to z
-};
 
 
 // Valor inicial do tempo
@@ -314,9 +329,6 @@ double time_now;
 double passo_tempo;
 
 
-struct square_bbox Museu;
-std::vector<square_bbox> estandes_bbox;
-struct square_bbox Dino;
 
 // Variável que controla o tipo de projeção utilizada: perspectiva ou ortográfica.
 bool g_UsePerspectiveProjection = true;
@@ -324,6 +336,10 @@ bool g_UsePerspectiveProjection = true;
 // Variável que controla se o texto informativo será mostrado na tela.
 bool g_ShowInfoText = true;
 
+// Variável que controla se os tempos de cada etapa da renderização serão
+// mostrados na tela (tecla F4).
+bool g_ShowGpuTimers = false;
+
 // Variáveis que definem um programa de GPU (shaders). Veja função LoadShadersFromFiles().
 GLuint vertex_shader_id;
 GLuint fragment_shader_id;
@@ -338,69 +354,155 @@ GLint estande_shader;
 GLint acerto_ou_erro_est1;
 GLint cor_lampada_shader;
 GLint direcao_textura_plana_shader;
+GLint impostor_bake_uniform;
+GLint static_batch_uniform;
+GLint multi_draw_uniform;
+
+// Último valor enviado para "object_id" (veja SetObjectId()).
+GLint g_ObjectId = 0;
+
+// Conjuntos de instâncias testadas na GPU (veja InitInstanceSets()), -1
+// enquanto não existem, e as matrizes da multidão de "--crowd".
+int g_StandInstances = -1;
+int g_CrowdInstances = -1;
+std::vector<glm::mat4> g_CrowdModels;
 
 // Número de texturas carregadas pela função LoadTextureImage()
 GLuint g_NumLoadedTextures = 0;
 
 int main(int argc, char* argv[])
 {
-    // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
-    // sistema operacional, onde poderemos renderizar com OpenGL.
-    int success = glfwInit();
-    if (!success)
+    // Relógio do rastreamento de trechos do programa (somente com "make
+    // trace"); o carregamento da cena aparece como um único trecho.
+    TRACE_INIT();
+    TRACE_THREAD_NAME("principal");
+    TRACE_BEGIN("carregamento");
+
+    // Início da contagem do tempo até o primeiro quadro e até a cena completa.
+    double startup_start_ms = AssetStats_NowMs();
+
+    // Argumentos "--bench*" (veja bench.h), "--record"/"--replay*" (veja
+    // replay.h), "--golden*" (veja golden.h), "--stream*" (veja
+    // streaming.h), "--pack" (veja assetpack.h), "--io" (veja assetio.h),
+    // "--no-lod"/"--lod-error" (veja lod.h), "--no-impostors"/
+    // "--impostor-pixels" (veja impostor.h), "--no-meshlets" (veja
+    // meshlet.h), "--static-batching"/"--static-batch-vertices" (veja
+    // staticbatch.h), "--no-mesh-arena" (veja mesharena.h),
+    // "--no-multi-draw" (veja multidraw.h) e "--no-instance-culling"/
+    // "--crowd" (veja instancecull.h). O argumento restante, se houver, é um
+    // modelo OBJ extra.
+    BenchConfig bench;
+    Bench_InitConfig(&bench);
+    const char* extra_model = NULL;
+    for (int i = 1; i < argc; ++i)
     {
-        fprintf(stderr, "ERROR: glfwInit() failed.\n");
-        std::exit(EXIT_FAILURE);
+        if (Bench_ParseArg(argc, argv, &i, &bench) || Replay_ParseArg(argc, argv, &i) || Golden_ParseArg(argc, argv, &i)
+            || Streaming_ParseArg(argc, argv, &i) || AssetPack_ParseArg(argc, argv, &i) || AssetIO_ParseArg(argc, argv, &i)
+            || Lod_ParseArg(argc, argv, &i) || Impostor_ParseArg(argc, argv, &i) || Meshlet_ParseArg(argc, argv, &i)
+            || StaticBatch_ParseArg(argc, argv, &i) || MeshArena_ParseArg(argc, argv, &i)
+            || MultiDraw_ParseArg(argc, argv, &i) || InstanceCull_ParseArg(argc, argv, &i))
+            continue;
+        extra_model = argv[i];
+    }
+
+    // O teste de regressão visual ("--golden", veja golden.h) roda como um
+    // benchmark com roteiro próprio.
+    if (Golden_IsEnabled())
+    {
+        bench.enabled = true;
+        Golden_Start(bench.width, bench.height);
     }
+    if (bench.enabled)
+        Bench_Start();
+
+    // No modo --bench tentamos primeiro criar um contexto OpenGL sem janela,
+    // que não depende de um servidor gráfico.
+    GLFWwindow* window = NULL;
+    bool headless = bench.enabled && Bench_CreateContext();
+
+    if (!headless)
+    {
+        // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
+        // sistema operacional, onde poderemos renderizar com OpenGL.
+        int success = glfwInit();
+        if (!success)
+        {
+            fprintf(stderr, "ERROR: glfwInit() failed.\n");
+            std::exit(EXIT_FAILURE);
+        }
 
-    // Definimos o callback para impressão de erros da GLFW no terminal
-    glfwSetErrorCallback(ErrorCallback);
+        // Definimos o callback para impressão de erros da GLFW no terminal
+        glfwSetErrorCallback(ErrorCallback);
 
-    // Pedimos para utilizar OpenGL versão 3.3 (ou superior)
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        // Pedimos para utilizar OpenGL versão 3.3 (ou superior)
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 
-    #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    #endif
+        #ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        #endif
 
-    // Pedimos para utilizar o perfil "core", isto é, utilizaremos somente as
-    // funções modernas de OpenGL.
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        // Pedimos para utilizar o perfil "core", isto é, utilizaremos somente as
+        // funções modernas de OpenGL.
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    // Criamos uma janela do sistema operacional, com 800 colunas e 600 linhas
-    // de pixels, e com título "INF01047 ...".
-    GLFWwindow* window;
-    window = glfwCreateWindow(WIDTH, HEIGHT, WINDOW_TITLE, NULL, NULL);
-    if (!window)
-    {
-        glfwTerminate();
-        fprintf(stderr, "ERROR: glfwCreateWindow() failed.\n");
-        std::exit(EXIT_FAILURE);
-    }
+        // No modo --bench sem contexto EGL a janela fica invisível, com o
+        // tamanho do framebuffer de benchmark.
+        if (bench.enabled)
+            glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+        // Criamos uma janela do sistema operacional, com 800 colunas e 600 linhas
+        // de pixels, e com título "INF01047 ...".
+        window = glfwCreateWindow(bench.enabled ? bench.width : WIDTH, bench.enabled ? bench.height : HEIGHT, WINDOW_TITLE, NULL, NULL);
+        if (!window)
+        {
+            glfwTerminate();
+            fprintf(stderr, "ERROR: glfwCreateWindow() failed.\n");
+            std::exit(EXIT_FAILURE);
+        }
 
-    // Definimos a função de callback que será chamada sempre que o usuário
-    // pressionar alguma tecla do teclado ...
-    glfwSetKeyCallback(window, KeyCallback);
-    // ... ou clicar os botões do mouse ...
-    glfwSetMouseButtonCallback(window, MouseButtonCallback);
-    // ... ou movimentar o cursor do mouse em cima da janela ...
-    glfwSetCursorPosCallback(window, CursorPosCallback);
-    // ... ou rolar a "rodinha" do mouse.
-    //glfwSetScrollCallback(window, ScrollCallback);
+        // Definimos a função de callback que será chamada sempre que o usuário
+        // pressionar alguma tecla do teclado ...
+        glfwSetKeyCallback(window, KeyCallback);
+        // ... ou clicar os botões do mouse ...
+        glfwSetMouseButtonCallback(window, MouseButtonCallback);
+        // ... ou movimentar o cursor do mouse em cima da janela ...
+        glfwSetCursorPosCallback(window, CursorPosCallback);
+        // ... ou rolar a "rodinha" do mouse.
+        //glfwSetScrollCallback(window, ScrollCallback);
+        // Com --record os eventos passam antes pelo gravador; com --replay a
+        // janela ignora o usuário. Veja replay.h.
+        Replay_InstallCallbacks(window);
 
-    // Indicamos que as chamadas OpenGL deverão renderizar nesta janela
-    glfwMakeContextCurrent(window);
+        // Indicamos que as chamadas OpenGL deverão renderizar nesta janela
+        glfwMakeContextCurrent(window);
+
+        // Carregamento de todas funções definidas por OpenGL 3.3, utilizando a
+        // biblioteca GLAD.
+        gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+    }
 
-    // Carregamento de todas funções definidas por OpenGL 3.3, utilizando a
-    // biblioteca GLAD.
-    gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+    // No build instrumentado ("make profile") passamos a contar as chamadas
+    // OpenGL desde já; o carregamento da cena é registrado como o quadro 0.
+    // A tecla F3 liga/desliga a contagem. Nos demais builds não faz nada.
+    gladProfileSetEnabled(1);
 
     // Definimos a função de callback que será chamada sempre que a janela for
     // redimensionada, por consequência alterando o tamanho do "framebuffer"
     // (região de memória onde são armazenados os pixels da imagem).
-    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
-    FramebufferSizeCallback(window, 800, 600); // Forçamos a chamada do callback acima, para definir g_ScreenRatio.
+    if (bench.enabled)
+    {
+        // No modo --bench renderizamos em um FBO com a resolução pedida.
+        if (!Bench_CreateFramebuffer(bench.width, bench.height))
+            std::exit(EXIT_FAILURE);
+        FramebufferSizeCallback(window, bench.width, bench.height);
+        TextRendering_SetWindowSize(bench.width, bench.height);
+    }
+    else
+    {
+        glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+        FramebufferSizeCallback(window, 800, 600); // Forçamos a chamada do callback acima, para definir g_ScreenRatio.
+    }
 
     // Imprimimos no terminal informações sobre a GPU do sistema
     const GLubyte *vendor      = glGetString(GL_VENDOR);
@@ -410,56 +512,151 @@ int main(int argc, char* argv[])
 
     printf("GPU: %s, %s, OpenGL %s, GLSL %s\n", vendor, renderer, glversion, glslversion);
 
+    // Com "--pack", os modelos, texturas e shaders abaixo são lidos do
+    // pacote de recursos mapeado na memória (veja assetpack.h).
+    AssetPack_Open();
+
     // Carregamos os shaders de vértices e de fragmentos que serão utilizados
     // para renderização. Veja slides 217-219 do documento "Aula_03_Rendering_Pipeline_Grafico.pdf".
     //
     LoadShadersFromFiles();
 
+    // Buffers compartilhados pelas malhas de todos os modelos (veja
+    // mesharena.h).
+    MeshArena_Init();
+
+    // Envio da cena em uma única chamada, se o contexto permitir (veja
+    // multidraw.h).
+    MultiDraw_Init(headless ? (GLADloadproc) Bench_GetProcAddress : (GLADloadproc) glfwGetProcAddress,
+                   MeshArena_VertexArray());
+
+    // Programa do teste de instâncias na GPU (veja instancecull.h).
+    InstanceCull_Init(headless ? (GLADloadproc) Bench_GetProcAddress : (GLADloadproc) glfwGetProcAddress);
+
     std::vector<const char*> object_names = {"museu", "estande", "triceratop", "triangulo", "cow", "esfera", "cubo", "rosquinha_1", "rosquinha_2", "lampada", "chaleira", "plano_gc_real", "vetor", "plano"};
     std::vector<const char*>::iterator iterator_obj_names ;
 
     const char* basepath = "../../data/";
 
+    // Com "--stream" somente o museu, os pedestais e o dinossauro são
+    // carregados aqui (com "--progressive", somente o museu e os pedestais).
+    // Os demais modelos e texturas são registrados para carregamento sob
+    // demanda (veja streaming.h), com as mesmas unidades de textura, e até lá
+    // são desenhados como substitutos. "streamed_assets" guarda os recursos
+    // registrados com cada nome de arquivo.
+    StreamedAssets streamed_assets;
+    if (Streaming_IsEnabled())
+        BuildPlaceholders();
+
     for (iterator_obj_names = object_names.begin(); iterator_obj_names != object_names.end(); iterator_obj_names++){
         char filepath[100];
         strcpy(filepath, basepath);
         strcat(filepath, *iterator_obj_names);
 
-        LoadTextureImage(filepath);
+        StreamedAssets* streamed = NULL;
+        if (Streaming_IsEnabled() && strcmp(*iterator_obj_names, "museu") != 0 && strcmp(*iterator_obj_names, "estande") != 0
+            && (Streaming_IsProgressive() || strcmp(*iterator_obj_names, "triceratop") != 0))
+            streamed = &streamed_assets;
+
+        LoadOrStreamTextureImage(filepath, streamed);
 
         if(strcmp(*iterator_obj_names, "estande") == 0) {
-            LoadTextureImage("../../data/estande_erro");
-            LoadTextureImage("../../data/estande_acerto");
+            LoadOrStreamTextureImage("../../data/estande_erro", streamed);
+            LoadOrStreamTextureImage("../../data/estande_acerto", streamed);
         } else if(strcmp(*iterator_obj_names, "lampada") == 0){
-            LoadTextureImage("../../data/vermelho");
-            LoadTextureImage("../../data/azul");
-            LoadTextureImage("../../data/verde");
-            LoadTextureImage("../../data/rosa");
-            LoadTextureImage("../../data/amarelo");
+            LoadOrStreamTextureImage("../../data/vermelho", streamed);
+            LoadOrStreamTextureImage("../../data/azul", streamed);
+            LoadOrStreamTextureImage("../../data/verde", streamed);
+            LoadOrStreamTextureImage("../../data/rosa", streamed);
+            LoadOrStreamTextureImage("../../data/amarelo", streamed);
+        }
+
+        if (streamed != NULL)
+        {
+            (*streamed)[*iterator_obj_names].push_back(Streaming_AddModel(filepath, basepath));
+            AddPlaceholderToVirtualScene(*iterator_obj_names);
+            continue;
+        }
+
+        if (AssetPack_IsOpen())
+        {
+            char objpath[100];
+            strcpy(objpath, filepath);
+            strcat(objpath, ".obj");
+            LoadCookedMeshAndAddToVirtualScene(objpath, AssetStats_Add(objpath, ASSET_MODEL));
+            continue;
         }
 
-        ObjModel obj_model(filepath, basepath);
-        ComputeNormals(&obj_model);
-        BuildTrianglesAndAddToVirtualScene(&obj_model);
+        QueueModel(filepath, basepath);
     }
 
+    // Sem "--pack", os arquivos registrados acima para carregamento imediato
+    // são lidos de uma vez, e cada um é processado assim que a sua leitura
+    // termina (veja assetio.h).
+    LoadQueuedAssets();
 
-    if ( argc > 1 )
+    // Recursos de cada estande, para o carregamento sob demanda.
+    if (Streaming_IsEnabled())
     {
-        ObjModel model(argv[1]);
-        BuildTrianglesAndAddToVirtualScene(&model);
+        for (int stand = 0; stand < NUM_ESTANDES; ++stand)
+            for (int k = 0; k < MAX_ARQUIVOS_ESTANDE && g_ArquivosEstande[stand][k] != NULL; ++k)
+            {
+                const std::vector<int>& assets = streamed_assets[g_ArquivosEstande[stand][k]];
+                for (size_t a = 0; a < assets.size(); ++a)
+                    Streaming_AddToStand(stand, assets[a]);
+            }
+        Streaming_Start(window);
     }
 
+    if ( extra_model != NULL )
+    {
+        AssetStats* stats = AssetStats_Add(extra_model, ASSET_MODEL);
+        double start = AssetStats_NowMs();
+        ObjModel model(extra_model);
+        stats->load_ms = AssetStats_NowMs() - start;
+        BuildTrianglesAndAddToVirtualScene(&model, stats);
+    }
+
+    // Lotes dos objetos que nunca se movem. Com "--stream" eles são criados
+    // quando todos os recursos chegarem (veja abaixo).
+    InitStaticBatches();
+
     // Inicializamos o código para renderização de texto.
     TextRendering_Init();
 
+    // Atlas e programa dos impostores; as vistas são preparadas nos
+    // primeiros quadros (veja impostor.h).
+    InitImpostors();
+
+    // Memória e tempo de carregamento de cada modelo e textura.
+    AssetStats_PrintTable(stdout);
+    TextureCache_PrintStats(stdout);
+
+    // Fim do "quadro" de carregamento para o profiler de chamadas OpenGL.
+    gladProfileEndFrame();
+
+    // Criamos as queries utilizadas para medir o tempo de cada etapa do
+    // quadro na GPU. Veja "gputimer.h".
+    GpuTimer_Init();
+
+    TRACE_END(); // carregamento
+
+    // A partir daqui contamos as alocações de memória de cada quadro (veja
+    // alloctrack.h).
+    AllocTrack_Init();
+
+    // Na reprodução o tempo da simulação começa em zero, independente da
+    // duração do carregamento.
+    if (Replay_IsPlaying())
+        time_prev = current_time();
+
     // Habilitamos o Z-buffer. Veja slide 108 do documento "Aula_09_Projecoes.pdf".
-    glEnable(GL_DEPTH_TEST);
+    GLState_Enable(GL_DEPTH_TEST);
 
     // Habilitamos o Backface Culling. Veja slides 22-34 do documento "Aula_13_Clipping_and_Culling.pdf".
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    GLState_Enable(GL_CULL_FACE);
+    GLState_CullFace(GL_BACK);
+    GLState_FrontFace(GL_CCW);
 
     // Variáveis auxiliares utilizadas para chamada à função
     // TextRendering_ShowModelViewProjection(), armazenando matrizes 4x4.
@@ -468,13 +665,31 @@ int main(int argc, char* argv[])
     glm::mat4 the_view;
 
 
+    // Tempos até o primeiro quadro e até a cena completa (veja streaming.h).
+    double first_frame_ms = -1.0;
+    double fully_loaded_ms = -1.0;
+
     // Ficamos em loop, renderizando, até que o usuário feche a janela
-    while (!glfwWindowShouldClose(window))
+    // (ou, reproduzindo eventos gravados, até o fechamento gravado).
+    while (Replay_IsPlaying() ? !Replay_Finished(window) : !glfwWindowShouldClose(window))
     {
         // Aqui executamos as operações de renderização
+        TRACE_ZONE("quadro");
+        AllocTrack_BeginFrame();
+        FrameArena_Reset();
+        PerfHud_BeginFrame();
+        gladProfileBeginFrame();
+        GpuTimer_BeginFrame();
+
+        if (bench.enabled)
+            Bench_BeginFrame();
+
+        // Na reprodução (--replay ou roteiro do --bench) os eventos gravados
+        // fazem o papel do usuário e o relógio da simulação avança um passo.
+        Replay_BeginFrame(window);
 
         // Controle do tempo no movimento para reposicionamento da câmera com WASD keys
-        time_now = glfwGetTime();
+        time_now = current_time();
         passo_tempo = (time_now - time_prev);
         double passo_camera = passo_tempo*4.0f;
         time_prev = time_now;
@@ -485,20 +700,26 @@ int main(int argc, char* argv[])
         // Conversaremos sobre sistemas de cores nas aulas de Modelos de Iluminação.
         //
         //           R     G     B     A
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        GLState_ClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
         // "Pintamos" todos os pixels do framebuffer com a cor definida acima,
         // e também resetamos todos os pixels do Z-buffer (depth buffer).
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
-        // os shaders de vértice e fragmentos).
-        glUseProgram(program_id);
+        // os shaders de vértice e fragmentos). O texto desenhado ao final do
+        // quadro anterior deixa o blending ligado e o teste de profundidade
+        // desligado; restauramos o estado necessário para a cena. Chamadas
+        // redundantes são descartadas pelo cache de estado (veja glstate.h).
+        GLState_UseProgram(program_id);
+        GLState_Disable(GL_BLEND);
+        GLState_DepthFunc(GL_LESS);
 
         // Computamos a posição da câmera utilizando coordenadas esféricas.  As
         // variáveis g_CameraDistance, g_CameraPhi, e g_CameraTheta são
         // controladas pelo mouse do usuário. Veja as funções CursorPosCallback()
         // e ScrollCallback().
+        TRACE_BEGIN("camera");
         float r = g_CameraDistance;
 
         // Cálculos trigonométricos salvos para economizar recursos computacionais
@@ -586,6 +807,7 @@ int main(int argc, char* argv[])
 
         // Computamos a matriz "View" utilizando os parâmetros da câmera para definir o sistema de coordenadas da câmera.
         glm::mat4 view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
+        TRACE_END(); // camera
 
         // Agora computamos a matriz de Projeção.
         glm::mat4 projection;
@@ -620,14 +842,41 @@ int main(int argc, char* argv[])
         // Enviamos as matrizes "view" e "projection" para a placa de vídeo
         // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
         // efetivamente aplicadas em todos os pontos.
-        glUniformMatrix4fv(view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
-        glUniformMatrix4fv(projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
-
+        GLState_UniformMatrix4fv(view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
+        GLState_UniformMatrix4fv(projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
+
+        // Os níveis de detalhe dos objetos são escolhidos com as matrizes
+        // deste quadro (veja DrawVirtualObject()).
+        Lod_BeginFrame(view, projection);
+        Impostor_BeginFrame(view, projection);
+        Meshlet_BeginFrame(view, projection);
+        MultiDraw_BeginFrame(multi_draw_uniform);
+
+
+        GLState_Uniform1i(estande_shader, estande_atual);
+        GLState_Uniform1i(acerto_ou_erro_est1, opcao_estande1);
+        GLState_Uniform1i(cor_lampada_shader, cor_lampada);
+        GLState_Uniform1i(direcao_textura_plana_shader, direcao_textura_plana);
+
+        // Vistas dos impostores ainda não preparadas, ou desatualizadas, com
+        // os uniforms acima já com os valores deste quadro. Com "--stream",
+        // somente depois que todos os recursos chegaram (veja impostor.h).
+        if (!Streaming_IsEnabled() || Streaming_IsFullyLoaded())
+        {
+            InitStaticBatches();
+            InitInstanceSets();
+            if (Impostor_BakePending())
+            {
+                GLState_Uniform1i(impostor_bake_uniform, 0);
+                GLState_UniformMatrix4fv(view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
+                GLState_UniformMatrix4fv(projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
+            }
+        }
 
-        glUniform1i(estande_shader, estande_atual);
-        glUniform1i(acerto_ou_erro_est1, opcao_estande1);
-        glUniform1i(cor_lampada_shader, cor_lampada);
-        glUniform1i(direcao_textura_plana_shader, direcao_textura_plana);
+        // Instâncias testadas contra o frustum deste quadro, na GPU, com um
+        // programa próprio (veja instancecull.h).
+        InstanceCull_BeginFrame(view, projection);
+        GLState_UseProgram(program_id);
 
 
         #define MUSEU 0
@@ -661,14 +910,23 @@ int main(int argc, char* argv[])
         glm::vec4 posMax;
 
 
-        model = Matrix_Translate(-21.5f, 1.0f, 0.0f)
-              * Matrix_Scale(24.0f, 6.0f, 12.0f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, MUSEU);
-        DrawVirtualObject("museu");
+        // Com os lotes estáticos, o museu e os estandes são todos desenhados
+        // aqui (veja staticbatch.h).
+        GpuTimer_BeginPass(GPUTIMER_MUSEU);
+        model = ModelMuseu();
+        if (StaticBatch_IsBuilt())
+            DrawStaticBatches();
+        else
+        {
+            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+            SetObjectId(MUSEU);
+            DrawVirtualObject("museu", model);
+        }
+        GpuTimer_EndPass(GPUTIMER_MUSEU);
 
-        glm::vec3 museu_min = g_VirtualScene["museu"].bbox_min;
-        glm::vec3 museu_max = g_VirtualScene["museu"].bbox_max;
+        const SceneObject& museu = g_VirtualScene["museu"];
+        glm::vec3 museu_min = museu.bbox_min;
+        glm::vec3 museu_max = museu.bbox_max;
         glm::vec4 museu_min_vec4 = glm::vec4(museu_min.x, museu_min.y, museu_min.z, 1.0f);
         glm::vec4 museu_max_vec4 = glm::vec4(museu_max.x, museu_max.y, museu_max.z, 1.0f);
 
@@ -681,17 +939,27 @@ int main(int argc, char* argv[])
         Museu.p4 = glm::vec3(posMin.x + ERRO_COLISAO, 1.0f, posMax.z - ERRO_COLISAO);
 
 
+        // Posições e contornos dos estandes são recalculados a cada quadro. A
+        // câmera (acima) usa os do quadro anterior. clear() mantém a memória
+        // já reservada, e os vetores não crescem mais após o primeiro quadro.
+        posicoes_estandes.clear();
+        estandes_bbox.clear();
+        const SceneObject& estande_obj = g_VirtualScene["estande"];
+
+        GpuTimer_BeginPass(GPUTIMER_ESTANDES);
         for (float estandes = 0; estandes<9*4; estandes+=4){
-            model = Matrix_Translate(-1.32f*estandes, -4.8f, -11.0f)
-                  * Matrix_Scale(0.95f, 1.2f, 0.95f);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, ESTANDE);
-            DrawVirtualObject("estande");
+            model = ModelEstande((int)estandes / 4);
+            if (!StaticBatch_IsBuilt() && g_StandInstances < 0)
+            {
+                GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                SetObjectId(ESTANDE);
+                DrawVirtualObject("estande", model);
+            }
 
             posicoes_estandes.push_back(glm::vec4(-1.32f*estandes, -4.8f, -11.0f, 1.0f));
 
-            glm::vec3 estande_min = g_VirtualScene["estande"].bbox_min;
-            glm::vec3 estande_max = g_VirtualScene["estande"].bbox_max;
+            glm::vec3 estande_min = estande_obj.bbox_min;
+            glm::vec3 estande_max = estande_obj.bbox_max;
             glm::vec4 estande_min_vec4 = glm::vec4(estande_min.x, estande_min.y, estande_min.z, 1.0f);
             glm::vec4 estande_max_vec4 = glm::vec4(estande_max.x, estande_max.y, estande_max.z, 1.0f);
 
@@ -709,17 +977,18 @@ int main(int argc, char* argv[])
         }
 
         for (float estandes = 0; estandes<9*4; estandes+=4){
-            model = Matrix_Translate(-1.32f*estandes, -4.8f, 11.0f)
-                  * Matrix_Scale(0.95f, 1.2f, 0.95f)
-                  * Matrix_Rotate_Y(M_PI);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, ESTANDE);
-            DrawVirtualObject("estande");
+            model = ModelEstande(9 + (int)estandes / 4);
+            if (!StaticBatch_IsBuilt() && g_StandInstances < 0)
+            {
+                GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                SetObjectId(ESTANDE);
+                DrawVirtualObject("estande", model);
+            }
 
             posicoes_estandes.push_back(glm::vec4(-1.32f*estandes, -4.8f, 11.0f, 1.0f));
 
-            glm::vec3 estande_min = g_VirtualScene["estande"].bbox_min;
-            glm::vec3 estande_max = g_VirtualScene["estande"].bbox_max;
+            glm::vec3 estande_min = estande_obj.bbox_min;
+            glm::vec3 estande_max = estande_obj.bbox_max;
             glm::vec4 estande_min_vec4 = glm::vec4(estande_min.x, estande_min.y, estande_min.z, 1.0f);
             glm::vec4 estande_max_vec4 = glm::vec4(estande_max.x, estande_max.y, estande_max.z, 1.0f);
 
@@ -735,15 +1004,20 @@ int main(int argc, char* argv[])
 
             estandes_bbox.push_back(estande);
         }
-
-        model = Matrix_Translate(-22.0f, -5.0f, 1.0f)
-              * Matrix_Scale(2.0f, 2.0f, 2.0f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, DINOSSAURO);
-        DrawVirtualObject("triceratop");
-
-        glm::vec3 dino_min = g_VirtualScene["triceratop"].bbox_min;
-        glm::vec3 dino_max = g_VirtualScene["triceratop"].bbox_max;
+        if (!StaticBatch_IsBuilt() && g_StandInstances >= 0)
+            DrawInstances(g_StandInstances, "estande");
+        GpuTimer_EndPass(GPUTIMER_ESTANDES);
+
+        GpuTimer_BeginPass(GPUTIMER_DINOSSAURO);
+        model = ModelDinossauro();
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(DINOSSAURO);
+        DrawVirtualObject("triceratop", model);
+        GpuTimer_EndPass(GPUTIMER_DINOSSAURO);
+
+        const SceneObject& triceratop = g_VirtualScene["triceratop"];
+        glm::vec3 dino_min = triceratop.bbox_min;
+        glm::vec3 dino_max = triceratop.bbox_max;
         glm::vec4 dino_min_vec4 = glm::vec4(dino_min.x, dino_min.y, dino_min.z, 1.0f);
         glm::vec4 dino_max_vec4 = glm::vec4(dino_max.x, dino_max.y, dino_max.z, 1.0f);
 
@@ -756,57 +1030,67 @@ int main(int argc, char* argv[])
         Dino.p4 = glm::vec3(posMin.x - ERRO_COLISAO, 1.0f, posMax.z + ERRO_COLISAO);
 
         // estande 1
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1);
+        TRACE_BEGIN("estande 1");
         model = Matrix_Translate(posicoes_estandes[1-1].x, posicoes_estandes[1-1].y + 3.68f, posicoes_estandes[1-1].z)
               * Matrix_Scale(0.6f, 0.6f, 0.6f)
               * Matrix_Rotate_X(0.4f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, PLANO_GC_REAL);
-        DrawVirtualObject("plano_gc_real");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(PLANO_GC_REAL);
+        DrawVirtualObject("plano_gc_real", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1);
 
         // estante 2
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 1);
+        TRACE_BEGIN("estande 2");
         model = Matrix_Translate(posicoes_estandes[2-1].x - 0.45f, posicoes_estandes[2-1].y + 3.82f, posicoes_estandes[2-1].z - 0.2f)
               * Matrix_Scale(0.30f, 0.2f, 0.3f)
               * Matrix_Rotate_X(0.4f)
               * Matrix_Rotate_Y(-M_PI/2);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, VETOR_ESTATICO);
-        DrawVirtualObject("vetor");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(VETOR_ESTATICO);
+        DrawVirtualObject("vetor", model);
 
         model = Matrix_Translate(posicoes_estandes[2-1].x - 0.3f, posicoes_estandes[2-1].y + 3.84f, posicoes_estandes[2-1].z + 0.0f - g_Angle_Stand2*0.15f)
               * Matrix_Scale(0.30f, 0.2f, 0.3f)
               * Matrix_Rotate_X(0.4f)
               * Matrix_Rotate_Y(M_PI + g_Angle_Stand2);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, VETOR_MOVE);
-        DrawVirtualObject("vetor");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(VETOR_MOVE);
+        DrawVirtualObject("vetor", model);
 
         model = Matrix_Translate(posicoes_estandes[2-1].x - 0.33f, posicoes_estandes[2-1].y + 3.9f, posicoes_estandes[2-1].z - 0.05f - g_Angle_Stand2*0.085f)
               * Matrix_Scale(0.3f + (g_aux_Stand2*0.011), 0.4f + (g_aux_Stand2*0.015), 0.3f + (g_aux_Stand2*0.011))
               * Matrix_Rotate_X(0.2f)
               * Matrix_Rotate_Y(-(27*M_PI)/36 + (g_aux_Stand2*0.035));
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, VETOR_RESULTANTE);
-        DrawVirtualObject("vetor");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(VETOR_RESULTANTE);
+        DrawVirtualObject("vetor", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 1);
 
 
         // estande 3
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 2);
+        TRACE_BEGIN("estande 3");
         // Torso
         model = Matrix_Identity();
         PushMatrix(model);
             model = Matrix_Translate(posicoes_estandes[3-1].x, posicoes_estandes[3-1].y + 4.2f, posicoes_estandes[3-1].z)
                     * Matrix_Scale(0.3f, 0.4f, 0.1f);
-                glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                DrawVirtualObject("cubo");
+                GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                SetObjectId(CUBO_HIERARQUICA);
+                DrawVirtualObject("cubo", model);
         PopMatrix(model);
 
         // Cabeça
         PushMatrix(model);
             model = Matrix_Translate(posicoes_estandes[3-1].x, posicoes_estandes[3-1].y + 4.85f, posicoes_estandes[3-1].z)
                     * Matrix_Scale(0.2f, 0.2f, 0.15f);
-                glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                DrawVirtualObject("cubo");
+                GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                SetObjectId(CUBO_HIERARQUICA);
+                DrawVirtualObject("cubo", model);
         PopMatrix(model);
 
         // Braço direito
@@ -818,9 +1102,9 @@ int main(int argc, char* argv[])
                         * Matrix_Rotate_X(g_ForearmAngleX);
                     PushMatrix(model);
                     model = model * Matrix_Scale(0.05f, 0.15f, 0.05f);
-                        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                        glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                        DrawVirtualObject("cubo");
+                        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                        SetObjectId(CUBO_HIERARQUICA);
+                        DrawVirtualObject("cubo", model);
                      PopMatrix(model);
 
                     PushMatrix(model);
@@ -830,18 +1114,18 @@ int main(int argc, char* argv[])
                             * Matrix_Rotate_X(g_ForearmAngleX);
                         PushMatrix(model);
                             model = model * Matrix_Scale(0.05f, 0.15f, 0.05f);
-                            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                            glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                            DrawVirtualObject("cubo");
+                            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                            SetObjectId(CUBO_HIERARQUICA);
+                            DrawVirtualObject("cubo", model);
 
                             // Mão
                             PushMatrix(model);
                                 model = model * Matrix_Translate(0.0f, -1.20f, 0.0f);
                                 PushMatrix(model);
                                     model = model * Matrix_Scale(1.05f, 0.2f, 1.05f);
-                                    glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                                    glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                                    DrawVirtualObject("cubo");
+                                    GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                                    SetObjectId(CUBO_HIERARQUICA);
+                                    DrawVirtualObject("cubo", model);
                                 PopMatrix(model);
                             PopMatrix(model);
 
@@ -861,9 +1145,9 @@ int main(int argc, char* argv[])
                         * Matrix_Rotate_X(g_ForearmAngleX);
                     PushMatrix(model);
                     model = model * Matrix_Scale(0.05f, 0.15f, 0.05f);
-                        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                        glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                        DrawVirtualObject("cubo");
+                        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                        SetObjectId(CUBO_HIERARQUICA);
+                        DrawVirtualObject("cubo", model);
                      PopMatrix(model);
 
                     PushMatrix(model);
@@ -873,18 +1157,18 @@ int main(int argc, char* argv[])
                             * Matrix_Rotate_X(g_ForearmAngleX);
                         PushMatrix(model);
                             model = model * Matrix_Scale(0.05f, 0.15f, 0.05f);
-                            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                            glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                            DrawVirtualObject("cubo");
+                            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                            SetObjectId(CUBO_HIERARQUICA);
+                            DrawVirtualObject("cubo", model);
 
                             // Mão
                             PushMatrix(model);
                                 model = model * Matrix_Translate(0.0f, -1.20f, 0.0f);
                                 PushMatrix(model);
                                     model = model * Matrix_Scale(1.05f, 0.2f, 1.05f);
-                                    glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-                                    glUniform1i(object_id_uniform, CUBO_HIERARQUICA);
-                                    DrawVirtualObject("cubo");
+                                    GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+                                    SetObjectId(CUBO_HIERARQUICA);
+                                    DrawVirtualObject("cubo", model);
                                 PopMatrix(model);
                             PopMatrix(model);
 
@@ -894,67 +1178,91 @@ int main(int argc, char* argv[])
 
             PopMatrix(model);
         PopMatrix(model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 2);
 
         // estande 4
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 3);
+        TRACE_BEGIN("estande 4");
         model = Matrix_Translate(posicoes_estandes[4-1].x, posicoes_estandes[4-1].y + 4.2f, posicoes_estandes[4-1].z)
               * Matrix_Scale(0.2f, 0.2f, 0.2f)
-              * Matrix_Rotate_X((float)glfwGetTime() * 1.5f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, TRIANGULO);
-        DrawVirtualObject("triangulo");
+              * Matrix_Rotate_X((float)current_time() * 1.5f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(TRIANGULO);
+        DrawVirtualObject("triangulo", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 3);
 
         // estande 5
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 4);
+        TRACE_BEGIN("estande 5");
         model = Matrix_Translate(posicoes_estandes[5-1].x + g_posX_5, posicoes_estandes[5-1].y + 4.4f + + g_posY_5, posicoes_estandes[5-1].z + g_posZ_5)
               * Matrix_Scale(g_scaleX_5, g_scaleY_5, g_scaleZ_5)
               * Matrix_Rotate_X(g_AngleX_5)
               * Matrix_Rotate_Y(g_AngleY_5)
               * Matrix_Rotate_Z(g_AngleZ_5);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, VACA);
-        DrawVirtualObject("cow");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(VACA);
+        DrawVirtualObject("cow", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 4);
 
         // estande 6
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 5);
+        TRACE_BEGIN("estande 6");
         model = Matrix_Translate(posicoes_estandes[6-1].x, posicoes_estandes[6-1].y + 4.2f, posicoes_estandes[6-1].z)
               * Matrix_Scale(0.3f, 0.3f, 0.3f)
               * Matrix_Rotate_Z(g_AngleZ)
               * Matrix_Rotate_Y(g_AngleY)
               * Matrix_Rotate_X(g_AngleX);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CUBO);
-        DrawVirtualObject("cubo");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CUBO);
+        DrawVirtualObject("cubo", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 5);
 
 
         // estande 7
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 6);
+        TRACE_BEGIN("estande 7");
         model = Matrix_Translate(posicoes_estandes[7-1].x + 0.2f, posicoes_estandes[7-1].y + 4.0f, posicoes_estandes[7-1].z + 0.3f)
               * Matrix_Scale(0.25f, 0.25f, 0.25f)
               * Matrix_Rotate_X(-1.5f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CUBO);
-        DrawVirtualObject("cubo");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CUBO);
+        DrawVirtualObject("cubo", model);
 
         model = Matrix_Translate(posicoes_estandes[7-1].x - 0.1f, posicoes_estandes[7-1].y + 4.2f, posicoes_estandes[7-1].z - 0.5f)
               * Matrix_Scale(0.25f, 0.25f, 0.25f)
               * Matrix_Rotate_X(-1.5f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CUBO);
-        DrawVirtualObject("cubo");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CUBO);
+        DrawVirtualObject("cubo", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 6);
 
         // estande 8
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 7);
+        TRACE_BEGIN("estande 8");
         model = Matrix_Translate(posicoes_estandes[8-1].x, posicoes_estandes[8-1].y + 4.2f, posicoes_estandes[8-1].z)
               * Matrix_Scale(0.4f, 0.4f, 0.4f)
-              * Matrix_Rotate_X((float)glfwGetTime() * 0.3f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, ROSQUINHA_1);
-        DrawVirtualObject("rosquinha_1");
+              * Matrix_Rotate_X((float)current_time() * 0.3f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(ROSQUINHA_1);
+        DrawVirtualObject("rosquinha_1", model);
         model = Matrix_Translate(posicoes_estandes[8-1].x, posicoes_estandes[8-1].y + 4.2f, posicoes_estandes[8-1].z)
               * Matrix_Scale(0.4f, 0.4f, 0.4002f)
-              * Matrix_Rotate_X((float)glfwGetTime() * 0.3f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, ROSQUINHA_2);
-        DrawVirtualObject("rosquinha_2");
+              * Matrix_Rotate_X((float)current_time() * 0.3f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(ROSQUINHA_2);
+        DrawVirtualObject("rosquinha_2", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 7);
 
 
         // estande 9
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 8);
+        TRACE_BEGIN("estande 9");
         // normalizando valores que inicialmente iam de [-1, 1] (como faz o cosseno)
         //      para [0,1]
         float t_bezier = ( cos(time_now) - (-1) )/(1 - (-1)) ;
@@ -969,84 +1277,121 @@ int main(int argc, char* argv[])
 
         model = Matrix_Translate(deslocamento_9.x, deslocamento_9.y, deslocamento_9.z)
               * Matrix_Scale(0.3f, 0.3f, 0.3f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, VACA);
-        DrawVirtualObject("cow");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(VACA);
+        DrawVirtualObject("cow", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 8);
 
 
         // estande 10
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 9);
+        TRACE_BEGIN("estande 10");
         model = Matrix_Translate(posicoes_estandes[10-1].x, posicoes_estandes[10-1].y + 3.85f, posicoes_estandes[10-1].z + 0.5f)
               * Matrix_Scale(2.6f, 2.6f, 2.6f)
               * Matrix_Rotate_X(-2.0f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, LAMPADA);
-        DrawVirtualObject("lampada");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(LAMPADA);
+        DrawVirtualObject("lampada", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 9);
 
         // estande 11
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 10);
+        TRACE_BEGIN("estande 11");
         model = Matrix_Translate(posicoes_estandes[11-1].x, posicoes_estandes[11-1].y + 4.2f, posicoes_estandes[11-1].z)
               * Matrix_Scale(0.5f, 0.5f, 0.5f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, ESFERA_GOURAUD);
-        DrawVirtualObject("esfera");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(ESFERA_GOURAUD);
+        DrawVirtualObject("esfera", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 10);
 
         // estande 12
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 11);
+        TRACE_BEGIN("estande 12");
         model = Matrix_Translate(posicoes_estandes[12-1].x, posicoes_estandes[12-1].y + 4.2f, posicoes_estandes[12-1].z)
               * Matrix_Scale(0.5f, 0.5f, 0.5f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, ESFERA);
-        DrawVirtualObject("esfera");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(ESFERA);
+        DrawVirtualObject("esfera", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 11);
 
         // estande 13
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 12);
+        TRACE_BEGIN("estande 13");
         model = Matrix_Translate(posicoes_estandes[13-1].x, posicoes_estandes[13-1].y + 4.2f, posicoes_estandes[13-1].z)
               * Matrix_Scale(0.5f, 0.5f, 0.5f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, ESFERA_BLINN);
-        DrawVirtualObject("esfera");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(ESFERA_BLINN);
+        DrawVirtualObject("esfera", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 12);
 
         // estande 14
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 13);
+        TRACE_BEGIN("estande 14");
         model = Matrix_Translate(posicoes_estandes[14-1].x, posicoes_estandes[14-1].y + 3.8f, posicoes_estandes[14-1].z)
               * Matrix_Scale(3.5f, 3.5f, 3.5f)
-              * Matrix_Rotate_Y((float)glfwGetTime() * 0.25f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CHALEIRA_PLANA);
-        DrawVirtualObject("chaleira");
+              * Matrix_Rotate_Y((float)current_time() * 0.25f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CHALEIRA_PLANA);
+        DrawVirtualObject("chaleira", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 13);
 
         // estande 15
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 14);
+        TRACE_BEGIN("estande 15");
         model = Matrix_Translate(posicoes_estandes[15-1].x, posicoes_estandes[15-1].y + 3.8f, posicoes_estandes[15-1].z)
               * Matrix_Scale(3.5f, 3.5f, 3.5f)
-              * Matrix_Rotate_Y((float)glfwGetTime() * 0.25f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CHALEIRA_CUBICA);
-        DrawVirtualObject("chaleira");
+              * Matrix_Rotate_Y((float)current_time() * 0.25f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CHALEIRA_CUBICA);
+        DrawVirtualObject("chaleira", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 14);
 
         // estande 16
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 15);
+        TRACE_BEGIN("estande 16");
         model = Matrix_Translate(posicoes_estandes[16-1].x, posicoes_estandes[16-1].y + 3.8f, posicoes_estandes[16-1].z)
               * Matrix_Scale(3.5f, 3.5f, 3.5f)
-              * Matrix_Rotate_Y((float)glfwGetTime() * 0.25f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CHALEIRA_ESFERICA);
-        DrawVirtualObject("chaleira");
+              * Matrix_Rotate_Y((float)current_time() * 0.25f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CHALEIRA_ESFERICA);
+        DrawVirtualObject("chaleira", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 15);
 
         // estande 17
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_1 + 16);
+        TRACE_BEGIN("estande 17");
         model = Matrix_Translate(posicoes_estandes[17-1].x, posicoes_estandes[17-1].y + 3.8f, posicoes_estandes[17-1].z)
               * Matrix_Scale(3.5f, 3.5f, 3.5f)
-              * Matrix_Rotate_Y((float)glfwGetTime() * 0.25f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, CHALEIRA_CILINDRICA);
-        DrawVirtualObject("chaleira");
+              * Matrix_Rotate_Y((float)current_time() * 0.25f);
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(CHALEIRA_CILINDRICA);
+        DrawVirtualObject("chaleira", model);
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_1 + 16);
 
 
         // estande 18
+        GpuTimer_BeginPass(GPUTIMER_EXPOSICAO_18);
+        TRACE_BEGIN("estande 18");
 
         // plano
         model = Matrix_Translate(posicoes_estandes[18-1].x, posicoes_estandes[18-1].y + 3.8f, posicoes_estandes[18-1].z - 0.3f)
               * Matrix_Scale(0.65f, 0.6f, 0.46f);
-        glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-        glUniform1i(object_id_uniform, PLANO);
-        DrawVirtualObject("plano");
+        GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+        SetObjectId(PLANO);
+        DrawVirtualObject("plano", model);
 
-        obj_min = g_VirtualScene["plano"].bbox_min;
-        obj_max = g_VirtualScene["plano"].bbox_max;
+        const SceneObject& plano_obj = g_VirtualScene["plano"];
+        obj_min = plano_obj.bbox_min;
+        obj_max = plano_obj.bbox_max;
         obj_min_vec4 = glm::vec4(obj_min.x, obj_min.y, obj_min.z, 1.0f);
         obj_max_vec4 = glm::vec4(obj_max.x, obj_max.y, obj_max.z, 1.0f);
 
@@ -1068,12 +1413,13 @@ int main(int argc, char* argv[])
         if (obj_atual_stand18 >= 1){
             model = Matrix_Translate(posicoes_estandes[18-1].x + move_obj1, posicoes_estandes[18-1].y + 5.0f - cai_obj1, posicoes_estandes[18-1].z - 0.3f)
                 * Matrix_Scale(0.1f, 0.1f, 0.1f);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, CUBO);
-            DrawVirtualObject("cubo");
+            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+            SetObjectId(CUBO);
+            DrawVirtualObject("cubo", model);
 
-            obj_min = g_VirtualScene["cubo"].bbox_min;
-            obj_max = g_VirtualScene["cubo"].bbox_max;
+            const SceneObject& cubo_obj = g_VirtualScene["cubo"];
+            obj_min = cubo_obj.bbox_min;
+            obj_max = cubo_obj.bbox_max;
             obj_min_vec4 = glm::vec4(obj_min.x, obj_min.y, obj_min.z, 1.0f);
             obj_max_vec4 = glm::vec4(obj_max.x, obj_max.y, obj_max.z, 1.0f);
 
@@ -1099,12 +1445,13 @@ int main(int argc, char* argv[])
         if (obj_atual_stand18 >=2){
             model = Matrix_Translate(posicoes_estandes[18-1].x + move_obj2, posicoes_estandes[18-1].y + 5.0f - cai_obj2, posicoes_estandes[18-1].z - 0.3f)
                 * Matrix_Scale(0.1f, 0.1f, 0.1f);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, CUBO);
-            DrawVirtualObject("cubo");
+            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+            SetObjectId(CUBO);
+            DrawVirtualObject("cubo", model);
 
-            obj_min = g_VirtualScene["cubo"].bbox_min;
-            obj_max = g_VirtualScene["cubo"].bbox_max;
+            const SceneObject& cubo_obj = g_VirtualScene["cubo"];
+            obj_min = cubo_obj.bbox_min;
+            obj_max = cubo_obj.bbox_max;
             obj_min_vec4 = glm::vec4(obj_min.x, obj_min.y, obj_min.z, 1.0f);
             obj_max_vec4 = glm::vec4(obj_max.x, obj_max.y, obj_max.z, 1.0f);
 
@@ -1129,12 +1476,13 @@ int main(int argc, char* argv[])
         if (obj_atual_stand18 >= 3){
             model = Matrix_Translate(posicoes_estandes[18-1].x + move_obj3, posicoes_estandes[18-1].y + 5.0f - cai_obj3, posicoes_estandes[18-1].z - 0.3f)
                 * Matrix_Scale(0.1f, 0.1f, 0.1f);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, ESFERA);
-            DrawVirtualObject("esfera");
+            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+            SetObjectId(ESFERA);
+            DrawVirtualObject("esfera", model);
 
-            obj_min = g_VirtualScene["esfera"].bbox_min;
-            obj_max = g_VirtualScene["esfera"].bbox_max;
+            const SceneObject& esfera_obj = g_VirtualScene["esfera"];
+            obj_min = esfera_obj.bbox_min;
+            obj_max = esfera_obj.bbox_max;
             obj_min_vec4 = glm::vec4(obj_min.x, obj_min.y, obj_min.z, 1.0f);
             obj_max_vec4 = glm::vec4(obj_max.x, obj_max.y, obj_max.z, 1.0f);
 
@@ -1158,12 +1506,13 @@ int main(int argc, char* argv[])
         if (obj_atual_stand18 >= 4){
             model = Matrix_Translate(posicoes_estandes[18-1].x + move_obj4, posicoes_estandes[18-1].y + 5.0f - cai_obj4, posicoes_estandes[18-1].z - 0.3f)
                 * Matrix_Scale(0.1f, 0.1f, 0.1f);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, ESFERA);
-            DrawVirtualObject("esfera");
+            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+            SetObjectId(ESFERA);
+            DrawVirtualObject("esfera", model);
 
-            obj_min = g_VirtualScene["esfera"].bbox_min;
-            obj_max = g_VirtualScene["esfera"].bbox_max;
+            const SceneObject& esfera_obj = g_VirtualScene["esfera"];
+            obj_min = esfera_obj.bbox_min;
+            obj_max = esfera_obj.bbox_max;
             obj_min_vec4 = glm::vec4(obj_min.x, obj_min.y, obj_min.z, 1.0f);
             obj_max_vec4 = glm::vec4(obj_max.x, obj_max.y, obj_max.z, 1.0f);
 
@@ -1188,12 +1537,13 @@ int main(int argc, char* argv[])
         if (obj_atual_stand18 >=5){
             model = Matrix_Translate(posicoes_estandes[18-1].x + move_obj5, posicoes_estandes[18-1].y + 5.0f - cai_obj5, posicoes_estandes[18-1].z - 0.3f)
                 * Matrix_Scale(0.1f, 0.1f, 0.1f);
-            glUniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
-            glUniform1i(object_id_uniform, CUBO);
-            DrawVirtualObject("cubo");
+            GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(model));
+            SetObjectId(CUBO);
+            DrawVirtualObject("cubo", model);
 
-            obj_min = g_VirtualScene["cubo"].bbox_min;
-            obj_max = g_VirtualScene["cubo"].bbox_max;
+            const SceneObject& cubo_obj = g_VirtualScene["cubo"];
+            obj_min = cubo_obj.bbox_min;
+            obj_max = cubo_obj.bbox_max;
             obj_min_vec4 = glm::vec4(obj_min.x, obj_min.y, obj_min.z, 1.0f);
             obj_max_vec4 = glm::vec4(obj_max.x, obj_max.y, obj_max.z, 1.0f);
 
@@ -1215,54 +1565,188 @@ int main(int argc, char* argv[])
             }
         }
 
+        TRACE_END();
+        GpuTimer_EndPass(GPUTIMER_EXPOSICAO_18);
+
+        // Multidão de "--crowd": as instâncias visíveis em um desenho, ou um
+        // objeto por vez com "--no-instance-culling" (veja instancecull.h).
+        GpuTimer_BeginPass(GPUTIMER_MULTIDAO);
+        if (g_CrowdInstances >= 0)
+            DrawInstances(g_CrowdInstances, "cubo");
+        else
+            for (size_t c = 0; c < g_CrowdModels.size(); ++c)
+            {
+                GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(g_CrowdModels[c]));
+                SetObjectId(CUBO);
+                DrawVirtualObject("cubo", g_CrowdModels[c]);
+            }
+        GpuTimer_EndPass(GPUTIMER_MULTIDAO);
+
+        // Objetos da arena guardados acima por DrawVirtualObject(), em uma
+        // única chamada (veja multidraw.h).
+        GpuTimer_BeginPass(GPUTIMER_ENVIO_INDIRETO);
+        MultiDraw_Flush();
+        GpuTimer_EndPass(GPUTIMER_ENVIO_INDIRETO);
+
+        // Objetos expostos pequenos na tela, desenhados acima como impostores
+        // (veja DrawVirtualObject()), em uma única chamada.
+        GpuTimer_BeginPass(GPUTIMER_IMPOSTORES);
+        Impostor_EndFrame();
+        GpuTimer_EndPass(GPUTIMER_IMPOSTORES);
+
+        GpuTimer_BeginPass(GPUTIMER_TEXTO);
         informative_text_stand(window);
 
-        // O framebuffer onde OpenGL executa as operações de renderização não
-        // é o mesmo que está sendo mostrado para o usuário, caso contrário
-        // seria possível ver artefatos conhecidos como "screen tearing". A
-        // chamada abaixo faz a troca dos buffers, mostrando para o usuário
-        // tudo que foi renderizado pelas funções acima.
-        // Veja o link: Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
-        glfwSwapBuffers(window);
+        if (g_ShowGpuTimers)
+            TextRendering_ShowGpuTimers(window);
 
-        // Verificamos com o sistema operacional se houve alguma interação do
-        // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
-        // definidas anteriormente usando glfwSet*Callback() serão chamadas
-        // pela biblioteca GLFW.
-        glfwPollEvents();
-    }
+        if (PerfHud_IsEnabled())
+            TextRendering_ShowPerfHud(window);
 
-    // Finalizamos o uso dos recursos do sistema operacional
-    glfwTerminate();
+        // Resumo das chamadas OpenGL do quadro anterior (somente no build
+        // instrumentado, com a contagem ligada).
+        if (gladProfileIsEnabled())
+        {
+            char buffer[256];
+            gladProfileFormatSummary(buffer, sizeof(buffer));
+            TextRendering_PrintString(window, buffer, -1.0f, -1.0f + TextRendering_LineHeight(window)/2, 0.75f);
+        }
+        GpuTimer_EndPass(GPUTIMER_TEXTO);
+        GpuTimer_EndFrame();
+        gladProfileEndFrame();
+        PerfHud_EndFrame(camera_view_ID == LOOK_AT_CAMERA ? estande_atual : -1);
+
+        // A troca de buffers e o tratamento de eventos (abaixo) ficam fora
+        // da contagem: as alocações ali são da GLFW e do sistema de janelas.
+        AllocTrack_EndFrame();
+
+        // Carregamento sob demanda dos estandes próximos da câmera (somente
+        // com "--stream"). Fica fora da contagem de alocações, pois o envio
+        // para a GPU e o registro na cena virtual alocam memória, mas dentro
+        // do tempo do quadro.
+        Streaming_Update(camera_position_c, posicoes_estandes.data(), (int)posicoes_estandes.size());
+
+        if (bench.enabled)
+        {
+            // Não há troca de buffers: o quadro fica no FBO do benchmark.
+            double frame_ms = Bench_EndFrame(camera_view_ID == LOOK_AT_CAMERA ? estande_atual : -1);
+            if (Golden_IsEnabled())
+                Golden_EndFrame(frame_ms);
+        }
+        else
+        {
+            // O framebuffer onde OpenGL executa as operações de renderização não
+            // é o mesmo que está sendo mostrado para o usuário, caso contrário
+            // seria possível ver artefatos conhecidos como "screen tearing". A
+            // chamada abaixo faz a troca dos buffers, mostrando para o usuário
+            // tudo que foi renderizado pelas funções acima.
+            // Veja o link: Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
+            TRACE_BEGIN("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+            TRACE_END();
+
+            // Verificamos com o sistema operacional se houve alguma interação do
+            // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
+            // definidas anteriormente usando glfwSet*Callback() serão chamadas
+            // pela biblioteca GLFW.
+            glfwPollEvents();
+        }
 
-    // Fim do programa
-    return 0;
-}
+        // O primeiro quadro já foi apresentado; com carregamento sob demanda
+        // a cena só fica completa quando todos os recursos chegam à GPU.
+        if (first_frame_ms < 0.0)
+        {
+            first_frame_ms = AssetStats_NowMs() - startup_start_ms;
+            printf("Inicializacao: primeiro quadro apresentado em %.1f ms.\n", first_frame_ms);
+        }
+        if (fully_loaded_ms < 0.0 && (!Streaming_IsEnabled() || Streaming_IsFullyLoaded()))
+        {
+            fully_loaded_ms = AssetStats_NowMs() - startup_start_ms;
+            printf("Inicializacao: cena completa em %.1f ms.\n", fully_loaded_ms);
+        }
+    }
+
+    if (fully_loaded_ms < 0.0)
+        printf("Inicializacao: a cena nao ficou completa.\n");
 
-float absolute_float(float v){
-    if (v < 0){
-        return -v;
+    // Métricas do carregamento sob demanda, e a tabela com os recursos
+    // carregados durante a execução.
+    if (Streaming_IsEnabled())
+    {
+        Streaming_Stop();
+        Streaming_PrintStats(stdout);
+        AssetStats_PrintTable(stdout);
+        TextureCache_PrintStats(stdout);
+    }
+
+    // Triângulos poupados pelos níveis de detalhe e desenhos feitos como
+    // impostores ao longo da execução.
+    Lod_PrintStats(stdout);
+    Impostor_PrintStats(stdout);
+    Meshlet_PrintStats(stdout);
+    StaticBatch_PrintStats(stdout);
+    MeshArena_PrintStats(stdout);
+    MultiDraw_PrintStats(stdout);
+    InstanceCull_PrintStats(stdout);
+
+    // Nenhum recurso é lido depois daqui.
+    AssetPack_Close();
+
+    // Exportamos os contadores do profiler de chamadas OpenGL, caso existam.
+    if (gladProfileWriteCSV("gl_profile.csv") && gladProfileWriteJSON("gl_profile.json"))
+        printf("Profiler OpenGL: quadros salvos em \"gl_profile.csv\" e \"gl_profile.json\".\n");
+
+    // No benchmark, nenhum quadro após o aquecimento pode alocar memória.
+    bool bench_passed = true;
+    if (bench.enabled)
+    {
+        Bench_WriteJSON(bench);
+        bench_passed = Bench_CheckAllocations();
     }
-    return v;
-}
+    else
+    {
+        AllocTrackStats allocs = AllocTrack_GetStats();
+        printf("Alocacoes de memoria: %lu de %lu quadros alocaram (%llu new, %llu malloc, %llu bytes, max. %lu por quadro; %llu de outras bibliotecas).\n",
+               allocs.frames_with_allocs, allocs.frames, allocs.new_allocs, allocs.malloc_allocs, allocs.bytes, allocs.max_allocs_per_frame, allocs.external_allocs);
+        AllocTrack_PrintSites(stdout, 5);
+    }
+    printf("Arena do quadro: maximo de %lu bytes utilizados.\n", (unsigned long)FrameArena_HighWater());
 
-glm::vec4 bezier(float t, glm::vec4 p1, glm::vec4 p2, glm::vec4 p3, glm::vec4 p4)
-{
+    // Resultado do teste de regressão visual; alguma vista falhando faz o
+    // programa terminar com erro.
+    bool golden_passed = !Golden_IsEnabled() || Golden_Finish();
+
+    // Fechamos o arquivo de eventos gravados (--record).
+    Replay_Close();
+
+    // Exportamos a linha do tempo do rastreamento (somente com "make trace").
+    TRACE_WRITE("trace.json");
 
-    glm::vec4 c12 = p1 + t*(p2-p1);
-    glm::vec4 c23 = p2 + t*(p3-p2);
-    glm::vec4 c34 = p3 + t*(p4-p3);
-    glm::vec4 c123 = c12 + t*(c23-c12);
-    glm::vec4 c234 = c23 + t*(c34-c23);
-    glm::vec4 c = c123 + t*(c234-c123);
+    // Exportamos as estatísticas de tempo de cada etapa do quadro.
+    if (GpuTimer_WriteJSON("gpu_timer.json"))
+        printf("Tempos por etapa salvos em \"gpu_timer.json\" (%lu quadros descartados).\n", GpuTimer_DroppedFrames());
+
+    GLStateStats glstate_stats = GLState_GetStats();
+    printf("Cache de estado OpenGL: %llu chamadas descartadas, %llu repassadas.\n",
+           glstate_stats.filtered, glstate_stats.forwarded);
+
+    // Finalizamos o uso dos recursos do sistema operacional
+    Bench_DestroyContext();
+    glfwTerminate();
 
-    return c;
+    // Fim do programa
+    return (golden_passed && bench_passed) ? 0 : EXIT_FAILURE;
 }
 
+
 template <typename T> int sgn(T val) {
     return (T(0) < val) - (val < T(0));
 }
 
+double current_time(){
+    return Replay_IsPlaying() ? Replay_Time() : glfwGetTime();
+}
+
 void load_free_camera(){
     camera_view_ID = FREE_CAMERA;
     g_CameraDistance = CameraDistance_save;
@@ -1275,181 +1759,209 @@ void load_look_at_camera(){
     camera_view_ID = LOOK_AT_CAMERA;
 }
 
-bool interseccao_caixa_caixa(struct box_obj obj1, struct box_obj obj2){
-    glm::vec3 distancia_centros = (obj1.c - obj2.c);
-
-    bool x_dist = absolute_float(distancia_centros.x) <= (obj1.x_size + obj2.x_size);
-    bool y_dist = absolute_float(distancia_centros.y) <= (obj1.y_size + obj2.y_size);
-    bool z_dist = absolute_float(distancia_centros.z) <= (obj1.z_size + obj2.z_size);
-
-    return (x_dist && y_dist && z_dist);
-}
-
-bool interseccao_esfera_esfera(struct sphere_obj obj1, struct sphere_obj obj2){
-    glm::vec3 vetor_dist = obj1.c - obj2.c;
-    float distancia_centros = sqrt( pow(vetor_dist.x,2) + pow(vetor_dist.y,2) + pow(vetor_dist.z,2) );
 
-    return distancia_centros <= (obj1.r + obj2.r);
-}
+// Decodifica uma imagem PNG já na memória ("encoded", com "size" bytes) e a
+// envia para a GPU, ligada à unidade "textureunit". A decodificação é somada
+// ao tempo de leitura em "stats".
+static void DecodeTextureImage(const char* filepath, const void* encoded, size_t size, GLuint textureunit, AssetStats* stats)
+{
+    printf("Carregando imagem \"%s\"... ", filepath);
 
-bool interseccao_caixa_esfera(struct box_obj caixa, struct sphere_obj esfera){
-    glm::vec3 distancia_centros = (caixa.c - esfera.c);
+    double start = AssetStats_NowMs();
+    stbi_set_flip_vertically_on_load(true);
+    int width;
+    int height;
+    int channels;
+    unsigned char *data = NULL;
+    if (encoded != NULL)
+        data = stbi_load_from_memory((const stbi_uc*)encoded, (int)size, &width, &height, &channels, 3);
 
-    if (absolute_float(distancia_centros.x) > (caixa.x_size + esfera.r)){
-        return false;
-    }
-    if (absolute_float(distancia_centros.y) > (caixa.y_size + esfera.r)){
-        return false;
-    }
-    if (absolute_float(distancia_centros.z) > (caixa.z_size + esfera.r)){
-        return false;
+    if ( data == NULL )
+    {
+        fprintf(stderr, "ERROR: Cannot open image file \"%s\".\n", filepath);
+        std::exit(EXIT_FAILURE);
     }
 
+    printf("OK (%dx%d).\n", width, height);
 
-    if (absolute_float(distancia_centros.x) <= caixa.x_size ){
-        return true;
-    }
-    if (absolute_float(distancia_centros.y) <= caixa.y_size ){
-        return true;
-    }
-    if (absolute_float(distancia_centros.z) <= caixa.z_size ){
-        return true;
-    }
+    stats->file_bytes = size;
+    stats->load_ms += AssetStats_NowMs() - start;
+    stats->cpu_peak_bytes = (size_t)width * height * 3;
+    start = AssetStats_NowMs();
+
+    uint64_t content_hash = TextureCache_Hash(data, (size_t)width * height * 3);
+    UploadTextureImage(textureunit, data, width, height, content_hash, stats);
 
-    return ( pow(distancia_centros.x - caixa.x_size, 2) + pow(distancia_centros.y - caixa.y_size, 2) )
-                        <= pow(esfera.r, 2);
+    // A cópia na CPU não é mais necessária após o envio para a GPU.
+    stbi_image_free(data);
 
+    stats->upload_ms = AssetStats_NowMs() - start;
+    AssetStats_Finish(stats);
 }
 
-bool interseccao_caixa_plano(struct box_obj caixa, struct plane_obj plano){
-    glm::vec3 distancia_centros = (caixa.c - plano.c);
+// Função que carrega uma imagem do pacote de recursos (veja assetpack.h) para
+// ser utilizada como textura. Sem o pacote, as imagens são lidas em lote por
+// LoadQueuedAssets().
+void LoadTextureImage(const char* filename)
+{
+    TRACE_ZONE("LoadTextureImage");
 
-    bool y_dist = absolute_float(distancia_centros.y) <= (caixa.y_size);
-    bool x_dist = absolute_float(distancia_centros.x) <= (caixa.x_size + plano.x_size);
-    bool z_dist = absolute_float(distancia_centros.z) <= (caixa.z_size + plano.z_size);
+    char filepath[100];
+    strcpy(filepath, filename);
+    strcat(filepath, ".png");
+
+    AssetStats* stats = AssetStats_Add(filepath, ASSET_TEXTURE);
+    double start = AssetStats_NowMs();
+    size_t size;
+    const void* packed = AssetPack_Get(filepath, ASSETPACK_IMAGE, &size);
+    stats->load_ms = AssetStats_NowMs() - start;
 
-    return (y_dist && x_dist && z_dist);
+    DecodeTextureImage(filepath, packed, size, g_NumLoadedTextures, stats);
+    g_NumLoadedTextures += 1;
 }
 
-bool interseccao_esfera_plano(struct sphere_obj esfera, struct plane_obj plano){
-    glm::vec3 distancia_centros = (esfera.c - plano.c);
+// Um recurso registrado para a leitura em lote.
+struct QueuedAsset
+{
+    char        filepath[100]; // Com a extensão (".obj" ou ".png")
+    char        filename[100]; // Sem a extensão, como recebido por ObjModel
+    const char* basepath;      // Diretório dos materiais (somente modelos)
+    GLuint      textureunit;   // Somente texturas
+    AssetStats* stats;
+};
 
-    bool y_dist = absolute_float(distancia_centros.y) <= (esfera.r);
-    bool x_dist = absolute_float(distancia_centros.x) <= (esfera.r + plano.x_size);
-    bool z_dist = absolute_float(distancia_centros.z) <= (esfera.r + plano.z_size);
+static std::vector<QueuedAsset> g_QueuedAssets;
 
-    return (y_dist && x_dist && z_dist);
+void QueueTextureImage(const char* filename)
+{
+    // A unidade de textura é reservada agora, na ordem de registro, pois as
+    // imagens podem terminar de ser lidas em outra ordem.
+    QueuedAsset asset;
+    strcpy(asset.filename, filename);
+    strcpy(asset.filepath, filename);
+    strcat(asset.filepath, ".png");
+    asset.basepath    = NULL;
+    asset.textureunit = g_NumLoadedTextures++;
+    asset.stats       = AssetStats_Add(asset.filepath, ASSET_TEXTURE);
+    g_QueuedAssets.push_back(asset);
 }
 
-/// return true if inside museum
-bool check_inside_museum(float x,  float z){
-    glm::vec3 p_41 = Museu.p4 - Museu.p1;
-    glm::vec3 p_24 = Museu.p2 - Museu.p4;
-    glm::vec3 p_12 = Museu.p1 - Museu.p2;
+void QueueModel(const char* filepath, const char* basepath)
+{
+    QueuedAsset asset;
+    strcpy(asset.filename, filepath);
+    strcpy(asset.filepath, filepath);
+    strcat(asset.filepath, ".obj");
+    asset.basepath    = basepath;
+    asset.textureunit = 0;
+    asset.stats       = AssetStats_Add(asset.filepath, ASSET_MODEL);
+    g_QueuedAssets.push_back(asset);
+}
 
-    glm::vec3 p_23 = Museu.p2 - Museu.p3;
-    glm::vec3 p_42 = Museu.p4 - Museu.p2;
-    glm::vec3 p_34 = Museu.p3 - Museu.p4;
+// Processa um recurso cuja leitura terminou: decodifica a imagem ou lê o
+// modelo e monta a sua malha, e envia o resultado para a GPU. Os tempos de
+// "stats" não incluem a leitura do arquivo, que se sobrepõe ao processamento
+// dos demais (veja o resumo impresso por LoadQueuedAssets()).
+static void LoadQueuedAsset(AssetRead* read)
+{
+    const QueuedAsset* asset = (const QueuedAsset*)read->user;
+    AssetStats* stats = asset->stats;
 
-    bool t1 = F_p1_p2(p_41, Museu.p4, x, z) > 0 && F_p1_p2(p_24, Museu.p2, x, z) > 0 && F_p1_p2(p_12, Museu.p1, x, z) > 0;
-    bool t2 = F_p1_p2(p_23, Museu.p2, x, z) > 0 && F_p1_p2(p_42, Museu.p4, x, z) > 0 && F_p1_p2(p_34, Museu.p3, x, z) > 0;
+    // Contagem inicial de faltas de página, como em AssetStats_Add(): o
+    // recurso foi registrado antes da leitura do lote inteiro, e as faltas
+    // dos demais não são suas.
+    size_t peak_rss;
+    AssetStats_GetProcessMemory(&peak_rss, &stats->page_faults);
 
-    if (t1 || t2) {
-        return true;
+    if (asset->basepath == NULL)
+    {
+        DecodeTextureImage(asset->filepath, read->data, read->size, asset->textureunit, stats);
+        return;
     }
-    return false;
-}
 
-/// return true if outside estande
-bool check_estande(struct square_bbox estande, float x, float z){
-    glm::vec3 p_41 = estande.p4 - estande.p1;
-    glm::vec3 p_24 = estande.p2 - estande.p4;
-    glm::vec3 p_12 = estande.p1 - estande.p2;
+    if (read->data == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", asset->filepath);
+        std::exit(EXIT_FAILURE);
+    }
 
-    glm::vec3 p_23 = estande.p2 - estande.p3;
-    glm::vec3 p_42 = estande.p4 - estande.p2;
-    glm::vec3 p_34 = estande.p3 - estande.p4;
+    // Medimos a leitura do ".obj" e o cálculo das normais aqui; a montagem
+    // da malha e o envio para a GPU são medidos dentro de
+    // BuildTrianglesAndAddToVirtualScene() (veja assetstats.h).
+    stats->file_bytes = read->size;
+    double start = AssetStats_NowMs();
+    ObjModel obj_model(asset->filename, read->data, read->size, asset->basepath);
+    stats->load_ms = AssetStats_NowMs() - start;
 
-    bool t1 = F_p1_p2(p_41, estande.p4, x, z) >= 0 && F_p1_p2(p_24, estande.p2, x, z) >= 0 && F_p1_p2(p_12, estande.p1, x, z) >= 0;
-    bool t2 = F_p1_p2(p_23, estande.p2, x, z) >= 0 && F_p1_p2(p_42, estande.p4, x, z) >= 0 && F_p1_p2(p_34, estande.p3, x, z) >= 0;
+    start = AssetStats_NowMs();
+    ComputeNormals(&obj_model);
+    stats->build_ms = AssetStats_NowMs() - start;
 
-    if (t1 || t2) {
-        return false;
-    }
-    return true;
+    BuildTrianglesAndAddToVirtualScene(&obj_model, stats);
 }
 
-bool check_estandes(float x, float z){
-    bool colisoes_estandes = true;
-    for (int i=0; i != QUANT_ESTANDE; i++){
-        colisoes_estandes = colisoes_estandes && check_estande(estandes_bbox[i], x, z);
-    }
-    return colisoes_estandes;
-}
+void LoadQueuedAssets()
+{
+    if (g_QueuedAssets.empty())
+        return;
 
-bool check_dino(float x, float z){
-    glm::vec3 p_41 = Dino.p4 - Dino.p1;
-    glm::vec3 p_24 = Dino.p2 - Dino.p4;
-    glm::vec3 p_12 = Dino.p1 - Dino.p2;
+    std::vector<AssetRead> reads(g_QueuedAssets.size());
+    for (size_t a = 0; a < g_QueuedAssets.size(); ++a)
+    {
+        reads[a].filepath = g_QueuedAssets[a].filepath;
+        reads[a].user     = &g_QueuedAssets[a];
+        reads[a].data     = NULL;
+        reads[a].size     = 0;
+    }
 
-    glm::vec3 p_23 = Dino.p2 - Dino.p3;
-    glm::vec3 p_42 = Dino.p4 - Dino.p2;
-    glm::vec3 p_34 = Dino.p3 - Dino.p4;
+    AssetIO_ReadAll(reads.data(), (int)reads.size(), LoadQueuedAsset, AssetIO_GetBackend());
 
-    bool t1 = F_p1_p2(p_41, Dino.p4, x, z) >= 0 && F_p1_p2(p_24, Dino.p2, x, z) >= 0 && F_p1_p2(p_12, Dino.p1, x, z) >= 0;
-    bool t2 = F_p1_p2(p_23, Dino.p2, x, z) >= 0 && F_p1_p2(p_42, Dino.p4, x, z) >= 0 && F_p1_p2(p_34, Dino.p3, x, z) >= 0;
+    AssetIOStats io = AssetIO_GetStats();
+    printf("Leitura em lote (%s): %d arquivos, %.1f MiB em %.0f ms, %.0f ms esperando por leituras.\n",
+           AssetIO_BackendName(io.backend), io.files, io.bytes / (1024.0*1024.0), io.total_ms, io.wait_ms);
 
-    if (t1 || t2) {
-        return false;
-    }
-    return true;
+    g_QueuedAssets.clear();
+    g_QueuedAssets.shrink_to_fit();
 }
 
-float F_p1_p2(glm::vec3 v, glm::vec3 a, float x, float z){
-    return v.z*x - v.x*z - v.z*a.x + v.x*a.z;
-}
+// Parâmetros de amostragem das texturas da cena. Todas as unidades usam o
+// mesmo sampler (veja texturecache.h).
+static const TextureSamplerParams g_TextureSamplerParams = {
+    // Veja slide 100 do documento "Aula_20_e_21_Mapeamento_de_Texturas.pdf"
+    GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE,
+    // Parâmetros de amostragem da textura. Falaremos sobre eles em uma próxima aula.
+    GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR
+};
 
-bool check_colision(float x, float z){
-    return check_inside_museum(x, z) && check_estandes(x, z) && check_dino(x, z);
+// Liga uma textura já existente à unidade "textureunit", com o sampler das
+// texturas da cena.
+static void BindTextureToUnit(GLuint textureunit, GLuint texture_id)
+{
+    GLState_ActiveTexture(GL_TEXTURE0 + textureunit);
+    GLState_BindTexture(GL_TEXTURE_2D, texture_id);
+    GLState_BindSampler(textureunit, TextureCache_GetSampler(g_TextureSamplerParams));
 }
 
-// Função que carrega uma imagem para ser utilizada como textura
-void LoadTextureImage(const char* filename)
+// Copia uma imagem RGB lida do disco para uma nova textura, ligada à unidade
+// "textureunit", e retorna o seu ID. Se uma textura com o mesmo conteúdo
+// ("content_hash", veja texturecache.h) já existir, ela é ligada à unidade
+// no lugar de uma nova. Os bytes ocupados na GPU são registrados em "stats"
+// (zero para uma textura compartilhada).
+GLuint UploadTextureImage(GLuint textureunit, const unsigned char* data, int width, int height, uint64_t content_hash, AssetStats* stats)
 {
-    char filepath[100];
-    strcpy(filepath, filename);
-    strcat(filepath, ".png");
-
-    printf("Carregando imagem \"%s\"... ", filepath);
-
-    // Primeiro fazemos a leitura da imagem do disco
-    stbi_set_flip_vertically_on_load(true);
-    int width;
-    int height;
-    int channels;
-    unsigned char *data = stbi_load(filepath, &width, &height, &channels, 3);
-
-    if ( data == NULL )
+    GLuint shared_id = TextureCache_Acquire(content_hash, width, height);
+    if (shared_id != 0)
     {
-        fprintf(stderr, "ERROR: Cannot open image file \"%s\".\n", filepath);
-        std::exit(EXIT_FAILURE);
+        BindTextureToUnit(textureunit, shared_id);
+        stats->gpu_texture_bytes = 0;
+        return shared_id;
     }
 
-    printf("OK (%dx%d).\n", width, height);
-
     // Agora criamos objetos na GPU com OpenGL para armazenar a textura
     GLuint texture_id;
-    GLuint sampler_id;
     glGenTextures(1, &texture_id);
-    glGenSamplers(1, &sampler_id);
-
-    // Veja slide 100 do documento "Aula_20_e_21_Mapeamento_de_Texturas.pdf"
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    // Parâmetros de amostragem da textura. Falaremos sobre eles em uma próxima aula.
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLuint sampler_id = TextureCache_GetSampler(g_TextureSamplerParams);
 
     // Agora enviamos a imagem lida do disco para a GPU
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -1457,49 +1969,492 @@ void LoadTextureImage(const char* filename)
     glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
     glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
 
-    GLuint textureunit = g_NumLoadedTextures;
-    glActiveTexture(GL_TEXTURE0 + textureunit);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    GLState_ActiveTexture(GL_TEXTURE0 + textureunit);
+    GLState_BindTexture(GL_TEXTURE_2D, texture_id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
-    glBindSampler(textureunit, sampler_id);
+    GLState_BindSampler(textureunit, sampler_id);
 
-    stbi_image_free(data);
+    // Os drivers costumam guardar GL_SRGB8 com 4 bytes por texel.
+    stats->gpu_texture_bytes = AssetStats_TextureBytes(width, height, 4);
+    PerfHud_AddTextureMemory(stats->gpu_texture_bytes);
+    TextureCache_Insert(content_hash, width, height, texture_id, stats->gpu_texture_bytes);
+    return texture_id;
+}
 
-    g_NumLoadedTextures += 1;
+// Liga à unidade "textureunit" uma textura enviada pela thread de envio
+// (veja uploader.h) e retorna o ID usado. A thread de envio não consulta o
+// cache de texturas: se outra textura com o mesmo conteúdo já existir, a
+// nova é apagada e a existente é compartilhada.
+GLuint BindUploadedTextureImage(GLuint textureunit, GLuint texture_id, int width, int height, uint64_t content_hash, AssetStats* stats)
+{
+    GLuint shared_id = TextureCache_Acquire(content_hash, width, height);
+    if (shared_id != 0)
+    {
+        GLState_DeleteTexture(texture_id);
+        BindTextureToUnit(textureunit, shared_id);
+        stats->gpu_texture_bytes = 0;
+        return shared_id;
+    }
+
+    BindTextureToUnit(textureunit, texture_id);
+    stats->gpu_texture_bytes = AssetStats_TextureBytes(width, height, 4);
+    PerfHud_AddTextureMemory(stats->gpu_texture_bytes);
+    TextureCache_Insert(content_hash, width, height, texture_id, stats->gpu_texture_bytes);
+    return texture_id;
+}
+
+// Malha e textura desenhadas no lugar dos recursos ainda não carregados (veja
+// streaming.h): uma caixa cinza de lado 1 centrada na origem.
+static GLuint g_PlaceholderVAO = 0;
+static GLuint g_PlaceholderTexture = 0;
+static const size_t g_PlaceholderNumIndices = 36;
+
+void BuildPlaceholders()
+{
+    // Oito vértices compartilhados; as normais apontam para fora a partir do
+    // centro, o que basta para que a caixa seja iluminada.
+    static const float positions[8*4] = {
+        -0.5f, -0.5f, -0.5f, 1.0f,   0.5f, -0.5f, -0.5f, 1.0f,
+         0.5f,  0.5f, -0.5f, 1.0f,  -0.5f,  0.5f, -0.5f, 1.0f,
+        -0.5f, -0.5f,  0.5f, 1.0f,   0.5f, -0.5f,  0.5f, 1.0f,
+         0.5f,  0.5f,  0.5f, 1.0f,  -0.5f,  0.5f,  0.5f, 1.0f,
+    };
+    static const float normals[8*4] = {
+        -0.577f, -0.577f, -0.577f, 0.0f,   0.577f, -0.577f, -0.577f, 0.0f,
+         0.577f,  0.577f, -0.577f, 0.0f,  -0.577f,  0.577f, -0.577f, 0.0f,
+        -0.577f, -0.577f,  0.577f, 0.0f,   0.577f, -0.577f,  0.577f, 0.0f,
+         0.577f,  0.577f,  0.577f, 0.0f,  -0.577f,  0.577f,  0.577f, 0.0f,
+    };
+    static const GLuint indices[g_PlaceholderNumIndices] = {
+        0, 3, 2,  0, 2, 1, // z = -0.5
+        4, 5, 6,  4, 6, 7, // z = +0.5
+        0, 4, 7,  0, 7, 3, // x = -0.5
+        1, 2, 6,  1, 6, 5, // x = +0.5
+        0, 1, 5,  0, 5, 4, // y = -0.5
+        3, 7, 6,  3, 6, 2, // y = +0.5
+    };
+
+    glGenVertexArrays(1, &g_PlaceholderVAO);
+    GLState_BindVertexArray(g_PlaceholderVAO);
+
+    GLuint buffer_ids[3];
+    glGenBuffers(3, buffer_ids);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, buffer_ids[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 0)" em "shader_vertex.glsl"
+    glEnableVertexAttribArray(0);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, buffer_ids[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(normals), normals, GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 1)"
+    glEnableVertexAttribArray(1);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_ids[2]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    GLState_BindVertexArray(0);
+    PerfHud_AddBufferMemory(sizeof(positions) + sizeof(normals) + sizeof(indices));
+
+    // Textura de um único texel cinza. Com um texel não há níveis de mipmap
+    // além do primeiro, então os samplers com mipmap podem amostrá-la.
+    static const unsigned char gray[3] = { 128, 128, 128 };
+    glGenTextures(1, &g_PlaceholderTexture);
+    GLState_ActiveTexture(GL_TEXTURE0);
+    GLState_BindTexture(GL_TEXTURE_2D, g_PlaceholderTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, gray);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+}
+
+// Registra em g_VirtualScene um objeto (com o nome do arquivo, como em
+// todos os modelos da cena) desenhado como a caixa substituta até que o seu
+// modelo seja carregado.
+void AddPlaceholderToVirtualScene(const char* name)
+{
+    SceneObject theobject;
+    theobject.name           = name;
+    theobject.first_index    = 0;
+    theobject.num_indices    = g_PlaceholderNumIndices;
+    theobject.rendering_mode = GL_TRIANGLES;
+    theobject.vertex_array_object_id = g_PlaceholderVAO;
+    theobject.base_vertex    = 0;
+    theobject.bbox_min = glm::vec3(-0.5f, -0.5f, -0.5f);
+    theobject.bbox_max = glm::vec3( 0.5f,  0.5f,  0.5f);
+    theobject.lods.count = 0;
+    theobject.lod_state = LodState();
+    theobject.meshlets.count = 0;
+    g_VirtualScene[name] = theobject;
+}
+
+// Liga a textura substituta à unidade de uma textura ainda não carregada.
+static void BindPlaceholderTexture(GLuint textureunit)
+{
+    GLState_ActiveTexture(GL_TEXTURE0 + textureunit);
+    GLState_BindTexture(GL_TEXTURE_2D, g_PlaceholderTexture);
+}
+
+void LoadOrStreamTextureImage(const char* filename, StreamedAssets* streamed)
+{
+    if (streamed == NULL)
+    {
+        if (AssetPack_IsOpen())
+            LoadTextureImage(filename);
+        else
+            QueueTextureImage(filename);
+        return;
+    }
+
+    // A unidade de textura é reservada agora, mantendo a ordem das unidades
+    // usada em "shader_fragment.glsl".
+    GLuint textureunit = g_NumLoadedTextures++;
+    const char* name = strrchr(filename, '/');
+    name = (name != NULL) ? name + 1 : filename;
+    (*streamed)[name].push_back(Streaming_AddTexture(filename, textureunit));
+    BindPlaceholderTexture(textureunit);
+}
+
+// Apaga uma textura carregada sob demanda, voltando a usar a substituta, e
+// retorna os bytes liberados na GPU. "bytes" é o tamanho de uma textura fora
+// do cache de texturas.
+size_t RemoveTextureImage(GLuint textureunit, GLuint texture_id, size_t bytes)
+{
+    BindPlaceholderTexture(textureunit);
+
+    // Uma textura compartilhada só é apagada pela última unidade que a usa,
+    // com os bytes registrados quando foi criada.
+    if (TextureCache_Release(texture_id, &bytes))
+    {
+        GLState_DeleteTexture(texture_id);
+        PerfHud_RemoveTextureMemory(bytes);
+        return bytes;
+    }
+    return 0;
+}
+
+// Define o "object_id" dos shaders, que escolhe o material do objeto, e o
+// guarda para DrawVirtualObject(): um mesmo modelo é exposto com vários
+// materiais, e cada par modelo/material tem o seu impostor.
+void SetObjectId(GLint object_id)
+{
+    g_ObjectId = object_id;
+    GLState_Uniform1i(object_id_uniform, object_id);
 }
 
 // Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
 // dos objetos na função BuildTrianglesAndAddToVirtualScene().
-void DrawVirtualObject(const char* object_name)
+void DrawVirtualObject(const char* object_name, const glm::mat4& model)
 {
-    // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
-    // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
-    // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
-    glBindVertexArray(g_VirtualScene[object_name].vertex_array_object_id);
-
-    // Setamos as variáveis "bbox_min" e "bbox_max" do fragment shader
-    // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
-    glm::vec3 bbox_min = g_VirtualScene[object_name].bbox_min;
-    glm::vec3 bbox_max = g_VirtualScene[object_name].bbox_max;
-    glUniform4f(bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
-    glUniform4f(bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
+    SceneObject& object = g_VirtualScene[object_name];
+
+    // Objetos expostos pequenos na tela vão para a fila de impostores,
+    // desenhada ao fim da cena (veja impostor.h).
+    if (Impostor_Draw(object_name, g_ObjectId, model, object.bbox_min, object.bbox_max))
+        return;
+
+    // Objetos de triângulos da arena entram na fila do envio indireto,
+    // desenhada ao fim da cena com o registro do objeto no lugar dos uniforms
+    // (veja multidraw.h).
+    bool multi_draw = MultiDraw_IsActive() && object.vertex_array_object_id == MeshArena_VertexArray()
+                      && object.rendering_mode == GL_TRIANGLES;
+    if (multi_draw)
+    {
+        MultiDraw_AddObject(model, g_ObjectId, object.bbox_min, object.bbox_max);
+    }
+    else
+    {
+        // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
+        // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
+        // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
+        GLState_BindVertexArray(object.vertex_array_object_id);
+
+        // Setamos as variáveis "bbox_min" e "bbox_max" dos shaders
+        // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
+        glm::vec3 bbox_min = object.bbox_min;
+        glm::vec3 bbox_max = object.bbox_max;
+        GLState_Uniform4f(bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
+        GLState_Uniform4f(bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
+    }
 
     // Pedimos para a GPU rasterizar os vértices dos eixos XYZ
     // apontados pelo VAO como linhas. Veja a definição de
     // g_VirtualScene[""] dentro da função BuildTrianglesAndAddToVirtualScene(), e veja
     // a documentação da função glDrawElements() em
-    // http://docs.gl/gl3/glDrawElements.
-    glDrawElements(
-        g_VirtualScene[object_name].rendering_mode,
-        g_VirtualScene[object_name].num_indices,
+    // http://docs.gl/gl3/glDrawElements. O "base vertex" do objeto é somado
+    // a cada índice (veja mesharena.h).
+    //
+    // Objetos com níveis de detalhe desenham os índices do nível escolhido
+    // pelo tamanho na tela com a matriz "model" (veja lod.h).
+    size_t first_index = object.first_index;
+    size_t num_indices = object.num_indices;
+    int level = Lod_Select(object.lods, num_indices, &object.lod_state, g_ObjectId, model, object.bbox_min, object.bbox_max);
+    if (level > 0)
+    {
+        first_index = object.lods.first_index[level - 1];
+        num_indices = object.lods.num_indices[level - 1];
+    }
+
+    // Na malha original dos objetos grandes, somente os meshlets dentro do
+    // frustum e não todos de costas para a câmera (veja meshlet.h).
+    if (level == 0 && object.meshlets.count > 0)
+    {
+        GLsizei* counts = FrameArena_AllocArray<GLsizei>(object.meshlets.count);
+        const void** offsets = FrameArena_AllocArray<const void*>(object.meshlets.count);
+        int ranges = Meshlet_Cull(object.meshlets, model, counts, offsets);
+        if (ranges >= 0 && multi_draw)
+        {
+            for (int r = 0; r < ranges; ++r)
+                MultiDraw_AddCommand(counts[r], (size_t)offsets[r] / sizeof(GLuint), object.base_vertex);
+            return;
+        }
+        if (ranges >= 0)
+        {
+            GLint* base_vertices = FrameArena_AllocArray<GLint>(object.meshlets.count);
+            GLsizei drawn = 0;
+            for (int r = 0; r < ranges; ++r)
+            {
+                drawn += counts[r];
+                base_vertices[r] = object.base_vertex;
+            }
+            if (ranges > 0)
+            {
+                glMultiDrawElementsBaseVertex(object.rendering_mode, counts, GL_UNSIGNED_INT, offsets, ranges, base_vertices);
+                PerfHud_CountDraw(drawn / 3);
+            }
+            return;
+        }
+    }
+
+    if (multi_draw)
+    {
+        MultiDraw_AddCommand((GLsizei)num_indices, first_index, object.base_vertex);
+        return;
+    }
+
+    glDrawElementsBaseVertex(
+        object.rendering_mode,
+        num_indices,
         GL_UNSIGNED_INT,
-        (void*)(g_VirtualScene[object_name].first_index * sizeof(GLuint))
+        (void*)(first_index * sizeof(GLuint)),
+        object.base_vertex
     );
+    PerfHud_CountDraw(object.rendering_mode == GL_TRIANGLES ? num_indices / 3 : 0);
 
-    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
-    // alterar o mesmo. Isso evita bugs.
-    glBindVertexArray(0);
+    // Não "desligamos" o VAO aqui: objetos consecutivos que compartilham o
+    // mesmo VAO não precisam religá-lo. Como todas as alterações de VAO passam
+    // pelo cache de estado (glstate.h), nenhuma operação posterior altera este
+    // VAO por engano.
+}
+
+// Desenha uma vista de um impostor: a malha, levada à esfera de raio 1 na
+// origem, com o shader no modo de preparo. Veja impostor.h.
+bool BakeImpostorView(const char* name, int object_id, const glm::mat4& view, const glm::mat4& projection)
+{
+    std::map<std::string, SceneObject>::iterator it = g_VirtualScene.find(name);
+    if (it == g_VirtualScene.end())
+        return false;
+
+    const SceneObject& object = it->second;
+    if (g_PlaceholderVAO != 0 && object.vertex_array_object_id == g_PlaceholderVAO)
+        return false;
+
+    glm::mat4 model = Impostor_BakeModel(object.bbox_min, object.bbox_max);
+    GLState_UniformMatrix4fv(model_uniform      , 1 , GL_FALSE , glm::value_ptr(model));
+    GLState_UniformMatrix4fv(view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
+    GLState_UniformMatrix4fv(projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
+    GLState_Uniform1i(impostor_bake_uniform, 1);
+    SetObjectId(object_id);
+    GLState_Uniform4f(bbox_min_uniform, object.bbox_min.x, object.bbox_min.y, object.bbox_min.z, 1.0f);
+    GLState_Uniform4f(bbox_max_uniform, object.bbox_max.x, object.bbox_max.y, object.bbox_max.z, 1.0f);
+
+    // Cada vista tem poucos pixels: basta o nível de detalhe mais simples
+    // cujo erro fica abaixo do limite nesta escala (veja lod.h).
+    float radius = 0.5f * glm::length(object.bbox_max - object.bbox_min);
+    int level = Lod_SelectForScale(object.lods, 0.5f * IMPOSTOR_TILE / (radius * IMPOSTOR_MARGIN));
+    size_t first_index = (level > 0) ? object.lods.first_index[level - 1] : object.first_index;
+    size_t num_indices = (level > 0) ? object.lods.num_indices[level - 1] : object.num_indices;
+
+    GLState_BindVertexArray(object.vertex_array_object_id);
+    glDrawElementsBaseVertex(
+        object.rendering_mode,
+        num_indices,
+        GL_UNSIGNED_INT,
+        (void*)(first_index * sizeof(GLuint)),
+        object.base_vertex
+    );
+    return true;
+}
+
+// Objetos expostos nos estandes que podem ser desenhados como impostores,
+// com os Ks e q de "shader_fragment.glsl" (ou "shader_vertex.glsl", para a
+// esfera com Gouraud). O museu e os pedestais nunca ficam pequenos na tela;
+// VETOR_RESULTANTE não tem material no shader.
+void InitImpostors()
+{
+    static const ImpostorExhibit exposicoes[] = {
+        { "triceratop",    DINOSSAURO,          glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "plano_gc_real", PLANO_GC_REAL,       glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "vetor",         VETOR_ESTATICO,      glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "vetor",         VETOR_MOVE,          glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "cubo",          CUBO_HIERARQUICA,    glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "triangulo",     TRIANGULO,           glm::vec3(0.8f, 0.8f, 0.8f), 20.0f },
+        { "cow",           VACA,                glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "cubo",          CUBO,                glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "rosquinha_1",   ROSQUINHA_1,         glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "rosquinha_2",   ROSQUINHA_2,         glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "lampada",       LAMPADA,             glm::vec3(0.7f, 0.7f, 0.7f), 10.0f },
+        { "esfera",        ESFERA_GOURAUD,      glm::vec3(0.8f, 0.8f, 0.8f), 40.0f },
+        { "esfera",        ESFERA,              glm::vec3(0.8f, 0.8f, 0.9f), 40.0f },
+        { "esfera",        ESFERA_BLINN,        glm::vec3(0.8f, 0.8f, 0.9f), 40.0f },
+        { "chaleira",      CHALEIRA_PLANA,      glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "chaleira",      CHALEIRA_CUBICA,     glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "chaleira",      CHALEIRA_ESFERICA,   glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "chaleira",      CHALEIRA_CILINDRICA, glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+        { "plano",         PLANO,               glm::vec3(0.5f, 0.5f, 0.5f), 20.0f },
+    };
+    Impostor_Init(exposicoes, sizeof(exposicoes) / sizeof(exposicoes[0]), BakeImpostorView);
+}
+
+// Matrizes de modelagem do museu, dos 18 estandes (0 a 8 na parede de z
+// negativo, 9 a 17 na de z positivo, virados para o centro) e do
+// triceratops.
+glm::mat4 ModelMuseu()
+{
+    return Matrix_Translate(-21.5f, 1.0f, 0.0f)
+         * Matrix_Scale(24.0f, 6.0f, 12.0f);
+}
+
+glm::mat4 ModelEstande(int estande)
+{
+    float estandes = 4.0f * (estande % 9);
+    if (estande < 9)
+        return Matrix_Translate(-1.32f*estandes, -4.8f, -11.0f)
+             * Matrix_Scale(0.95f, 1.2f, 0.95f);
+    return Matrix_Translate(-1.32f*estandes, -4.8f, 11.0f)
+         * Matrix_Scale(0.95f, 1.2f, 0.95f)
+         * Matrix_Rotate_Y(M_PI);
+}
+
+glm::mat4 ModelDinossauro()
+{
+    return Matrix_Translate(-22.0f, -5.0f, 1.0f)
+         * Matrix_Scale(2.0f, 2.0f, 2.0f);
+}
+
+// Preenche "source" com o objeto "name" de g_VirtualScene. Retorna false se
+// a malha ainda não foi carregada.
+static bool GetStaticSource(const char* name, int object_id, const glm::mat4& model, StaticBatchSource* source)
+{
+    std::map<std::string, SceneObject>::iterator it = g_VirtualScene.find(name);
+    if (it == g_VirtualScene.end() || it->second.vertex_array_object_id == g_PlaceholderVAO)
+        return false;
+
+    const SceneObject& object = it->second;
+    source->name        = name;
+    source->object_id   = object_id;
+    source->model       = model;
+    source->vertex_array_object_id = object.vertex_array_object_id;
+    source->base_vertex = object.base_vertex;
+    source->first_index = object.first_index;
+    source->num_indices = object.num_indices;
+    source->bbox_min    = object.bbox_min;
+    source->bbox_max    = object.bbox_max;
+    return true;
+}
+
+// Junta o museu e os estandes em lotes (veja staticbatch.h), se as suas
+// malhas já estiverem carregadas. O triceratops, também imóvel, fica de
+// fora: no lote ele perderia os níveis de detalhe, os meshlets e o
+// impostor, e desenhar a malha inteira em todo quadro custa mais do que as
+// chamadas economizadas.
+void InitStaticBatches()
+{
+    if (!StaticBatch_IsEnabled() || StaticBatch_IsBuilt())
+        return;
+
+    StaticBatchSource sources[1 + NUM_ESTANDES];
+    int count = 0;
+    bool ready = GetStaticSource("museu", MUSEU, ModelMuseu(), &sources[count++]);
+    for (int estande = 0; estande < NUM_ESTANDES; ++estande)
+        ready = ready && GetStaticSource("estande", ESTANDE, ModelEstande(estande), &sources[count++]);
+    if (ready)
+        StaticBatch_Build(sources, count);
+}
+
+// Cria os conjuntos de instâncias testadas na GPU (veja instancecull.h): os
+// estandes, quando não estão nos lotes estáticos, e a multidão de "--crowd",
+// cubos pequenos em uma grade sobre o chão do museu. Uma vez, depois dos
+// lotes estáticos.
+void InitInstanceSets()
+{
+    static bool initialized = false;
+    if (initialized)
+        return;
+    initialized = true;
+
+    int crowd = InstanceCull_CrowdSize();
+    const SceneObject& cubo = g_VirtualScene["cubo"];
+    if (crowd > 0)
+    {
+        const SceneObject& museu = g_VirtualScene["museu"];
+        glm::vec4 museu_min = ModelMuseu() * glm::vec4(museu.bbox_min, 1.0f);
+        glm::vec4 museu_max = ModelMuseu() * glm::vec4(museu.bbox_max, 1.0f);
+
+        const float scale = 0.15f;
+        const float margin = 2.0f;
+        int columns = (int)ceilf(sqrtf((float)crowd));
+        int rows = (crowd + columns - 1) / columns;
+        g_CrowdModels.reserve(crowd);
+        for (int c = 0; c < crowd; ++c)
+        {
+            float u = (columns > 1) ? (float)(c % columns) / (columns - 1) : 0.5f;
+            float v = (rows > 1) ? (float)(c / columns) / (rows - 1) : 0.5f;
+            float x = museu_min.x + margin + u * (museu_max.x - museu_min.x - 2.0f * margin);
+            float z = museu_min.z + margin + v * (museu_max.z - museu_min.z - 2.0f * margin);
+            float y = museu_min.y - scale * cubo.bbox_min.y;
+            g_CrowdModels.push_back(Matrix_Translate(x, y, z) * Matrix_Scale(scale, scale, scale));
+        }
+    }
+
+    if (!InstanceCull_IsEnabled())
+        return;
+
+    if (!StaticBatch_IsBuilt())
+    {
+        const SceneObject& estande = g_VirtualScene["estande"];
+        glm::mat4 models[NUM_ESTANDES];
+        for (int e = 0; e < NUM_ESTANDES; ++e)
+            models[e] = ModelEstande(e);
+        g_StandInstances = InstanceCull_CreateSet(models, NUM_ESTANDES, ESTANDE, estande.bbox_min, estande.bbox_max);
+    }
+    if (crowd > 0)
+        g_CrowdInstances = InstanceCull_CreateSet(g_CrowdModels.data(), crowd, CUBO, cubo.bbox_min, cubo.bbox_max);
+}
+
+// Desenha as instâncias visíveis de um conjunto com a malha atual do objeto.
+void DrawInstances(int set, const char* object_name)
+{
+    const SceneObject& object = g_VirtualScene[object_name];
+    InstanceCull_Draw(set, object.vertex_array_object_id, object.rendering_mode, object.first_index, object.num_indices,
+                      object.base_vertex);
+}
+
+// Desenha os lotes estáticos com a matriz identidade: os vértices já estão
+// no sistema de coordenadas do mundo.
+void DrawStaticBatches()
+{
+    glm::mat4 identity = Matrix_Identity();
+    GLState_UniformMatrix4fv(model_uniform, 1 , GL_FALSE , glm::value_ptr(identity));
+    GLState_Uniform1i(static_batch_uniform, 1);
+    for (int b = 0; b < StaticBatch_Count(); ++b)
+    {
+        const StaticBatch& batch = StaticBatch_Get(b);
+        SetObjectId(batch.object_id);
+        GLState_Uniform4f(bbox_min_uniform, batch.bbox_min.x, batch.bbox_min.y, batch.bbox_min.z, 1.0f);
+        GLState_Uniform4f(bbox_max_uniform, batch.bbox_max.x, batch.bbox_max.y, batch.bbox_max.z, 1.0f);
+        GLState_BindVertexArray(batch.vertex_array_object_id);
+        glDrawElements(GL_TRIANGLES, batch.num_indices, GL_UNSIGNED_INT, (void*)0);
+        PerfHud_CountDraw(batch.num_indices / 3);
+    }
+    GLState_Uniform1i(static_batch_uniform, 0);
 }
 
 // Função que carrega os shaders de vértices e de fragmentos que serão
@@ -1530,7 +2485,7 @@ void LoadShadersFromFiles()
 
     // Deletamos o programa de GPU anterior, caso ele exista.
     if ( program_id != 0 )
-        glDeleteProgram(program_id);
+        GLState_DeleteProgram(program_id);
 
     // Criamos um programa de GPU utilizando os shaders carregados acima.
     program_id = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
@@ -1549,10 +2504,13 @@ void LoadShadersFromFiles()
     acerto_ou_erro_est1 = glGetUniformLocation(program_id, "acerto_ou_erro_est1");
     cor_lampada_shader = glGetUniformLocation(program_id, "cor_lampada");
     direcao_textura_plana_shader = glGetUniformLocation(program_id, "direcao_planar");
+    impostor_bake_uniform = glGetUniformLocation(program_id, "impostor_bake");
+    static_batch_uniform = glGetUniformLocation(program_id, "static_batch");
+    multi_draw_uniform = glGetUniformLocation(program_id, "multi_draw");
 
 
     // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
-    glUseProgram(program_id);
+    GLState_UseProgram(program_id);
     glUniform1i(glGetUniformLocation(program_id, "TextureImage0"), 0);
     glUniform1i(glGetUniformLocation(program_id, "TextureImage1"), 1);
     glUniform1i(glGetUniformLocation(program_id, "TextureImage2"), 2);
@@ -1577,7 +2535,7 @@ void LoadShadersFromFiles()
     glUniform1i(glGetUniformLocation(program_id, "TextureImage21"), 21);
 
 
-    glUseProgram(0);
+    GLState_UseProgram(0);
 }
 
 // Função que pega a matriz M e guarda a mesma no topo da pilha
@@ -1600,211 +2558,294 @@ void PopMatrix(glm::mat4& M)
     }
 }
 
-// Função que computa as normais de um ObjModel, caso elas não tenham sido
-// especificadas dentro do arquivo ".obj"
-void ComputeNormals(ObjModel* model)
-{
-    if ( !model->attrib.normals.empty() )
-        return;
-
-    // Primeiro computamos as normais para todos os TRIÂNGULOS.
-    // Segundo, computamos as normais dos VÉRTICES através do método proposto
-    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
-    // todas as faces que compartilham este vértice.
-
-    size_t num_vertices = model->attrib.vertices.size() / 3;
-
-    std::vector<int> num_triangles_per_vertex(num_vertices, 0);
-    std::vector<glm::vec4> vertex_normals(num_vertices, glm::vec4(0.0f,0.0f,0.0f,0.0f));
-
-    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
-    {
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
 
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
-        {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+// Constrói triângulos para futura renderização a partir de um ObjModel. Os
+// dados de "model" são liberados assim que a malha é montada, e os da malha
+// (na arena de carregamento, veja loadarena.h) após a cópia para a GPU.
+// Tempos e memória são registrados em "stats" (veja assetstats.h).
+void BuildTrianglesAndAddToVirtualScene(ObjModel* model, AssetStats* stats)
+{
+    // A malha é montada na CPU (veja objmodel.cpp) e depois copiada para a GPU.
+    double start = AssetStats_NowMs();
+    MeshData mesh;
+    BuildTriangles(model, &mesh);
+    stats->build_ms += AssetStats_NowMs() - start;
 
-            glm::vec4  vertices[3];
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
-                vertices[vertex] = glm::vec4(vx,vy,vz,1.0);
-            }
+    // O pico de memória é aqui: o modelo lido e a malha montada coexistem.
+    stats->cpu_peak_bytes  = ObjModelMemoryBytes(model) + MeshDataMemoryBytes(&mesh);
+    stats->vertices        = mesh.model_coefficients.size() / 4;
+    stats->unique_vertices = CountUniqueVertices(model);
+    ReleaseObjModel(model);
 
-            const glm::vec4  a = vertices[0];
-            const glm::vec4  b = vertices[1];
-            const glm::vec4  c = vertices[2];
+    AddMeshToVirtualScene(&mesh, stats, NULL);
 
-            const glm::vec4  n = crossproduct(b-a,c-a);
+    // Todos os buffers da malha foram copiados: liberamos a arena de uma vez.
+    LoadArena_Release();
 
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-                num_triangles_per_vertex[idx.vertex_index] += 1;
-                vertex_normals[idx.vertex_index] += n;
-                model->shapes[shape].mesh.indices[3*triangle + vertex].normal_index = idx.vertex_index;
-            }
-        }
-    }
+    AssetStats_Finish(stats);
+}
 
-    model->attrib.normals.resize( 3*num_vertices );
+// Lê uma malha cozida do pacote de recursos (veja assetpack.h) e a copia para
+// a GPU, como BuildTrianglesAndAddToVirtualScene(), sem ler o ".obj" nem
+// calcular normais.
+void LoadCookedMeshAndAddToVirtualScene(const char* objpath, AssetStats* stats)
+{
+    printf("Carregando modelo \"%s\" do pacote... ", objpath);
 
-    for (size_t i = 0; i < vertex_normals.size(); ++i)
+    double start = AssetStats_NowMs();
+    size_t size;
+    const void* cooked = AssetPack_Get(objpath, ASSETPACK_COOKED_MESH, &size);
+    MeshData mesh;
+    if (!ReadCookedMesh(cooked, size, &mesh, &stats->unique_vertices))
     {
-        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
-        n /= norm(n);
-        model->attrib.normals[3*i + 0] = n.x;
-        model->attrib.normals[3*i + 1] = n.y;
-        model->attrib.normals[3*i + 2] = n.z;
+        fprintf(stderr, "ERROR: Invalid cooked mesh \"%s\" in the asset pack.\n", objpath);
+        std::exit(EXIT_FAILURE);
     }
+    stats->load_ms         = AssetStats_NowMs() - start;
+    stats->file_bytes      = size;
+    stats->cpu_peak_bytes  = MeshDataMemoryBytes(&mesh);
+    stats->vertices        = mesh.model_coefficients.size() / 4;
+    printf("OK.\n");
+
+    AddMeshToVirtualScene(&mesh, stats, NULL);
+    LoadArena_Release();
+    AssetStats_Finish(stats);
 }
 
-// Constrói triângulos para futura renderização a partir de um ObjModel.
-void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
+// Registra em g_VirtualScene os objetos de uma malha desenhada com o VAO
+// "vertex_array_object_id", cujos índices começam em "first_index" no buffer
+// de índices e são somados a "base_vertex" (0 fora da arena de geometria,
+// veja mesharena.h).
+static void AddMeshObjectsToVirtualScene(const MeshData* mesh, GLuint vertex_array_object_id, size_t first_index, GLint base_vertex)
 {
-    GLuint vertex_array_object_id;
-    glGenVertexArrays(1, &vertex_array_object_id);
-    glBindVertexArray(vertex_array_object_id);
-
-    std::vector<GLuint> indices;
-    std::vector<float>  model_coefficients;
-    std::vector<float>  normal_coefficients;
-    std::vector<float>  texture_coefficients;
-
-    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    for (size_t shape = 0; shape < mesh->shapes.size(); ++shape)
     {
-        size_t first_index = indices.size();
-        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+        SceneObject theobject;
+        theobject.name           = mesh->shapes[shape].name;
+        theobject.first_index    = first_index + mesh->shapes[shape].first_index; // Primeiro índice
+        theobject.num_indices    = mesh->shapes[shape].num_indices; // Número de indices
+        theobject.rendering_mode = GL_TRIANGLES;       // Índices correspondem ao tipo de rasterização GL_TRIANGLES.
+        theobject.vertex_array_object_id = vertex_array_object_id;
+        theobject.base_vertex    = base_vertex;
 
-        const float minval = std::numeric_limits<float>::min();
-        const float maxval = std::numeric_limits<float>::max();
+        theobject.bbox_min = mesh->shapes[shape].bbox_min;
+        theobject.bbox_max = mesh->shapes[shape].bbox_max;
+        theobject.lods     = mesh->shapes[shape].lods;
+        for (int level = 0; level < theobject.lods.count; ++level)
+            theobject.lods.first_index[level] += first_index;
+        theobject.lod_state = LodState();
+        Meshlet_MakeSet(mesh->meshlets.data() + mesh->shapes[shape].first_meshlet, mesh->shapes[shape].num_meshlets,
+                        first_index, &theobject.meshlets);
 
-        glm::vec3 bbox_min = glm::vec3(maxval,maxval,maxval);
-        glm::vec3 bbox_max = glm::vec3(minval,minval,minval);
+        g_VirtualScene[mesh->shapes[shape].name] = theobject;
+    }
+}
 
-        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
-        {
-            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+// Copia uma malha montada para a GPU e registra os seus objetos em
+// g_VirtualScene. Os objetos OpenGL criados (ou os trechos da arena de
+// geometria, veja mesharena.h) são guardados em "buffers", se não for NULL,
+// para que a malha possa ser apagada depois (veja
+// RemoveMeshFromVirtualScene()).
+void AddMeshToVirtualScene(const MeshData* mesh, AssetStats* stats, MeshBuffers* buffers)
+{
+    double start = AssetStats_NowMs();
 
-            for (size_t vertex = 0; vertex < 3; ++vertex)
-            {
-                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
-
-                indices.push_back(first_index + 3*triangle + vertex);
-
-                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
-                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
-                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
-                //printf("tri %d vert %d = (%.2f, %.2f, %.2f)\n", (int)triangle, (int)vertex, vx, vy, vz);
-                model_coefficients.push_back( vx ); // X
-                model_coefficients.push_back( vy ); // Y
-                model_coefficients.push_back( vz ); // Z
-                model_coefficients.push_back( 1.0f ); // W
-
-                bbox_min.x = std::min(bbox_min.x, vx);
-                bbox_min.y = std::min(bbox_min.y, vy);
-                bbox_min.z = std::min(bbox_min.z, vz);
-                bbox_max.x = std::max(bbox_max.x, vx);
-                bbox_max.y = std::max(bbox_max.y, vy);
-                bbox_max.z = std::max(bbox_max.z, vz);
-
-                // Inspecionando o código da tinyobjloader, o aluno Bernardo
-                // Sulzbach (2017/1) apontou que a maneira correta de testar se
-                // existem normais e coordenadas de textura no ObjModel é
-                // comparando se o índice retornado é -1. Fazemos isso abaixo.
-
-                if ( idx.normal_index != -1 )
-                {
-                    const float nx = model->attrib.normals[3*idx.normal_index + 0];
-                    const float ny = model->attrib.normals[3*idx.normal_index + 1];
-                    const float nz = model->attrib.normals[3*idx.normal_index + 2];
-                    normal_coefficients.push_back( nx ); // X
-                    normal_coefficients.push_back( ny ); // Y
-                    normal_coefficients.push_back( nz ); // Z
-                    normal_coefficients.push_back( 0.0f ); // W
-                }
+    const MeshIndexVector& indices              = mesh->indices;
+    const MeshFloatVector& model_coefficients   = mesh->model_coefficients;
+    const MeshFloatVector& normal_coefficients  = mesh->normal_coefficients;
+    const MeshFloatVector& texture_coefficients = mesh->texture_coefficients;
 
-                if ( idx.texcoord_index != -1 )
-                {
-                    const float u = model->attrib.texcoords[2*idx.texcoord_index + 0];
-                    const float v = model->attrib.texcoords[2*idx.texcoord_index + 1];
-                    texture_coefficients.push_back( u );
-                    texture_coefficients.push_back( v );
-                }
-            }
-        }
+    MeshBuffers created = {}; // IDs 0 para os atributos ausentes
+    created.bytes = (model_coefficients.size() + normal_coefficients.size() + texture_coefficients.size()) * sizeof(float)
+                  + indices.size() * sizeof(GLuint);
 
-        size_t last_index = indices.size() - 1;
+    // Na arena de geometria a malha ocupa trechos dos buffers compartilhados,
+    // sem objetos OpenGL próprios; a memória é contada pela arena.
+    if (MeshArena_IsEnabled())
+    {
+        created.vertex_array_object_id = MeshArena_VertexArray();
+        MeshArena_Alloc(model_coefficients.size() / 4, indices.size(), &created.arena);
+        MeshArena_Upload(created.arena, model_coefficients.data(),
+                         normal_coefficients.empty() ? NULL : normal_coefficients.data(),
+                         texture_coefficients.empty() ? NULL : texture_coefficients.data(),
+                         indices.data());
+        AddMeshObjectsToVirtualScene(mesh, created.vertex_array_object_id, created.arena.first_index, (GLint)created.arena.first_vertex);
+
+        stats->gpu_vbo_bytes += created.bytes - indices.size() * sizeof(GLuint);
+        stats->gpu_ibo_bytes += indices.size() * sizeof(GLuint);
+        if (buffers != NULL)
+            *buffers = created;
+        stats->upload_ms = AssetStats_NowMs() - start;
+        return;
+    }
 
-        SceneObject theobject;
-        theobject.name           = model->shapes[shape].name;
-        theobject.first_index    = first_index; // Primeiro índice
-        theobject.num_indices    = last_index - first_index + 1; // Número de indices
-        theobject.rendering_mode = GL_TRIANGLES;       // Índices correspondem ao tipo de rasterização GL_TRIANGLES.
-        theobject.vertex_array_object_id = vertex_array_object_id;
+    GLuint vertex_array_object_id;
+    glGenVertexArrays(1, &vertex_array_object_id);
+    GLState_BindVertexArray(vertex_array_object_id);
 
-        theobject.bbox_min = bbox_min;
-        theobject.bbox_max = bbox_max;
+    AddMeshObjectsToVirtualScene(mesh, vertex_array_object_id, 0, 0);
 
-        g_VirtualScene[model->shapes[shape].name] = theobject;
-    }
+    created.vertex_array_object_id = vertex_array_object_id;
 
     GLuint VBO_model_coefficients_id;
     glGenBuffers(1, &VBO_model_coefficients_id);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
     glBufferData(GL_ARRAY_BUFFER, model_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
+    stats->gpu_vbo_bytes += model_coefficients.size() * sizeof(float);
+    PerfHud_AddBufferMemory(model_coefficients.size() * sizeof(float));
     glBufferSubData(GL_ARRAY_BUFFER, 0, model_coefficients.size() * sizeof(float), model_coefficients.data());
+    created.buffer_ids[MESHBUFFER_POSITIONS] = VBO_model_coefficients_id;
     GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
     GLint  number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
     glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(location);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
 
     if ( !normal_coefficients.empty() )
     {
         GLuint VBO_normal_coefficients_id;
         glGenBuffers(1, &VBO_normal_coefficients_id);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
+        GLState_BindBuffer(GL_ARRAY_BUFFER, VBO_normal_coefficients_id);
         glBufferData(GL_ARRAY_BUFFER, normal_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
+        stats->gpu_vbo_bytes += normal_coefficients.size() * sizeof(float);
+        PerfHud_AddBufferMemory(normal_coefficients.size() * sizeof(float));
         glBufferSubData(GL_ARRAY_BUFFER, 0, normal_coefficients.size() * sizeof(float), normal_coefficients.data());
+        created.buffer_ids[MESHBUFFER_NORMALS] = VBO_normal_coefficients_id;
         location = 1; // "(location = 1)" em "shader_vertex.glsl"
         number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
         glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(location);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     if ( !texture_coefficients.empty() )
     {
         GLuint VBO_texture_coefficients_id;
         glGenBuffers(1, &VBO_texture_coefficients_id);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
+        GLState_BindBuffer(GL_ARRAY_BUFFER, VBO_texture_coefficients_id);
         glBufferData(GL_ARRAY_BUFFER, texture_coefficients.size() * sizeof(float), NULL, GL_STATIC_DRAW);
+        stats->gpu_vbo_bytes += texture_coefficients.size() * sizeof(float);
+        PerfHud_AddBufferMemory(texture_coefficients.size() * sizeof(float));
         glBufferSubData(GL_ARRAY_BUFFER, 0, texture_coefficients.size() * sizeof(float), texture_coefficients.data());
+        created.buffer_ids[MESHBUFFER_TEXCOORDS] = VBO_texture_coefficients_id;
         location = 2; // "(location = 1)" em "shader_vertex.glsl"
         number_of_dimensions = 2; // vec2 em "shader_vertex.glsl"
         glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(location);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     GLuint indices_id;
     glGenBuffers(1, &indices_id);
 
     // "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+    stats->gpu_ibo_bytes += indices.size() * sizeof(GLuint);
+    PerfHud_AddBufferMemory(indices.size() * sizeof(GLuint));
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+    created.buffer_ids[MESHBUFFER_INDICES] = indices_id;
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // XXX Errado!
     //
 
     // "Desligamos" o VAO, evitando assim que operações posteriores venham a
     // alterar o mesmo. Isso evita bugs.
-    glBindVertexArray(0);
+    GLState_BindVertexArray(0);
+
+    if (buffers != NULL)
+        *buffers = created;
+
+    stats->upload_ms = AssetStats_NowMs() - start;
+}
+
+// Registra em g_VirtualScene uma malha cujos buffers já foram preenchidos
+// pela thread de envio (veja uploader.h). Somente o VAO, que não é
+// compartilhado entre contextos, é criado aqui. Na arena de geometria os
+// buffers da thread de envio são copiados, na GPU, para a arena e apagados.
+void AddUploadedMeshToVirtualScene(const MeshData* mesh, AssetStats* stats, MeshBuffers* buffers)
+{
+    size_t ibo_bytes = mesh->indices.size() * sizeof(GLuint);
+    stats->gpu_vbo_bytes += buffers->bytes - ibo_bytes;
+    stats->gpu_ibo_bytes += ibo_bytes;
+
+    if (MeshArena_IsEnabled())
+    {
+        MeshArena_Alloc(mesh->model_coefficients.size() / 4, mesh->indices.size(), &buffers->arena);
+        MeshArena_CopyFromBuffers(buffers->arena, buffers->buffer_ids[MESHBUFFER_POSITIONS], buffers->buffer_ids[MESHBUFFER_NORMALS],
+                                  buffers->buffer_ids[MESHBUFFER_TEXCOORDS], buffers->buffer_ids[MESHBUFFER_INDICES]);
+        for (int i = 0; i < MESHBUFFER_COUNT; ++i)
+        {
+            if (buffers->buffer_ids[i] != 0)
+                GLState_DeleteBuffer(buffers->buffer_ids[i]);
+            buffers->buffer_ids[i] = 0;
+        }
+        buffers->vertex_array_object_id = MeshArena_VertexArray();
+        AddMeshObjectsToVirtualScene(mesh, buffers->vertex_array_object_id, buffers->arena.first_index, (GLint)buffers->arena.first_vertex);
+        return;
+    }
+
+    GLuint vertex_array_object_id;
+    glGenVertexArrays(1, &vertex_array_object_id);
+    GLState_BindVertexArray(vertex_array_object_id);
+
+    GLState_BindBuffer(GL_ARRAY_BUFFER, buffers->buffer_ids[MESHBUFFER_POSITIONS]);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 0)" em "shader_vertex.glsl"
+    glEnableVertexAttribArray(0);
+    if (buffers->buffer_ids[MESHBUFFER_NORMALS] != 0)
+    {
+        GLState_BindBuffer(GL_ARRAY_BUFFER, buffers->buffer_ids[MESHBUFFER_NORMALS]);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 1)"
+        glEnableVertexAttribArray(1);
+    }
+    if (buffers->buffer_ids[MESHBUFFER_TEXCOORDS] != 0)
+    {
+        GLState_BindBuffer(GL_ARRAY_BUFFER, buffers->buffer_ids[MESHBUFFER_TEXCOORDS]);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0); // "(location = 2)"
+        glEnableVertexAttribArray(2);
+    }
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->buffer_ids[MESHBUFFER_INDICES]);
+    GLState_BindVertexArray(0);
+    buffers->vertex_array_object_id = vertex_array_object_id;
+
+    AddMeshObjectsToVirtualScene(mesh, vertex_array_object_id, 0, 0);
+    PerfHud_AddBufferMemory(buffers->bytes);
+}
+
+// Apaga da GPU uma malha criada por AddMeshToVirtualScene(), ou devolve os
+// seus trechos da arena de geometria. Os objetos da malha continuam em
+// g_VirtualScene, com a mesma bounding box, mas passam a ser desenhados como
+// a caixa substituta até serem carregados de novo.
+void RemoveMeshFromVirtualScene(const MeshBuffers* buffers)
+{
+    // Na arena todas as malhas têm o mesmo VAO; os objetos de uma malha são
+    // os que começam no seu primeiro vértice.
+    std::map<std::string, SceneObject>::iterator it;
+    for (it = g_VirtualScene.begin(); it != g_VirtualScene.end(); ++it)
+    {
+        SceneObject& object = it->second;
+        if (object.vertex_array_object_id != buffers->vertex_array_object_id
+            || object.base_vertex != (GLint)buffers->arena.first_vertex)
+            continue;
+        object.vertex_array_object_id = g_PlaceholderVAO;
+        object.base_vertex = 0;
+        object.first_index = 0;
+        object.num_indices = g_PlaceholderNumIndices;
+        object.lods.count  = 0;
+        object.meshlets.count = 0;
+    }
+
+    if (MeshArena_IsEnabled())
+    {
+        MeshArena_Free(buffers->arena);
+        return;
+    }
+
+    GLState_DeleteVertexArray(buffers->vertex_array_object_id);
+    for (int i = 0; i < MESHBUFFER_COUNT; ++i)
+        if (buffers->buffer_ids[i] != 0)
+            GLState_DeleteBuffer(buffers->buffer_ids[i]);
+    PerfHud_RemoveBufferMemory(buffers->bytes);
 }
 
 // Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
@@ -1839,22 +2880,37 @@ GLuint LoadShader_Fragment(const char* filename)
 // um arquivo GLSL e faz sua compilação.
 void LoadShader(const char* filename, GLuint shader_id)
 {
+    TRACE_ZONE("LoadShader");
+
     // Lemos o arquivo de texto indicado pela variável "filename"
     // e colocamos seu conteúdo em memória, apontado pela variável
-    // "shader_string".
-    std::ifstream file;
-    try {
-        file.exceptions(std::ifstream::failbit);
-        file.open(filename);
-    } catch ( std::exception& e ) {
-        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
-        std::exit(EXIT_FAILURE);
+    // "shader_string". Com o pacote de recursos (veja assetpack.h) o texto é
+    // lido diretamente do mapeamento.
+    std::string str;
+    const GLchar* shader_string;
+    GLint         shader_string_length;
+    if (AssetPack_IsOpen())
+    {
+        size_t size;
+        shader_string = (const GLchar*)AssetPack_Get(filename, ASSETPACK_TEXT, &size);
+        shader_string_length = static_cast<GLint>( size );
+    }
+    else
+    {
+        std::ifstream file;
+        try {
+            file.exceptions(std::ifstream::failbit);
+            file.open(filename);
+        } catch ( std::exception& e ) {
+            fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+            std::exit(EXIT_FAILURE);
+        }
+        std::stringstream shader;
+        shader << file.rdbuf();
+        str = shader.str();
+        shader_string = str.c_str();
+        shader_string_length = static_cast<GLint>( str.length() );
     }
-    std::stringstream shader;
-    shader << file.rdbuf();
-    std::string str = shader.str();
-    const GLchar* shader_string = str.c_str();
-    const GLint   shader_string_length = static_cast<GLint>( str.length() );
 
     // Define o código do shader GLSL, contido na string "shader_string"
     glShaderSource(shader_id, 1, &shader_string, &shader_string_length);
@@ -1975,6 +3031,11 @@ void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
     // O cast para float é necessário pois números inteiros são arredondados ao
     // serem divididos!
     g_ScreenRatio = (float)width / height;
+
+    // O erro dos níveis de detalhe e o tamanho abaixo do qual um objeto vira
+    // impostor são medidos em pixels (veja lod.h e impostor.h).
+    Lod_SetViewportHeight(height);
+    Impostor_SetViewportHeight(height);
 }
 
 // Variáveis globais que armazenam a última posição do cursor do mouse, para
@@ -1992,7 +3053,7 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_LeftMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        Replay_GetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
         g_LeftMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
@@ -2008,7 +3069,7 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_RightMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        Replay_GetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
         g_RightMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_RELEASE)
@@ -2123,7 +3184,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
 
         if (camera_view_ID == LOOK_AT_CAMERA)
             load_free_camera();
-        else
+        else if (window != NULL) // Sem janela no --bench (veja bench.h)
             glfwSetWindowShouldClose(window, GL_TRUE);
     }
 
@@ -2201,6 +3262,39 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
         g_ShowInfoText = !g_ShowInfoText;
     }
 
+    // Se o usuário apertar a tecla F1, mostramos/escondemos o painel de
+    // desempenho (veja perfhud.h).
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+    {
+        PerfHud_SetEnabled(!PerfHud_IsEnabled());
+    }
+
+    // Se o usuário apertar a tecla F2, ligamos/desligamos o cache de estado do
+    // OpenGL (veja glstate.h), imprimindo os contadores acumulados até então.
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
+    {
+        GLStateStats stats = GLState_GetStats();
+        GLState_SetEnabled(!GLState_IsEnabled());
+        GLState_ResetStats();
+        fprintf(stdout, "Cache de estado OpenGL %s (anterior: %llu chamadas descartadas, %llu repassadas).\n",
+                GLState_IsEnabled() ? "ligado" : "desligado", stats.filtered, stats.forwarded);
+        fflush(stdout);
+    }
+
+    // Se o usuário apertar a tecla F3, ligamos/desligamos a contagem de
+    // chamadas OpenGL (somente no build instrumentado, "make profile").
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+    {
+        gladProfileSetEnabled(!gladProfileIsEnabled());
+    }
+
+    // Se o usuário apertar a tecla F4, mostramos/escondemos os tempos de GPU
+    // e de CPU de cada etapa da renderização.
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        g_ShowGpuTimers = !g_ShowGpuTimers;
+    }
+
     // Se o usuário apertar a tecla R, recarregamos os shaders dos arquivos "shader_fragment.glsl" e "shader_vertex.glsl".
     // if (key == GLFW_KEY_R && action == GLFW_PRESS)
     // {
@@ -2221,31 +3315,40 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
 
     if (key == GLFW_KEY_1 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 10-1){
         cor_lampada = 1;
+        Impostor_Invalidate("lampada");
     }
     if (key == GLFW_KEY_2 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 10-1){
         cor_lampada = 2;
+        Impostor_Invalidate("lampada");
     }
     if (key == GLFW_KEY_3 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 10-1){
         cor_lampada = 3;
+        Impostor_Invalidate("lampada");
     }
     if (key == GLFW_KEY_4 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 10-1){
         cor_lampada = 4;
+        Impostor_Invalidate("lampada");
     }
     if (key == GLFW_KEY_5 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 10-1){
         cor_lampada = 5;
+        Impostor_Invalidate("lampada");
     }
     if (key == GLFW_KEY_6 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 10-1){
         cor_lampada = 6;
+        Impostor_Invalidate("lampada");
     }
 
     if (key == GLFW_KEY_1 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 14-1){
         direcao_textura_plana = 1;
+        Impostor_Invalidate("chaleira");
     }
     if (key == GLFW_KEY_2 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 14-1){
         direcao_textura_plana = 2;
+        Impostor_Invalidate("chaleira");
     }
     if (key == GLFW_KEY_3 && action == GLFW_PRESS && camera_view_ID == LOOK_AT_CAMERA && estande_atual == 14-1){
         direcao_textura_plana = 3;
+        Impostor_Invalidate("chaleira");
     }
 
 
@@ -2702,6 +3805,7 @@ void TextRendering_ShowModelViewProjection(
 
 
 void informative_text_stand(GLFWwindow* window){
+    TRACE_ZONE("informative_text_stand");
 
     float lineheight = TextRendering_LineHeight(window);
 
@@ -2795,6 +3899,50 @@ void informative_text_stand(GLFWwindow* window){
 }
 
 
+// Escrevemos na tela os tempos médios e o percentil 95 de GPU e de CPU de cada
+// etapa do quadro, medidos em quadros anteriores (veja "gputimer.h").
+void TextRendering_ShowGpuTimers(GLFWwindow* window)
+{
+    float lineheight = TextRendering_LineHeight(window);
+    float charwidth = TextRendering_CharWidth(window);
+
+    char buffer[80];
+    const char* header = "etapa            GPU ms   p95   CPU ms   p95";
+    float x = 1.0f - (strlen(header) + 1)*charwidth*0.75f;
+    float y = 1.0f - lineheight;
+
+    TextRendering_PrintString(window, header, x, y, 0.75f);
+
+    for (int pass = -1; pass < GPUTIMER_NUM_PASSES; ++pass)
+    {
+        GpuTimerStats s = (pass < 0) ? GpuTimer_GetFrameStats() : GpuTimer_GetStats(pass);
+        snprintf(buffer, 80, "%-14s %7.3f %6.3f %7.3f %6.3f", s.name, s.gpu_mean_ms, s.gpu_p95_ms, s.cpu_mean_ms, s.cpu_p95_ms);
+        y -= lineheight*0.75f;
+        TextRendering_PrintString(window, buffer, x, y, 0.75f);
+    }
+}
+
+// Escrevemos na tela o painel de desempenho (veja "perfhud.h"), no canto
+// inferior direito. O texto é recalculado poucas vezes por segundo; aqui
+// apenas desenhamos as linhas prontas.
+void TextRendering_ShowPerfHud(GLFWwindow* window)
+{
+    float lineheight = TextRendering_LineHeight(window) * 0.75f;
+    float charwidth = TextRendering_CharWidth(window) * 0.75f;
+
+    const char* const* lines;
+    int num_lines = PerfHud_GetLines(&lines);
+
+    float x = 1.0f - (PERFHUD_GRAPH_COLUMNS + 3)*charwidth;
+    float y = -1.0f + (num_lines + 1)*lineheight;
+
+    for (int i = 0; i < num_lines; ++i)
+    {
+        y -= lineheight;
+        TextRendering_PrintString(window, lines[i], x, y, 0.75f);
+    }
+}
+
 // set makeprg=cd\ ..\ &&\ make\ run\ >/dev/null
 // vim: set spell spelllang=pt_br :
 
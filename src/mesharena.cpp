@@ -0,0 +1,381 @@
+// Arena de geometria. Veja comentários em "include/mesharena.h".
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "mesharena.h"
+#include "glstate.h"
+#include "perfhud.h"
+
+// Bytes por vértice de cada região do buffer de vértices, na ordem das
+// regiões ("(location = 0)" a "(location = 2)" em "shader_vertex.glsl").
+#define MESHARENA_ATTRIBUTES 3
+static const size_t g_AttributeSizes[MESHARENA_ATTRIBUTES]      = { 4*sizeof(float), 4*sizeof(float), 2*sizeof(float) };
+static const GLint  g_AttributeDimensions[MESHARENA_ATTRIBUTES] = { 4, 4, 2 };
+static const size_t g_VertexBytes = 10*sizeof(float);
+
+struct FreeRange
+{
+    size_t first;
+    size_t count;
+};
+
+// Trechos livres de um buffer, ordenados pela posição. Posições e tamanhos
+// em vértices ou índices.
+struct FreeList
+{
+    FreeRange ranges[MESHARENA_MAX_FREE_RANGES];
+    int       count;
+    size_t    capacity;
+    size_t    used;
+};
+
+static bool           g_Enabled = true;
+static GLuint         g_VAO = 0;
+static GLuint         g_VertexBuffer = 0;
+static GLuint         g_IndexBuffer = 0;
+static FreeList       g_Vertices;
+static FreeList       g_Indices;
+static MeshArenaStats g_Stats;
+
+bool MeshArena_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--no-mesh-arena") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    return false;
+}
+
+bool MeshArena_IsEnabled()
+{
+    return g_Enabled;
+}
+
+GLuint MeshArena_VertexArray()
+{
+    return g_VAO;
+}
+
+// Devolve um trecho à lista, juntando-o aos vizinhos livres.
+static void InsertFree(FreeList* list, size_t first, size_t count)
+{
+    if (count == 0)
+        return;
+
+    int r = 0;
+    while (r < list->count && list->ranges[r].first < first)
+        ++r;
+    bool merge_prev = r > 0 && list->ranges[r-1].first + list->ranges[r-1].count == first;
+    bool merge_next = r < list->count && first + count == list->ranges[r].first;
+    if (merge_prev && merge_next)
+    {
+        list->ranges[r-1].count += count + list->ranges[r].count;
+        memmove(&list->ranges[r], &list->ranges[r+1], (list->count - r - 1) * sizeof(FreeRange));
+        list->count -= 1;
+    }
+    else if (merge_prev)
+    {
+        list->ranges[r-1].count += count;
+    }
+    else if (merge_next)
+    {
+        list->ranges[r].first  = first;
+        list->ranges[r].count += count;
+    }
+    else
+    {
+        if (list->count == MESHARENA_MAX_FREE_RANGES)
+        {
+            fprintf(stderr, "ERROR: too many free ranges in the mesh arena (max. %d).\n", MESHARENA_MAX_FREE_RANGES);
+            std::exit(EXIT_FAILURE);
+        }
+        memmove(&list->ranges[r+1], &list->ranges[r], (list->count - r) * sizeof(FreeRange));
+        list->ranges[r].first = first;
+        list->ranges[r].count = count;
+        list->count += 1;
+    }
+}
+
+// Retira "count" elementos do menor trecho livre que os comporta. Retorna
+// false se nenhum comporta.
+static bool TakeFree(FreeList* list, size_t count, size_t* first)
+{
+    int best = -1;
+    for (int r = 0; r < list->count; ++r)
+        if (list->ranges[r].count >= count && (best < 0 || list->ranges[r].count < list->ranges[best].count))
+            best = r;
+    if (best < 0)
+        return false;
+
+    FreeRange& range = list->ranges[best];
+    *first = range.first;
+    range.first += count;
+    range.count -= count;
+    if (range.count == 0)
+    {
+        memmove(&list->ranges[best], &list->ranges[best+1], (list->count - best - 1) * sizeof(FreeRange));
+        list->count -= 1;
+    }
+    list->used += count;
+    return true;
+}
+
+static size_t LargestFree(const FreeList& list)
+{
+    size_t largest = 0;
+    for (int r = 0; r < list.count; ++r)
+        largest = std::max(largest, list.ranges[r].count);
+    return largest;
+}
+
+// Nova capacidade para que caibam "count" elementos: pelo menos o dobro, e
+// o bastante considerando o trecho livre no fim do buffer, que se junta ao
+// espaço acrescentado.
+static size_t GrownCapacity(const FreeList& list, size_t count)
+{
+    size_t tail = 0;
+    if (list.count > 0 && list.ranges[list.count-1].first + list.ranges[list.count-1].count == list.capacity)
+        tail = list.ranges[list.count-1].count;
+
+    size_t capacity = 2 * list.capacity;
+    while (capacity - list.capacity + tail < count)
+        capacity *= 2;
+    return capacity;
+}
+
+// Cria um buffer de "bytes" bytes, ligado a GL_COPY_WRITE_BUFFER.
+static GLuint CreateBuffer(size_t bytes)
+{
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, NULL, GL_STATIC_DRAW);
+    PerfHud_AddBufferMemory(bytes);
+    g_Stats.bytes += bytes;
+    return buffer;
+}
+
+static void DeleteBuffer(GLuint buffer, size_t bytes)
+{
+    GLState_DeleteBuffer(buffer);
+    PerfHud_RemoveBufferMemory(bytes);
+    g_Stats.bytes -= bytes;
+}
+
+// Início da região do atributo "attribute" no buffer de vértices.
+static size_t RegionOffset(int attribute, size_t capacity)
+{
+    size_t offset = 0;
+    for (int a = 0; a < attribute; ++a)
+        offset += capacity * g_AttributeSizes[a];
+    return offset;
+}
+
+// Aponta os atributos do VAO para as regiões do buffer de vértices. Deixa o
+// VAO ligado.
+static void SetAttributePointers()
+{
+    GLState_BindVertexArray(g_VAO);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, g_VertexBuffer);
+    for (GLuint location = 0; location < MESHARENA_ATTRIBUTES; ++location)
+    {
+        glVertexAttribPointer(location, g_AttributeDimensions[location], GL_FLOAT, GL_FALSE, 0,
+                              (void*)RegionOffset(location, g_Vertices.capacity));
+        glEnableVertexAttribArray(location);
+    }
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void GrowVertices(size_t count)
+{
+    size_t old_capacity = g_Vertices.capacity;
+    size_t capacity = GrownCapacity(g_Vertices, count);
+
+    // Cada região é copiada para a sua nova posição, mais adiante no buffer.
+    GLuint buffer = CreateBuffer(capacity * g_VertexBytes);
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, g_VertexBuffer);
+    for (int a = 0; a < MESHARENA_ATTRIBUTES; ++a)
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, RegionOffset(a, old_capacity),
+                            RegionOffset(a, capacity), old_capacity * g_AttributeSizes[a]);
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, 0);
+    DeleteBuffer(g_VertexBuffer, old_capacity * g_VertexBytes);
+
+    g_VertexBuffer = buffer;
+    g_Vertices.capacity = capacity;
+    InsertFree(&g_Vertices, old_capacity, capacity - old_capacity);
+    SetAttributePointers();
+    g_Stats.grows += 1;
+}
+
+static void GrowIndices(size_t count)
+{
+    size_t old_capacity = g_Indices.capacity;
+    size_t capacity = GrownCapacity(g_Indices, count);
+
+    GLuint buffer = CreateBuffer(capacity * sizeof(GLuint));
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, g_IndexBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_capacity * sizeof(GLuint));
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    // O buffer de índices é guardado no VAO.
+    GLState_BindVertexArray(g_VAO);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    DeleteBuffer(g_IndexBuffer, old_capacity * sizeof(GLuint));
+
+    g_IndexBuffer = buffer;
+    g_Indices.capacity = capacity;
+    InsertFree(&g_Indices, old_capacity, capacity - old_capacity);
+    g_Stats.grows += 1;
+}
+
+void MeshArena_Init()
+{
+    if (!g_Enabled || g_VAO != 0)
+        return;
+
+    g_Vertices.capacity = MESHARENA_INITIAL_VERTICES;
+    g_Indices.capacity  = MESHARENA_INITIAL_INDICES;
+    InsertFree(&g_Vertices, 0, g_Vertices.capacity);
+    InsertFree(&g_Indices, 0, g_Indices.capacity);
+
+    g_VertexBuffer = CreateBuffer(g_Vertices.capacity * g_VertexBytes);
+    g_IndexBuffer  = CreateBuffer(g_Indices.capacity * sizeof(GLuint));
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glGenVertexArrays(1, &g_VAO);
+    SetAttributePointers();
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_IndexBuffer);
+    GLState_BindVertexArray(0);
+}
+
+void MeshArena_Alloc(size_t num_vertices, size_t num_indices, MeshArenaAllocation* allocation)
+{
+    allocation->first_vertex = 0;
+    allocation->num_vertices = num_vertices;
+    allocation->first_index  = 0;
+    allocation->num_indices  = num_indices;
+
+    if (num_vertices > 0 && !TakeFree(&g_Vertices, num_vertices, &allocation->first_vertex))
+    {
+        GrowVertices(num_vertices);
+        TakeFree(&g_Vertices, num_vertices, &allocation->first_vertex);
+    }
+    if (num_indices > 0 && !TakeFree(&g_Indices, num_indices, &allocation->first_index))
+    {
+        GrowIndices(num_indices);
+        TakeFree(&g_Indices, num_indices, &allocation->first_index);
+    }
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    g_Stats.allocations += 1;
+}
+
+// Preenche com zeros "bytes" bytes do buffer ligado a GL_COPY_WRITE_BUFFER,
+// sem alocar memória (a malha pode chegar durante o quadro, veja
+// streaming.h).
+static void WriteZeros(size_t offset, size_t bytes)
+{
+    static const float zeros[1024] = {};
+    while (bytes > 0)
+    {
+        size_t chunk = std::min(bytes, sizeof(zeros));
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, chunk, zeros);
+        offset += chunk;
+        bytes  -= chunk;
+    }
+}
+
+void MeshArena_Upload(const MeshArenaAllocation& allocation, const float* positions, const float* normals,
+                      const float* texcoords, const GLuint* indices)
+{
+    const float* arrays[MESHARENA_ATTRIBUTES] = { positions, normals, texcoords };
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, g_VertexBuffer);
+    for (int a = 0; a < MESHARENA_ATTRIBUTES; ++a)
+    {
+        size_t offset = RegionOffset(a, g_Vertices.capacity) + allocation.first_vertex * g_AttributeSizes[a];
+        size_t bytes  = allocation.num_vertices * g_AttributeSizes[a];
+        if (arrays[a] != NULL)
+            glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, arrays[a]);
+        else
+            WriteZeros(offset, bytes);
+    }
+
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, g_IndexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.first_index * sizeof(GLuint), allocation.num_indices * sizeof(GLuint), indices);
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void MeshArena_CopyFromBuffers(const MeshArenaAllocation& allocation, GLuint positions, GLuint normals,
+                               GLuint texcoords, GLuint indices)
+{
+    const GLuint buffers[MESHARENA_ATTRIBUTES] = { positions, normals, texcoords };
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, g_VertexBuffer);
+    for (int a = 0; a < MESHARENA_ATTRIBUTES; ++a)
+    {
+        size_t offset = RegionOffset(a, g_Vertices.capacity) + allocation.first_vertex * g_AttributeSizes[a];
+        size_t bytes  = allocation.num_vertices * g_AttributeSizes[a];
+        if (buffers[a] == 0)
+        {
+            WriteZeros(offset, bytes);
+            continue;
+        }
+        GLState_BindBuffer(GL_COPY_READ_BUFFER, buffers[a]);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, offset, bytes);
+    }
+
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, indices);
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, g_IndexBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, allocation.first_index * sizeof(GLuint),
+                        allocation.num_indices * sizeof(GLuint));
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, 0);
+    GLState_BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void MeshArena_Free(const MeshArenaAllocation& allocation)
+{
+    InsertFree(&g_Vertices, allocation.first_vertex, allocation.num_vertices);
+    InsertFree(&g_Indices, allocation.first_index, allocation.num_indices);
+    g_Vertices.used -= allocation.num_vertices;
+    g_Indices.used  -= allocation.num_indices;
+    g_Stats.frees += 1;
+}
+
+MeshArenaStats MeshArena_GetStats()
+{
+    MeshArenaStats stats = g_Stats;
+    stats.vertex_capacity       = g_Vertices.capacity;
+    stats.vertices_used         = g_Vertices.used;
+    stats.index_capacity        = g_Indices.capacity;
+    stats.indices_used          = g_Indices.used;
+    stats.vertex_free_ranges    = g_Vertices.count;
+    stats.index_free_ranges     = g_Indices.count;
+    stats.largest_free_vertices = LargestFree(g_Vertices);
+    stats.largest_free_indices  = LargestFree(g_Indices);
+    return stats;
+}
+
+// Fração do espaço livre fora do maior trecho livre, em porcentagem.
+static double Fragmentation(size_t capacity, size_t used, size_t largest_free)
+{
+    size_t free = capacity - used;
+    return (free > 0) ? 100.0 * (1.0 - (double)largest_free / free) : 0.0;
+}
+
+void MeshArena_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "Arena de geometria: desligada (--no-mesh-arena).\n");
+        return;
+    }
+
+    MeshArenaStats stats = MeshArena_GetStats();
+    fprintf(f, "Arena de geometria: %lu de %lu vertices e %lu de %lu indices em uso (%.1f MiB de GPU), %lu alocacoes, %lu liberacoes, %lu crescimentos.\n",
+            (unsigned long)stats.vertices_used, (unsigned long)stats.vertex_capacity,
+            (unsigned long)stats.indices_used, (unsigned long)stats.index_capacity,
+            stats.bytes / (1024.0*1024.0), stats.allocations, stats.frees, stats.grows);
+    fprintf(f, "Arena de geometria: %d trechos livres de vertices (fragmentacao %.1f%%) e %d de indices (fragmentacao %.1f%%).\n",
+            stats.vertex_free_ranges, Fragmentation(stats.vertex_capacity, stats.vertices_used, stats.largest_free_vertices),
+            stats.index_free_ranges, Fragmentation(stats.index_capacity, stats.indices_used, stats.largest_free_indices));
+}
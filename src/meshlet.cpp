@@ -0,0 +1,471 @@
+// Meshlets. Veja comentários em "include/meshlet.h".
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MESHLET_SSE 1
+#endif
+
+#include "meshlet.h"
+
+// Distância do olho, nas unidades do modelo, na projeção ortográfica.
+#define MESHLET_ORTHO_DISTANCE 1e4f
+
+// Soldagem dos cantos (os índices do objeto, 3 por triângulo) pela posição.
+struct PositionKey
+{
+    float p[3];
+    int   corner;
+
+    bool operator<(const PositionKey& k) const
+    {
+        if (p[0] != k.p[0]) return p[0] < k.p[0];
+        if (p[1] != k.p[1]) return p[1] < k.p[1];
+        return p[2] < k.p[2];
+    }
+    bool operator!=(const PositionKey& k) const
+    {
+        return p[0] != k.p[0] || p[1] != k.p[1] || p[2] != k.p[2];
+    }
+};
+
+static glm::vec3 CornerPosition(const MeshData* mesh, size_t index)
+{
+    const float* p = &mesh->model_coefficients[4*mesh->indices[index]];
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+// Esfera e cone das normais dos triângulos "triangles[0..count)" do objeto
+// que começa em "first_index".
+static void ComputeBounds(const MeshData* mesh, size_t first_index, const int* triangles, int count,
+                          const std::vector<glm::vec3>& normal, Meshlet* meshlet)
+{
+    glm::vec3 lo = CornerPosition(mesh, first_index + 3*triangles[0]);
+    glm::vec3 hi = lo;
+    for (int i = 0; i < count; ++i)
+        for (int k = 0; k < 3; ++k)
+        {
+            glm::vec3 p = CornerPosition(mesh, first_index + 3*triangles[i] + k);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+
+    glm::vec3 center = 0.5f * (lo + hi);
+    float radius = 0.0f;
+    for (int i = 0; i < count; ++i)
+        for (int k = 0; k < 3; ++k)
+            radius = std::max(radius, glm::length(CornerPosition(mesh, first_index + 3*triangles[i] + k) - center));
+
+    // Eixo: média das normais unitárias. O cone só serve se todas as normais
+    // estiverem a menos de 90 graus do eixo.
+    glm::vec3 axis(0.0f);
+    for (int i = 0; i < count; ++i)
+        axis += normal[triangles[i]];
+    float cutoff = 1.0f;
+    float length = glm::length(axis);
+    if (length > 1e-6f)
+    {
+        axis /= length;
+        float min_dot = 1.0f;
+        for (int i = 0; i < count; ++i)
+            if (normal[triangles[i]] != glm::vec3(0.0f))
+                min_dot = std::min(min_dot, glm::dot(axis, normal[triangles[i]]));
+        if (min_dot > 0.0f)
+            cutoff = sqrtf(1.0f - min_dot*min_dot);
+    }
+    else
+        axis = glm::vec3(0.0f, 0.0f, 1.0f);
+
+    meshlet->center      = center;
+    meshlet->radius      = radius;
+    meshlet->cone_axis   = axis;
+    meshlet->cone_cutoff = cutoff;
+}
+
+static void BuildShapeMeshlets(MeshData* mesh, MeshShape* shape)
+{
+    size_t first_index = shape->first_index;
+    int num_triangles = (int)(shape->num_indices / 3);
+    int num_corners = 3 * num_triangles;
+
+    std::vector<PositionKey> keys(num_corners);
+    for (int c = 0; c < num_corners; ++c)
+    {
+        glm::vec3 p = CornerPosition(mesh, first_index + c);
+        keys[c].p[0] = p.x;
+        keys[c].p[1] = p.y;
+        keys[c].p[2] = p.z;
+        keys[c].corner = c;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> position(num_corners);
+    int num_positions = 0;
+    for (int i = 0; i < num_corners; ++i)
+    {
+        if (i > 0 && keys[i-1] != keys[i])
+            num_positions += 1;
+        position[keys[i].corner] = num_positions;
+    }
+    num_positions += 1;
+
+    // Triângulos de cada posição.
+    std::vector<int> adjacency_first(num_positions + 1, 0);
+    std::vector<int> adjacency(num_corners);
+    for (int c = 0; c < num_corners; ++c)
+        adjacency_first[position[c] + 1] += 1;
+    for (int p = 0; p < num_positions; ++p)
+        adjacency_first[p + 1] += adjacency_first[p];
+    std::vector<int> fill(adjacency_first.begin(), adjacency_first.end() - 1);
+    for (int c = 0; c < num_corners; ++c)
+        adjacency[fill[position[c]]++] = c / 3;
+
+    // Normais unitárias das faces, pela ordem dos vértices (zero nos
+    // triângulos degenerados).
+    std::vector<glm::vec3> normal(num_triangles);
+    for (int t = 0; t < num_triangles; ++t)
+    {
+        glm::vec3 a = CornerPosition(mesh, first_index + 3*t + 0);
+        glm::vec3 b = CornerPosition(mesh, first_index + 3*t + 1);
+        glm::vec3 c = CornerPosition(mesh, first_index + 3*t + 2);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        normal[t] = (length > 0.0f) ? n / length : glm::vec3(0.0f);
+    }
+
+    std::vector<unsigned char> used(num_triangles, 0);
+    std::vector<int> position_stamp(num_positions, -1); // Meshlet que já inclui a posição
+    std::vector<int> triangle_stamp(num_triangles, -1); // Meshlet que já tem o triângulo como candidato
+    std::vector<int> order;
+    order.reserve(num_triangles);
+    std::vector<int> candidates;
+
+    shape->first_meshlet = mesh->meshlets.size();
+    int next_seed = 0;
+    for (int meshlet = 0; (int)order.size() < num_triangles; ++meshlet)
+    {
+        while (used[next_seed])
+            next_seed += 1;
+
+        int first_triangle = (int)order.size();
+        int num_vertices = 0;
+        glm::vec3 normal_sum(0.0f);
+        candidates.clear();
+
+        for (int t = next_seed; t >= 0; )
+        {
+            used[t] = 1;
+            order.push_back(t);
+            normal_sum += normal[t];
+            for (int k = 0; k < 3; ++k)
+            {
+                int p = position[3*t + k];
+                if (position_stamp[p] == meshlet)
+                    continue;
+                position_stamp[p] = meshlet;
+                num_vertices += 1;
+                for (int a = adjacency_first[p]; a < adjacency_first[p + 1]; ++a)
+                {
+                    int u = adjacency[a];
+                    if (!used[u] && triangle_stamp[u] != meshlet)
+                    {
+                        triangle_stamp[u] = meshlet;
+                        candidates.push_back(u);
+                    }
+                }
+            }
+            if ((int)order.size() - first_triangle == MESHLET_MAX_TRIANGLES)
+                break;
+
+            // Próximo triângulo: o vizinho que acrescenta menos posições e,
+            // entre esses, o de normal mais próxima da média do meshlet.
+            t = -1;
+            int best_new = 4;
+            float best_dot = -2.0f;
+            for (size_t i = 0; i < candidates.size(); )
+            {
+                int u = candidates[i];
+                if (used[u])
+                {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                ++i;
+
+                int p0 = position[3*u + 0], p1 = position[3*u + 1], p2 = position[3*u + 2];
+                int added = (position_stamp[p0] != meshlet)
+                          + (position_stamp[p1] != meshlet && p1 != p0)
+                          + (position_stamp[p2] != meshlet && p2 != p0 && p2 != p1);
+                if (num_vertices + added > MESHLET_MAX_VERTICES)
+                    continue;
+
+                float d = glm::dot(normal[u], normal_sum);
+                if (added < best_new || (added == best_new && d > best_dot))
+                {
+                    t = u;
+                    best_new = added;
+                    best_dot = d;
+                }
+            }
+        }
+
+        // Os índices ainda estão na ordem antiga: os triângulos do meshlet
+        // são lidos através de "order".
+        Meshlet m;
+        int count = (int)order.size() - first_triangle;
+        m.first_index = (unsigned int)(first_index + 3*first_triangle);
+        m.num_indices = (unsigned int)(3*count);
+        ComputeBounds(mesh, first_index, &order[first_triangle], count, normal, &m);
+        mesh->meshlets.push_back(m);
+    }
+    shape->num_meshlets = mesh->meshlets.size() - shape->first_meshlet;
+
+    // Os triângulos passam a ficar na ordem dos meshlets. Os níveis de
+    // detalhe apontam para os vértices, e não para os índices, e não mudam.
+    std::vector<unsigned int> old(mesh->indices.begin() + first_index, mesh->indices.begin() + first_index + num_corners);
+    for (int i = 0; i < num_triangles; ++i)
+        for (int k = 0; k < 3; ++k)
+            mesh->indices[first_index + 3*i + k] = old[3*order[i] + k];
+}
+
+void Meshlet_Build(MeshData* mesh)
+{
+    mesh->meshlets.clear();
+    for (size_t shape = 0; shape < mesh->shapes.size(); ++shape)
+    {
+        MeshShape& theshape = mesh->shapes[shape];
+        theshape.first_meshlet = mesh->meshlets.size();
+        theshape.num_meshlets  = 0;
+        if (theshape.num_indices / 3 >= MESHLET_MIN_TRIANGLES)
+            BuildShapeMeshlets(mesh, &theshape);
+    }
+}
+
+void Meshlet_MakeSet(const Meshlet* meshlets, size_t count, size_t first_index, MeshletSet* set)
+{
+    set->blocks.assign((count + 3) / 4, MeshletBlock());
+    set->count = (int)count;
+    set->num_indices = 0;
+    for (size_t m = 0; m < count; ++m)
+    {
+        MeshletBlock& block = set->blocks[m / 4];
+        int lane = (int)(m % 4);
+        block.center_x[lane]    = meshlets[m].center.x;
+        block.center_y[lane]    = meshlets[m].center.y;
+        block.center_z[lane]    = meshlets[m].center.z;
+        block.radius[lane]      = meshlets[m].radius;
+        block.axis_x[lane]      = meshlets[m].cone_axis.x;
+        block.axis_y[lane]      = meshlets[m].cone_axis.y;
+        block.axis_z[lane]      = meshlets[m].cone_axis.z;
+        block.cutoff[lane]      = meshlets[m].cone_cutoff;
+        block.first_index[lane] = (unsigned int)(first_index + meshlets[m].first_index);
+        block.num_indices[lane] = meshlets[m].num_indices;
+        set->num_indices += meshlets[m].num_indices;
+    }
+}
+
+static bool         g_Enabled = true;
+static glm::mat4    g_ViewProjection;
+static glm::vec3    g_Eye;     // Posição da câmera no mundo
+static glm::vec3    g_ViewDir; // Direção de visão no mundo
+static bool         g_Perspective = true;
+static MeshletStats g_Stats;
+
+bool Meshlet_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--no-meshlets") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    return false;
+}
+
+void Meshlet_BeginFrame(const glm::mat4& view, const glm::mat4& projection)
+{
+    // A câmera olha para -z no seu sistema de coordenadas.
+    glm::mat4 camera_to_world = glm::inverse(view);
+    g_ViewProjection = projection * view;
+    g_Eye            = glm::vec3(camera_to_world[3]);
+    g_ViewDir        = -glm::normalize(glm::vec3(camera_to_world[2]));
+    g_Perspective    = projection[2][3] != 0.0f;
+    g_Stats.frames  += 1;
+}
+
+// Planos do frustum no sistema de coordenadas do modelo (Gribb e Hartmann),
+// a partir de clip = projection*view*model, normalizados para que a
+// distância de um ponto seja dada nas unidades do modelo.
+static void ExtractPlanes(const glm::mat4& clip, float planes[6][4])
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        int axis = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        for (int j = 0; j < 4; ++j)
+            planes[i][j] = clip[j][3] + sign * clip[j][axis];
+        float length = sqrtf(planes[i][0]*planes[i][0] + planes[i][1]*planes[i][1] + planes[i][2]*planes[i][2]);
+        if (length > 0.0f)
+            for (int j = 0; j < 4; ++j)
+                planes[i][j] /= length;
+    }
+}
+
+// Bits (um por meshlet do bloco) dos meshlets fora do frustum, em "frustum",
+// e dos todos de costas para "eye", em "backface". Sem "cone" o teste de
+// costas não é feito.
+static void TestBlock(const MeshletBlock& block, const float planes[6][4], bool cone, const glm::vec3& eye,
+                      int* frustum, int* backface)
+{
+#ifdef MESHLET_SSE
+    __m128 cx = _mm_loadu_ps(block.center_x);
+    __m128 cy = _mm_loadu_ps(block.center_y);
+    __m128 cz = _mm_loadu_ps(block.center_z);
+    __m128 r  = _mm_loadu_ps(block.radius);
+    __m128 minus_r = _mm_sub_ps(_mm_setzero_ps(), r);
+
+    __m128 outside = _mm_setzero_ps();
+    for (int i = 0; i < 6; ++i)
+    {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planes[i][0])),
+                                         _mm_mul_ps(cy, _mm_set1_ps(planes[i][1]))),
+                              _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planes[i][2])),
+                                         _mm_set1_ps(planes[i][3])));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(d, minus_r));
+    }
+    *frustum = _mm_movemask_ps(outside);
+
+    *backface = 0;
+    if (cone)
+    {
+        __m128 vx = _mm_sub_ps(cx, _mm_set1_ps(eye.x));
+        __m128 vy = _mm_sub_ps(cy, _mm_set1_ps(eye.y));
+        __m128 vz = _mm_sub_ps(cz, _mm_set1_ps(eye.z));
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(block.axis_x)),
+                                         _mm_mul_ps(vy, _mm_loadu_ps(block.axis_y))),
+                              _mm_mul_ps(vz, _mm_loadu_ps(block.axis_z)));
+        __m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(block.cutoff), length), r);
+        *backface = _mm_movemask_ps(_mm_cmpge_ps(d, limit));
+    }
+#else
+    *frustum = 0;
+    *backface = 0;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        glm::vec3 c(block.center_x[lane], block.center_y[lane], block.center_z[lane]);
+        float r = block.radius[lane];
+        for (int i = 0; i < 6; ++i)
+            if (planes[i][0]*c.x + planes[i][1]*c.y + planes[i][2]*c.z + planes[i][3] < -r)
+                *frustum |= 1 << lane;
+
+        if (cone)
+        {
+            glm::vec3 v = c - eye;
+            glm::vec3 axis(block.axis_x[lane], block.axis_y[lane], block.axis_z[lane]);
+            if (glm::dot(v, axis) >= block.cutoff[lane] * glm::length(v) + r)
+                *backface |= 1 << lane;
+        }
+    }
+#endif
+}
+
+int Meshlet_Cull(const MeshletSet& set, const glm::mat4& model, int* counts, const void** offsets)
+{
+    if (!g_Enabled || set.count == 0)
+        return -1;
+
+    float planes[6][4];
+    ExtractPlanes(g_ViewProjection * model, planes);
+
+    // O teste de costas é feito no sistema de coordenadas do modelo, que
+    // preserva o lado de cada triângulo em relação ao olho. Uma reflexão
+    // (determinante negativo) inverte a ordem dos vértices na tela, e então
+    // não testamos.
+    bool cone = glm::determinant(glm::mat3(model)) > 0.0f;
+    glm::vec3 eye(0.0f);
+    if (cone)
+    {
+        glm::mat4 world_to_model = glm::inverse(model);
+        if (g_Perspective)
+            eye = glm::vec3(world_to_model * glm::vec4(g_Eye, 1.0f));
+        else
+            eye = -MESHLET_ORTHO_DISTANCE * glm::normalize(glm::vec3(world_to_model * glm::vec4(g_ViewDir, 0.0f)));
+    }
+
+    int ranges = 0;
+    unsigned int range_end = 0;
+    size_t drawn_indices = 0;
+    for (size_t b = 0; b < set.blocks.size(); ++b)
+    {
+        const MeshletBlock& block = set.blocks[b];
+        int lanes = std::min(4, set.count - 4*(int)b);
+        int valid = (1 << lanes) - 1;
+
+        int frustum, backface;
+        TestBlock(block, planes, cone, eye, &frustum, &backface);
+        frustum &= valid;
+        backface &= valid & ~frustum;
+        g_Stats.frustum_culled  += (unsigned long)((frustum & 1) + ((frustum >> 1) & 1) + ((frustum >> 2) & 1) + ((frustum >> 3) & 1));
+        g_Stats.backface_culled += (unsigned long)((backface & 1) + ((backface >> 1) & 1) + ((backface >> 2) & 1) + ((backface >> 3) & 1));
+
+        int visible = valid & ~(frustum | backface);
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            if (!(visible & (1 << lane)))
+                continue;
+
+            // Meshlets vizinhos no buffer de índices viram um só trecho.
+            unsigned int first = block.first_index[lane];
+            unsigned int num = block.num_indices[lane];
+            if (ranges > 0 && first == range_end)
+                counts[ranges - 1] += (int)num;
+            else
+            {
+                counts[ranges]  = (int)num;
+                offsets[ranges] = (const void*)(first * sizeof(unsigned int));
+                ranges += 1;
+            }
+            range_end = first + num;
+            drawn_indices += num;
+        }
+    }
+
+    g_Stats.draws           += 1;
+    g_Stats.tested          += (unsigned long)set.count;
+    g_Stats.ranges          += (unsigned long)ranges;
+    g_Stats.full_triangles  += set.num_indices / 3;
+    g_Stats.drawn_triangles += drawn_indices / 3;
+    return ranges;
+}
+
+MeshletStats Meshlet_GetStats()
+{
+    return g_Stats;
+}
+
+void Meshlet_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "Meshlets: desligados (--no-meshlets).\n");
+        return;
+    }
+
+    MeshletStats stats = Meshlet_GetStats();
+    double frames = (stats.frames > 0) ? (double)stats.frames : 1.0;
+    double reduction = (stats.full_triangles > 0) ? 100.0 * (1.0 - (double)stats.drawn_triangles / stats.full_triangles) : 0.0;
+    fprintf(f, "Meshlets: por quadro, %.1f testados e %.1f descartados (%.1f fora da vista, %.1f de costas); %llu de %llu triangulos enviados (%.1f%% a menos) em %.1f trechos por desenho.\n",
+            stats.tested / frames, (stats.frustum_culled + stats.backface_culled) / frames,
+            stats.frustum_culled / frames, stats.backface_culled / frames,
+            stats.drawn_triangles, stats.full_triangles, reduction,
+            stats.draws > 0 ? (double)stats.ranges / stats.draws : 0.0);
+}
@@ -0,0 +1,499 @@
+// Microbenchmarks das funções da CPU chamadas a cada quadro ou no
+// carregamento: construção e produto de matrizes (matrices.h), testes de
+// colisão e intersecção (geometry.h), curva de Bézier, cálculo de normais,
+// montagem das malhas (objmodel.h) e dos seus níveis de detalhe (lod.h) e
+// posicionamento de texto (textlayout.h),
+// e o carregamento de todos os modelos e texturas da cena com cada backend de
+// leitura em lote (assetio.h).
+//
+// É um executável separado, que não abre janela nem usa OpenGL ("make
+// microbench"). Cada caso é aquecido por MICROBENCH_WARMUP_MS, depois o
+// número de repetições por amostra é calibrado para que cada amostra dure
+// ao menos MICROBENCH_SAMPLE_MS, e são medidas "--samples" amostras (padrão
+// 30). O resultado (nanossegundos por chamada: média, desvio padrão, mínimo,
+// mediana e percentil 95) é mostrado no terminal e salvo em JSON.
+//
+// O carregamento da cena, que leva centenas de milissegundos, não é
+// calibrado: cada amostra é um carregamento completo, e são medidas
+// MICROBENCH_LOAD_SAMPLES amostras. Nos casos "frio" os arquivos são
+// retirados do cache de páginas do sistema antes de cada amostra (veja
+// AssetIO_DropCache()), como na primeira execução após ligar o computador.
+//
+// Argumentos de linha de comando reconhecidos:
+//   --output arquivo   Arquivo JSON de saída (padrão "microbench.json")
+//   --filter texto     Roda somente os casos cujo nome contém "texto"
+//   --samples N        Número de amostras por caso
+//
+// Os modelos são lidos de "../../data/", como no programa principal; rode a
+// partir de "bin/Linux" (ou "bin/macOS").
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "matrices.h"
+#include "geometry.h"
+#include "objmodel.h"
+#include "lod.h"
+#include "textlayout.h"
+#include "assetio.h"
+#include "loadarena.h"
+
+#include <stb_image.h>
+
+#define MICROBENCH_WARMUP_MS 50.0 // Duração do aquecimento de cada caso
+#define MICROBENCH_SAMPLE_MS 2.0  // Duração mínima de cada amostra
+#define MICROBENCH_LOAD_SAMPLES 5 // Amostras de cada caso de carregamento da cena
+
+typedef std::chrono::steady_clock Clock;
+
+struct MicroBenchResult
+{
+    std::string   name;
+    unsigned long iterations; // Repetições por amostra
+    int           samples;
+    double        mean_ns;
+    double        stddev_ns;
+    double        min_ns;
+    double        p50_ns;
+    double        p95_ns;
+};
+
+static std::vector<MicroBenchResult> g_Results;
+static const char* g_Filter  = NULL;
+static int         g_Samples = 30;
+
+// Impede que o compilador descarte o cálculo cujo resultado não é usado.
+template <typename T> static inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile char sink;
+    sink = *(const volatile char*)&value;
+#endif
+}
+
+// Calcula as estatísticas das amostras "ns" (nanossegundos por chamada,
+// cada amostra com "iterations" chamadas), mostra-as e as guarda em
+// g_Results.
+static void Report(const char* name, unsigned long iterations, std::vector<double> ns)
+{
+    int samples = (int)ns.size();
+
+    MicroBenchResult r;
+    r.name       = name;
+    r.iterations = iterations;
+    r.samples    = samples;
+
+    double sum = 0.0;
+    for (int s = 0; s < samples; ++s)
+        sum += ns[s];
+    r.mean_ns = sum / samples;
+
+    double var = 0.0;
+    for (int s = 0; s < samples; ++s)
+        var += (ns[s] - r.mean_ns)*(ns[s] - r.mean_ns);
+    r.stddev_ns = samples > 1 ? sqrt(var / (samples - 1)) : 0.0;
+
+    std::sort(ns.begin(), ns.end());
+    r.min_ns = ns[0];
+    r.p50_ns = ns[samples/2];
+    r.p95_ns = ns[(size_t)(0.95*(samples - 1) + 0.5)];
+
+    printf("%-36s %12.1f ns  +- %8.1f  (min %10.1f, p50 %10.1f, p95 %10.1f)  %lu x %d\n",
+           name, r.mean_ns, r.stddev_ns, r.min_ns, r.p50_ns, r.p95_ns, iterations, samples);
+    g_Results.push_back(r);
+}
+
+// Mede "f" (que recebe o índice da repetição, para variar a entrada) e
+// guarda o resultado em g_Results.
+template <typename F> static void Run(const char* name, F f)
+{
+    if (g_Filter != NULL && strstr(name, g_Filter) == NULL)
+        return;
+
+    // Aquecimento, que também estima o custo de uma chamada.
+    unsigned long count = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed_ms = 0.0;
+    while (elapsed_ms < MICROBENCH_WARMUP_MS)
+    {
+        f(count++);
+        elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+    unsigned long iterations = (unsigned long)(count * MICROBENCH_SAMPLE_MS / elapsed_ms) + 1;
+
+    std::vector<double> ns(g_Samples);
+    for (int s = 0; s < g_Samples; ++s)
+    {
+        Clock::time_point t0 = Clock::now();
+        for (unsigned long i = 0; i < iterations; ++i)
+            f(i);
+        ns[s] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations;
+    }
+
+    Report(name, iterations, ns);
+}
+
+// Ângulo que varia com a repetição, para que nenhum caso seja calculado
+// somente uma vez pelo compilador.
+static inline float Angle(unsigned long i)
+{
+    return (float)(i & 1023) * 0.00613f;
+}
+
+static void MatrixBenchmarks()
+{
+    Run("Matrix_Identity", [](unsigned long i) {
+        glm::mat4 M = Matrix_Identity();
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Translate", [](unsigned long i) {
+        glm::mat4 M = Matrix_Translate(Angle(i), 1.0f, -2.0f);
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Scale", [](unsigned long i) {
+        glm::mat4 M = Matrix_Scale(Angle(i), 0.5f, 0.5f);
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Rotate_X", [](unsigned long i) {
+        glm::mat4 M = Matrix_Rotate_X(Angle(i));
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Rotate_Y", [](unsigned long i) {
+        glm::mat4 M = Matrix_Rotate_Y(Angle(i));
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Rotate_Z", [](unsigned long i) {
+        glm::mat4 M = Matrix_Rotate_Z(Angle(i));
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Rotate", [](unsigned long i) {
+        glm::mat4 M = Matrix_Rotate(Angle(i), glm::vec4(0.267f, 0.535f, 0.802f, 0.0f));
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Perspective", [](unsigned long i) {
+        glm::mat4 M = Matrix_Perspective(3.141592f / 3.0f + Angle(i)*0.001f, 16.0f/9.0f, -0.1f, -50.0f);
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Orthographic", [](unsigned long i) {
+        glm::mat4 M = Matrix_Orthographic(-Angle(i), Angle(i), -1.0f, 1.0f, -0.1f, -50.0f);
+        DoNotOptimize(M);
+    });
+    Run("Matrix_Camera_View", [](unsigned long i) {
+        float t = Angle(i);
+        glm::vec4 position = glm::vec4(cosf(t)*3.0f, 1.0f, sinf(t)*3.0f, 1.0f);
+        glm::vec4 view     = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) - position;
+        glm::mat4 M = Matrix_Camera_View(position, view, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+        DoNotOptimize(M);
+    });
+
+    // Produto encadeado típico da modelagem dos objetos dos estandes em main().
+    Run("produto_encadeado_TRRRS", [](unsigned long i) {
+        float t = Angle(i);
+        glm::mat4 M = Matrix_Translate(1.0f, 2.0f, t)
+                    * Matrix_Rotate_Z(t)
+                    * Matrix_Rotate_Y(0.5f*t)
+                    * Matrix_Rotate_X(0.25f*t)
+                    * Matrix_Scale(0.5f, 0.5f, 0.5f);
+        DoNotOptimize(M);
+    });
+    Run("produto_model_view_projection", [](unsigned long i) {
+        float t = Angle(i);
+        glm::mat4 model      = Matrix_Translate(t, 0.0f, 0.0f) * Matrix_Rotate_Y(t);
+        glm::mat4 view       = Matrix_Camera_View(glm::vec4(0.0f, 1.0f, 3.0f, 1.0f), glm::vec4(0.0f, 0.0f, -1.0f, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+        glm::mat4 projection = Matrix_Perspective(3.141592f / 3.0f, 16.0f/9.0f, -0.1f, -50.0f);
+        glm::vec4 p = projection * view * model * glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+        DoNotOptimize(p);
+    });
+}
+
+// Contorno retangular no plano XZ, no formato usado em main().
+static square_bbox Rectangle(float min_x, float min_z, float max_x, float max_z)
+{
+    square_bbox b;
+    b.p1 = glm::vec3(min_x, 1.0f, min_z);
+    b.p2 = glm::vec3(max_x, 1.0f, min_z);
+    b.p3 = glm::vec3(max_x, 1.0f, max_z);
+    b.p4 = glm::vec3(min_x, 1.0f, max_z);
+    return b;
+}
+
+static void GeometryBenchmarks()
+{
+    // Cena sintética com as mesmas proporções do museu: um corredor com nove
+    // estandes de cada lado e o dinossauro no centro.
+    Museu = Rectangle(-2.0f, -30.0f, 2.0f, 30.0f);
+    estandes_bbox.clear();
+    for (int i = 0; i < QUANT_ESTANDE; ++i)
+    {
+        float z = -27.0f + 6.0f*(i/2);
+        float x = (i % 2 == 0) ? -1.6f : 1.2f;
+        estandes_bbox.push_back(Rectangle(x, z, x + 0.4f, z + 0.4f));
+    }
+    Dino = Rectangle(-0.5f, -1.0f, 0.5f, 1.0f);
+
+    Run("F_p1_p2", [](unsigned long i) {
+        float f = F_p1_p2(Museu.p4 - Museu.p1, Museu.p4, Angle(i), 0.5f);
+        DoNotOptimize(f);
+    });
+    Run("check_colision", [](unsigned long i) {
+        bool inside = check_colision(Angle(i)*0.5f - 1.5f, (float)(i % 60) - 30.0f);
+        DoNotOptimize(inside);
+    });
+
+    box_obj caixa1 = { glm::vec3(0.0f, 0.0f, 0.0f), 0.5f, 0.5f, 0.5f };
+    sphere_obj esfera1 = { glm::vec3(0.0f, 0.0f, 0.0f), 0.5f };
+    plane_obj plano = { glm::vec3(0.0f, -0.5f, 0.0f), 2.0f, 2.0f };
+
+    Run("interseccao_caixa_caixa", [=](unsigned long i) {
+        box_obj caixa2 = { glm::vec3(Angle(i), 0.3f, 0.2f), 0.25f, 0.25f, 0.25f };
+        bool hit = interseccao_caixa_caixa(caixa1, caixa2);
+        DoNotOptimize(hit);
+    });
+    Run("interseccao_esfera_esfera", [=](unsigned long i) {
+        sphere_obj esfera2 = { glm::vec3(Angle(i), 0.3f, 0.2f), 0.25f };
+        bool hit = interseccao_esfera_esfera(esfera1, esfera2);
+        DoNotOptimize(hit);
+    });
+    Run("interseccao_caixa_esfera", [=](unsigned long i) {
+        sphere_obj esfera2 = { glm::vec3(Angle(i), 0.3f, 0.2f), 0.25f };
+        bool hit = interseccao_caixa_esfera(caixa1, esfera2);
+        DoNotOptimize(hit);
+    });
+    Run("interseccao_caixa_plano", [=](unsigned long i) {
+        box_obj caixa2 = { glm::vec3(0.1f, Angle(i) - 1.0f, 0.2f), 0.25f, 0.25f, 0.25f };
+        bool hit = interseccao_caixa_plano(caixa2, plano);
+        DoNotOptimize(hit);
+    });
+    Run("interseccao_esfera_plano", [=](unsigned long i) {
+        sphere_obj esfera2 = { glm::vec3(0.1f, Angle(i) - 1.0f, 0.2f), 0.25f };
+        bool hit = interseccao_esfera_plano(esfera2, plano);
+        DoNotOptimize(hit);
+    });
+
+    Run("bezier", [](unsigned long i) {
+        glm::vec4 c = bezier(Angle(i) / 6.28f,
+                             glm::vec4(0.6f, 4.0f, 0.5f, 1.0f), glm::vec4(0.2f, 4.5f, 0.2f, 1.0f),
+                             glm::vec4(-0.2f, 4.7f, -0.3f, 1.0f), glm::vec4(-0.5f, 4.2f, -0.5f, 1.0f));
+        DoNotOptimize(c);
+    });
+}
+
+static void MeshBenchmarks()
+{
+    // A vaca não tem normais no arquivo: ComputeNormals() calcula todas.
+    ObjModel cow("../../data/cow");
+    Run("ComputeNormals/cow", [&](unsigned long) {
+        cow.attrib.normals.clear();
+        ComputeNormals(&cow);
+        DoNotOptimize(cow.attrib.normals[0]);
+    });
+
+    MeshData mesh;
+    ObjModel triceratop("../../data/triceratop");
+    Run("BuildTriangles/triceratop", [&](unsigned long) {
+        BuildTriangles(&triceratop, &mesh);
+        DoNotOptimize(mesh.indices[0]);
+    });
+    ObjModel estande("../../data/estande");
+    Run("BuildTriangles/estande", [&](unsigned long) {
+        BuildTriangles(&estande, &mesh);
+        DoNotOptimize(mesh.indices[0]);
+    });
+
+    // Somente os níveis de detalhe, que BuildTriangles() já inclui: os
+    // índices acrescentados são descartados a cada repetição.
+    BuildTriangles(&cow, &mesh);
+    size_t original_indices = mesh.shapes.back().first_index + mesh.shapes.back().num_indices;
+    Run("Lod_BuildLevels/cow", [&](unsigned long) {
+        mesh.indices.resize(original_indices);
+        Lod_BuildLevels(&mesh);
+        DoNotOptimize(mesh.shapes[0].lods.count);
+    });
+}
+
+// Processamento de cada arquivo lido, como em LoadQueuedAsset() (main.cpp),
+// sem o envio para a GPU.
+static void ProcessLoadedAsset(AssetRead* read)
+{
+    if (read->data == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", read->filepath);
+        std::exit(EXIT_FAILURE);
+    }
+
+    const char* filename = (const char*)read->user;
+    if (filename == NULL)
+    {
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* pixels = stbi_load_from_memory(read->data, (int)read->size, &width, &height, &channels, 3);
+        DoNotOptimize(pixels);
+        stbi_image_free(pixels);
+        return;
+    }
+
+    ObjModel model(filename, read->data, read->size);
+    ComputeNormals(&model);
+    MeshData mesh;
+    BuildTriangles(&model, &mesh);
+    DoNotOptimize(mesh.indices[0]);
+    LoadArena_Release();
+}
+
+static void LoadSetBenchmarks()
+{
+    // Os mesmos arquivos carregados por main.cpp sem "--pack" e "--stream".
+    static const char* models[] = { "museu", "estande", "triceratop", "triangulo", "cow", "esfera", "cubo",
+                                    "rosquinha_1", "rosquinha_2", "lampada", "chaleira", "plano_gc_real", "vetor", "plano" };
+    static const char* extra_textures[] = { "estande_erro", "estande_acerto", "vermelho", "azul", "verde", "rosa", "amarelo" };
+
+    std::vector<std::string> filenames;
+    std::vector<std::string> filepaths;
+    for (size_t m = 0; m < sizeof(models)/sizeof(models[0]); ++m)
+    {
+        filenames.push_back(std::string("../../data/") + models[m]);
+        filepaths.push_back(filenames.back() + ".obj");
+        filepaths.push_back(filenames.back() + ".png");
+    }
+    for (size_t t = 0; t < sizeof(extra_textures)/sizeof(extra_textures[0]); ++t)
+        filepaths.push_back(std::string("../../data/") + extra_textures[t] + ".png");
+
+    std::vector<AssetRead> reads(filepaths.size());
+    for (size_t r = 0; r < reads.size(); ++r)
+    {
+        reads[r].filepath = filepaths[r].c_str();
+        reads[r].user = NULL;
+        if (r < 2*filenames.size() && r % 2 == 0)
+            reads[r].user = (void*)filenames[r/2].c_str();
+    }
+
+    bool can_drop_cache = AssetIO_DropCache(filepaths[0].c_str());
+
+    static const AssetIOBackend backends[] = { ASSETIO_URING, ASSETIO_THREADS, ASSETIO_SYNC };
+    for (int cold = 1; cold >= 0; --cold)
+        for (size_t b = 0; b < sizeof(backends)/sizeof(backends[0]); ++b)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "CarregamentoCena/%s/%s", AssetIO_BackendName(backends[b]), cold ? "frio" : "quente");
+            if (g_Filter != NULL && strstr(name, g_Filter) == NULL)
+                continue;
+            if (cold && !can_drop_cache)
+            {
+                printf("%-36s indisponivel (cache de paginas)\n", name);
+                continue;
+            }
+
+            // Aquecimento (também preenche o cache para os casos "quente").
+            AssetIO_ReadAll(reads.data(), (int)reads.size(), ProcessLoadedAsset, backends[b]);
+            if (AssetIO_GetStats().backend != backends[b])
+            {
+                printf("%-36s indisponivel\n", name);
+                continue;
+            }
+
+            std::vector<double> ns(MICROBENCH_LOAD_SAMPLES);
+            for (int s = 0; s < MICROBENCH_LOAD_SAMPLES; ++s)
+            {
+                if (cold)
+                    for (size_t f = 0; f < filepaths.size(); ++f)
+                        AssetIO_DropCache(filepaths[f].c_str());
+
+                Clock::time_point t0 = Clock::now();
+                AssetIO_ReadAll(reads.data(), (int)reads.size(), ProcessLoadedAsset, backends[b]);
+                ns[s] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            }
+            Report(name, 1, ns);
+        }
+}
+
+static void TextBenchmarks()
+{
+    // Escala de uma janela de 800x600 com textscale = 1.5 (textrendering.cpp).
+    const float sx = 1.5f / 800.0f;
+    const float sy = 1.5f / 600.0f;
+
+    const char* line = "Estande 5: rotacao com angulos de Euler (X, Y, Z) e escala";
+    const char* matrix_row = "[ +0.86 +0.00 -0.50 +1.25 ]   [ +0.50 ]   [ +1.68 ]";
+    std::vector<float> vertices((strlen(line) + strlen(matrix_row)) * TEXTLAYOUT_FLOATS_PER_GLYPH);
+
+    Run("TextLayout_String/linha", [&](unsigned long) {
+        int n = TextLayout_String(line, -1.0f, 0.9f, sx, sy, vertices.data());
+        DoNotOptimize(n);
+    });
+
+    Run("TextLayout_String/matriz", [&](unsigned long) {
+        int n = 0;
+        for (int row = 0; row < 4; ++row)
+            n += TextLayout_String(matrix_row, -1.0f, 0.9f - row*0.05f, sx, sy, vertices.data());
+        DoNotOptimize(n);
+    });
+}
+
+static bool WriteJSON(const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+
+    fprintf(f, "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < g_Results.size(); ++i)
+    {
+        const MicroBenchResult& r = g_Results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %lu, \"samples\": %d, \"mean\": %.3f, \"stddev\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p95\": %.3f}%s\n",
+                r.name.c_str(), r.iterations, r.samples, r.mean_ns, r.stddev_ns, r.min_ns, r.p50_ns, r.p95_ns,
+                (i + 1 < g_Results.size()) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+
+    printf("Microbenchmarks: %u casos salvos em \"%s\".\n", (unsigned int)g_Results.size(), filename);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* output = "microbench.json";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            g_Filter = argv[++i];
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            g_Samples = atoi(argv[++i]);
+            if (g_Samples < 1)
+            {
+                fprintf(stderr, "ERROR: invalid --samples \"%s\".\n", argv[i]);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: unknown argument \"%s\".\n", argv[i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    MatrixBenchmarks();
+    GeometryBenchmarks();
+    MeshBenchmarks();
+    TextBenchmarks();
+    LoadSetBenchmarks();
+
+    return WriteJSON(output) ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,228 @@
+// Envio por glMultiDrawElementsIndirect(). Veja comentários em "include/multidraw.h".
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glad/glad_profile.h>
+
+#include "multidraw.h"
+#include "mesharena.h"
+#include "glstate.h"
+#include "perfhud.h"
+
+// Ausentes na GLAD gerada para o OpenGL 3.3.
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+typedef void (APIENTRYP PFNMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect,
+                                                         GLsizei drawcount, GLsizei stride);
+
+// Comando lido pela GPU, no formato definido pelo OpenGL.
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint  base_vertex;
+    GLuint base_instance; // Índice do registro do objeto
+};
+
+// Posições dos atributos por instância em "shader_vertex.glsl".
+#define MULTIDRAW_LOCATION_MODEL     4 // mat4: 4 a 7
+#define MULTIDRAW_LOCATION_BBOX_MIN  8
+#define MULTIDRAW_LOCATION_BBOX_MAX  9
+#define MULTIDRAW_LOCATION_OBJECT_ID 10
+
+static bool                             g_Enabled = true;
+static bool                             g_Active = false;
+static PFNMULTIDRAWELEMENTSINDIRECTPROC g_MultiDrawElementsIndirect = NULL;
+static GLuint                           g_VAO = 0;
+static GLuint                           g_CommandBuffer = 0;
+static GLuint                           g_ObjectBuffer = 0;
+static GLint                            g_MultiDrawUniform = -1;
+
+static DrawElementsIndirectCommand      g_Commands[MULTIDRAW_MAX_COMMANDS];
+static MultiDrawRecord                  g_Objects[MULTIDRAW_MAX_OBJECTS];
+static int                              g_NumCommands = 0;
+static int                              g_NumObjects = 0;
+static unsigned long                    g_Triangles = 0;
+static MultiDrawStats                   g_Stats;
+
+bool MultiDraw_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--no-multi-draw") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    return false;
+}
+
+void MultiDraw_Init(GLADloadproc load, GLuint vertex_array_object_id)
+{
+    glGetIntegerv(GL_MAJOR_VERSION, &g_Stats.gl_major);
+    glGetIntegerv(GL_MINOR_VERSION, &g_Stats.gl_minor);
+    if (!g_Enabled || !MeshArena_IsEnabled() || vertex_array_object_id == 0 || g_Active)
+        return;
+    if (g_Stats.gl_major * 10 + g_Stats.gl_minor < 43)
+        return;
+    g_MultiDrawElementsIndirect = (PFNMULTIDRAWELEMENTSINDIRECTPROC)
+        gladProfileWrapProc("glMultiDrawElementsIndirect", load("glMultiDrawElementsIndirect"));
+    if (g_MultiDrawElementsIndirect == NULL)
+        return;
+
+    glGenBuffers(1, &g_CommandBuffer);
+    GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, g_CommandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(g_Commands), NULL, GL_STREAM_DRAW);
+    GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    // Os atributos por instância ficam sempre ligados no VAO da arena: os
+    // desenhos diretos leem o primeiro registro, que o shader ignora.
+    glGenBuffers(1, &g_ObjectBuffer);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, g_ObjectBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g_Objects), NULL, GL_STREAM_DRAW);
+    GLState_BindVertexArray(vertex_array_object_id);
+    MultiDraw_SetRecordAttributes(g_ObjectBuffer);
+    GLState_BindVertexArray(0);
+    PerfHud_AddBufferMemory(sizeof(g_Commands) + sizeof(g_Objects));
+
+    g_VAO = vertex_array_object_id;
+    g_Active = true;
+    g_Stats.active = true;
+}
+
+bool MultiDraw_IsActive()
+{
+    return g_Active;
+}
+
+void MultiDraw_BeginFrame(GLint multi_draw_uniform)
+{
+    g_MultiDrawUniform = multi_draw_uniform;
+    if (g_Active)
+        g_Stats.frames += 1;
+}
+
+void MultiDraw_MakeRecord(const glm::mat4& model, int object_id, const glm::vec3& bbox_min, const glm::vec3& bbox_max,
+                          MultiDrawRecord* record)
+{
+    memcpy(record->model, glm::value_ptr(model), sizeof(record->model));
+    record->bbox_min[0] = bbox_min.x; record->bbox_min[1] = bbox_min.y; record->bbox_min[2] = bbox_min.z; record->bbox_min[3] = 1.0f;
+    record->bbox_max[0] = bbox_max.x; record->bbox_max[1] = bbox_max.y; record->bbox_max[2] = bbox_max.z; record->bbox_max[3] = 1.0f;
+    record->object_id = object_id;
+    record->padding[0] = record->padding[1] = record->padding[2] = 0;
+}
+
+void MultiDraw_SetRecordAttributes(GLuint buffer)
+{
+    GLState_BindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        GLuint location = MULTIDRAW_LOCATION_MODEL + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(MultiDrawRecord),
+                              (void*)(offsetof(MultiDrawRecord, model) + column * 4*sizeof(float)));
+        glVertexAttribDivisor(location, 1);
+        glEnableVertexAttribArray(location);
+    }
+    glVertexAttribPointer(MULTIDRAW_LOCATION_BBOX_MIN, 4, GL_FLOAT, GL_FALSE, sizeof(MultiDrawRecord), (void*)offsetof(MultiDrawRecord, bbox_min));
+    glVertexAttribPointer(MULTIDRAW_LOCATION_BBOX_MAX, 4, GL_FLOAT, GL_FALSE, sizeof(MultiDrawRecord), (void*)offsetof(MultiDrawRecord, bbox_max));
+    glVertexAttribIPointer(MULTIDRAW_LOCATION_OBJECT_ID, 1, GL_INT, sizeof(MultiDrawRecord), (void*)offsetof(MultiDrawRecord, object_id));
+    for (GLuint location = MULTIDRAW_LOCATION_BBOX_MIN; location <= MULTIDRAW_LOCATION_OBJECT_ID; ++location)
+    {
+        glVertexAttribDivisor(location, 1);
+        glEnableVertexAttribArray(location);
+    }
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MultiDraw_UseRecords(bool use)
+{
+    GLState_Uniform1i(g_MultiDrawUniform, use ? 1 : 0);
+}
+
+void MultiDraw_AddObject(const glm::mat4& model, int object_id, const glm::vec3& bbox_min, const glm::vec3& bbox_max)
+{
+    if (g_NumObjects == MULTIDRAW_MAX_OBJECTS)
+        MultiDraw_Flush();
+
+    MultiDraw_MakeRecord(model, object_id, bbox_min, bbox_max, &g_Objects[g_NumObjects++]);
+}
+
+void MultiDraw_AddCommand(GLsizei count, size_t first_index, GLint base_vertex)
+{
+    if (count <= 0 || g_NumObjects == 0)
+        return;
+
+    // Fila de comandos cheia: envia, e o objeto atual continua na fila nova.
+    if (g_NumCommands == MULTIDRAW_MAX_COMMANDS)
+    {
+        MultiDrawRecord current = g_Objects[g_NumObjects - 1];
+        MultiDraw_Flush();
+        g_Objects[g_NumObjects++] = current;
+    }
+
+    DrawElementsIndirectCommand& command = g_Commands[g_NumCommands++];
+    command.count          = (GLuint)count;
+    command.instance_count = 1;
+    command.first_index    = (GLuint)first_index;
+    command.base_vertex    = base_vertex;
+    command.base_instance  = (GLuint)(g_NumObjects - 1);
+    g_Triangles += count / 3;
+}
+
+void MultiDraw_Flush()
+{
+    if (g_NumCommands > 0)
+    {
+        // glBufferData() com NULL descarta o conteúdo anterior, que ainda
+        // pode estar em uso pela GPU, sem esperar por ela.
+        GLState_BindBuffer(GL_ARRAY_BUFFER, g_ObjectBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(g_Objects), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, g_NumObjects * sizeof(MultiDrawRecord), g_Objects);
+        GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, g_CommandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(g_Commands), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, g_NumCommands * sizeof(DrawElementsIndirectCommand), g_Commands);
+
+        GLState_BindVertexArray(g_VAO);
+        MultiDraw_UseRecords(true);
+        g_MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, g_NumCommands, 0);
+        MultiDraw_UseRecords(false);
+        GLState_BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        PerfHud_CountDraw(g_Triangles);
+
+        g_Stats.flushes  += 1;
+        g_Stats.objects  += g_NumObjects;
+        g_Stats.commands += g_NumCommands;
+    }
+    g_NumCommands = 0;
+    g_NumObjects  = 0;
+    g_Triangles   = 0;
+}
+
+MultiDrawStats MultiDraw_GetStats()
+{
+    return g_Stats;
+}
+
+void MultiDraw_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "Envio indireto: desligado (--no-multi-draw).\n");
+        return;
+    }
+    if (!g_Active)
+    {
+        fprintf(f, "Envio indireto: indisponivel (contexto OpenGL %d.%d%s).\n", g_Stats.gl_major, g_Stats.gl_minor,
+                MeshArena_IsEnabled() ? "" : ", --no-mesh-arena");
+        return;
+    }
+
+    MultiDrawStats stats = MultiDraw_GetStats();
+    double frames = (stats.frames > 0) ? (double)stats.frames : 1.0;
+    fprintf(f, "Envio indireto: contexto OpenGL %d.%d, %.1f comandos de %.1f objetos em %.2f chamadas por quadro.\n",
+            stats.gl_major, stats.gl_minor, stats.commands / frames, stats.objects / frames, stats.flushes / frames);
+}
@@ -0,0 +1,498 @@
+// Construção de malhas a partir de modelos ".obj". Veja comentários em "include/objmodel.h".
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#include <glm/vec4.hpp>
+
+#include "matrices.h"
+#include "objmodel.h"
+#include "lod.h"
+#include "meshlet.h"
+
+// Função que computa as normais de um ObjModel, caso elas não tenham sido
+// especificadas dentro do arquivo ".obj"
+void ComputeNormals(ObjModel* model)
+{
+    if ( !model->attrib.normals.empty() )
+        return;
+
+    // Primeiro computamos as normais para todos os TRIÂNGULOS.
+    // Segundo, computamos as normais dos VÉRTICES através do método proposto
+    // por Gouraud, onde a normal de cada vértice vai ser a média das normais de
+    // todas as faces que compartilham este vértice.
+
+    size_t num_vertices = model->attrib.vertices.size() / 3;
+
+    LoadArena_Reserve(num_vertices * (sizeof(int) + sizeof(glm::vec4)) + 2*LOADARENA_ALIGN_SLACK);
+    int*       num_triangles_per_vertex = LoadArena_AllocArray<int>(num_vertices);
+    glm::vec4* vertex_normals           = LoadArena_AllocArray<glm::vec4>(num_vertices);
+    for (size_t i = 0; i < num_vertices; ++i)
+    {
+        num_triangles_per_vertex[i] = 0;
+        vertex_normals[i] = glm::vec4(0.0f,0.0f,0.0f,0.0f);
+    }
+
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+
+        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+
+            glm::vec4  vertices[3];
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
+                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
+                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
+                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
+                vertices[vertex] = glm::vec4(vx,vy,vz,1.0);
+            }
+
+            const glm::vec4  a = vertices[0];
+            const glm::vec4  b = vertices[1];
+            const glm::vec4  c = vertices[2];
+
+            const glm::vec4  n = crossproduct(b-a,c-a);
+
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
+                num_triangles_per_vertex[idx.vertex_index] += 1;
+                vertex_normals[idx.vertex_index] += n;
+                model->shapes[shape].mesh.indices[3*triangle + vertex].normal_index = idx.vertex_index;
+            }
+        }
+    }
+
+    model->attrib.normals.resize( 3*num_vertices );
+
+    for (size_t i = 0; i < num_vertices; ++i)
+    {
+        glm::vec4 n = vertex_normals[i] / (float)num_triangles_per_vertex[i];
+        n /= norm(n);
+        model->attrib.normals[3*i + 0] = n.x;
+        model->attrib.normals[3*i + 1] = n.y;
+        model->attrib.normals[3*i + 2] = n.z;
+    }
+}
+
+// Constrói os triângulos de um ObjModel na CPU. A cópia para a GPU é feita
+// por BuildTrianglesAndAddToVirtualScene(), em main.cpp.
+void BuildTriangles(ObjModel* model, MeshData* mesh)
+{
+    // Contamos os vértices (3 por triângulo), e quantos deles têm normal e
+    // coordenada de textura, para reservar o tamanho exato de cada vetor. Os
+    // índices incluem os dos níveis de detalhe (veja lod.h).
+    size_t num_vertices = 0, num_normals = 0, num_texcoords = 0, num_lod_indices = 0;
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        const std::vector<tinyobj::index_t>& idx = model->shapes[shape].mesh.indices;
+        size_t count = 3 * model->shapes[shape].mesh.num_face_vertices.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            num_normals   += (idx[i].normal_index != -1);
+            num_texcoords += (idx[i].texcoord_index != -1);
+        }
+        num_vertices += count;
+        num_lod_indices += Lod_MaxExtraIndices(count);
+    }
+
+    // Os vetores anteriores apontam para a arena, que é reaproveitada abaixo:
+    // trocamos por vetores vazios em vez de apenas esvaziá-los.
+    mesh->indices              = MeshIndexVector();
+    mesh->model_coefficients   = MeshFloatVector();
+    mesh->normal_coefficients  = MeshFloatVector();
+    mesh->texture_coefficients = MeshFloatVector();
+    mesh->shapes.clear();
+    mesh->meshlets.clear();
+
+    LoadArena_Reserve((num_vertices + num_lod_indices) * sizeof(unsigned int)
+                    + 4*num_vertices  * sizeof(float)
+                    + 4*num_normals   * sizeof(float)
+                    + 2*num_texcoords * sizeof(float)
+                    + 4*LOADARENA_ALIGN_SLACK);
+
+    MeshIndexVector& indices              = mesh->indices;
+    MeshFloatVector& model_coefficients   = mesh->model_coefficients;
+    MeshFloatVector& normal_coefficients  = mesh->normal_coefficients;
+    MeshFloatVector& texture_coefficients = mesh->texture_coefficients;
+
+    indices.reserve(num_vertices + num_lod_indices);
+    model_coefficients.reserve(4*num_vertices);
+    normal_coefficients.reserve(4*num_normals);
+    texture_coefficients.reserve(2*num_texcoords);
+    mesh->shapes.reserve(model->shapes.size());
+
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        size_t first_index = indices.size();
+        size_t num_triangles = model->shapes[shape].mesh.num_face_vertices.size();
+
+        const float minval = std::numeric_limits<float>::min();
+        const float maxval = std::numeric_limits<float>::max();
+
+        glm::vec3 bbox_min = glm::vec3(maxval,maxval,maxval);
+        glm::vec3 bbox_max = glm::vec3(minval,minval,minval);
+
+        for (size_t triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            assert(model->shapes[shape].mesh.num_face_vertices[triangle] == 3);
+
+            for (size_t vertex = 0; vertex < 3; ++vertex)
+            {
+                tinyobj::index_t idx = model->shapes[shape].mesh.indices[3*triangle + vertex];
+
+                indices.push_back(first_index + 3*triangle + vertex);
+
+                const float vx = model->attrib.vertices[3*idx.vertex_index + 0];
+                const float vy = model->attrib.vertices[3*idx.vertex_index + 1];
+                const float vz = model->attrib.vertices[3*idx.vertex_index + 2];
+                //printf("tri %d vert %d = (%.2f, %.2f, %.2f)\n", (int)triangle, (int)vertex, vx, vy, vz);
+                model_coefficients.push_back( vx ); // X
+                model_coefficients.push_back( vy ); // Y
+                model_coefficients.push_back( vz ); // Z
+                model_coefficients.push_back( 1.0f ); // W
+
+                bbox_min.x = std::min(bbox_min.x, vx);
+                bbox_min.y = std::min(bbox_min.y, vy);
+                bbox_min.z = std::min(bbox_min.z, vz);
+                bbox_max.x = std::max(bbox_max.x, vx);
+                bbox_max.y = std::max(bbox_max.y, vy);
+                bbox_max.z = std::max(bbox_max.z, vz);
+
+                // Inspecionando o código da tinyobjloader, o aluno Bernardo
+                // Sulzbach (2017/1) apontou que a maneira correta de testar se
+                // existem normais e coordenadas de textura no ObjModel é
+                // comparando se o índice retornado é -1. Fazemos isso abaixo.
+
+                if ( idx.normal_index != -1 )
+                {
+                    const float nx = model->attrib.normals[3*idx.normal_index + 0];
+                    const float ny = model->attrib.normals[3*idx.normal_index + 1];
+                    const float nz = model->attrib.normals[3*idx.normal_index + 2];
+                    normal_coefficients.push_back( nx ); // X
+                    normal_coefficients.push_back( ny ); // Y
+                    normal_coefficients.push_back( nz ); // Z
+                    normal_coefficients.push_back( 0.0f ); // W
+                }
+
+                if ( idx.texcoord_index != -1 )
+                {
+                    const float u = model->attrib.texcoords[2*idx.texcoord_index + 0];
+                    const float v = model->attrib.texcoords[2*idx.texcoord_index + 1];
+                    texture_coefficients.push_back( u );
+                    texture_coefficients.push_back( v );
+                }
+            }
+        }
+
+        size_t last_index = indices.size() - 1;
+
+        MeshShape theshape;
+        theshape.name        = model->shapes[shape].name;
+        theshape.first_index = first_index; // Primeiro índice
+        theshape.num_indices = last_index - first_index + 1; // Número de indices
+        theshape.bbox_min    = bbox_min;
+        theshape.bbox_max    = bbox_max;
+        theshape.lods.count  = 0;
+        theshape.first_meshlet = 0;
+        theshape.num_meshlets  = 0;
+        mesh->shapes.push_back(theshape);
+    }
+
+    Lod_BuildLevels(mesh);
+    Meshlet_Build(mesh);
+}
+
+size_t CountUniqueVertices(const ObjModel* model)
+{
+    std::vector<tinyobj::index_t> keys;
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+        keys.insert(keys.end(), model->shapes[shape].mesh.indices.begin(), model->shapes[shape].mesh.indices.end());
+
+    struct Less
+    {
+        bool operator()(const tinyobj::index_t& a, const tinyobj::index_t& b) const
+        {
+            if (a.vertex_index != b.vertex_index) return a.vertex_index < b.vertex_index;
+            if (a.normal_index != b.normal_index) return a.normal_index < b.normal_index;
+            return a.texcoord_index < b.texcoord_index;
+        }
+    };
+    std::sort(keys.begin(), keys.end(), Less());
+
+    size_t unique = 0;
+    for (size_t i = 0; i < keys.size(); ++i)
+        if (i == 0 || Less()(keys[i-1], keys[i]))
+            unique += 1;
+    return unique;
+}
+
+template <typename V> static size_t VectorBytes(const V& v)
+{
+    return v.capacity() * sizeof(typename V::value_type);
+}
+
+size_t ObjModelMemoryBytes(const ObjModel* model)
+{
+    size_t bytes = VectorBytes(model->attrib.vertices)
+                 + VectorBytes(model->attrib.normals)
+                 + VectorBytes(model->attrib.texcoords)
+                 + VectorBytes(model->shapes)
+                 + VectorBytes(model->materials);
+    for (size_t shape = 0; shape < model->shapes.size(); ++shape)
+    {
+        const tinyobj::mesh_t& mesh = model->shapes[shape].mesh;
+        bytes += VectorBytes(mesh.indices) + VectorBytes(mesh.num_face_vertices) + VectorBytes(mesh.material_ids);
+    }
+    return bytes;
+}
+
+size_t MeshDataMemoryBytes(const MeshData* mesh)
+{
+    return VectorBytes(mesh->indices)
+         + VectorBytes(mesh->model_coefficients)
+         + VectorBytes(mesh->normal_coefficients)
+         + VectorBytes(mesh->texture_coefficients)
+         + VectorBytes(mesh->shapes)
+         + VectorBytes(mesh->meshlets);
+}
+
+void ReleaseObjModel(ObjModel* model)
+{
+    // clear() não devolve a memória; a troca com um objeto vazio devolve.
+    model->attrib = tinyobj::attrib_t();
+    std::vector<tinyobj::shape_t>().swap(model->shapes);
+    std::vector<tinyobj::material_t>().swap(model->materials);
+}
+
+// Cabeçalho de uma malha cozida. Seguem, para cada objeto, o tamanho do nome,
+// o nome, o primeiro índice, o número de índices, a bounding box, os níveis
+// de detalhe e os meshlets; e então, alinhados a 16 bytes, os vetores de
+// índices, posições, normais, coordenadas de textura e meshlets.
+struct CookedMeshHeader
+{
+    char     magic[4];
+    uint32_t num_shapes;
+    uint64_t num_indices;
+    uint64_t num_model_coefficients;
+    uint64_t num_normal_coefficients;
+    uint64_t num_texture_coefficients;
+    uint64_t num_meshlets;
+    uint64_t unique_vertices;
+};
+
+struct CookedShape
+{
+    uint64_t first_index;
+    uint64_t num_indices;
+    float    bbox_min[3];
+    float    bbox_max[3];
+    uint32_t num_lods;
+    uint64_t lod_first_index[MESH_MAX_LODS];
+    uint64_t lod_num_indices[MESH_MAX_LODS];
+    float    lod_error[MESH_MAX_LODS];
+    uint64_t first_meshlet;
+    uint64_t num_meshlets;
+};
+
+static void Append(std::vector<unsigned char>* out, const void* data, size_t size)
+{
+    out->insert(out->end(), (const unsigned char*)data, (const unsigned char*)data + size);
+}
+
+static void AlignTo16(std::vector<unsigned char>* out)
+{
+    out->resize((out->size() + 15) & ~(size_t)15, 0);
+}
+
+void WriteCookedMesh(const MeshData* mesh, size_t unique_vertices, std::vector<unsigned char>* out)
+{
+    CookedMeshHeader header;
+    memcpy(header.magic, "MESH", 4);
+    header.num_shapes               = (uint32_t)mesh->shapes.size();
+    header.num_indices              = mesh->indices.size();
+    header.num_model_coefficients   = mesh->model_coefficients.size();
+    header.num_normal_coefficients  = mesh->normal_coefficients.size();
+    header.num_texture_coefficients = mesh->texture_coefficients.size();
+    header.num_meshlets             = mesh->meshlets.size();
+    header.unique_vertices          = unique_vertices;
+    out->clear();
+    Append(out, &header, sizeof(header));
+
+    for (size_t shape = 0; shape < mesh->shapes.size(); ++shape)
+    {
+        const MeshShape& theshape = mesh->shapes[shape];
+        uint32_t name_length = (uint32_t)theshape.name.size();
+        Append(out, &name_length, sizeof(name_length));
+        Append(out, theshape.name.data(), name_length);
+
+        CookedShape cooked;
+        cooked.first_index = theshape.first_index;
+        cooked.num_indices = theshape.num_indices;
+        for (int i = 0; i < 3; ++i)
+        {
+            cooked.bbox_min[i] = theshape.bbox_min[i];
+            cooked.bbox_max[i] = theshape.bbox_max[i];
+        }
+        cooked.num_lods = (uint32_t)theshape.lods.count;
+        for (int level = 0; level < MESH_MAX_LODS; ++level)
+        {
+            bool used = level < theshape.lods.count;
+            cooked.lod_first_index[level] = used ? theshape.lods.first_index[level] : 0;
+            cooked.lod_num_indices[level] = used ? theshape.lods.num_indices[level] : 0;
+            cooked.lod_error[level]       = used ? theshape.lods.error[level] : 0.0f;
+        }
+        cooked.first_meshlet = theshape.first_meshlet;
+        cooked.num_meshlets  = theshape.num_meshlets;
+        Append(out, &cooked, sizeof(cooked));
+    }
+
+    AlignTo16(out);
+    Append(out, mesh->indices.data(), mesh->indices.size() * sizeof(unsigned int));
+    AlignTo16(out);
+    Append(out, mesh->model_coefficients.data(), mesh->model_coefficients.size() * sizeof(float));
+    AlignTo16(out);
+    Append(out, mesh->normal_coefficients.data(), mesh->normal_coefficients.size() * sizeof(float));
+    AlignTo16(out);
+    Append(out, mesh->texture_coefficients.data(), mesh->texture_coefficients.size() * sizeof(float));
+    AlignTo16(out);
+    Append(out, mesh->meshlets.data(), mesh->meshlets.size() * sizeof(Meshlet));
+}
+
+// Leitura sequencial de um bloco, com verificação de limites.
+struct CookedReader
+{
+    const unsigned char* data;
+    size_t               size;
+    size_t               position;
+
+    const void* Read(size_t bytes)
+    {
+        if (bytes > size - position)
+            return NULL;
+        const void* p = data + position;
+        position += bytes;
+        return p;
+    }
+
+    // Cópia para "out": os campos depois dos nomes não ficam alinhados.
+    bool Copy(void* out, size_t bytes)
+    {
+        const void* p = Read(bytes);
+        if (p != NULL)
+            memcpy(out, p, bytes);
+        return p != NULL;
+    }
+
+    void Align()
+    {
+        position = std::min(size, (position + 15) & ~(size_t)15);
+    }
+};
+
+// Indica se o trecho [first, first + count) cabe em [begin, end).
+static bool RangeInside(uint64_t first, uint64_t count, uint64_t begin, uint64_t end)
+{
+    return first >= begin && first <= end && count <= end - first;
+}
+
+template <typename V> static bool ReadVector(CookedReader* reader, uint64_t count, V* v)
+{
+    reader->Align();
+    const void* p = reader->Read(count * sizeof(typename V::value_type));
+    if (p == NULL)
+        return false;
+    const typename V::value_type* first = (const typename V::value_type*)p;
+    v->reserve(count);
+    v->assign(first, first + count);
+    return true;
+}
+
+bool ReadCookedMesh(const void* data, size_t size, MeshData* mesh, size_t* unique_vertices)
+{
+    CookedReader reader = { (const unsigned char*)data, size, 0 };
+    CookedMeshHeader header;
+    if (!reader.Copy(&header, sizeof(header)) || memcmp(header.magic, "MESH", 4) != 0)
+        return false;
+
+    mesh->indices              = MeshIndexVector();
+    mesh->model_coefficients   = MeshFloatVector();
+    mesh->normal_coefficients  = MeshFloatVector();
+    mesh->texture_coefficients = MeshFloatVector();
+    mesh->shapes.clear();
+    mesh->shapes.reserve(header.num_shapes);
+    mesh->meshlets.clear();
+
+    for (uint32_t shape = 0; shape < header.num_shapes; ++shape)
+    {
+        uint32_t name_length;
+        const char* name = NULL;
+        CookedShape cooked;
+        if (!reader.Copy(&name_length, sizeof(name_length))
+            || (name = (const char*)reader.Read(name_length)) == NULL
+            || !reader.Copy(&cooked, sizeof(cooked)))
+            return false;
+
+        // Os trechos de índices vão direto para glDrawElements() e
+        // glMultiDrawElements(); um bloco corrompido não pode apontar para
+        // fora dos índices da malha.
+        if (!RangeInside(cooked.first_index, cooked.num_indices, 0, header.num_indices))
+            return false;
+
+        MeshShape theshape;
+        theshape.name        = std::string(name, name_length);
+        theshape.first_index = (size_t)cooked.first_index;
+        theshape.num_indices = (size_t)cooked.num_indices;
+        theshape.bbox_min    = glm::vec3(cooked.bbox_min[0], cooked.bbox_min[1], cooked.bbox_min[2]);
+        theshape.bbox_max    = glm::vec3(cooked.bbox_max[0], cooked.bbox_max[1], cooked.bbox_max[2]);
+        if (cooked.num_lods > MESH_MAX_LODS)
+            return false;
+        theshape.lods.count = (int)cooked.num_lods;
+        for (int level = 0; level < theshape.lods.count; ++level)
+        {
+            if (!RangeInside(cooked.lod_first_index[level], cooked.lod_num_indices[level], 0, header.num_indices))
+                return false;
+            theshape.lods.first_index[level] = (size_t)cooked.lod_first_index[level];
+            theshape.lods.num_indices[level] = (size_t)cooked.lod_num_indices[level];
+            theshape.lods.error[level]       = cooked.lod_error[level];
+        }
+        if (!RangeInside(cooked.first_meshlet, cooked.num_meshlets, 0, header.num_meshlets))
+            return false;
+        theshape.first_meshlet = (size_t)cooked.first_meshlet;
+        theshape.num_meshlets  = (size_t)cooked.num_meshlets;
+        mesh->shapes.push_back(theshape);
+    }
+
+    LoadArena_Reserve(header.num_indices * sizeof(unsigned int)
+                    + (header.num_model_coefficients + header.num_normal_coefficients
+                       + header.num_texture_coefficients) * sizeof(float)
+                    + 4*LOADARENA_ALIGN_SLACK);
+
+    *unique_vertices = (size_t)header.unique_vertices;
+    if (!ReadVector(&reader, header.num_indices, &mesh->indices)
+        || !ReadVector(&reader, header.num_model_coefficients, &mesh->model_coefficients)
+        || !ReadVector(&reader, header.num_normal_coefficients, &mesh->normal_coefficients)
+        || !ReadVector(&reader, header.num_texture_coefficients, &mesh->texture_coefficients)
+        || !ReadVector(&reader, header.num_meshlets, &mesh->meshlets))
+        return false;
+
+    // Cada meshlet é um trecho da malha original do seu objeto (veja
+    // meshlet.h).
+    for (size_t shape = 0; shape < mesh->shapes.size(); ++shape)
+    {
+        const MeshShape& theshape = mesh->shapes[shape];
+        for (size_t m = theshape.first_meshlet; m < theshape.first_meshlet + theshape.num_meshlets; ++m)
+        {
+            const Meshlet& meshlet = mesh->meshlets[m];
+            if (!RangeInside(meshlet.first_index, meshlet.num_indices,
+                             theshape.first_index, theshape.first_index + theshape.num_indices))
+                return false;
+        }
+    }
+    return true;
+}
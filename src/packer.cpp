@@ -0,0 +1,120 @@
+// Gerador do pacote de recursos (veja include/assetpack.h).
+//
+// É um executável separado, que não abre janela nem usa OpenGL ("make
+// pack"). Recebe a lista de arquivos a empacotar:
+//   - ".obj": lido com tinyobjloader, com as normais calculadas e a malha
+//     montada como no programa principal, e guardado como malha cozida;
+//   - ".png": guardado sem alterações;
+//   - ".glsl": guardado como texto.
+// Outros arquivos (p.ex. ".mtl", cujos dados não são usados pela malha) são
+// ignorados.
+//
+// Argumentos de linha de comando reconhecidos:
+//   --output arquivo   Arquivo do pacote (padrão "../../data/fcg.pack")
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "objmodel.h"
+#include "assetpack.h"
+
+static bool EndsWith(const std::string& s, const char* suffix)
+{
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool ReadFile(const char* filename, std::vector<unsigned char>* data)
+{
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL)
+        return false;
+    data->clear();
+    unsigned char buffer[64*1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        data->insert(data->end(), buffer, buffer + n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static void CookModel(const std::string& path, std::vector<unsigned char>* cooked)
+{
+    // ObjModel recebe o nome sem a extensão, e os materiais ficam no mesmo
+    // diretório do modelo.
+    std::string filename = path.substr(0, path.size() - 4);
+    size_t slash = path.rfind('/');
+    std::string basepath = (slash != std::string::npos) ? path.substr(0, slash + 1) : std::string("./");
+
+    try
+    {
+        ObjModel model(filename.c_str(), basepath.c_str());
+        ComputeNormals(&model);
+        MeshData mesh;
+        BuildTriangles(&model, &mesh);
+        WriteCookedMesh(&mesh, CountUniqueVertices(&model), cooked);
+        LoadArena_Release();
+    }
+    catch (const std::runtime_error& e)
+    {
+        fprintf(stderr, "ERROR: %s (\"%s\").\n", e.what(), path.c_str());
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* output = "../../data/fcg.pack";
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    size_t total = 0;
+    int count = 0;
+    std::vector<unsigned char> data;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const std::string& path = inputs[i];
+        AssetPackFormat format;
+        if (EndsWith(path, ".obj"))
+        {
+            CookModel(path, &data);
+            format = ASSETPACK_COOKED_MESH;
+        }
+        else if (EndsWith(path, ".png") || EndsWith(path, ".glsl"))
+        {
+            if (!ReadFile(path.c_str(), &data))
+            {
+                fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", path.c_str());
+                std::exit(EXIT_FAILURE);
+            }
+            format = EndsWith(path, ".png") ? ASSETPACK_IMAGE : ASSETPACK_TEXT;
+        }
+        else
+        {
+            continue;
+        }
+
+        AssetPack_Add(path.c_str(), format, data.data(), data.size());
+        total += data.size();
+        count += 1;
+    }
+
+    if (!AssetPack_Write(output))
+    {
+        fprintf(stderr, "ERROR: Cannot write asset pack \"%s\".\n", output);
+        return EXIT_FAILURE;
+    }
+    printf("Pacote \"%s\": %d recursos, %.1f MiB.\n", output, count, total / (1024.0*1024.0));
+    return 0;
+}
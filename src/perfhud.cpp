@@ -0,0 +1,240 @@
+// Painel de desempenho. Veja comentários em "include/perfhud.h".
+#include <cstdio>
+#include <cstdarg>
+#include <chrono>
+
+#include "perfhud.h"
+#include "gputimer.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static bool g_Enabled = false;
+
+// Buffer circular com o tempo de CPU e o intervalo entre quadros.
+static float g_CpuMs[PERFHUD_HISTORY];
+static float g_FrameMs[PERFHUD_HISTORY];
+static int   g_Head  = 0; // Próxima posição a ser escrita
+static int   g_Count = 0; // Posições preenchidas
+
+static Clock::time_point g_FrameStart;
+static Clock::time_point g_PrevFrameStart;
+static bool              g_HasPrevFrame = false;
+
+// Contadores do quadro em andamento e do último quadro terminado.
+static unsigned long g_DrawCalls = 0;
+static unsigned long g_Triangles = 0;
+static unsigned long g_LastDrawCalls = 0;
+static unsigned long g_LastTriangles = 0;
+static int           g_Stand = -1;
+
+static size_t g_TextureBytes = 0;
+static size_t g_BufferBytes  = 0;
+
+// Texto do painel, recalculado por RefreshLines().
+static char              g_Lines[PERFHUD_MAX_LINES][PERFHUD_LINE_SIZE];
+static const char*       g_LinePointers[PERFHUD_MAX_LINES];
+static int               g_NumLines = 0;
+static Clock::time_point g_LastRefresh;
+
+static double Ms(Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+void PerfHud_SetEnabled(bool enabled)
+{
+    g_Enabled = enabled;
+    g_NumLines = 0; // Força a atualização do texto ao abrir o painel
+}
+
+bool PerfHud_IsEnabled()
+{
+    return g_Enabled;
+}
+
+void PerfHud_BeginFrame()
+{
+    g_PrevFrameStart = g_FrameStart;
+    g_FrameStart = Clock::now();
+    g_DrawCalls = 0;
+    g_Triangles = 0;
+}
+
+void PerfHud_EndFrame(int stand)
+{
+    // O intervalo entre o início deste quadro e o do anterior inclui a troca
+    // de buffers e o tratamento de eventos, que ficam fora do tempo de CPU.
+    g_CpuMs[g_Head]   = (float)Ms(Clock::now() - g_FrameStart);
+    g_FrameMs[g_Head] = g_HasPrevFrame ? (float)Ms(g_FrameStart - g_PrevFrameStart) : g_CpuMs[g_Head];
+    g_Head = (g_Head + 1) % PERFHUD_HISTORY;
+    if (g_Count < PERFHUD_HISTORY)
+        g_Count += 1;
+    g_HasPrevFrame = true;
+
+    g_LastDrawCalls = g_DrawCalls;
+    g_LastTriangles = g_Triangles;
+    g_Stand = stand;
+}
+
+void PerfHud_CountDraw(unsigned long triangles)
+{
+    g_DrawCalls += 1;
+    g_Triangles += triangles;
+}
+
+void PerfHud_AddTextureMemory(size_t bytes)
+{
+    g_TextureBytes += bytes;
+}
+
+void PerfHud_AddBufferMemory(size_t bytes)
+{
+    g_BufferBytes += bytes;
+}
+
+void PerfHud_RemoveTextureMemory(size_t bytes)
+{
+    g_TextureBytes -= bytes;
+}
+
+void PerfHud_RemoveBufferMemory(size_t bytes)
+{
+    g_BufferBytes -= bytes;
+}
+
+// Adiciona uma linha ao painel, no formato de printf().
+static void AddLine(const char* format, ...)
+{
+    if (g_NumLines >= PERFHUD_MAX_LINES)
+        return;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(g_Lines[g_NumLines], PERFHUD_LINE_SIZE, format, args);
+    va_end(args);
+    g_NumLines += 1;
+}
+
+// Gráfico de barras do intervalo entre quadros, do mais antigo (à esquerda)
+// para o mais recente. Cada coluna mostra o pior quadro do seu grupo, para
+// que picos isolados não desapareçam na média.
+static void AddGraph()
+{
+    const int frames_per_column = PERFHUD_HISTORY / PERFHUD_GRAPH_COLUMNS;
+
+    float column_ms[PERFHUD_GRAPH_COLUMNS];
+    float max_ms = 0.0f;
+    for (int c = 0; c < PERFHUD_GRAPH_COLUMNS; ++c)
+    {
+        column_ms[c] = -1.0f; // Coluna sem quadros registrados
+        for (int k = 0; k < frames_per_column; ++k)
+        {
+            int age = PERFHUD_HISTORY - (c*frames_per_column + k); // 1 = último quadro
+            if (age > g_Count)
+                continue;
+            float ms = g_FrameMs[(g_Head - age + PERFHUD_HISTORY) % PERFHUD_HISTORY];
+            if (ms > column_ms[c])
+                column_ms[c] = ms;
+        }
+        if (column_ms[c] > max_ms)
+            max_ms = column_ms[c];
+    }
+
+    // A escala começa em um quadro a 60 Hz e dobra até que o pior quadro caiba.
+    float scale_ms = 1000.0f/60.0f;
+    while (scale_ms < max_ms && scale_ms < 1000.0f)
+        scale_ms *= 2.0f;
+
+    AddLine("intervalo entre quadros (escala 0 a %.1f ms):", scale_ms);
+    for (int row = PERFHUD_GRAPH_ROWS - 1; row >= 0 && g_NumLines < PERFHUD_MAX_LINES; --row)
+    {
+        char* line = g_Lines[g_NumLines];
+        int n = 0;
+        line[n++] = '|';
+        for (int c = 0; c < PERFHUD_GRAPH_COLUMNS; ++c)
+        {
+            float height = column_ms[c] / scale_ms * PERFHUD_GRAPH_ROWS;
+            if (height >= row + 1)
+                line[n++] = '#';
+            else if (height >= row + 0.5f)
+                line[n++] = '.';
+            else
+                line[n++] = ' ';
+        }
+        line[n] = '\0';
+        g_NumLines += 1;
+    }
+}
+
+static void RefreshLines()
+{
+    g_NumLines = 0;
+
+    double cpu_sum = 0.0, cpu_max = 0.0, frame_sum = 0.0, frame_max = 0.0;
+    for (int i = 0; i < g_Count; ++i)
+    {
+        cpu_sum   += g_CpuMs[i];
+        frame_sum += g_FrameMs[i];
+        if (g_CpuMs[i] > cpu_max)
+            cpu_max = g_CpuMs[i];
+        if (g_FrameMs[i] > frame_max)
+            frame_max = g_FrameMs[i];
+    }
+    double cpu_mean   = (g_Count > 0) ? cpu_sum / g_Count : 0.0;
+    double frame_mean = (g_Count > 0) ? frame_sum / g_Count : 0.0;
+
+    AddLine("desempenho (F1), ultimos %d quadros", g_Count);
+    AddLine("quadro %6.2f ms (%5.1f fps)  max %6.2f ms", frame_mean, frame_mean > 0.0 ? 1000.0/frame_mean : 0.0, frame_max);
+    AddLine("CPU    %6.2f ms               max %6.2f ms", cpu_mean, cpu_max);
+
+    GpuTimerStats frame = GpuTimer_GetFrameStats();
+    if (frame.samples > 0)
+        AddLine("GPU    %6.2f ms  p95 %6.2f ms  max %6.2f ms", frame.gpu_mean_ms, frame.gpu_p95_ms, frame.gpu_max_ms);
+    else
+        AddLine("GPU    sem medicao");
+
+    AddGraph();
+
+    AddLine("desenhos %lu, triangulos %lu", g_LastDrawCalls, g_LastTriangles);
+    AddLine("memoria GPU: texturas %.1f MB, buffers %.1f MB",
+            g_TextureBytes / (1024.0*1024.0), g_BufferBytes / (1024.0*1024.0));
+
+    // Custo (GPU + CPU de envio) dos objetos expostos em cada estande, e os
+    // três estandes mais caros.
+    const int num_stands = GPUTIMER_EXPOSICAO_18 - GPUTIMER_EXPOSICAO_1 + 1;
+    double stand_ms[num_stands];
+    int top[3] = { -1, -1, -1 };
+    for (int s = 0; s < num_stands; ++s)
+    {
+        GpuTimerStats st = GpuTimer_GetStats(GPUTIMER_EXPOSICAO_1 + s);
+        stand_ms[s] = st.gpu_mean_ms + st.cpu_mean_ms;
+        for (int t = 0; t < 3; ++t)
+        {
+            if (top[t] < 0 || stand_ms[s] > stand_ms[top[t]])
+            {
+                for (int u = 2; u > t; --u)
+                    top[u] = top[u-1];
+                top[t] = s;
+                break;
+            }
+        }
+    }
+
+    if (g_Stand >= 0 && g_Stand < num_stands)
+        AddLine("estande atual %2d: %6.3f ms (GPU+CPU)", g_Stand + 1, stand_ms[g_Stand]);
+    else
+        AddLine("estande atual: nenhum");
+    AddLine("mais caros: %2d %6.3f  %2d %6.3f  %2d %6.3f ms",
+            top[0] + 1, stand_ms[top[0]], top[1] + 1, stand_ms[top[1]], top[2] + 1, stand_ms[top[2]]);
+
+    for (int i = 0; i < g_NumLines; ++i)
+        g_LinePointers[i] = g_Lines[i];
+    g_LastRefresh = Clock::now();
+}
+
+int PerfHud_GetLines(const char* const** lines)
+{
+    if (g_NumLines == 0 || Ms(Clock::now() - g_LastRefresh) >= 1000.0 / PERFHUD_REFRESH_HZ)
+        RefreshLines();
+    *lines = g_LinePointers;
+    return g_NumLines;
+}
@@ -0,0 +1,379 @@
+// Gravação e reprodução de eventos de entrada. Veja comentários em "include/replay.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+
+#include <GLFW/glfw3.h>
+
+#include "replay.h"
+
+// Funções definidas em main.cpp
+void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
+
+typedef std::chrono::steady_clock Clock;
+
+static const char g_ReplayMagic[4] = {'F', 'C', 'G', 'R'};
+
+// Gravação
+static FILE*             g_RecordFile = NULL;
+static const char*       g_RecordFilename = NULL;
+static Clock::time_point g_RecordStart;
+static unsigned long     g_RecordCount = 0;
+
+// Reprodução
+static bool                     g_Playing = false;
+static std::vector<ReplayEvent> g_Events;
+static size_t                   g_NextEvent = 0;
+static unsigned int             g_NumFrames = 0;
+static double                   g_TimeStep = 1.0/60.0;
+static bool                     g_PaceByTime = false; // Eventos pelo instante (arquivo) ou pelo quadro (roteiro)
+static double                   g_EndTime = 0.0;      // Instante do fechamento gravado
+static double                   g_CursorX = 0.0;
+static double                   g_CursorY = 0.0;
+
+// Quadros iniciados até agora (veja Replay_BeginFrame()).
+static unsigned int g_Frame = 0;
+
+static void WriteBytes(const void* data, size_t size)
+{
+    if (fwrite(data, size, 1, g_RecordFile) != 1)
+    {
+        fprintf(stderr, "ERROR: Cannot write file \"%s\".\n", g_RecordFilename);
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+static void WriteU8(int v)      { uint8_t x = (uint8_t)v; WriteBytes(&x, sizeof(x)); }
+static void WriteI32(int v)     { int32_t x = (int32_t)v; WriteBytes(&x, sizeof(x)); }
+static void WriteU32(unsigned int v) { uint32_t x = (uint32_t)v; WriteBytes(&x, sizeof(x)); }
+static void WriteF64(double v)  { WriteBytes(&v, sizeof(v)); }
+
+// Cabeçalho comum a todos os registros. O relógio da gravação começa no
+// primeiro quadro (veja Replay_BeginFrame()), como o da reprodução; eventos
+// anteriores, durante o carregamento, ficam no instante zero.
+static void WriteRecordHeader(int type)
+{
+    float t = (g_Frame == 0) ? 0.0f : std::chrono::duration<float>(Clock::now() - g_RecordStart).count();
+    WriteU32(g_Frame);
+    WriteBytes(&t, sizeof(t));
+    WriteU8(type);
+    g_RecordCount += 1;
+}
+
+static void StartRecording(const char* filename)
+{
+    g_RecordFile = fopen(filename, "wb");
+    if (g_RecordFile == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        std::exit(EXIT_FAILURE);
+    }
+    g_RecordFilename = filename;
+
+    WriteBytes(g_ReplayMagic, sizeof(g_ReplayMagic));
+    WriteU32(REPLAY_VERSION);
+}
+
+// Callbacks instalados durante a gravação: salvam o evento e o repassam para
+// o callback original de main.cpp.
+static void RecordKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    WriteRecordHeader(REPLAY_KEY);
+    WriteI32(key);
+    WriteI32(scancode);
+    WriteU8(action);
+    WriteU8(mods);
+    KeyCallback(window, key, scancode, action, mods);
+}
+
+static void RecordMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    // MouseButtonCallback() lê a posição do cursor no momento do clique;
+    // guardamos a mesma posição para a reprodução.
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+
+    WriteRecordHeader(REPLAY_MOUSE_BUTTON);
+    WriteU8(button);
+    WriteU8(action);
+    WriteU8(mods);
+    WriteF64(x);
+    WriteF64(y);
+    MouseButtonCallback(window, button, action, mods);
+}
+
+static void RecordCursorPosCallback(GLFWwindow* window, double xpos, double ypos)
+{
+    WriteRecordHeader(REPLAY_CURSOR_POS);
+    WriteF64(xpos);
+    WriteF64(ypos);
+    CursorPosCallback(window, xpos, ypos);
+}
+
+// Leitura do arquivo gravado. Retorna false se o arquivo terminar antes do
+// fim de um campo.
+static bool ReadBytes(FILE* f, void* data, size_t size)
+{
+    return fread(data, size, 1, f) == 1;
+}
+
+static bool ReadU8(FILE* f, int* v)
+{
+    uint8_t x;
+    if (!ReadBytes(f, &x, sizeof(x)))
+        return false;
+    *v = x;
+    return true;
+}
+
+static bool ReadI32(FILE* f, int* v)
+{
+    int32_t x;
+    if (!ReadBytes(f, &x, sizeof(x)))
+        return false;
+    *v = x;
+    return true;
+}
+
+static void LoadReplay(const char* filename)
+{
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        std::exit(EXIT_FAILURE);
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    if (!ReadBytes(f, magic, sizeof(magic)) || memcmp(magic, g_ReplayMagic, sizeof(magic)) != 0
+        || !ReadBytes(f, &version, sizeof(version)) || version != REPLAY_VERSION)
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not an input recording (version %d).\n", filename, REPLAY_VERSION);
+        std::exit(EXIT_FAILURE);
+    }
+
+    g_Events.clear();
+    g_NumFrames = 0;
+    bool ended = false;
+    for (;;)
+    {
+        ReplayEvent e;
+        memset(&e, 0, sizeof(e));
+
+        uint32_t frame;
+        if (!ReadBytes(f, &frame, sizeof(frame)))
+            break; // Fim do arquivo
+        e.frame = frame;
+
+        bool ok = ReadBytes(f, &e.time, sizeof(e.time)) && ReadU8(f, &e.type);
+        if (ok && e.type == REPLAY_KEY)
+            ok = ReadI32(f, &e.key) && ReadI32(f, &e.scancode) && ReadU8(f, &e.action) && ReadU8(f, &e.mods);
+        else if (ok && e.type == REPLAY_MOUSE_BUTTON)
+            ok = ReadU8(f, &e.key) && ReadU8(f, &e.action) && ReadU8(f, &e.mods)
+                 && ReadBytes(f, &e.x, sizeof(e.x)) && ReadBytes(f, &e.y, sizeof(e.y));
+        else if (ok && e.type == REPLAY_CURSOR_POS)
+            ok = ReadBytes(f, &e.x, sizeof(e.x)) && ReadBytes(f, &e.y, sizeof(e.y));
+        else if (ok && e.type != REPLAY_END)
+        {
+            fprintf(stderr, "ERROR: invalid event type %d in \"%s\".\n", e.type, filename);
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (!ok || (!g_Events.empty() && (e.frame < g_Events.back().frame || e.time < g_Events.back().time)))
+        {
+            fprintf(stderr, "ERROR: corrupted input recording \"%s\".\n", filename);
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (e.type == REPLAY_END)
+        {
+            g_NumFrames = e.frame;
+            g_EndTime   = e.time;
+            ended = true;
+            break;
+        }
+        g_Events.push_back(e);
+    }
+    fclose(f);
+
+    // Gravação interrompida (p.ex. o programa travou): reproduzimos até o
+    // instante do último evento.
+    if (!ended)
+    {
+        fprintf(stderr, "WARNING: input recording \"%s\" has no end marker.\n", filename);
+        g_NumFrames = g_Events.empty() ? 0 : g_Events.back().frame + 1;
+        g_EndTime   = g_Events.empty() ? 0.0 : g_Events.back().time;
+    }
+
+    printf("Reproducao: %lu eventos em %u quadros (%.1f s gravados) de \"%s\".\n",
+           (unsigned long)g_Events.size(), g_NumFrames, g_EndTime, filename);
+
+    g_Playing    = true;
+    g_PaceByTime = true;
+    g_NextEvent  = 0;
+    g_Frame      = 0;
+}
+
+bool Replay_ParseArg(int argc, char* argv[], int* i)
+{
+    const char* arg = argv[*i];
+    if (strcmp(arg, "--record") == 0 && *i + 1 < argc)
+    {
+        if (g_Playing)
+        {
+            fprintf(stderr, "ERROR: --record and --replay cannot be used together.\n");
+            std::exit(EXIT_FAILURE);
+        }
+        StartRecording(argv[++*i]);
+    }
+    else if (strcmp(arg, "--replay") == 0 && *i + 1 < argc)
+    {
+        if (g_RecordFile != NULL)
+        {
+            fprintf(stderr, "ERROR: --record and --replay cannot be used together.\n");
+            std::exit(EXIT_FAILURE);
+        }
+        LoadReplay(argv[++*i]);
+    }
+    else if (strcmp(arg, "--replay-step") == 0 && *i + 1 < argc)
+    {
+        g_TimeStep = atof(argv[++*i]);
+        if (!(g_TimeStep > 0.0))
+        {
+            fprintf(stderr, "ERROR: invalid --replay-step \"%s\".\n", argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else
+        return false;
+    return true;
+}
+
+bool Replay_IsRecording()
+{
+    return g_RecordFile != NULL;
+}
+
+bool Replay_IsPlaying()
+{
+    return g_Playing;
+}
+
+void Replay_InstallCallbacks(GLFWwindow* window)
+{
+    if (g_RecordFile != NULL)
+    {
+        glfwSetKeyCallback(window, RecordKeyCallback);
+        glfwSetMouseButtonCallback(window, RecordMouseButtonCallback);
+        glfwSetCursorPosCallback(window, RecordCursorPosCallback);
+    }
+    else if (g_Playing)
+    {
+        glfwSetKeyCallback(window, NULL);
+        glfwSetMouseButtonCallback(window, NULL);
+        glfwSetCursorPosCallback(window, NULL);
+    }
+}
+
+void Replay_SetEvents(const ReplayEvent* events, int num_events, unsigned int num_frames)
+{
+    g_Events.assign(events, events + num_events);
+    g_NumFrames  = num_frames;
+    g_Playing    = true;
+    g_PaceByTime = false;
+    g_NextEvent  = 0;
+    g_Frame      = 0;
+}
+
+// Indica se o próximo evento já deve ser repassado no quadro atual.
+static bool NextEventDue()
+{
+    if (g_NextEvent == g_Events.size())
+        return false;
+    if (g_PaceByTime) // Instantes gravados em f32
+        return g_Events[g_NextEvent].time <= (float)Replay_Time();
+    return g_Events[g_NextEvent].frame <= g_Frame;
+}
+
+void Replay_BeginFrame(GLFWwindow* window)
+{
+    if (g_RecordFile != NULL && g_Frame == 0)
+        g_RecordStart = Clock::now();
+
+    // Eventos recebidos pela GLFW durante o quadro N (em glfwPollEvents(), no
+    // fim do quadro) são gravados e tratados pelo programa no quadro N+1, que
+    // começa depois do seu instante; na reprodução eles são repassados no
+    // início do primeiro quadro cujo tempo alcança o instante gravado, antes
+    // da atualização do tempo, mantendo a mesma ordem.
+    while (g_Playing && NextEventDue())
+    {
+        const ReplayEvent& e = g_Events[g_NextEvent++];
+        switch (e.type)
+        {
+        case REPLAY_KEY:
+            KeyCallback(window, e.key, e.scancode, e.action, e.mods);
+            break;
+        case REPLAY_MOUSE_BUTTON:
+            g_CursorX = e.x;
+            g_CursorY = e.y;
+            MouseButtonCallback(window, e.key, e.action, e.mods);
+            break;
+        case REPLAY_CURSOR_POS:
+            g_CursorX = e.x;
+            g_CursorY = e.y;
+            CursorPosCallback(window, e.x, e.y);
+            break;
+        }
+    }
+    g_Frame += 1;
+}
+
+bool Replay_Finished(GLFWwindow* window)
+{
+    if (!g_Playing)
+        return false;
+    if (window != NULL && glfwWindowShouldClose(window))
+        return true;
+    // O próximo quadro já passaria do fechamento gravado.
+    if (g_PaceByTime)
+        return g_NextEvent == g_Events.size() && Replay_Time() > g_EndTime;
+    return g_Frame >= g_NumFrames;
+}
+
+double Replay_Time()
+{
+    return g_Frame * g_TimeStep;
+}
+
+double Replay_TimeStep()
+{
+    return g_TimeStep;
+}
+
+void Replay_GetCursorPos(GLFWwindow* window, double* x, double* y)
+{
+    if (g_Playing)
+    {
+        *x = g_CursorX;
+        *y = g_CursorY;
+    }
+    else
+        glfwGetCursorPos(window, x, y);
+}
+
+void Replay_Close()
+{
+    if (g_RecordFile == NULL)
+        return;
+
+    WriteRecordHeader(REPLAY_END);
+    fclose(g_RecordFile);
+    g_RecordFile = NULL;
+    printf("Gravacao: %lu eventos em %u quadros salvos em \"%s\".\n", g_RecordCount - 1, g_Frame, g_RecordFilename);
+}
@@ -42,11 +42,12 @@ uniform mat4 projection;
 #define ESFERA_BLINN 21
 
 
-uniform int object_id;
-
-// Parâmetros da axis-aligned bounding box (AABB) do modelo
-uniform vec4 bbox_min;
-uniform vec4 bbox_max;
+// Material e parâmetros da axis-aligned bounding box (AABB) do modelo,
+// escolhidos pelo Vertex Shader entre os uniforms de mesmo nome e o registro
+// do objeto no envio indireto (veja "include/multidraw.h").
+flat in int object_id_v;
+flat in vec4 bbox_min_v;
+flat in vec4 bbox_max_v;
 
 // Variáveis para acesso das imagens de textura
 uniform sampler2D TextureImage0;
@@ -78,8 +79,16 @@ uniform int acerto_ou_erro_est1 = 0;
 uniform int cor_lampada = 1;
 uniform int direcao_planar = 1;
 
+// Preparo dos impostores (veja "include/impostor.h"): em vez da cor
+// iluminada, gravamos a refletância difusa, a normal no sistema de
+// coordenadas do modelo e a profundidade.
+uniform int impostor_bake = 0;
+
 // O valor de saída ("out") de um Fragment Shader é a cor final do fragmento.
-out vec3 color;
+// A segunda saída só é usada no preparo dos impostores (veja abaixo).
+layout (location = 0) out vec4 frag_color;
+layout (location = 1) out vec4 frag_normal;
+vec3 color;
 vec3 lambert_color;
 
 in vec3 cor_v;
@@ -96,6 +105,10 @@ float q; // Expoente especular para o modelo de iluminação de Phong
 
 void main()
 {
+    int object_id = object_id_v;
+    vec4 bbox_min = bbox_min_v;
+    vec4 bbox_max = bbox_max_v;
+
     // Obtemos a posição da câmera utilizando a inversa da matriz que define o
     // sistema de coordenadas da câmera.
     vec4 origin = vec4(0.0, 0.0, 0.0, 1.0);
@@ -546,6 +559,15 @@ void main()
     }
 
 
+    if (impostor_bake == 1)
+    {
+        if (object_id == ESFERA_GOURAUD)
+            Kd = vec3(1.0, 0.843, 0.0);
+        frag_color = vec4(Kd, 1.0);
+        frag_normal = vec4(n.xyz * 0.5 + 0.5, gl_FragCoord.z);
+        return;
+    }
+
     // Equação de Iluminação
     float lambert = max(0,dot(n,l));
 
@@ -615,5 +637,6 @@ void main()
     // Cor final com correção gamma, considerando monitor sRGB.
     // Veja https://en.wikipedia.org/w/index.php?title=Gamma_correction&oldid=751281772#Windows.2C_Mac.2C_sRGB_and_TV.2Fvideo_standard_gammas
     color = pow(color, vec3(1.0,1.0,1.0)/2.2);
+    frag_color = vec4(color, 1.0);
 }
 
@@ -6,6 +6,22 @@ layout (location = 0) in vec4 model_coefficients;
 layout (location = 1) in vec4 normal_coefficients;
 layout (location = 2) in vec2 texture_coefficients;
 
+// Posio no sistema de coordenadas do modelo, somente nos lotes estticos
+// (veja "include/staticbatch.h"), cujos vrtices j esto no mundo.
+layout (location = 3) in vec4 model_position_coefficients;
+uniform int static_batch = 0;
+
+// Registro do objeto no envio indireto (veja "include/multidraw.h"), um por
+// instncia. Usados no lugar dos uniforms "model", "object_id", "bbox_min" e
+// "bbox_max" quando "multi_draw" est ligado.
+layout (location = 4) in mat4 draw_model;
+layout (location = 8) in vec4 draw_bbox_min;
+layout (location = 9) in vec4 draw_bbox_max;
+layout (location = 10) in int draw_object_id;
+uniform int multi_draw = 0;
+uniform vec4 bbox_min;
+uniform vec4 bbox_max;
+
 // Matrizes computadas no cdigo C++ e enviadas para a GPU
 uniform mat4 model;
 uniform mat4 view;
@@ -24,8 +40,21 @@ out vec4 normal;
 out vec2 texcoords;
 out vec3 cor_v;
 
+// Material e bounding box do objeto, para o Fragment Shader.
+flat out int object_id_v;
+flat out vec4 bbox_min_v;
+flat out vec4 bbox_max_v;
+
 void main()
 {
+    // Matriz de modelagem e identificador do objeto: os do registro do
+    // objeto no envio indireto, ou os uniforms de mesmo nome.
+    mat4 model_matrix = (multi_draw != 0) ? draw_model : model;
+    int current_object_id = (multi_draw != 0) ? draw_object_id : object_id;
+    object_id_v = current_object_id;
+    bbox_min_v = (multi_draw != 0) ? draw_bbox_min : bbox_min;
+    bbox_max_v = (multi_draw != 0) ? draw_bbox_max : bbox_max;
+
     // A varivel gl_Position define a posio final de cada vrtice
     // OBRIGATORIAMENTE em "normalized device coordinates" (NDC), onde cada
     // coeficiente estar entre -1 e 1 aps diviso por w.
@@ -38,7 +67,7 @@ void main()
     // deste Vertex Shader, a placa de vdeo (GPU) far a diviso por W. Veja
     // slide 189 do documento "Aula_09_Projecoes.pdf".
 
-    gl_Position = projection * view * model * model_coefficients;
+    gl_Position = projection * view * model_matrix * model_coefficients;
 
     // Como as variveis acima  (tipo vec4) so vetores com 4 coeficientes,
     // tambm  possvel acessar e modificar cada coeficiente de maneira
@@ -55,14 +84,14 @@ void main()
     // rasterizador para gerar atributos nicos para cada fragmento gerado.
 
     // Posio do vrtice atual no sistema de coordenadas global (World).
-    position_world = model * model_coefficients;
+    position_world = model_matrix * model_coefficients;
 
     // Posio do vrtice atual no sistema de coordenadas local do modelo.
-    position_model = model_coefficients;
+    position_model = (static_batch != 0) ? model_position_coefficients : model_coefficients;
 
     // Normal do vrtice atual no sistema de coordenadas global (World).
     // Veja slide 107 do documento "Aula_07_Transformacoes_Geometricas_3D.pdf".
-    normal = inverse(transpose(model)) * normal_coefficients;
+    normal = inverse(transpose(model_matrix)) * normal_coefficients;
     normal.w = 0.0;
 
     // Coordenadas de textura obtidas do arquivo OBJ (se existirem!)
@@ -72,7 +101,7 @@ void main()
 cor_v = vec3(0.0f, 0.0f, 0.0f);
 
     // GOURAUD SHADING
-    if ( object_id == ESFERA_GOURAUD )
+    if ( current_object_id == ESFERA_GOURAUD )
     {
         float q = 40;
         vec3 Kd = vec3(1.0, 0.843, 0.0);
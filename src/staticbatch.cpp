@@ -0,0 +1,267 @@
+// Lotes estáticos. Veja comentários em "include/staticbatch.h".
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+
+#include "staticbatch.h"
+#include "glstate.h"
+#include "perfhud.h"
+#include "assetstats.h"
+
+static bool             g_Enabled = false;
+static bool             g_Built = false;
+static size_t           g_MaxVertices = STATICBATCH_DEFAULT_MAX_VERTICES;
+static StaticBatch      g_Batches[STATICBATCH_MAX_BATCHES];
+static int              g_NumBatches = 0;
+static StaticBatchStats g_Stats;
+
+bool StaticBatch_ParseArg(int argc, char* argv[], int* i)
+{
+    if (strcmp(argv[*i], "--static-batching") == 0)
+    {
+        g_Enabled = true;
+        return true;
+    }
+    if (strcmp(argv[*i], "--no-static-batching") == 0)
+    {
+        g_Enabled = false;
+        return true;
+    }
+    if (strcmp(argv[*i], "--static-batch-vertices") == 0 && *i + 1 < argc)
+    {
+        g_MaxVertices = (size_t)std::max(1, atoi(argv[++*i]));
+        return true;
+    }
+    return false;
+}
+
+bool StaticBatch_IsEnabled()
+{
+    return g_Enabled;
+}
+
+bool StaticBatch_IsBuilt()
+{
+    return g_Built;
+}
+
+// Vértices de um lote em construção, um vetor por atributo, como em
+// BuildTrianglesAndAddToVirtualScene().
+struct BatchData
+{
+    std::vector<float>        positions;       // vec4, no mundo
+    std::vector<float>        normals;         // vec4, no mundo
+    std::vector<float>        texcoords;       // vec2
+    std::vector<float>        model_positions; // vec4, no sistema do modelo
+    std::vector<unsigned int> indices;
+};
+
+// Lê "count" valores de "size" bytes, a partir do valor "first", do buffer
+// ligado ao atributo "location" do VAO atual (nada se ele estiver desligado).
+// O atributo pode começar no meio do buffer (veja mesharena.h).
+static bool ReadAttribute(GLuint location, size_t size, size_t first, size_t count, std::vector<float>* out)
+{
+    GLint enabled = 0, buffer = 0;
+    void* pointer = NULL;
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+    glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+    glGetVertexAttribPointerv(location, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+    if (!enabled || buffer == 0)
+        return false;
+
+    out->resize(count * size / sizeof(float));
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, (size_t)pointer + first * size, count * size, out->data());
+    return true;
+}
+
+// Lê os índices de "source", e o trecho de vértices que eles usam: "*count"
+// vértices a partir de "*first".
+static void ReadIndices(const StaticBatchSource& source, std::vector<unsigned int>* indices, unsigned int* first,
+                        size_t* count)
+{
+    GLState_BindVertexArray(source.vertex_array_object_id);
+
+    GLint index_buffer = 0;
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer);
+    indices->resize(source.num_indices);
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, index_buffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, source.first_index * sizeof(GLuint), source.num_indices * sizeof(GLuint), indices->data());
+    *first = *std::min_element(indices->begin(), indices->end());
+    *count = *std::max_element(indices->begin(), indices->end()) - *first + 1;
+}
+
+// Acrescenta ao lote os vértices de "source", levados ao mundo, com os
+// índices lidos por ReadIndices().
+static void AppendSource(const StaticBatchSource& source, const std::vector<unsigned int>& indices, unsigned int first,
+                         size_t count, BatchData* batch)
+{
+    GLState_BindVertexArray(source.vertex_array_object_id);
+
+    std::vector<float> positions, normals, texcoords;
+    ReadAttribute(0, 4*sizeof(float), source.base_vertex + first, count, &positions);
+    bool has_normals   = ReadAttribute(1, 4*sizeof(float), source.base_vertex + first, count, &normals);
+    bool has_texcoords = ReadAttribute(2, 2*sizeof(float), source.base_vertex + first, count, &texcoords);
+
+    glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(source.model)));
+    unsigned int base = (unsigned int)(batch->positions.size() / 4);
+    for (size_t v = 0; v < count; ++v)
+    {
+        glm::vec4 p(positions[4*v + 0], positions[4*v + 1], positions[4*v + 2], positions[4*v + 3]);
+        glm::vec4 world = source.model * p;
+        batch->positions.insert(batch->positions.end(), { world.x, world.y, world.z, world.w });
+        batch->model_positions.insert(batch->model_positions.end(), { p.x, p.y, p.z, p.w });
+
+        glm::vec3 n = has_normals ? normal_matrix * glm::vec3(normals[4*v + 0], normals[4*v + 1], normals[4*v + 2]) : glm::vec3(0.0f);
+        batch->normals.insert(batch->normals.end(), { n.x, n.y, n.z, 0.0f });
+
+        batch->texcoords.push_back(has_texcoords ? texcoords[2*v + 0] : 0.0f);
+        batch->texcoords.push_back(has_texcoords ? texcoords[2*v + 1] : 0.0f);
+    }
+    for (size_t i = 0; i < indices.size(); ++i)
+        batch->indices.push_back(base + indices[i] - first);
+}
+
+// Copia um lote para a GPU: um VBO com os quatro atributos em sequência e
+// um IBO.
+static void UploadBatch(const BatchData& data, StaticBatch* batch)
+{
+    size_t sizes[4] = {
+        data.positions.size() * sizeof(float),
+        data.normals.size() * sizeof(float),
+        data.texcoords.size() * sizeof(float),
+        data.model_positions.size() * sizeof(float)
+    };
+    const float* arrays[4] = { data.positions.data(), data.normals.data(), data.texcoords.data(), data.model_positions.data() };
+    const GLint dimensions[4] = { 4, 4, 2, 4 }; // "(location = 0)" a "(location = 3)" em "shader_vertex.glsl"
+
+    GLuint vertex_array_object_id, vbo_id, ibo_id;
+    glGenVertexArrays(1, &vertex_array_object_id);
+    GLState_BindVertexArray(vertex_array_object_id);
+
+    glGenBuffers(1, &vbo_id);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, vbo_id);
+    glBufferData(GL_ARRAY_BUFFER, sizes[0] + sizes[1] + sizes[2] + sizes[3], NULL, GL_STATIC_DRAW);
+    size_t offset = 0;
+    for (GLuint location = 0; location < 4; ++location)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, offset, sizes[location], arrays[location]);
+        glVertexAttribPointer(location, dimensions[location], GL_FLOAT, GL_FALSE, 0, (void*)offset);
+        glEnableVertexAttribArray(location);
+        offset += sizes[location];
+    }
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &ibo_id);
+    GLState_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(GLuint), data.indices.data(), GL_STATIC_DRAW);
+    GLState_BindVertexArray(0);
+
+    size_t bytes = offset + data.indices.size() * sizeof(GLuint);
+    PerfHud_AddBufferMemory(bytes);
+    g_Stats.bytes    += bytes;
+    g_Stats.vertices += data.positions.size() / 4;
+
+    batch->vertex_array_object_id = vertex_array_object_id;
+    batch->num_indices = (GLsizei)data.indices.size();
+}
+
+void StaticBatch_Build(const StaticBatchSource* sources, int count)
+{
+    if (!g_Enabled || g_Built)
+        return;
+
+    double start = AssetStats_NowMs();
+
+    // Materiais na ordem em que aparecem.
+    int materials[STATICBATCH_MAX_SOURCES];
+    int num_materials = 0;
+    for (int s = 0; s < count; ++s)
+    {
+        int m = 0;
+        while (m < num_materials && materials[m] != sources[s].object_id)
+            ++m;
+        if (m == num_materials)
+            materials[num_materials++] = sources[s].object_id;
+    }
+
+    BatchData data;
+    std::vector<unsigned int> indices;
+    for (int m = 0; m < num_materials; ++m)
+    {
+        int first_source = -1;
+        for (int s = 0; s <= count; ++s)
+        {
+            bool last = (s == count);
+            if (!last && sources[s].object_id != materials[m])
+                continue;
+
+            // Fecha o lote atual ao fim do material, ou se os vértices do
+            // próximo objeto não couberem nele.
+            unsigned int first = 0;
+            size_t vertices = 0;
+            if (!last)
+                ReadIndices(sources[s], &indices, &first, &vertices);
+            if (first_source >= 0 && (last || data.positions.size() / 4 + vertices > g_MaxVertices))
+            {
+                if (g_NumBatches == STATICBATCH_MAX_BATCHES)
+                {
+                    fprintf(stderr, "ERROR: too many static batches (max. %d).\n", STATICBATCH_MAX_BATCHES);
+                    std::exit(EXIT_FAILURE);
+                }
+                StaticBatch& batch = g_Batches[g_NumBatches++];
+                UploadBatch(data, &batch);
+                batch.object_id = materials[m];
+                batch.bbox_min  = sources[first_source].bbox_min;
+                batch.bbox_max  = sources[first_source].bbox_max;
+                data = BatchData();
+                first_source = -1;
+            }
+            if (last)
+                continue;
+
+            if (first_source < 0)
+                first_source = s;
+            AppendSource(sources[s], indices, first, vertices, &data);
+            g_Stats.sources += 1;
+        }
+    }
+    GLState_BindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    g_Stats.batches  = g_NumBatches;
+    g_Stats.build_ms = AssetStats_NowMs() - start;
+    g_Built = true;
+}
+
+int StaticBatch_Count()
+{
+    return g_NumBatches;
+}
+
+const StaticBatch& StaticBatch_Get(int batch)
+{
+    return g_Batches[batch];
+}
+
+StaticBatchStats StaticBatch_GetStats()
+{
+    return g_Stats;
+}
+
+void StaticBatch_PrintStats(FILE* f)
+{
+    if (!g_Enabled)
+    {
+        fprintf(f, "Lotes estaticos: desligados (ligue com --static-batching).\n");
+        return;
+    }
+
+    StaticBatchStats stats = StaticBatch_GetStats();
+    fprintf(f, "Lotes estaticos: %d objetos em %d lotes (%lu vertices, %.1f KiB de GPU, %.1f ms).\n",
+            stats.sources, stats.batches, (unsigned long)stats.vertices, stats.bytes / 1024.0, stats.build_ms);
+}
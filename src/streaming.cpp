@@ -0,0 +1,714 @@
+// Carregamento sob demanda. Veja comentários em "include/streaming.h".
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <stb_image.h>
+
+#include "streaming.h"
+#include "uploader.h"
+#include "assetpack.h"
+#include "texturecache.h"
+#include "loadarena.h"
+
+// Funções definidas em main.cpp
+void AddMeshToVirtualScene(const MeshData* mesh, AssetStats* stats, MeshBuffers* buffers);
+void AddUploadedMeshToVirtualScene(const MeshData* mesh, AssetStats* stats, MeshBuffers* buffers);
+void RemoveMeshFromVirtualScene(const MeshBuffers* buffers);
+unsigned int UploadTextureImage(unsigned int textureunit, const unsigned char* data, int width, int height, uint64_t content_hash, AssetStats* stats);
+unsigned int BindUploadedTextureImage(unsigned int textureunit, unsigned int texture_id, int width, int height, uint64_t content_hash, AssetStats* stats);
+size_t RemoveTextureImage(unsigned int textureunit, unsigned int texture_id, size_t bytes);
+
+enum AssetState
+{
+    ASSET_UNLOADED, // Ausente: desenhado como substituto
+    ASSET_QUEUED,   // Na fila da thread de carregamento
+    ASSET_LOADING,  // Sendo lido pela thread de carregamento
+    ASSET_READY,    // Lido, aguardando o envio para a GPU
+    ASSET_UPLOADING,// Com a thread de envio (veja uploader.h)
+    ASSET_RESIDENT, // Na GPU
+    ASSET_FAILED    // Arquivo não pôde ser lido; fica como substituto
+};
+
+struct StreamAsset
+{
+    // Fixos após Streaming_Start().
+    char        filepath[100];  // Sem a extensão
+    char        basepath[100];  // Somente modelos
+    AssetKind   kind;
+    int         unit;           // Somente texturas
+    AssetStats* stats;
+
+    // Protegidos por g_Mutex.
+    AssetState  state;
+    bool        wanted;         // Próximo da câmera no último Streaming_Update()
+
+    // Dados lidos pela thread de carregamento. Com o recurso em ASSET_READY
+    // passam a pertencer à thread do laço; em ASSET_UPLOADING, são lidos pela
+    // thread de envio até ela devolver "job".
+    MeshData*      mesh;
+    void*          arena_block; // Bloco da arena onde estão os vetores de "mesh"
+    unsigned char* pixels;
+    int            width;
+    int            height;
+    uint64_t       content_hash; // TextureCache_Hash() de "pixels"
+    size_t         cpu_bytes;
+
+    // Somente na thread do laço.
+    unsigned long  last_near_frame;
+    double         request_ms;
+    MeshBuffers    buffers;
+    unsigned int   texture_id;
+    size_t         gpu_bytes;   // Cobrados no envio; zero ao compartilhar uma textura
+
+    UploadJob      job;
+};
+
+static bool  g_Enabled = false;
+static float g_Radius = STREAMING_DEFAULT_RADIUS;
+static size_t g_GpuBudget = (size_t)STREAMING_DEFAULT_GPU_MIB * 1024 * 1024;
+static size_t g_CpuBudget = (size_t)STREAMING_DEFAULT_CPU_MIB * 1024 * 1024;
+
+static StreamAsset g_Assets[STREAMING_MAX_ASSETS];
+static int         g_NumAssets = 0;
+
+// Recursos de cada estande.
+static int g_StandAssets[STREAMING_MAX_STANDS][STREAMING_MAX_STAND_ASSETS];
+static int g_NumStandAssets[STREAMING_MAX_STANDS];
+
+// Fila circular de pedidos. Cada recurso está na fila no máximo uma vez
+// (estado ASSET_QUEUED), então STREAMING_MAX_ASSETS posições bastam.
+static int g_Queue[STREAMING_MAX_ASSETS];
+static int g_QueueHead = 0;
+static int g_QueueSize = 0;
+
+static std::mutex              g_Mutex;
+static std::condition_variable g_WakeWorker;
+static std::thread             g_Worker;
+static bool                    g_Running = false;
+static bool                    g_Quit = false;
+static size_t                  g_CpuBytes = 0; // Dados em ASSET_READY
+
+// Orçamento de tempo de envio por quadro e custo estimado do envio, em ms
+// por byte lido, de malhas [0] e texturas [1].
+static double g_UploadBudgetMs = STREAMING_DEFAULT_UPLOAD_MS;
+static double g_UploadMsPerByte[2] = { 0.0, 0.0 };
+
+// Modo --progressive: todos os recursos são desejados, e nada é descartado.
+static bool g_Progressive = false;
+
+// Envio pela thread de envio (desligado com --no-upload-thread, ou se não for
+// possível criar o contexto compartilhado).
+static bool g_UploadThread = true;
+
+static StreamingStats g_Stats;
+static double         g_LatencySumMs = 0.0;
+static unsigned long  g_Frame = 0;
+
+bool Streaming_ParseArg(int argc, char* argv[], int* i)
+{
+    const char* arg = argv[*i];
+    if (strcmp(arg, "--stream") == 0)
+        g_Enabled = true;
+    else if (strcmp(arg, "--progressive") == 0)
+        g_Enabled = g_Progressive = true;
+    else if (strcmp(arg, "--no-upload-thread") == 0)
+        g_UploadThread = false;
+    else if (strcmp(arg, "--stream-radius") == 0 && *i + 1 < argc)
+    {
+        g_Enabled = true;
+        g_Radius = (float)atof(argv[++*i]);
+        if (g_Radius <= 0.0f)
+        {
+            fprintf(stderr, "ERROR: invalid --stream-radius \"%s\".\n", argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else if (strcmp(arg, "--stream-upload-ms") == 0 && *i + 1 < argc)
+    {
+        g_Enabled = true;
+        g_UploadBudgetMs = atof(argv[++*i]);
+        if (g_UploadBudgetMs <= 0.0)
+        {
+            fprintf(stderr, "ERROR: invalid --stream-upload-ms \"%s\".\n", argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    else if ((strcmp(arg, "--stream-gpu-budget") == 0 || strcmp(arg, "--stream-cpu-budget") == 0) && *i + 1 < argc)
+    {
+        g_Enabled = true;
+        double mib = atof(argv[++*i]);
+        if (mib <= 0.0)
+        {
+            fprintf(stderr, "ERROR: invalid %s \"%s\" (expected MiB).\n", arg, argv[*i]);
+            std::exit(EXIT_FAILURE);
+        }
+        size_t bytes = (size_t)(mib * 1024.0 * 1024.0);
+        if (strcmp(arg, "--stream-gpu-budget") == 0)
+            g_GpuBudget = bytes;
+        else
+            g_CpuBudget = bytes;
+    }
+    else
+        return false;
+    return true;
+}
+
+bool Streaming_IsEnabled()
+{
+    return g_Enabled;
+}
+
+bool Streaming_IsProgressive()
+{
+    return g_Progressive;
+}
+
+bool Streaming_IsFullyLoaded()
+{
+    std::lock_guard<std::mutex> lock(g_Mutex);
+    for (int i = 0; i < g_NumAssets; ++i)
+        if (g_Assets[i].state != ASSET_RESIDENT && g_Assets[i].state != ASSET_FAILED)
+            return false;
+    return true;
+}
+
+static int AddAsset(const char* filepath, AssetKind kind)
+{
+    if (g_NumAssets >= STREAMING_MAX_ASSETS)
+    {
+        fprintf(stderr, "ERROR: too many streamed assets (max. %d).\n", STREAMING_MAX_ASSETS);
+        std::exit(EXIT_FAILURE);
+    }
+    StreamAsset& a = g_Assets[g_NumAssets];
+    memset(&a, 0, sizeof(a));
+    strncpy(a.filepath, filepath, sizeof(a.filepath) - 1);
+    a.kind  = kind;
+    a.state = ASSET_UNLOADED;
+
+    char path[112];
+    snprintf(path, sizeof(path), "%s%s", filepath, kind == ASSET_MODEL ? ".obj" : ".png");
+    a.stats = AssetStats_Add(path, kind);
+    a.stats->page_faults = 0; // Contado a partir da leitura, veja WorkerMain()
+    return g_NumAssets++;
+}
+
+int Streaming_AddModel(const char* filepath, const char* basepath)
+{
+    int asset = AddAsset(filepath, ASSET_MODEL);
+    strncpy(g_Assets[asset].basepath, basepath, sizeof(g_Assets[asset].basepath) - 1);
+    return asset;
+}
+
+int Streaming_AddTexture(const char* filepath, int unit)
+{
+    int asset = AddAsset(filepath, ASSET_TEXTURE);
+    g_Assets[asset].unit = unit;
+    return asset;
+}
+
+void Streaming_AddToStand(int stand, int asset)
+{
+    if (stand < 0 || stand >= STREAMING_MAX_STANDS || g_NumStandAssets[stand] >= STREAMING_MAX_STAND_ASSETS)
+    {
+        fprintf(stderr, "ERROR: too many streamed assets in stand %d.\n", stand + 1);
+        std::exit(EXIT_FAILURE);
+    }
+    g_StandAssets[stand][g_NumStandAssets[stand]++] = asset;
+}
+
+// Leitura de um modelo pela thread de carregamento: o mesmo processo de
+// main(), mas com a malha guardada em "a" até o envio para a GPU.
+static bool LoadModel(StreamAsset* a)
+{
+    AssetStats* stats = a->stats;
+    if (AssetPack_IsOpen())
+    {
+        char objpath[112];
+        snprintf(objpath, sizeof(objpath), "%s.obj", a->filepath);
+        double start = AssetStats_NowMs();
+        size_t size;
+        const void* cooked = AssetPack_Find(objpath, ASSETPACK_COOKED_MESH, &size);
+        MeshData* mesh = new MeshData;
+        if (cooked == NULL || !ReadCookedMesh(cooked, size, mesh, &stats->unique_vertices))
+        {
+            fprintf(stderr, "ERROR: \"%s\" not found in the asset pack.\n", objpath);
+            delete mesh;
+            LoadArena_Release();
+            return false;
+        }
+        stats->load_ms        = AssetStats_NowMs() - start;
+        stats->file_bytes     = size;
+        stats->cpu_peak_bytes = MeshDataMemoryBytes(mesh);
+        stats->vertices       = mesh->model_coefficients.size() / 4;
+        a->mesh = mesh;
+        a->arena_block = LoadArena_Detach(&a->cpu_bytes);
+        return true;
+    }
+
+    try
+    {
+        double start = AssetStats_NowMs();
+        ObjModel model(a->filepath, a->basepath);
+        stats->load_ms = AssetStats_NowMs() - start;
+
+        start = AssetStats_NowMs();
+        ComputeNormals(&model);
+        MeshData* mesh = new MeshData;
+        BuildTriangles(&model, mesh);
+        stats->build_ms = AssetStats_NowMs() - start;
+
+        stats->cpu_peak_bytes  = ObjModelMemoryBytes(&model) + MeshDataMemoryBytes(mesh);
+        stats->vertices        = mesh->model_coefficients.size() / 4;
+        stats->unique_vertices = CountUniqueVertices(&model);
+        ReleaseObjModel(&model);
+
+        // Os vetores da malha ficam no bloco da arena desta thread; o bloco
+        // é liberado pela thread do laço após o envio.
+        a->mesh = mesh;
+        a->arena_block = LoadArena_Detach(&a->cpu_bytes);
+        return true;
+    }
+    catch (const std::runtime_error& e)
+    {
+        fprintf(stderr, "ERROR: %s (\"%s.obj\").\n", e.what(), a->filepath);
+        return false;
+    }
+}
+
+static bool LoadTexture(StreamAsset* a)
+{
+    char filepath[112];
+    snprintf(filepath, sizeof(filepath), "%s.png", a->filepath);
+
+    double start = AssetStats_NowMs();
+    int channels;
+    if (AssetPack_IsOpen())
+    {
+        size_t size = 0;
+        const void* packed = AssetPack_Find(filepath, ASSETPACK_IMAGE, &size);
+        a->pixels = (packed != NULL) ? stbi_load_from_memory((const stbi_uc*)packed, (int)size, &a->width, &a->height, &channels, 3) : NULL;
+        a->stats->file_bytes = size;
+    }
+    else
+    {
+        a->pixels = stbi_load(filepath, &a->width, &a->height, &channels, 3);
+    }
+    if (a->pixels == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open image file \"%s\".\n", filepath);
+        return false;
+    }
+    a->cpu_bytes = (size_t)a->width * a->height * 3;
+    a->content_hash = TextureCache_Hash(a->pixels, a->cpu_bytes);
+    a->stats->load_ms = AssetStats_NowMs() - start;
+    a->stats->cpu_peak_bytes = a->cpu_bytes;
+    return true;
+}
+
+// Libera os dados lidos de um recurso que não será enviado para a GPU.
+static void FreeCpuData(StreamAsset* a)
+{
+    if (a->mesh != NULL)
+    {
+        delete a->mesh;
+        LoadArena_FreeDetached(a->arena_block);
+    }
+    if (a->pixels != NULL)
+        stbi_image_free(a->pixels);
+    a->mesh = NULL;
+    a->arena_block = NULL;
+    a->pixels = NULL;
+    a->cpu_bytes = 0;
+}
+
+static void WorkerMain()
+{
+    std::unique_lock<std::mutex> lock(g_Mutex);
+    for (;;)
+    {
+        // Com o orçamento de CPU esgotado esperamos a thread do laço enviar
+        // (ou descartar) os recursos já lidos.
+        g_WakeWorker.wait(lock, [] { return g_Quit || (g_QueueSize > 0 && g_CpuBytes < g_CpuBudget); });
+        if (g_Quit)
+            break;
+
+        int id = g_Queue[g_QueueHead];
+        g_QueueHead = (g_QueueHead + 1) % STREAMING_MAX_ASSETS;
+        g_QueueSize -= 1;
+
+        StreamAsset* a = &g_Assets[id];
+        if (!a->wanted)
+        {
+            a->state = ASSET_UNLOADED;
+            g_Stats.cancelled += 1;
+            continue;
+        }
+        a->state = ASSET_LOADING;
+        lock.unlock();
+
+        // Contagem inicial de faltas de página, como em AssetStats_Add(): o
+        // recurso pode estar sendo carregado de novo após um descarte.
+        size_t peak_rss;
+        AssetStats_GetProcessMemory(&peak_rss, &a->stats->page_faults);
+
+        bool ok = (a->kind == ASSET_MODEL) ? LoadModel(a) : LoadTexture(a);
+
+        lock.lock();
+        if (ok)
+        {
+            // Com a thread de envio, o recurso segue direto para ela; a
+            // thread do laço só cria o VAO (ou liga a textura) quando o envio
+            // terminar.
+            a->state = ASSET_READY;
+            if (a->wanted && Uploader_IsRunning())
+            {
+                memset(&a->job, 0, sizeof(a->job));
+                a->job.mesh   = a->mesh;
+                a->job.pixels = a->pixels;
+                a->job.width  = a->width;
+                a->job.height = a->height;
+                if (Uploader_Submit(&a->job))
+                    a->state = ASSET_UPLOADING;
+            }
+            g_CpuBytes += a->cpu_bytes;
+            if (g_CpuBytes > g_Stats.peak_cpu_bytes)
+                g_Stats.peak_cpu_bytes = g_CpuBytes;
+        }
+        else
+        {
+            a->state = ASSET_FAILED;
+            a->cpu_bytes = 0;
+            g_Stats.failures += 1;
+        }
+    }
+}
+
+void Streaming_Start(GLFWwindow* window)
+{
+    if (!g_Enabled || g_Running)
+        return;
+
+    // A opção de stb_image é global; definimos antes de iniciar a thread.
+    stbi_set_flip_vertically_on_load(true);
+
+    if (g_UploadThread && !Uploader_Start(window))
+    {
+        printf("Carregamento sob demanda: contexto compartilhado indisponivel, envio na thread do laco.\n");
+        g_UploadThread = false;
+    }
+
+    g_Quit = false;
+    g_Running = true;
+    g_Worker = std::thread(WorkerMain);
+    if (g_Progressive)
+        printf("Carregamento progressivo: %d recursos, envio %s.\n", g_NumAssets, g_UploadThread ? "pela thread de envio" : "na thread do laco");
+    else
+        printf("Carregamento sob demanda: %d recursos, raio %.1f m, orcamento GPU %.1f MiB, CPU %.1f MiB, envio %s.\n",
+               g_NumAssets, g_Radius, g_GpuBudget / (1024.0*1024.0), g_CpuBudget / (1024.0*1024.0),
+               g_UploadThread ? "pela thread de envio" : "na thread do laco");
+}
+
+// Libera os dados na CPU de um recurso enviado para a GPU e registra o envio.
+static void FinishUpload(StreamAsset* a)
+{
+    FreeCpuData(a);
+    AssetStats_Finish(a->stats);
+
+    double latency = AssetStats_NowMs() - a->request_ms;
+    g_LatencySumMs += latency;
+    if (latency > g_Stats.max_latency_ms)
+        g_Stats.max_latency_ms = latency;
+    g_Stats.loads += 1;
+    g_Stats.gpu_bytes += a->gpu_bytes;
+    if (g_Stats.gpu_bytes > g_Stats.peak_gpu_bytes)
+        g_Stats.peak_gpu_bytes = g_Stats.gpu_bytes;
+}
+
+// Envia para a GPU um recurso em ASSET_READY, já retirado da thread de
+// carregamento.
+static void Upload(StreamAsset* a)
+{
+    double start = AssetStats_NowMs();
+    if (a->kind == ASSET_MODEL)
+    {
+        a->stats->gpu_vbo_bytes = 0;
+        a->stats->gpu_ibo_bytes = 0;
+        AddMeshToVirtualScene(a->mesh, a->stats, &a->buffers);
+        a->gpu_bytes = a->buffers.bytes;
+    }
+    else
+    {
+        a->texture_id = UploadTextureImage(a->unit, a->pixels, a->width, a->height, a->content_hash, a->stats);
+        a->gpu_bytes = a->stats->gpu_texture_bytes;
+    }
+    a->stats->upload_ms = AssetStats_NowMs() - start;
+    FinishUpload(a);
+}
+
+// Completa o envio feito pela thread de envio, cuja fence já foi sinalizada.
+static void FinishUploaded(StreamAsset* a)
+{
+    UploadJob* job = &a->job;
+    if (a->kind == ASSET_MODEL)
+    {
+        a->stats->gpu_vbo_bytes = 0;
+        a->stats->gpu_ibo_bytes = 0;
+        AddUploadedMeshToVirtualScene(a->mesh, a->stats, &job->buffers);
+        a->buffers = job->buffers;
+        a->gpu_bytes = job->gpu_bytes;
+    }
+    else
+    {
+        // Com uma textura de mesmo conteúdo já na GPU (veja texturecache.h),
+        // a enviada é apagada e a existente é compartilhada, sem custo: os
+        // seus bytes continuam contados até ela ser apagada (veja Evict()).
+        a->texture_id = BindUploadedTextureImage(a->unit, job->texture_id, a->width, a->height, a->content_hash, a->stats);
+        a->gpu_bytes = a->stats->gpu_texture_bytes;
+    }
+    a->stats->upload_ms = job->upload_ms;
+    FinishUpload(a);
+}
+
+// Os bytes de uma textura compartilhada são cobrados de quem a criou e
+// descontados de quem a apaga, a última unidade a liberá-la; assim
+// "gpu_bytes" segue o que de fato ocupa a GPU.
+static void Evict(StreamAsset* a)
+{
+    size_t freed = a->gpu_bytes;
+    if (a->kind == ASSET_MODEL)
+        RemoveMeshFromVirtualScene(&a->buffers);
+    else
+        freed = RemoveTextureImage(a->unit, a->texture_id, a->gpu_bytes);
+    g_Stats.gpu_bytes -= freed;
+    g_Stats.evictions += 1;
+    a->gpu_bytes = 0;
+    a->texture_id = 0;
+    memset(&a->buffers, 0, sizeof(a->buffers));
+}
+
+// Completa os envios já terminados pela thread de envio e envia recursos
+// lidos, em ordem, enquanto a estimativa do tempo de envio couber no
+// orçamento do quadro ("--stream-upload-ms"). O envio de um recurso não pode
+// ser dividido: um recurso que sozinho não cabe no orçamento é enviado em um
+// quadro só para ele, e o quadro é contado como estourado.
+static void UploadWithinBudget(StreamAsset* const* ready, int num_ready)
+{
+    double start = AssetStats_NowMs();
+    int uploads = 0;
+    for (UploadJob* job = Uploader_PollFinished(); job != NULL; job = Uploader_PollFinished())
+    {
+        StreamAsset* a = g_Assets;
+        while (&a->job != job)
+            ++a;
+        size_t cpu_bytes = a->cpu_bytes;
+        FinishUploaded(a);
+        uploads += 1;
+
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_CpuBytes -= cpu_bytes;
+        a->state = ASSET_RESIDENT;
+    }
+
+    for (int r = 0; r < num_ready; ++r)
+    {
+        StreamAsset* a = ready[r];
+        int kind = (a->kind == ASSET_MODEL) ? 0 : 1;
+        double estimate_ms = g_UploadMsPerByte[kind] * a->cpu_bytes;
+        if (uploads > 0 && AssetStats_NowMs() - start + estimate_ms > g_UploadBudgetMs)
+            break;
+
+        // Os recursos em ASSET_READY não são tocados pela thread de
+        // carregamento: o envio é feito fora do mutex.
+        size_t cpu_bytes = a->cpu_bytes;
+        double upload_start = AssetStats_NowMs();
+        Upload(a);
+        uploads += 1;
+
+        // Média móvel do custo por byte lido, separada para malhas e texturas
+        // (que incluem a geração de mipmaps).
+        double ms_per_byte = (AssetStats_NowMs() - upload_start) / (cpu_bytes > 0 ? cpu_bytes : 1);
+        g_UploadMsPerByte[kind] = (g_UploadMsPerByte[kind] > 0.0) ? 0.5*g_UploadMsPerByte[kind] + 0.5*ms_per_byte : ms_per_byte;
+
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_CpuBytes -= cpu_bytes;
+        a->state = ASSET_RESIDENT;
+    }
+    if (uploads == 0)
+        return;
+
+    g_WakeWorker.notify_one();
+    double elapsed_ms = AssetStats_NowMs() - start;
+    g_Stats.upload_frames += 1;
+    if (elapsed_ms > g_Stats.max_frame_upload_ms)
+        g_Stats.max_frame_upload_ms = elapsed_ms;
+    if (elapsed_ms > g_UploadBudgetMs)
+        g_Stats.upload_overrun_frames += 1;
+}
+
+// Enfileira um pedido de carregamento. Chamada com g_Mutex travado.
+static void Request(int id, double now)
+{
+    StreamAsset* a = &g_Assets[id];
+    a->state = ASSET_QUEUED;
+    a->request_ms = now;
+    g_Queue[(g_QueueHead + g_QueueSize) % STREAMING_MAX_ASSETS] = id;
+    g_QueueSize += 1;
+    g_Stats.requests += 1;
+}
+
+void Streaming_Update(glm::vec4 camera_position, const glm::vec4* stand_positions, int num_stands)
+{
+    if (!g_Running)
+        return;
+    g_Frame += 1;
+
+    // Recursos dos estandes próximos. A distância é medida no plano do chão,
+    // independente da altura da câmera.
+    bool is_near[STREAMING_MAX_ASSETS] = {};
+    if (num_stands > STREAMING_MAX_STANDS)
+        num_stands = STREAMING_MAX_STANDS;
+    for (int s = 0; s < num_stands; ++s)
+    {
+        float dx = stand_positions[s].x - camera_position.x;
+        float dz = stand_positions[s].z - camera_position.z;
+        if (dx*dx + dz*dz > g_Radius*g_Radius)
+            continue;
+        for (int k = 0; k < g_NumStandAssets[s]; ++k)
+            is_near[g_StandAssets[s][k]] = true;
+    }
+
+    double now = AssetStats_NowMs();
+    StreamAsset* ready[STREAMING_MAX_ASSETS];
+    int num_ready = 0;
+    bool stall = false;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_Stats.frames += 1;
+
+        // Pedidos: primeiro os recursos próximos, depois (somente no modo
+        // --progressive, em que todos são desejados) os demais.
+        for (int pass = 0; pass < 2; ++pass)
+            for (int i = 0; i < g_NumAssets; ++i)
+            {
+                StreamAsset* a = &g_Assets[i];
+                if (pass == 0)
+                {
+                    a->wanted = is_near[i] || g_Progressive;
+                    if (is_near[i])
+                        a->last_near_frame = g_Frame;
+                }
+                if (a->wanted && (pass == 0) == is_near[i] && a->state == ASSET_UNLOADED)
+                {
+                    Request(i, now);
+                    wake = true;
+                }
+                if (pass == 0 && is_near[i] && a->state != ASSET_RESIDENT && a->state != ASSET_FAILED)
+                    stall = true;
+            }
+
+        // Recursos já lidos, também com os próximos primeiro.
+        for (int pass = 0; pass < 2; ++pass)
+            for (int i = 0; i < g_NumAssets; ++i)
+            {
+                StreamAsset* a = &g_Assets[i];
+                if (a->state != ASSET_READY || (pass == 0) != is_near[i])
+                    continue;
+                if (a->wanted)
+                {
+                    ready[num_ready++] = a;
+                    continue;
+                }
+                // A câmera se afastou antes do envio.
+                g_CpuBytes -= a->cpu_bytes;
+                FreeCpuData(a);
+                a->state = ASSET_UNLOADED;
+                g_Stats.cancelled += 1;
+                wake = true;
+            }
+        if (stall)
+            g_Stats.stall_frames += 1;
+    }
+    if (wake)
+        g_WakeWorker.notify_one();
+
+    UploadWithinBudget(ready, num_ready);
+
+    // Acima do orçamento de GPU, descartamos o recurso que está há mais tempo
+    // longe da câmera. Somente esta thread altera recursos em ASSET_RESIDENT.
+    // No modo --progressive nada é descartado.
+    while (!g_Progressive && g_Stats.gpu_bytes > g_GpuBudget)
+    {
+        StreamAsset* victim = NULL;
+        for (int i = 0; i < g_NumAssets; ++i)
+        {
+            StreamAsset* a = &g_Assets[i];
+            if (a->state == ASSET_RESIDENT && !is_near[i]
+                && (victim == NULL || a->last_near_frame < victim->last_near_frame))
+                victim = a;
+        }
+        if (victim == NULL)
+        {
+            g_Stats.over_budget_frames += 1;
+            break;
+        }
+        Evict(victim);
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        victim->state = ASSET_UNLOADED;
+    }
+}
+
+void Streaming_Stop()
+{
+    if (!g_Running)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_Quit = true;
+    }
+    g_WakeWorker.notify_one();
+    g_Worker.join();
+    g_Running = false;
+
+    // Os envios não completados são abandonados; os objetos já criados pela
+    // thread de envio são liberados com o contexto, ao fim do programa.
+    Uploader_Stop();
+
+    for (int i = 0; i < g_NumAssets; ++i)
+        if (g_Assets[i].state == ASSET_READY || g_Assets[i].state == ASSET_UPLOADING)
+            FreeCpuData(&g_Assets[i]);
+    g_CpuBytes = 0;
+}
+
+StreamingStats Streaming_GetStats()
+{
+    std::lock_guard<std::mutex> lock(g_Mutex);
+    StreamingStats stats = g_Stats;
+    stats.mean_latency_ms = (g_Stats.loads > 0) ? g_LatencySumMs / g_Stats.loads : 0.0;
+    return stats;
+}
+
+void Streaming_PrintStats(FILE* f)
+{
+    StreamingStats s = Streaming_GetStats();
+    fprintf(f, "Carregamento sob demanda: %lu pedidos, %lu enviados, %lu cancelados, %lu descartados, %lu falhas.\n",
+            s.requests, s.loads, s.cancelled, s.evictions, s.failures);
+    fprintf(f, "  latencia media %.1f ms, max. %.1f ms; %lu de %lu quadros com substitutos proximos, %lu acima do orcamento.\n",
+            s.mean_latency_ms, s.max_latency_ms, s.stall_frames, s.frames, s.over_budget_frames);
+    fprintf(f, "  envio em %lu quadros, max. %.1f ms por quadro, %lu acima de %.1f ms.\n",
+            s.upload_frames, s.max_frame_upload_ms, s.upload_overrun_frames, g_UploadBudgetMs);
+    if (g_UploadThread)
+    {
+        UploaderStats u = Uploader_GetStats();
+        fprintf(f, "  thread de envio: %lu envios, %.1f MiB, %.1f ms ocupada; %lu consultas a fences ainda pendentes.\n",
+                u.jobs, u.bytes / (1024.0*1024.0), u.busy_ms, u.pending_polls);
+    }
+    fprintf(f, "  GPU: %.1f MiB ao fim, pico %.1f MiB (orcamento %.1f MiB); CPU: pico %.1f MiB (orcamento %.1f MiB).\n",
+            s.gpu_bytes / (1024.0*1024.0), s.peak_gpu_bytes / (1024.0*1024.0), g_GpuBudget / (1024.0*1024.0),
+            s.peak_cpu_bytes / (1024.0*1024.0), g_CpuBudget / (1024.0*1024.0));
+}
@@ -0,0 +1,79 @@
+// Posicionamento de texto. Veja comentários em "include/textlayout.h".
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "textlayout.h"
+#include "dejavufont.h"
+
+int TextLayout_String(const char* str, float x, float y, float sx, float sy, float* vertices)
+{
+    int num_glyphs = 0;
+
+    for (size_t i = 0; str[i] != '\0'; i++)
+    {
+        // Find the glyph for the character we are looking for
+        texture_glyph_t *glyph = 0;
+        for (size_t j = 0; j < dejavufont.glyphs_count; ++j)
+        {
+            if (dejavufont.glyphs[j].codepoint == (uint32_t)str[i])
+            {
+                glyph = &dejavufont.glyphs[j];
+                break;
+            }
+        }
+        if (!glyph) {
+            continue;
+        }
+        x += glyph->kerning[0].kerning;
+
+        // O espaço não tem pixels visíveis: apenas avançamos a posição, sem
+        // gerar um quadrilátero (e uma chamada de desenho) para ele.
+        if (glyph->codepoint == ' ')
+        {
+            x += (glyph->advance_x * sx);
+            continue;
+        }
+
+        float x0 = (float) (x + glyph->offset_x * sx);
+        float y0 = (float) (y + glyph->offset_y * sy);
+        float x1 = (float) (x0 + glyph->width * sx);
+        float y1 = (float) (y0 - glyph->height * sy);
+
+        float s0 = glyph->s0 - 0.5f/dejavufont.tex_width;
+        float t0 = glyph->t0 - 0.5f/dejavufont.tex_height;
+        float s1 = glyph->s1 - 0.5f/dejavufont.tex_width;
+        float t1 = glyph->t1 - 0.5f/dejavufont.tex_height;
+
+        const float data[TEXTLAYOUT_FLOATS_PER_GLYPH] = {
+            x0, y0, s0, t0,
+            x0, y1, s0, t1,
+            x1, y1, s1, t1,
+            x0, y0, s0, t0,
+            x1, y1, s1, t1,
+            x1, y0, s1, t0
+        };
+        memcpy(vertices + num_glyphs*TEXTLAYOUT_FLOATS_PER_GLYPH, data, sizeof(data));
+        num_glyphs += 1;
+
+        x += (glyph->advance_x * sx);
+    }
+    return num_glyphs;
+}
+
+float TextLayout_LineHeight()
+{
+    return dejavufont.height;
+}
+
+float TextLayout_CharWidth()
+{
+    return dejavufont.glyphs[32].advance_x;
+}
+
+const unsigned char* TextLayout_FontTexture(int* width, int* height)
+{
+    *width  = (int)dejavufont.tex_width;
+    *height = (int)dejavufont.tex_height;
+    return dejavufont.tex_data;
+}
@@ -1,6 +1,7 @@
 // Based on http://hamelot.io/visualization/opengl-text-without-any-external-libraries/
 //   and on https://github.com/rougier/freetype-gl
 #include <string>
+#include <cstring>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -9,7 +10,10 @@
 #include <glm/vec4.hpp>
 
 #include "utils.h"
-#include "dejavufont.h"
+#include "glstate.h"
+#include "textlayout.h"
+#include "framearena.h"
+#include "perfhud.h"
 
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
 
@@ -118,111 +122,104 @@ void TextRendering_Init()
     glCheckError();
 
     GLuint textureunit = 31;
-    glActiveTexture(GL_TEXTURE0 + textureunit);
-    glBindTexture(GL_TEXTURE_2D, texttexture_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, dejavufont.tex_width, dejavufont.tex_height, 0, GL_RED, GL_UNSIGNED_BYTE, dejavufont.tex_data);
-    glBindSampler(textureunit, sampler);
+    GLState_ActiveTexture(GL_TEXTURE0 + textureunit);
+    GLState_BindTexture(GL_TEXTURE_2D, texttexture_id);
+    int font_width, font_height;
+    const unsigned char* font_data = TextLayout_FontTexture(&font_width, &font_height);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, font_width, font_height, 0, GL_RED, GL_UNSIGNED_BYTE, font_data);
+    PerfHud_AddTextureMemory((size_t)font_width * font_height);
+    GLState_BindSampler(textureunit, sampler);
     glCheckError();
 
-    glBindVertexArray(textVAO);
+    GLState_BindVertexArray(textVAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, textVBO);
     glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    PerfHud_AddBufferMemory(24 * sizeof(float));
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(0);
     glCheckError();
 
-    glUseProgram(textprogram_id);
-    glUniform1i(texttex_uniform, textureunit);
-    glUseProgram(0);
+    GLState_UseProgram(textprogram_id);
+    GLState_Uniform1i(texttex_uniform, textureunit);
+    GLState_UseProgram(0);
     glCheckError();
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState_BindVertexArray(0);
     glCheckError();
 }
 
 float textscale = 1.5f;
 
-void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float x, float y, float scale = 1.0f)
+// Tamanho utilizado quando o texto é desenhado sem uma janela GLFW (modo
+// "--bench", veja bench.h). Definido por TextRendering_SetWindowSize().
+static int g_TextWidth = 0;
+static int g_TextHeight = 0;
+
+void TextRendering_SetWindowSize(int width, int height)
+{
+    g_TextWidth = width;
+    g_TextHeight = height;
+}
+
+static void GetWindowSize(GLFWwindow* window, int* width, int* height)
+{
+    if (window == NULL)
+    {
+        *width = g_TextWidth;
+        *height = g_TextHeight;
+        return;
+    }
+    glfwGetWindowSize(window, width, height);
+}
+
+void TextRendering_PrintString(GLFWwindow* window, const char* str, float x, float y, float scale = 1.0f)
 {
     scale *= textscale;
     int width, height;
-    glfwGetWindowSize(window, &width, &height);
+    GetWindowSize(window, &width, &height);
     float sx = scale / width;
     float sy = scale / height;
 
-    for (size_t i = 0; i < str.size(); i++)
+    // Definimos o estado necessário para o texto uma única vez por string, e
+    // não a cada caractere. O estado não é restaurado ao final: quem desenha
+    // em seguida define o estado que precisa, e o cache de estado (veja
+    // glstate.h) descarta as chamadas redundantes entre strings consecutivas.
+    GLState_Enable(GL_BLEND);
+    GLState_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState_PolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    GLState_DepthFunc(GL_ALWAYS);
+    GLState_UseProgram(textprogram_id);
+    GLState_BindVertexArray(textVAO);
+    GLState_BindBuffer(GL_ARRAY_BUFFER, textVBO);
+
+    // Posição de cada caractere, calculada na CPU (veja textlayout.h), em
+    // memória temporária do quadro (veja framearena.h).
+    float* vertices = FrameArena_AllocArray<float>(strlen(str) * TEXTLAYOUT_FLOATS_PER_GLYPH);
+    int num_glyphs = TextLayout_String(str, x, y, sx, sy, vertices);
+
+    for (int i = 0; i < num_glyphs; i++)
     {
-        // Find the glyph for the character we are looking for
-        texture_glyph_t *glyph = 0;
-        for (size_t j = 0; j < dejavufont.glyphs_count; ++j)
-        {
-            if (dejavufont.glyphs[j].codepoint == (uint32_t)str[i])
-            {
-                glyph = &dejavufont.glyphs[j];
-                break;
-            }
-        }
-        if (!glyph) {
-            continue;
-        }
-        x += glyph->kerning[0].kerning;
-        float x0 = (float) (x + glyph->offset_x * sx);
-        float y0 = (float) (y + glyph->offset_y * sy);
-        float x1 = (float) (x0 + glyph->width * sx);
-        float y1 = (float) (y0 - glyph->height * sy);
-
-        float s0 = glyph->s0 - 0.5f/dejavufont.tex_width;
-        float t0 = glyph->t0 - 0.5f/dejavufont.tex_height;
-        float s1 = glyph->s1 - 0.5f/dejavufont.tex_width;
-        float t1 = glyph->t1 - 0.5f/dejavufont.tex_height;
-
-        struct {float x, y, s, t;} data[6] = {
-            { x0, y0, s0, t0 },
-            { x0, y1, s0, t1 },
-            { x1, y1, s1, t1 },
-            { x0, y0, s0, t0 },
-            { x1, y1, s1, t1 },
-            { x1, y0, s1, t0 }
-        };
-
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDepthFunc(GL_ALWAYS);
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        glUseProgram(textprogram_id);
-        glBindVertexArray(textVAO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, TEXTLAYOUT_FLOATS_PER_GLYPH * sizeof(float), &vertices[i*TEXTLAYOUT_FLOATS_PER_GLYPH]);
 
         glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glDepthFunc(GL_LESS);
-
-        glDisable(GL_BLEND);
-
-        x += (glyph->advance_x * sx);
+        PerfHud_CountDraw(2);
     }
 }
 
 float TextRendering_LineHeight(GLFWwindow* window)
 {
     int width, height;
-    glfwGetWindowSize(window, &width, &height);
-    return dejavufont.height / height * textscale;
+    GetWindowSize(window, &width, &height);
+    return TextLayout_LineHeight() / height * textscale;
 }
 
 float TextRendering_CharWidth(GLFWwindow* window)
 {
     int width, height;
-    glfwGetWindowSize(window, &width, &height);
-    return dejavufont.glyphs[32].advance_x / width * textscale;
+    GetWindowSize(window, &width, &height);
+    return TextLayout_CharWidth() / width * textscale;
 }
 
 void TextRendering_PrintMatrix(GLFWwindow* window, glm::mat4 M, float x, float y, float scale = 1.0f)
@@ -0,0 +1,150 @@
+// Cache de texturas. Veja comentários em "include/texturecache.h".
+#include <cstdlib>
+#include <cstring>
+
+#include "texturecache.h"
+
+struct CachedTexture
+{
+    uint64_t hash;
+    int      width;
+    int      height;
+    GLuint   texture_id;
+    size_t   bytes;
+    int      refs;      // Unidades de textura que usam a textura
+};
+
+struct CachedSampler
+{
+    TextureSamplerParams params;
+    GLuint               sampler_id;
+};
+
+static CachedTexture     g_Textures[TEXTURECACHE_MAX_TEXTURES];
+static int               g_NumTextures = 0;
+static CachedSampler     g_Samplers[TEXTURECACHE_MAX_SAMPLERS];
+static TextureCacheStats g_Stats;
+
+uint64_t TextureCache_Hash(const unsigned char* pixels, size_t size)
+{
+    // Mistura de 8 bytes por vez (multiplicação e rotação, como no
+    // xxHash64): as imagens maiores têm alguns MiB, e o FNV-1a de
+    // AssetPack_Hash(), byte a byte, custaria milissegundos a mais.
+    const uint64_t prime1 = 11400714785074694791ULL;
+    const uint64_t prime2 = 14029467366897019727ULL;
+    uint64_t hash = 2870177450012600261ULL ^ (size * prime1);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, pixels + i, sizeof(word));
+        word *= prime2;
+        word = (word << 31) | (word >> 33);
+        word *= prime1;
+        hash ^= word;
+        hash = ((hash << 27) | (hash >> 37)) * prime1 + prime2;
+    }
+    for (; i < size; ++i)
+    {
+        hash ^= pixels[i] * prime1;
+        hash = ((hash << 11) | (hash >> 53)) * prime2;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+GLuint TextureCache_Acquire(uint64_t hash, int width, int height)
+{
+    g_Stats.lookups += 1;
+    for (int t = 0; t < g_NumTextures; ++t)
+    {
+        CachedTexture& texture = g_Textures[t];
+        if (texture.hash == hash && texture.width == width && texture.height == height)
+        {
+            texture.refs += 1;
+            g_Stats.hits += 1;
+            g_Stats.bytes_saved += texture.bytes;
+            return texture.texture_id;
+        }
+    }
+    return 0;
+}
+
+void TextureCache_Insert(uint64_t hash, int width, int height, GLuint texture_id, size_t bytes)
+{
+    if (g_NumTextures == TEXTURECACHE_MAX_TEXTURES)
+        return;
+
+    CachedTexture& texture = g_Textures[g_NumTextures++];
+    texture.hash       = hash;
+    texture.width      = width;
+    texture.height     = height;
+    texture.texture_id = texture_id;
+    texture.bytes      = bytes;
+    texture.refs       = 1;
+}
+
+bool TextureCache_Release(GLuint texture_id, size_t* bytes)
+{
+    for (int t = 0; t < g_NumTextures; ++t)
+    {
+        CachedTexture& texture = g_Textures[t];
+        if (texture.texture_id != texture_id)
+            continue;
+
+        texture.refs -= 1;
+        if (texture.refs > 0)
+            return false;
+
+        *bytes = texture.bytes;
+        g_Textures[t] = g_Textures[--g_NumTextures];
+        return true;
+    }
+    return true;
+}
+
+GLuint TextureCache_GetSampler(const TextureSamplerParams& params)
+{
+    g_Stats.sampler_requests += 1;
+
+    int s = 0;
+    for (; s < g_Stats.samplers; ++s)
+        if (memcmp(&g_Samplers[s].params, &params, sizeof(params)) == 0)
+            return g_Samplers[s].sampler_id;
+
+    if (s == TEXTURECACHE_MAX_SAMPLERS)
+    {
+        fprintf(stderr, "ERROR: too many sampler parameter sets (max. %d).\n", TEXTURECACHE_MAX_SAMPLERS);
+        std::exit(EXIT_FAILURE);
+    }
+
+    GLuint sampler_id;
+    glGenSamplers(1, &sampler_id);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, params.wrap_s);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, params.wrap_t);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, params.min_filter);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, params.mag_filter);
+
+    g_Samplers[s].params = params;
+    g_Samplers[s].sampler_id = sampler_id;
+    g_Stats.samplers += 1;
+    return sampler_id;
+}
+
+TextureCacheStats TextureCache_GetStats()
+{
+    TextureCacheStats stats = g_Stats;
+    stats.textures = g_NumTextures;
+    return stats;
+}
+
+void TextureCache_PrintStats(FILE* f)
+{
+    TextureCacheStats stats = TextureCache_GetStats();
+    fprintf(f, "Cache de texturas: %lu texturas pedidas, %lu com conteudo repetido (%.1f KiB de GPU economizados), %d samplers para %lu ligacoes.\n",
+            stats.lookups, stats.hits, stats.bytes_saved / 1024.0, stats.samplers, stats.sampler_requests);
+}
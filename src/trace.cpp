@@ -0,0 +1,184 @@
+// Rastreamento de trechos do programa. Veja comentários em "include/trace.h".
+#include "trace.h"
+
+#ifdef TRACE_ENABLED
+
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_HAS_TSC 1
+#endif
+
+struct TraceEvent
+{
+    const char* name;
+    uint64_t    begin;
+    uint64_t    end;
+};
+
+// Buffer de uma thread. Somente a própria thread escreve nele; a exportação
+// lê "written" com semântica "acquire" para enxergar eventos completos.
+struct TraceBuffer
+{
+    TraceEvent            events[TRACE_BUFFER_EVENTS];
+    std::atomic<uint64_t> written;
+    uint32_t              tid;
+    const char*           thread_name;
+    TraceBuffer*          next;
+
+    // Pilha de TRACE_BEGIN() ainda não terminados.
+    const char*           open_names[TRACE_MAX_DEPTH];
+    uint64_t              open_begin[TRACE_MAX_DEPTH];
+    int                   depth;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Lista (somente inserção) com os buffers de todas as threads. Os buffers
+// nunca são liberados, para que eventos de threads já terminadas possam ser
+// exportados.
+static std::atomic<TraceBuffer*> g_TraceBuffers(NULL);
+static std::atomic<uint32_t>     g_TraceNextTid(1);
+static thread_local TraceBuffer* t_TraceBuffer = NULL;
+
+// Instante da inicialização, nos dois relógios, para converter ciclos em
+// microssegundos.
+static uint64_t          g_TraceStartTicks = 0;
+static Clock::time_point g_TraceStartTime;
+
+static inline uint64_t Ticks()
+{
+#ifdef TRACE_HAS_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+#endif
+}
+
+void Trace_Init()
+{
+    g_TraceStartTime  = Clock::now();
+    g_TraceStartTicks = Ticks();
+}
+
+static TraceBuffer* ThreadBuffer()
+{
+    if (t_TraceBuffer != NULL)
+        return t_TraceBuffer;
+
+    TraceBuffer* buffer = new TraceBuffer;
+    buffer->written.store(0, std::memory_order_relaxed);
+    buffer->tid         = g_TraceNextTid.fetch_add(1);
+    buffer->thread_name = NULL;
+    buffer->depth       = 0;
+
+    buffer->next = g_TraceBuffers.load(std::memory_order_relaxed);
+    while (!g_TraceBuffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+        ;
+
+    t_TraceBuffer = buffer;
+    return buffer;
+}
+
+void Trace_SetThreadName(const char* name)
+{
+    ThreadBuffer()->thread_name = name;
+}
+
+void Trace_Begin(const char* name)
+{
+    TraceBuffer* buffer = ThreadBuffer();
+    if (buffer->depth < TRACE_MAX_DEPTH)
+    {
+        buffer->open_names[buffer->depth] = name;
+        buffer->open_begin[buffer->depth] = Ticks();
+    }
+    buffer->depth += 1;
+}
+
+void Trace_End()
+{
+    uint64_t end = Ticks();
+    TraceBuffer* buffer = ThreadBuffer();
+    if (buffer->depth == 0)
+        return;
+
+    buffer->depth -= 1;
+    if (buffer->depth >= TRACE_MAX_DEPTH)
+        return;
+
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    TraceEvent& e = buffer->events[index % TRACE_BUFFER_EVENTS];
+    e.name  = buffer->open_names[buffer->depth];
+    e.begin = buffer->open_begin[buffer->depth];
+    e.end   = end;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+// Escreve uma string JSON, escapando aspas e barras.
+static void WriteJSONString(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+bool Trace_WriteChromeJSON(const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+
+    // Calibramos o relógio comparando os ciclos decorridos desde Trace_Init()
+    // com o tempo medido por std::chrono.
+    uint64_t ticks = Ticks() - g_TraceStartTicks;
+    double   us    = std::chrono::duration<double, std::micro>(Clock::now() - g_TraceStartTime).count();
+    double   us_per_tick = (ticks > 0) ? us / (double)ticks : 0.0;
+
+    fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(f, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"fcg-tour\"}}");
+
+    unsigned long count = 0;
+    for (TraceBuffer* buffer = g_TraceBuffers.load(std::memory_order_acquire); buffer != NULL; buffer = buffer->next)
+    {
+        if (buffer->thread_name != NULL)
+        {
+            fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", buffer->tid);
+            WriteJSONString(f, buffer->thread_name);
+            fprintf(f, "}}");
+        }
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t first   = (written > TRACE_BUFFER_EVENTS) ? written - TRACE_BUFFER_EVENTS : 0;
+        for (uint64_t i = first; i < written; ++i)
+        {
+            const TraceEvent& e = buffer->events[i % TRACE_BUFFER_EVENTS];
+            double ts  = (double)(int64_t)(e.begin - g_TraceStartTicks) * us_per_tick;
+            double dur = (double)(e.end - e.begin) * us_per_tick;
+            fprintf(f, ",\n{\"name\": ");
+            WriteJSONString(f, e.name);
+            fprintf(f, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", buffer->tid, ts, dur);
+            count += 1;
+        }
+    }
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+
+    printf("Trace: %lu eventos salvos em \"%s\".\n", count, filename);
+    return true;
+}
+
+#endif // TRACE_ENABLED
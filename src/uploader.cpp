@@ -0,0 +1,366 @@
+// Thread de envio para a GPU. Veja comentários em "include/uploader.h".
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <glad/glad_profile.h>
+
+#include "uploader.h"
+#include "bench.h"
+#include "assetstats.h"
+#include "trace.h"
+
+// Fila circular com um produtor e um consumidor. Cada índice só é escrito
+// por um dos lados; a ordem release/acquire garante que o ponteiro gravado
+// no slot é visto antes do índice que o publica.
+struct UploadRing
+{
+    UploadJob*               slots[UPLOADER_QUEUE_SIZE];
+    std::atomic<unsigned>    head; // Próximo a ser lido (consumidor)
+    std::atomic<unsigned>    tail; // Próximo a ser escrito (produtor)
+};
+
+static bool RingPush(UploadRing* ring, UploadJob* job)
+{
+    unsigned tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->head.load(std::memory_order_acquire) == UPLOADER_QUEUE_SIZE)
+        return false;
+    ring->slots[tail % UPLOADER_QUEUE_SIZE] = job;
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+static UploadJob* RingPeek(UploadRing* ring)
+{
+    unsigned head = ring->head.load(std::memory_order_relaxed);
+    if (head == ring->tail.load(std::memory_order_acquire))
+        return NULL;
+    return ring->slots[head % UPLOADER_QUEUE_SIZE];
+}
+
+static void RingPop(UploadRing* ring)
+{
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+static UploadRing g_Pending;  // Thread de carregamento -> thread de envio
+static UploadRing g_Finished; // Thread de envio -> thread do laço
+
+static GLFWwindow*       g_UploaderWindow = NULL; // NULL no modo --bench sem janela
+static std::thread       g_UploaderThread;
+static std::atomic<bool> g_UploaderQuit(false);
+static bool              g_UploaderRunning = false;
+
+// Somente para acordar a thread de envio quando a fila estava vazia; os
+// pedidos em si não passam pelo mutex.
+static std::mutex              g_WakeMutex;
+static std::condition_variable g_Wake;
+
+// Resultado da ativação do contexto pela thread de envio, aguardado por
+// Uploader_Start(): 0 enquanto não se sabe, 1 ativado, -1 falhou.
+static int                     g_ContextState = 0;
+static std::condition_variable g_ContextReady;
+
+static UploaderStats g_UploaderStats;
+static std::mutex    g_StatsMutex;
+
+// Buffer de desempacotamento das imagens, reaproveitado entre os envios.
+static GLuint g_PixelBuffer = 0;
+
+// Cria um buffer com "size" bytes e copia "data" para ele por um mapeamento.
+// O alvo GL_COPY_WRITE_BUFFER não é usado para desenho, então o mesmo código
+// serve para vértices e índices (o contexto de envio não tem VAO).
+static GLuint UploadBuffer(const void* data, size_t size)
+{
+    GLuint buffer_id;
+    glGenBuffers(1, &buffer_id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STATIC_DRAW);
+    if (size > 0)
+    {
+        void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped != NULL)
+        {
+            memcpy(mapped, data, size);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+        else
+        {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return buffer_id;
+}
+
+static void UploadMesh(UploadJob* job)
+{
+    const MeshData* mesh = job->mesh;
+    MeshBuffers& buffers = job->buffers;
+    memset(&buffers, 0, sizeof(buffers));
+
+    size_t bytes = mesh->model_coefficients.size() * sizeof(float);
+    buffers.buffer_ids[MESHBUFFER_POSITIONS] = UploadBuffer(mesh->model_coefficients.data(), bytes);
+    buffers.bytes += bytes;
+
+    if (!mesh->normal_coefficients.empty())
+    {
+        bytes = mesh->normal_coefficients.size() * sizeof(float);
+        buffers.buffer_ids[MESHBUFFER_NORMALS] = UploadBuffer(mesh->normal_coefficients.data(), bytes);
+        buffers.bytes += bytes;
+    }
+
+    if (!mesh->texture_coefficients.empty())
+    {
+        bytes = mesh->texture_coefficients.size() * sizeof(float);
+        buffers.buffer_ids[MESHBUFFER_TEXCOORDS] = UploadBuffer(mesh->texture_coefficients.data(), bytes);
+        buffers.bytes += bytes;
+    }
+
+    bytes = mesh->indices.size() * sizeof(GLuint);
+    buffers.buffer_ids[MESHBUFFER_INDICES] = UploadBuffer(mesh->indices.data(), bytes);
+    buffers.bytes += bytes;
+
+    job->gpu_bytes = buffers.bytes;
+}
+
+static void UploadTexture(UploadJob* job)
+{
+    size_t size = (size_t)job->width * job->height * 3;
+
+    // O PBO é "órfão" a cada envio (glBufferData com NULL): o driver pode
+    // entregar memória nova enquanto a cópia anterior ainda é lida.
+    if (g_PixelBuffer == 0)
+        glGenBuffers(1, &g_PixelBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_PixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    const void* source = job->pixels;
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped != NULL)
+    {
+        memcpy(mapped, job->pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        source = NULL; // Deslocamento 0 dentro do PBO
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+    GLuint texture_id;
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, job->width, job->height, 0, GL_RGB, GL_UNSIGNED_BYTE, source);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    job->texture_id = texture_id;
+    // Os drivers costumam guardar GL_SRGB8 com 4 bytes por texel.
+    job->gpu_bytes = AssetStats_TextureBytes(job->width, job->height, 4);
+}
+
+static bool MakeContextCurrent(bool current)
+{
+    if (g_UploaderWindow != NULL)
+    {
+        // glfwMakeContextCurrent() não retorna erro; conferimos o resultado.
+        glfwMakeContextCurrent(current ? g_UploaderWindow : NULL);
+        return glfwGetCurrentContext() == (current ? g_UploaderWindow : NULL);
+    }
+    return Bench_MakeSharedContextCurrent(current);
+}
+
+static void UploaderMain()
+{
+    TRACE_THREAD_NAME("Envio");
+    gladProfileSkipThread(); // Os contadores do quadro são da thread do laço
+    bool current = MakeContextCurrent(true);
+    {
+        std::lock_guard<std::mutex> lock(g_WakeMutex);
+        g_ContextState = current ? 1 : -1;
+    }
+    g_ContextReady.notify_one();
+    if (!current)
+    {
+        fprintf(stderr, "ERROR: cannot make the upload context current.\n");
+        return;
+    }
+
+    while (!g_UploaderQuit.load())
+    {
+        UploadJob* job = RingPeek(&g_Pending);
+        if (job == NULL)
+        {
+            std::unique_lock<std::mutex> lock(g_WakeMutex);
+            g_Wake.wait_for(lock, std::chrono::milliseconds(2));
+            continue;
+        }
+
+        // A fila de devolução tem o mesmo tamanho da de pedidos, mas a
+        // thread do laço pode ainda não ter retirado os anteriores.
+        if (g_Finished.tail.load() - g_Finished.head.load() == UPLOADER_QUEUE_SIZE)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        RingPop(&g_Pending);
+
+        double start = AssetStats_NowMs();
+        {
+            TRACE_ZONE("Uploader_Job");
+            if (job->mesh != NULL)
+                UploadMesh(job);
+            else
+                UploadTexture(job);
+
+            // A fence marca o fim dos comandos acima; glFlush() garante que
+            // ela chegue à GPU sem depender de outros comandos deste contexto.
+            job->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+        job->upload_ms = AssetStats_NowMs() - start;
+
+        {
+            std::lock_guard<std::mutex> lock(g_StatsMutex);
+            g_UploaderStats.jobs += 1;
+            g_UploaderStats.busy_ms += job->upload_ms;
+            g_UploaderStats.bytes += job->gpu_bytes;
+        }
+
+        RingPush(&g_Finished, job);
+    }
+
+    if (g_PixelBuffer != 0)
+        glDeleteBuffers(1, &g_PixelBuffer);
+    g_PixelBuffer = 0;
+    glFinish();
+    MakeContextCurrent(false);
+}
+
+bool Uploader_Start(GLFWwindow* window)
+{
+    if (g_UploaderRunning)
+        return true;
+
+    if (window != NULL)
+    {
+        // As demais dicas (versão e perfil do OpenGL) continuam as usadas
+        // na criação da janela principal.
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        g_UploaderWindow = glfwCreateWindow(1, 1, "", NULL, window);
+        if (g_UploaderWindow == NULL)
+            return false;
+    }
+    else if (!Bench_CreateSharedContext())
+    {
+        return false;
+    }
+
+    g_Pending.head.store(0);
+    g_Pending.tail.store(0);
+    g_Finished.head.store(0);
+    g_Finished.tail.store(0);
+    memset(&g_UploaderStats, 0, sizeof(g_UploaderStats));
+    g_UploaderQuit.store(false);
+    g_ContextState = 0;
+    g_UploaderThread = std::thread(UploaderMain);
+
+    // Sem o contexto a thread termina; os pedidos enviados depois nunca
+    // seriam atendidos, então o envio fica com a thread do laço.
+    int state;
+    {
+        std::unique_lock<std::mutex> lock(g_WakeMutex);
+        while (g_ContextState == 0)
+            g_ContextReady.wait(lock);
+        state = g_ContextState;
+    }
+    if (state < 0)
+    {
+        g_UploaderThread.join();
+        if (g_UploaderWindow != NULL)
+            glfwDestroyWindow(g_UploaderWindow);
+        else
+            Bench_DestroySharedContext();
+        g_UploaderWindow = NULL;
+        return false;
+    }
+
+    g_UploaderRunning = true;
+    return true;
+}
+
+bool Uploader_IsRunning()
+{
+    return g_UploaderRunning;
+}
+
+bool Uploader_Submit(UploadJob* job)
+{
+    job->fence = 0;
+    job->texture_id = 0;
+    job->gpu_bytes = 0;
+    if (!RingPush(&g_Pending, job))
+        return false;
+    g_Wake.notify_one();
+    return true;
+}
+
+UploadJob* Uploader_PollFinished()
+{
+    UploadJob* job = RingPeek(&g_Finished);
+    if (job == NULL)
+        return NULL;
+
+    // Timeout 0: apenas consulta o estado da fence, sem bloquear o quadro.
+    GLenum result = glClientWaitSync(job->fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        std::lock_guard<std::mutex> lock(g_StatsMutex);
+        g_UploaderStats.pending_polls += 1;
+        return NULL;
+    }
+
+    glDeleteSync(job->fence);
+    job->fence = 0;
+    RingPop(&g_Finished);
+    return job;
+}
+
+void Uploader_Stop()
+{
+    if (!g_UploaderRunning)
+        return;
+
+    g_UploaderQuit.store(true);
+    g_Wake.notify_one();
+    g_UploaderThread.join();
+    g_UploaderRunning = false;
+
+    // Fences de pedidos terminados mas não devolvidos.
+    for (UploadJob* job = RingPeek(&g_Finished); job != NULL; job = RingPeek(&g_Finished))
+    {
+        glDeleteSync(job->fence);
+        job->fence = 0;
+        RingPop(&g_Finished);
+    }
+
+    if (g_UploaderWindow != NULL)
+        glfwDestroyWindow(g_UploaderWindow);
+    g_UploaderWindow = NULL;
+}
+
+UploaderStats Uploader_GetStats()
+{
+    std::lock_guard<std::mutex> lock(g_StatsMutex);
+    return g_UploaderStats;
+}